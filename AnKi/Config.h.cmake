@@ -140,6 +140,13 @@
 #	define ANKI_SIMD_NEON 1
 #endif
 
+// AVX2 is an extension of SSE. Some batched math uses it if the compiler targets it (see the ANKI_AVX2 CMake option)
+#if ANKI_SIMD_SSE && defined(__AVX2__) && defined(__FMA__)
+#	define ANKI_SIMD_AVX2 1
+#else
+#	define ANKI_SIMD_AVX2 0
+#endif
+
 // Graphics backend
 #define ANKI_GR_BACKEND_GL 0
 #define ANKI_GR_BACKEND_VULKAN 1
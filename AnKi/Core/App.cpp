@@ -129,6 +129,10 @@ void App::cleanup()
 	m_resourceFs = nullptr;
 	m_heapAlloc.deleteInstance(m_physics);
 	m_physics = nullptr;
+	m_heapAlloc.deleteInstance(m_gpuSceneMicroPatcher);
+	m_gpuSceneMicroPatcher = nullptr;
+	m_heapAlloc.deleteInstance(m_gpuSceneMem);
+	m_gpuSceneMem = nullptr;
 	m_heapAlloc.deleteInstance(m_stagingMem);
 	m_stagingMem = nullptr;
 	m_heapAlloc.deleteInstance(m_vertexMem);
@@ -137,6 +141,8 @@ void App::cleanup()
 	m_threadHive = nullptr;
 	m_heapAlloc.deleteInstance(m_maliHwCounters);
 	m_maliHwCounters = nullptr;
+	m_heapAlloc.deleteInstance(m_cpuHwCounters);
+	m_cpuHwCounters = nullptr;
 	GrManager::deleteInstance(m_gr);
 	m_gr = nullptr;
 	Input::deleteInstance(m_input);
@@ -151,6 +157,9 @@ void App::cleanup()
 
 	m_settingsDir.destroy(m_heapAlloc);
 	m_cacheDir.destroy(m_heapAlloc);
+
+	// Write all pending messages and stop the logger thread
+	LoggerSingleton::get().setAsync(false);
 }
 
 Error App::init(ConfigSet* config, AllocAlignedCallback allocCb, void* allocCbUserData)
@@ -170,6 +179,11 @@ Error App::init(ConfigSet* config, AllocAlignedCallback allocCb, void* allocCbUs
 Error App::initInternal(AllocAlignedCallback allocCb, void* allocCbUserData)
 {
 	LoggerSingleton::get().enableVerbosity(m_config->getCoreVerboseLog());
+	if(m_config->getCoreAsyncLogging())
+	{
+		// Don't turn it off, ANKI_LOG_ASYNC might have enabled it
+		LoggerSingleton::get().setAsync(true);
+	}
 
 	setSignalHandlers();
 
@@ -227,7 +241,7 @@ Error App::initInternal(AllocAlignedCallback allocCb, void* allocCbUserData)
 	//
 #if ANKI_ENABLE_TRACE
 	m_coreTracer = m_heapAlloc.newInstance<CoreTracer>();
-	ANKI_CHECK(m_coreTracer->init(m_heapAlloc, m_settingsDir));
+	ANKI_CHECK(m_coreTracer->init(m_heapAlloc, m_settingsDir, *m_config));
 #endif
 
 	//
@@ -273,6 +287,20 @@ Error App::initInternal(AllocAlignedCallback allocCb, void* allocCbUserData)
 		m_maliHwCounters = m_heapAlloc.newInstance<MaliHwCounters>(m_heapAlloc);
 	}
 
+	//
+	// CPU HW counters
+	//
+	if(m_config->getCoreCpuHwCounters())
+	{
+		m_cpuHwCounters = m_heapAlloc.newInstance<CpuHwCounters>();
+		if(m_cpuHwCounters->init())
+		{
+			ANKI_CORE_LOGW("CPU HW counters are not available. Check the perf_event_paranoid");
+			m_heapAlloc.deleteInstance(m_cpuHwCounters);
+			m_cpuHwCounters = nullptr;
+		}
+	}
+
 	//
 	// GPU mem
 	//
@@ -282,12 +310,19 @@ Error App::initInternal(AllocAlignedCallback allocCb, void* allocCbUserData)
 	m_stagingMem = m_heapAlloc.newInstance<StagingGpuMemoryPool>();
 	ANKI_CHECK(m_stagingMem->init(m_gr, *m_config));
 
+	m_gpuSceneMem = m_heapAlloc.newInstance<GpuSceneMemoryPool>();
+	ANKI_CHECK(m_gpuSceneMem->init(m_heapAlloc, m_gr, *m_config));
+
+	m_gpuSceneMicroPatcher = m_heapAlloc.newInstance<GpuSceneMicroPatcher>();
+	m_gpuSceneMicroPatcher->init(m_heapAlloc);
+
 	//
 	// Physics
 	//
 	m_physics = m_heapAlloc.newInstance<PhysicsWorld>();
 
-	ANKI_CHECK(m_physics->init(m_allocCb, m_allocCbData));
+	ANKI_CHECK(m_physics->init(m_allocCb, m_allocCbData,
+							   (m_config->getCoreMultithreadedPhysics()) ? m_threadHive : nullptr));
 
 	//
 	// Resource FS
@@ -328,6 +363,8 @@ Error App::initInternal(AllocAlignedCallback allocCb, void* allocCbUserData)
 	renderInit.m_resourceManager = m_resources;
 	renderInit.m_gr = m_gr;
 	renderInit.m_stagingMemory = m_stagingMem;
+	renderInit.m_gpuSceneMemory = m_gpuSceneMem;
+	renderInit.m_gpuSceneMicroPatcher = m_gpuSceneMicroPatcher;
 	renderInit.m_ui = m_ui;
 	renderInit.m_config = m_config;
 	renderInit.m_globTimestamp = &m_globalTimestamp;
@@ -346,7 +383,7 @@ Error App::initInternal(AllocAlignedCallback allocCb, void* allocCbUserData)
 	m_scene = m_heapAlloc.newInstance<SceneGraph>();
 
 	ANKI_CHECK(m_scene->init(m_allocCb, m_allocCbData, m_threadHive, m_resources, m_input, m_script, m_ui, m_config,
-							 &m_globalTimestamp));
+							 &m_globalTimestamp, m_gpuSceneMem, m_gpuSceneMicroPatcher));
 
 	// Inform the script engine about some subsystems
 	m_script->setRenderer(m_renderer);
@@ -415,7 +452,7 @@ Error App::mainLoop()
 	while(!quit)
 	{
 		{
-			ANKI_TRACE_SCOPED_EVENT(FRAME);
+			ANKI_TRACE_SCOPED_HW_EVENT(FRAME);
 			const Second startTime = HighRezTimer::getCurrentTime();
 
 			prevUpdateTime = crntTime;
@@ -450,6 +487,7 @@ Error App::mainLoop()
 
 			m_gr->swapBuffers();
 			m_stagingMem->endFrame();
+			m_vertexMem->endFrame();
 
 			// Update the trace info with some async loader stats
 			U64 asyncTaskCount = m_resources->getAsyncLoader().getCompletedTaskCount();
@@ -491,11 +529,26 @@ Error App::mainLoop()
 					statsUi.setGpuWriteBandwidth(out.m_writeBandwidth);
 				}
 
+				if(m_cpuHwCounters)
+				{
+					CpuHwCounterValues values;
+					m_cpuHwCounters->read(values);
+
+					CpuHwCounterValues deltas;
+					for(U32 i = 0; i < values.getSize(); ++i)
+					{
+						deltas[i] = values[i] - m_prevCpuHwCounters[i];
+					}
+					m_prevCpuHwCounters = values;
+
+					statsUi.setCpuHwCounters(deltas, *m_cpuHwCounters);
+				}
+
 				statsUi.setAllocatedCpuMemory(m_memStats.m_allocatedMem.load());
 				statsUi.setCpuAllocationCount(m_memStats.m_allocCount.load());
 				statsUi.setCpuFreeCount(m_memStats.m_freeCount.load());
 				statsUi.setGrStats(m_gr->getStats());
-				BuddyAllocatorBuilderStats vertMemStats;
+				VertexGpuMemoryPoolStats vertMemStats;
 				m_vertexMem->getMemoryStats(vertMemStats);
 				statsUi.setGlobalVertexMemoryPoolStats(vertMemStats);
 
@@ -600,6 +653,9 @@ void App::setSignalHandlers()
 			break;
 		}
 
+		// Try to write the pending log messages. They might explain the crash
+		LoggerSingleton::get().flushOnCrash();
+
 		if(name)
 			printf("Caught signal %d (%s)\n", signum, name);
 		else
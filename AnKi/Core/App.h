@@ -9,6 +9,7 @@
 #include <AnKi/Util/Allocator.h>
 #include <AnKi/Util/String.h>
 #include <AnKi/Util/Ptr.h>
+#include <AnKi/Util/CpuHwCounters.h>
 #include <AnKi/Ui/UiImmediateModeBuilder.h>
 
 namespace anki {
@@ -28,6 +29,8 @@ class ResourceManager;
 class ResourceFilesystem;
 class StagingGpuMemoryPool;
 class VertexGpuMemoryPool;
+class GpuSceneMemoryPool;
+class GpuSceneMicroPatcher;
 class UiManager;
 class UiQueueElement;
 class RenderQueue;
@@ -165,8 +168,11 @@ private:
 	ThreadHive* m_threadHive = nullptr;
 	GrManager* m_gr = nullptr;
 	MaliHwCounters* m_maliHwCounters = nullptr;
+	CpuHwCounters* m_cpuHwCounters = nullptr; ///< The counters of the main thread.
 	VertexGpuMemoryPool* m_vertexMem = nullptr;
 	StagingGpuMemoryPool* m_stagingMem = nullptr;
+	GpuSceneMemoryPool* m_gpuSceneMem = nullptr;
+	GpuSceneMicroPatcher* m_gpuSceneMicroPatcher = nullptr;
 	PhysicsWorld* m_physics = nullptr;
 	ResourceFilesystem* m_resourceFs = nullptr;
 	ResourceManager* m_resources = nullptr;
@@ -183,6 +189,7 @@ private:
 	String m_settingsDir; ///< The path that holds the configuration
 	String m_cacheDir; ///< This is used as a cache
 	U64 m_resourceCompletedAsyncTaskCount = 0;
+	CpuHwCounterValues m_prevCpuHwCounters = {};
 
 	class MemStats
 	{
@@ -10,8 +10,26 @@ ANKI_CONFIG_VAR_PTR_SIZE(CoreStoragePerFrameMemorySize, 24_MB, 1_MB, 1_GB, "Stor
 ANKI_CONFIG_VAR_PTR_SIZE(CoreVertexPerFrameMemorySize, 12_MB, 1_MB, 1_GB, "Vertex staging buffer size")
 ANKI_CONFIG_VAR_PTR_SIZE(CoreTextureBufferPerFrameMemorySize, 1_MB, 1_MB, 1_GB, "Texture staging buffer size")
 ANKI_CONFIG_VAR_PTR_SIZE(CoreGlobalVertexMemorySize, 128_MB, 16_MB, 2_GB, "Global index and vertex buffer size")
+ANKI_CONFIG_VAR_BOOL(CoreTlsfVertexMemory, true,
+					 "Use a TLSF allocator for the global vertex memory. If false use a buddy allocator")
+ANKI_CONFIG_VAR_PTR_SIZE(CoreVertexMemoryDefragmentationBudget, 4_MB, 0, 256_MB,
+						 "Max bytes of vertex memory to move every frame in order to defragment it. 0 to disable")
+ANKI_CONFIG_VAR_PTR_SIZE(CoreGpuSceneMemorySize, 16_MB, 1_MB, 1_GB, "The size of the buffer that holds the GPU scene")
+
+ANKI_CONFIG_VAR_BOOL(CoreAsyncLogging, false,
+					 "Format the log messages in the caller but write them to the log handlers in a background thread")
 
 ANKI_CONFIG_VAR_BOOL(CoreMaliHwCounters, false, "Enable Mali counters")
+ANKI_CONFIG_VAR_BOOL(CoreCpuHwCounters, false,
+					 "Enable CPU counters (perf_event on Linux) for the stats and the HW events of the tracer")
+
+ANKI_CONFIG_VAR_BOOL(CoreTracerFlightRecorder, false,
+					 "Keep only the recent trace events in memory and write them to a file on frame spikes")
+ANKI_CONFIG_VAR_F32(CoreTracerFlightRecorderSeconds, 5.0f, 0.1f, 600.0f, "The seconds of events that a dump will have")
+ANKI_CONFIG_VAR_U32(CoreTracerFlightRecorderChunkCount, 64, 1, 16 * 1024,
+					"The memory of the flight recorder in chunks of 256 events per thread")
+ANKI_CONFIG_VAR_F32(CoreTracerFrameSpikeThreshold, 50.0f, 0.0f, 10000.0f,
+					"Frames longer than that (in ms) trigger a flight recorder dump. 0 to disable")
 
 ANKI_CONFIG_VAR_U32(Width, 1920, 16, 16 * 1024, "Width")
 ANKI_CONFIG_VAR_U32(Height, 1080, 16, 16 * 1024, "Height")
@@ -19,6 +37,7 @@ ANKI_CONFIG_VAR_BOOL(WindowFullscreen, false, "Start at fullscreen")
 
 ANKI_CONFIG_VAR_U32(CoreTargetFps, 60u, 30u, MAX_U32, "Target FPS")
 ANKI_CONFIG_VAR_U32(CoreJobThreadCount, max(2u, getCpuCoresCount() / 2u), 2u, 1024u, "Number of job thread")
+ANKI_CONFIG_VAR_BOOL(CoreMultithreadedPhysics, false, "Step the physics world in the job threads")
 ANKI_CONFIG_VAR_BOOL(CoreDisplayStats, false, "Display stats")
 ANKI_CONFIG_VAR_BOOL(CoreClearCaches, false, "Clear all caches")
 ANKI_CONFIG_VAR_BOOL(CoreVerboseLog, false, "Verbose logging")
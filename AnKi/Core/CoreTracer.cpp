@@ -4,7 +4,9 @@
 // http://www.anki3d.org/LICENSE
 
 #include <AnKi/Core/CoreTracer.h>
+#include <AnKi/Core/ConfigSet.h>
 #include <AnKi/Util/DynamicArray.h>
+#include <AnKi/Util/HighRezTimer.h>
 #include <AnKi/Util/Tracer.h>
 #include <AnKi/Util/System.h>
 #include <AnKi/Math/Functions.h>
@@ -37,6 +39,7 @@ public:
 	DynamicArrayAuto<TracerCounter> m_counters;
 	ThreadId m_tid;
 	U64 m_frame;
+	U32 m_dumpIdx = 0; ///< If not zero the events go to a flight recorder dump.
 
 	ThreadWorkItem(GenericMemoryPoolAllocator<U8>& alloc)
 		: m_events(alloc)
@@ -73,11 +76,9 @@ CoreTracer::~CoreTracer()
 	Error err = m_thread.join();
 	(void)err;
 
-	// Finalize trace file
-	if(m_traceJsonFile.isOpen())
-	{
-		err = m_traceJsonFile.writeText("{}\n]\n");
-	}
+	// Close the trace files
+	m_traceFile.close();
+	m_dumpFile.close();
 
 	// Write counter file
 	err = writeCountersForReal();
@@ -100,18 +101,31 @@ CoreTracer::~CoreTracer()
 		s.destroy(m_alloc);
 	}
 	m_counterNames.destroy(m_alloc);
+	m_filenamePrefix.destroy(m_alloc);
 
 	// Destroy the tracer
 	TracerSingleton::destroy();
 }
 
-Error CoreTracer::init(GenericMemoryPoolAllocator<U8> alloc, CString directory)
+Error CoreTracer::init(GenericMemoryPoolAllocator<U8> alloc, CString directory, const ConfigSet& config)
 {
+	m_flightRecorder = config.getCoreTracerFlightRecorder();
+	m_flightRecorderDuration = config.getCoreTracerFlightRecorderSeconds();
+	m_frameSpikeThreshold = config.getCoreTracerFrameSpikeThreshold() / 1000.0;
+
 	TracerSingleton::init(alloc);
-	const Bool enableTracer = getenv("ANKI_CORE_TRACER_ENABLED") && getenv("ANKI_CORE_TRACER_ENABLED")[0] == '1';
+	const Bool enableTracer = m_flightRecorder
+							  || (getenv("ANKI_CORE_TRACER_ENABLED") && getenv("ANKI_CORE_TRACER_ENABLED")[0] == '1');
 	TracerSingleton::get().setEnabled(enableTracer);
+	TracerSingleton::get().setHwCountersEnabled(config.getCoreCpuHwCounters());
 	ANKI_CORE_LOGI("Tracing is %s from the beginning", (enableTracer) ? "enabled" : "disabled");
 
+	if(m_flightRecorder)
+	{
+		TracerSingleton::get().setMaxChunksPerThread(config.getCoreTracerFlightRecorderChunkCount());
+		ANKI_CORE_LOGI("Tracer flight recorder is enabled. It will keep the last %f seconds", m_flightRecorderDuration);
+	}
+
 	m_alloc = alloc;
 	m_thread.start(this, [](ThreadCallbackInfo& info) -> Error {
 		return static_cast<CoreTracer*>(info.m_userData)->threadWorker();
@@ -122,10 +136,16 @@ Error CoreTracer::init(GenericMemoryPoolAllocator<U8> alloc, CString directory)
 	fname.sprintf("%s/%d%02d%02d-%02d%02d_", directory.cstr(), tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour,
 				  tm.tm_min);
 
-	ANKI_CHECK(m_traceJsonFile.open(StringAuto(alloc).sprintf("%strace.json", fname.cstr()), FileOpenFlag::WRITE));
-	ANKI_CHECK(m_traceJsonFile.writeText("[\n"));
+	m_filenamePrefix.create(m_alloc, fname);
+
+	// In flight recorder mode the files are created on every dump
+	if(!m_flightRecorder)
+	{
+		ANKI_CHECK(m_traceFile.open(m_alloc, StringAuto(alloc).sprintf("%strace.ankitrace", fname.cstr())));
 
-	ANKI_CHECK(m_countersCsvFile.open(StringAuto(alloc).sprintf("%scounters.csv", fname.cstr()), FileOpenFlag::WRITE));
+		ANKI_CHECK(
+			m_countersCsvFile.open(StringAuto(alloc).sprintf("%scounters.csv", fname.cstr()), FileOpenFlag::WRITE));
+	}
 
 	return Error::NONE;
 }
@@ -164,7 +184,7 @@ Error CoreTracer::threadWorker()
 		{
 			err = writeEvents(*item);
 
-			if(!err)
+			if(!err && item->m_dumpIdx == 0)
 			{
 				gatherCounters(*item);
 			}
@@ -178,33 +198,42 @@ Error CoreTracer::threadWorker()
 
 Error CoreTracer::writeEvents(ThreadWorkItem& item)
 {
-	// First sort them to fix overlaping in chrome
-	std::sort(item.m_events.getBegin(), item.m_events.getEnd(), [](const TracerEvent& a, TracerEvent& b) {
-		return (a.m_start != b.m_start) ? a.m_start < b.m_start : a.m_duration > b.m_duration;
-	});
+	if(item.m_dumpIdx == 0)
+	{
+		return m_traceFile.writeEvents(item.m_tid, item.m_frame, item.m_events);
+	}
 
-	// Write events
-	for(const TracerEvent& event : item.m_events)
+	// The items of a dump are pushed in one go so open a new file when the dump changes
+	if(item.m_dumpIdx != m_dumpFileIdx)
 	{
-		const I64 startMicroSec = I64(event.m_start * 1000000.0);
-		const I64 durMicroSec = I64(event.m_duration * 1000000.0);
+		m_dumpFile.close();
 
-		// Do a hack
-		const ThreadId tid = (event.m_name == "GPU_TIME") ? 1 : item.m_tid;
+		StringAuto fname(m_alloc);
+		fname.sprintf("%sflight_%u.ankitrace", m_filenamePrefix.cstr(), item.m_dumpIdx);
+		ANKI_CHECK(m_dumpFile.open(m_alloc, fname));
+		m_dumpFileIdx = item.m_dumpIdx;
 
-		ANKI_CHECK(m_traceJsonFile.writeText("{\"name\": \"%s\", \"cat\": \"PERF\", \"ph\": \"X\", "
-											 "\"pid\": 1, \"tid\": %llu, \"ts\": %lld, \"dur\": %lld},\n",
-											 event.m_name.cstr(), tid, startMicroSec, durMicroSec));
+		ANKI_CORE_LOGI("Writing tracer flight recorder dump: %s", fname.cstr());
 	}
 
-	// Store counters
-	// TODO
-
-	return Error::NONE;
+	return m_dumpFile.writeEvents(item.m_tid, item.m_frame, item.m_events);
 }
 
 void CoreTracer::gatherCounters(ThreadWorkItem& item)
 {
+	// The durations of the events are counters as well. In ns
+	for(const TracerEvent& event : item.m_events)
+	{
+		TracerCounter& counter = *item.m_counters.emplaceBack();
+		counter.m_name = event.m_name;
+		counter.m_value = U64(event.m_duration * 1000000000.0);
+	}
+
+	if(item.m_counters.getSize() == 0)
+	{
+		return;
+	}
+
 	// Sort
 	std::sort(item.m_counters.getBegin(), item.m_counters.getEnd(), [](const TracerCounter& a, const TracerCounter& b) {
 		return a.m_name < b.m_name;
@@ -292,6 +321,35 @@ void CoreTracer::gatherCounters(ThreadWorkItem& item)
 
 void CoreTracer::flushFrame(U64 frame)
 {
+	if(m_flightRecorder)
+	{
+		const Second now = HighRezTimer::getCurrentTime();
+		const Second frameTime = (m_prevFrameTime > 0.0) ? now - m_prevFrameTime : 0.0;
+		m_prevFrameTime = now;
+
+		Bool dump = m_flightRecorderDumpRequested.exchange(false);
+
+		// Dump on spikes but not on consecutive frames since the dump would contain the same events
+		if(m_frameSpikeThreshold > 0.0 && frameTime > m_frameSpikeThreshold
+		   && now - m_lastDumpTime > m_flightRecorderDuration)
+		{
+			ANKI_CORE_LOGW("Frame took %f ms. Dumping the tracer flight recorder", frameTime * 1000.0);
+			dump = true;
+		}
+
+		if(dump)
+		{
+			m_lastDumpTime = now;
+			dumpFlightRecorder(frame);
+		}
+		else
+		{
+			TracerSingleton::get().discardOldChunks();
+		}
+
+		return;
+	}
+
 	struct Ctx
 	{
 		U64 m_frame;
@@ -330,6 +388,64 @@ void CoreTracer::flushFrame(U64 frame)
 		&ctx);
 }
 
+void CoreTracer::dumpFlightRecorder(U64 frame)
+{
+	class Ctx
+	{
+	public:
+		CoreTracer* m_self;
+		U64 m_frame;
+		U32 m_dumpIdx;
+		Second m_oldestTime;
+		IntrusiveList<ThreadWorkItem> m_items;
+	};
+
+	Ctx ctx;
+	ctx.m_self = this;
+	ctx.m_frame = frame;
+	ctx.m_dumpIdx = ++m_dumpCount;
+	ctx.m_oldestTime = HighRezTimer::getCurrentTime() - m_flightRecorderDuration;
+
+	TracerSingleton::get().flush(
+		[](void* ud, ThreadId tid, ConstWeakArray<TracerEvent> events, ConstWeakArray<TracerCounter> counters) {
+			Ctx& ctx = *static_cast<Ctx*>(ud);
+			CoreTracer& self = *ctx.m_self;
+
+			ThreadWorkItem* item = nullptr;
+			for(const TracerEvent& event : events)
+			{
+				if(event.m_start < ctx.m_oldestTime)
+				{
+					continue;
+				}
+
+				if(item == nullptr)
+				{
+					item = self.m_alloc.newInstance<ThreadWorkItem>(self.m_alloc);
+					item->m_tid = tid;
+					item->m_frame = ctx.m_frame;
+					item->m_dumpIdx = ctx.m_dumpIdx;
+				}
+
+				item->m_events.emplaceBack(event);
+			}
+
+			if(item)
+			{
+				ctx.m_items.pushBack(item);
+			}
+		},
+		&ctx);
+
+	// Push all the items of the dump together so the worker can write them to the same file
+	LockGuard<Mutex> lock(m_mtx);
+	while(!ctx.m_items.isEmpty())
+	{
+		m_workItems.pushBack(ctx.m_items.popFront());
+	}
+	m_cvar.notifyOne();
+}
+
 Error CoreTracer::writeCountersForReal()
 {
 	if(!m_countersCsvFile.isOpen() || m_frameCounters.getSize() == 0)
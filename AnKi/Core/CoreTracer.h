@@ -10,13 +10,22 @@
 #include <AnKi/Util/Allocator.h>
 #include <AnKi/Util/List.h>
 #include <AnKi/Util/File.h>
+#include <AnKi/Util/Atomic.h>
+#include <AnKi/Core/TraceFile.h>
 
 namespace anki {
 
 /// @addtogroup core
 /// @{
 
-/// A system that sits on top of the tracer and processes the counters and events.
+// Forward
+class ConfigSet;
+
+/// A system that sits on top of the tracer and processes the counters and events. It has two modes. The default one
+/// streams all events to a binary trace file and the counters to a CSV file. The flight recorder mode keeps only the
+/// most recent events in memory and writes the last few seconds to a separate file when a frame takes too long or when
+/// requestFlightRecorderDump() is called. The trace files can be converted to the Chrome trace format with the
+/// TraceConverter tool.
 class CoreTracer
 {
 public:
@@ -25,11 +34,18 @@ public:
 	~CoreTracer();
 
 	/// @param directory The directory to store the trace and counters.
-	ANKI_USE_RESULT Error init(GenericMemoryPoolAllocator<U8> alloc, CString directory);
+	ANKI_USE_RESULT Error init(GenericMemoryPoolAllocator<U8> alloc, CString directory, const ConfigSet& config);
 
 	/// It will flush everything.
 	void flushFrame(U64 frame);
 
+	/// Write the contents of the flight recorder to a file at the end of the frame.
+	/// @note It's thread-safe.
+	void requestFlightRecorderDump()
+	{
+		m_flightRecorderDumpRequested.store(true);
+	}
+
 private:
 	class ThreadWorkItem;
 	class PerFrameCounters;
@@ -44,15 +60,31 @@ private:
 	IntrusiveList<PerFrameCounters> m_frameCounters;
 
 	IntrusiveList<ThreadWorkItem> m_workItems; ///< Items for the thread to process.
-	File m_traceJsonFile;
+	TraceFileWriter m_traceFile;
 	File m_countersCsvFile;
+	String m_filenamePrefix;
 	Bool m_quit = false;
 
+	/// @name Flight recorder
+	/// @{
+	Bool m_flightRecorder = false;
+	Second m_flightRecorderDuration = 0.0;
+	Second m_frameSpikeThreshold = 0.0;
+	Second m_prevFrameTime = 0.0;
+	Second m_lastDumpTime = 0.0;
+	U32 m_dumpCount = 0;
+	Atomic<Bool> m_flightRecorderDumpRequested = {false};
+	TraceFileWriter m_dumpFile; ///< Only the tracer thread touches it.
+	U32 m_dumpFileIdx = 0;
+	/// @}
+
 	Error threadWorker();
 
 	Error writeEvents(ThreadWorkItem& item);
 	void gatherCounters(ThreadWorkItem& item);
 	Error writeCountersForReal();
+
+	void dumpFlightRecorder(U64 frame);
 };
 /// @}
 
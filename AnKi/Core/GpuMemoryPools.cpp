@@ -6,29 +6,46 @@
 #include <AnKi/Core/GpuMemoryPools.h>
 #include <AnKi/Core/ConfigSet.h>
 #include <AnKi/Gr/GrManager.h>
+#include <AnKi/Gr/CommandBuffer.h>
 #include <AnKi/Util/Tracer.h>
 
 namespace anki {
 
 VertexGpuMemoryPool::~VertexGpuMemoryPool()
 {
-	// Do nothing
+	// The GPU is idle by now
+	for(DynamicArray<Range>& garbage : m_garbage)
+	{
+		for(const Range& range : garbage)
+		{
+			freeInternal(range.m_size, range.m_offset);
+		}
+
+		garbage.destroy(m_alloc);
+	}
+
+	ANKI_ASSERT(m_relocatables.getSize() == 0 && "Someone forgot to free");
+	m_relocatables.destroy(m_alloc);
 }
 
 Error VertexGpuMemoryPool::init(GenericMemoryPoolAllocator<U8> alloc, GrManager* gr, const ConfigSet& cfg)
 {
+	m_alloc = alloc;
 	m_gr = gr;
+	m_useTlsf = cfg.getCoreTlsfVertexMemory();
+	m_defragmentationBudget = cfg.getCoreVertexMemoryDefragmentationBudget();
 
 	// Create the GPU buffer.
 	BufferInitInfo bufferInit("Global vertex & index");
 	bufferInit.m_size = cfg.getCoreGlobalVertexMemorySize();
-	if(!isPowerOfTwo(bufferInit.m_size))
+	if(!m_useTlsf && !isPowerOfTwo(bufferInit.m_size))
 	{
 		ANKI_CORE_LOGE("core_globalVertexMemorySize should be a power of two (because of the buddy allocator");
 		return Error::USER_DATA;
 	}
 
-	bufferInit.m_usage = BufferUsageBit::VERTEX | BufferUsageBit::INDEX | BufferUsageBit::TRANSFER_DESTINATION;
+	bufferInit.m_usage = BufferUsageBit::VERTEX | BufferUsageBit::INDEX | BufferUsageBit::TRANSFER_DESTINATION
+						 | BufferUsageBit::TRANSFER_SOURCE;
 	if(gr->getDeviceCapabilities().m_rayTracingEnabled)
 	{
 		bufferInit.m_usage |= BufferUsageBit::ACCELERATION_STRUCTURE_BUILD;
@@ -37,33 +54,218 @@ Error VertexGpuMemoryPool::init(GenericMemoryPoolAllocator<U8> alloc, GrManager*
 	m_vertBuffer = gr->newBuffer(bufferInit);
 
 	// Init the rest
-	m_buddyAllocator.init(alloc, __builtin_ctzll(bufferInit.m_size));
+	if(m_useTlsf)
+	{
+		m_tlsfAllocator.init(alloc, bufferInit.m_size);
+	}
+	else
+	{
+		m_buddyAllocator.init(alloc, __builtin_ctzll(bufferInit.m_size));
+	}
 
 	return Error::NONE;
 }
 
+Bool VertexGpuMemoryPool::allocateInternal(PtrSize size, PtrSize& offset)
+{
+	if(m_useTlsf)
+	{
+		return m_tlsfAllocator.allocate(size, 4, offset);
+	}
+	else
+	{
+		U32 offset32;
+		const Bool success = m_buddyAllocator.allocate(size, 4, offset32);
+		if(success)
+		{
+			offset = offset32;
+		}
+
+		return success;
+	}
+}
+
+void VertexGpuMemoryPool::freeInternal(PtrSize size, PtrSize offset)
+{
+	if(m_useTlsf)
+	{
+		m_tlsfAllocator.free(offset, size, 4);
+	}
+	else
+	{
+		m_buddyAllocator.free(U32(offset), size, 4);
+	}
+}
+
 ANKI_USE_RESULT Error VertexGpuMemoryPool::allocate(PtrSize size, PtrSize& offset)
 {
-	U32 offset32;
-	const Bool success = m_buddyAllocator.allocate(size, 4, offset32);
+	const Bool success = allocateInternal(size, offset);
 	if(ANKI_UNLIKELY(!success))
 	{
-		BuddyAllocatorBuilderStats stats;
-		m_buddyAllocator.getStats(stats);
+		VertexGpuMemoryPoolStats stats;
+		getMemoryStats(stats);
 		ANKI_CORE_LOGE("Failed to allocate vertex memory of size %zu. The allocator has %zu (user requested %zu) out "
-					   "%zu allocated",
-					   size, stats.m_realAllocatedSize, stats.m_userAllocatedSize, m_vertBuffer->getSize());
+					   "%zu allocated. External fragmentation %f",
+					   size, stats.m_realAllocatedSize, stats.m_userAllocatedSize, m_vertBuffer->getSize(),
+					   stats.m_externalFragmentation);
 		return Error::OUT_OF_MEMORY;
 	}
 
-	offset = offset32;
-
 	return Error::NONE;
 }
 
 void VertexGpuMemoryPool::free(PtrSize size, PtrSize offset)
 {
-	m_buddyAllocator.free(U32(offset), size, 4);
+	{
+		LockGuard<Mutex> lock(m_relocationMtx);
+
+		for(U32 i = 0; i < m_relocatables.getSize(); ++i)
+		{
+			if(m_relocatables[i].m_offset == offset)
+			{
+				ANKI_ASSERT(m_relocatables[i].m_size == size);
+				m_relocatables[i] = m_relocatables.getBack();
+				m_relocatables.popBack(m_alloc);
+				break;
+			}
+		}
+	}
+
+	freeInternal(size, offset);
+}
+
+void VertexGpuMemoryPool::makeRelocatable(PtrSize size, PtrSize offset, VertexGpuMemoryRelocationCallback callback,
+										  void* userData)
+{
+	ANKI_ASSERT(callback);
+	LockGuard<Mutex> lock(m_relocationMtx);
+	m_relocatables.emplaceBack(m_alloc, RelocatableAllocation{offset, size, callback, userData});
+}
+
+void VertexGpuMemoryPool::endFrame()
+{
+	ANKI_TRACE_SCOPED_EVENT(VERTEX_MEM_DEFRAG);
+	LockGuard<Mutex> lock(m_relocationMtx);
+
+	// The frames that might have used the old ranges are done
+	m_frame = (m_frame + 1) % MAX_FRAMES_IN_FLIGHT;
+	for(const Range& range : m_garbage[m_frame])
+	{
+		freeInternal(range.m_size, range.m_offset);
+	}
+	m_garbage[m_frame].destroy(m_alloc);
+
+	if(m_defragmentationBudget > 0)
+	{
+		defragment();
+	}
+}
+
+void VertexGpuMemoryPool::defragment()
+{
+	// Don't bother if the free memory is contiguous enough
+	constexpr F32 MIN_EXTERNAL_FRAGMENTATION = 0.1f;
+	VertexGpuMemoryPoolStats stats;
+	getMemoryStats(stats);
+	if(stats.m_externalFragmentation < MIN_EXTERNAL_FRAGMENTATION || m_relocatables.getSize() == 0)
+	{
+		return;
+	}
+
+	// Try to move the allocations that are at the end of the buffer to free space that is closer to the beginning. That
+	// way the free space gathers at the end
+	std::sort(m_relocatables.getBegin(), m_relocatables.getEnd(),
+			  [](const RelocatableAllocation& a, const RelocatableAllocation& b) {
+				  return a.m_offset > b.m_offset;
+			  });
+
+	CommandBufferPtr cmdb;
+	PtrSize budget = m_defragmentationBudget;
+	for(RelocatableAllocation& relocatable : m_relocatables)
+	{
+		if(relocatable.m_size > budget)
+		{
+			continue;
+		}
+
+		PtrSize newOffset;
+		if(!allocateInternal(relocatable.m_size, newOffset))
+		{
+			continue;
+		}
+
+		if(newOffset > relocatable.m_offset)
+		{
+			// Moving it will make things worse
+			freeInternal(relocatable.m_size, newOffset);
+			continue;
+		}
+
+		if(!cmdb.isCreated())
+		{
+			CommandBufferInitInfo cmdbInit;
+			cmdbInit.m_flags = CommandBufferFlag::SMALL_BATCH | CommandBufferFlag::GENERAL_WORK;
+			cmdb = m_gr->newCommandBuffer(cmdbInit);
+
+			cmdb->setBufferBarrier(m_vertBuffer,
+								   BufferUsageBit::VERTEX | BufferUsageBit::INDEX
+									   | BufferUsageBit::TRANSFER_DESTINATION,
+								   BufferUsageBit::TRANSFER_SOURCE | BufferUsageBit::TRANSFER_DESTINATION, 0,
+								   MAX_PTR_SIZE);
+		}
+
+		// The ranges don't overlap because the new range was free
+		cmdb->copyBufferToBuffer(m_vertBuffer, relocatable.m_offset, m_vertBuffer, newOffset, relocatable.m_size);
+
+		// The frames in flight still use the old range. Release it later
+		m_garbage[m_frame].emplaceBack(m_alloc, Range{relocatable.m_offset, relocatable.m_size});
+
+		relocatable.m_callback(relocatable.m_userData, relocatable.m_offset, newOffset);
+		relocatable.m_offset = newOffset;
+
+		budget -= relocatable.m_size;
+		m_relocatedSize += relocatable.m_size;
+		++m_relocationCount;
+	}
+
+	if(cmdb.isCreated())
+	{
+		BufferUsageBit after = BufferUsageBit::VERTEX | BufferUsageBit::INDEX;
+		if(m_gr->getDeviceCapabilities().m_rayTracingEnabled)
+		{
+			after |= BufferUsageBit::ACCELERATION_STRUCTURE_BUILD;
+		}
+
+		cmdb->setBufferBarrier(m_vertBuffer, BufferUsageBit::TRANSFER_SOURCE | BufferUsageBit::TRANSFER_DESTINATION,
+							   after, 0, MAX_PTR_SIZE);
+		cmdb->flush();
+	}
+}
+
+void VertexGpuMemoryPool::getMemoryStats(VertexGpuMemoryPoolStats& stats) const
+{
+	if(m_useTlsf)
+	{
+		TlsfAllocatorBuilderStats tlsfStats;
+		m_tlsfAllocator.getStats(tlsfStats);
+		stats.m_userAllocatedSize = tlsfStats.m_userAllocatedSize;
+		stats.m_realAllocatedSize = tlsfStats.m_realAllocatedSize;
+		stats.m_externalFragmentation = tlsfStats.m_externalFragmentation;
+		stats.m_internalFragmentation = tlsfStats.m_internalFragmentation;
+	}
+	else
+	{
+		BuddyAllocatorBuilderStats buddyStats;
+		m_buddyAllocator.getStats(buddyStats);
+		stats.m_userAllocatedSize = buddyStats.m_userAllocatedSize;
+		stats.m_realAllocatedSize = buddyStats.m_realAllocatedSize;
+		stats.m_externalFragmentation = buddyStats.m_externalFragmentation;
+		stats.m_internalFragmentation = buddyStats.m_internalFragmentation;
+	}
+
+	// Not locking, they are just stats
+	stats.m_relocatedSize = m_relocatedSize;
+	stats.m_relocationCount = m_relocationCount;
 }
 
 StagingGpuMemoryPool::~StagingGpuMemoryPool()
@@ -173,4 +375,134 @@ void StagingGpuMemoryPool::endFrame()
 	}
 }
 
+GpuSceneMemoryPool::~GpuSceneMemoryPool()
+{
+	// Do nothing
+}
+
+Error GpuSceneMemoryPool::init(GenericMemoryPoolAllocator<U8> alloc, GrManager* gr, const ConfigSet& cfg)
+{
+	BufferInitInfo bufferInit("GPU scene");
+	bufferInit.m_size = cfg.getCoreGpuSceneMemorySize();
+	if(!isPowerOfTwo(bufferInit.m_size))
+	{
+		ANKI_CORE_LOGE("core_gpuSceneMemorySize should be a power of two (because of the buddy allocator");
+		return Error::USER_DATA;
+	}
+
+	bufferInit.m_usage = BufferUsageBit::ALL_STORAGE | BufferUsageBit::TRANSFER_DESTINATION;
+	m_buffer = gr->newBuffer(bufferInit);
+
+	m_buddyAllocator.init(alloc, __builtin_ctzll(bufferInit.m_size));
+
+	return Error::NONE;
+}
+
+Error GpuSceneMemoryPool::allocate(PtrSize size, PtrSize& offset)
+{
+	U32 offset32;
+	const Bool success = m_buddyAllocator.allocate(size, 16, offset32);
+	if(ANKI_UNLIKELY(!success))
+	{
+		BuddyAllocatorBuilderStats stats;
+		m_buddyAllocator.getStats(stats);
+		ANKI_CORE_LOGE("Failed to allocate GPU scene memory of size %zu. The allocator has %zu (user requested %zu) "
+					   "out %zu allocated",
+					   size, stats.m_realAllocatedSize, stats.m_userAllocatedSize, m_buffer->getSize());
+		return Error::OUT_OF_MEMORY;
+	}
+
+	offset = offset32;
+
+	return Error::NONE;
+}
+
+void GpuSceneMemoryPool::free(PtrSize size, PtrSize offset)
+{
+	m_buddyAllocator.free(U32(offset), size, 16);
+}
+
+GpuSceneMicroPatcher::~GpuSceneMicroPatcher()
+{
+	m_crntFramePatchHeaders.destroy(m_alloc);
+	m_crntFramePatchData.destroy(m_alloc);
+}
+
+void GpuSceneMicroPatcher::init(GenericMemoryPoolAllocator<U8> alloc)
+{
+	m_alloc = alloc;
+}
+
+void GpuSceneMicroPatcher::newCopy(PtrSize gpuSceneDestOffset, PtrSize dataSize, const void* data)
+{
+	ANKI_ASSERT(dataSize > 0 && (dataSize % 4) == 0);
+	ANKI_ASSERT((gpuSceneDestOffset % 4) == 0 && gpuSceneDestOffset / 4 < MAX_U32);
+	ANKI_ASSERT(data);
+
+	const U32 dataDwords = U32(dataSize / 4);
+	U32 gpuSceneDestDwordOffset = U32(gpuSceneDestOffset / 4);
+	const U32* patchIt = static_cast<const U32*>(data);
+	const U32* const patchEnd = patchIt + dataDwords;
+
+	LockGuard<Mutex> lock(m_mtx);
+
+	// Break the data into patches of the workgroup size so every workgroup does the same amount of work
+	while(patchIt < patchEnd)
+	{
+		const U32 patchDwords = min(U32(patchEnd - patchIt), GPU_SCENE_MICRO_PATCHING_WORKGROUP_SIZE);
+
+		GpuSceneMicroPatch& header = *m_crntFramePatchHeaders.emplaceBack(m_alloc);
+		header.m_srcDwordOffset = m_crntFramePatchData.getSize();
+		header.m_dstDwordOffset = gpuSceneDestDwordOffset;
+		header.m_dwordCount = patchDwords;
+		header.m_padding = 0;
+
+		const U32 srcOffset = m_crntFramePatchData.getSize();
+		m_crntFramePatchData.resize(m_alloc, srcOffset + patchDwords);
+		memcpy(&m_crntFramePatchData[srcOffset], patchIt, patchDwords * sizeof(U32));
+
+		patchIt += patchDwords;
+		gpuSceneDestDwordOffset += patchDwords;
+	}
+}
+
+void GpuSceneMicroPatcher::patchGpuScene(StagingGpuMemoryPool& stagingMem, CommandBuffer& cmdb,
+										 const BufferPtr& gpuSceneBuffer)
+{
+	ANKI_TRACE_SCOPED_EVENT(GPU_SCENE_PATCH);
+	LockGuard<Mutex> lock(m_mtx);
+
+	if(m_crntFramePatchHeaders.getSize() == 0)
+	{
+		m_lastPatchedSize = 0;
+		return;
+	}
+
+	// Copy the data to staging memory
+	StagingGpuMemoryToken headersToken;
+	void* mapped = stagingMem.allocateFrame(m_crntFramePatchHeaders.getSizeInBytes(), StagingGpuMemoryType::STORAGE,
+											headersToken);
+	memcpy(mapped, m_crntFramePatchHeaders.getBegin(), m_crntFramePatchHeaders.getSizeInBytes());
+
+	StagingGpuMemoryToken dataToken;
+	mapped =
+		stagingMem.allocateFrame(m_crntFramePatchData.getSizeInBytes(), StagingGpuMemoryType::STORAGE, dataToken);
+	memcpy(mapped, m_crntFramePatchData.getBegin(), m_crntFramePatchData.getSizeInBytes());
+
+	// Dispatch
+	cmdb.bindStorageBuffer(0, 0, headersToken.m_buffer, headersToken.m_offset, headersToken.m_range);
+	cmdb.bindStorageBuffer(0, 1, dataToken.m_buffer, dataToken.m_offset, dataToken.m_range);
+	cmdb.bindStorageBuffer(0, 2, gpuSceneBuffer, 0, MAX_PTR_SIZE);
+
+	const UVec4 pc(m_crntFramePatchHeaders.getSize(), 0, 0, 0);
+	cmdb.setPushConstants(&pc, sizeof(pc));
+
+	cmdb.dispatchCompute(min(m_crntFramePatchHeaders.getSize(), GPU_SCENE_MICRO_PATCHING_MAX_WORKGROUP_COUNT), 1, 1);
+
+	// Cleanup for the next frame
+	m_lastPatchedSize = m_crntFramePatchData.getSizeInBytes();
+	m_crntFramePatchHeaders.destroy(m_alloc);
+	m_crntFramePatchData.destroy(m_alloc);
+}
+
 } // end namespace anki
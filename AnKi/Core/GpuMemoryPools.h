@@ -9,6 +9,8 @@
 #include <AnKi/Gr/Buffer.h>
 #include <AnKi/Gr/Utils/FrameGpuAllocator.h>
 #include <AnKi/Util/BuddyAllocatorBuilder.h>
+#include <AnKi/Util/TlsfAllocatorBuilder.h>
+#include <AnKi/Shaders/Include/GpuSceneTypes.h>
 
 namespace anki {
 
@@ -18,6 +20,23 @@ class ConfigSet;
 /// @addtogroup core
 /// @{
 
+/// @memberof VertexGpuMemoryPool
+class VertexGpuMemoryPoolStats
+{
+public:
+	PtrSize m_userAllocatedSize;
+	PtrSize m_realAllocatedSize;
+	F32 m_externalFragmentation;
+	F32 m_internalFragmentation;
+	PtrSize m_relocatedSize; ///< Bytes moved by the defragmentation since the beginning.
+	U32 m_relocationCount; ///< Allocations moved by the defragmentation since the beginning.
+};
+
+/// It's called when an allocation is moved by the defragmentation. The callback should patch all the places that hold
+/// the offset. It's called in VertexGpuMemoryPool::endFrame() while other threads might still be reading the offset so
+/// the new offset should be published atomically. The old range keeps its contents for MAX_FRAMES_IN_FLIGHT frames.
+using VertexGpuMemoryRelocationCallback = void (*)(void* userData, PtrSize oldOffset, PtrSize newOffset);
+
 /// Manages vertex and index memory for the whole application.
 class VertexGpuMemoryPool
 {
@@ -32,24 +51,64 @@ public:
 
 	ANKI_USE_RESULT Error init(GenericMemoryPoolAllocator<U8> alloc, GrManager* gr, const ConfigSet& cfg);
 
+	/// Allocate memory. Thread-safe.
 	ANKI_USE_RESULT Error allocate(PtrSize size, PtrSize& offset);
 
+	/// Free memory. Thread-safe.
 	void free(PtrSize size, PtrSize offset);
 
+	/// Allow the defragmentation to move an allocation. Call it when the GPU work that writes the allocation has been
+	/// submitted. The allocation stays relocatable until it's freed. Thread-safe.
+	void makeRelocatable(PtrSize size, PtrSize offset, VertexGpuMemoryRelocationCallback callback, void* userData);
+
+	/// Release the memory of old relocations and run an incremental defragmentation step. The GPU copies are submitted
+	/// so they will happen before the work of the next frame. Call it on a point that no one is rendering.
+	void endFrame();
+
 	BufferPtr getVertexBuffer() const
 	{
 		return m_vertBuffer;
 	}
 
-	void getMemoryStats(BuddyAllocatorBuilderStats& stats) const
-	{
-		m_buddyAllocator.getStats(stats);
-	}
+	void getMemoryStats(VertexGpuMemoryPoolStats& stats) const;
 
 private:
+	class RelocatableAllocation
+	{
+	public:
+		PtrSize m_offset;
+		PtrSize m_size;
+		VertexGpuMemoryRelocationCallback m_callback;
+		void* m_userData;
+	};
+
+	class Range
+	{
+	public:
+		PtrSize m_offset;
+		PtrSize m_size;
+	};
+
+	GenericMemoryPoolAllocator<U8> m_alloc;
 	GrManager* m_gr = nullptr;
 	BufferPtr m_vertBuffer;
 	BuddyAllocatorBuilder<32, Mutex> m_buddyAllocator;
+	TlsfAllocatorBuilder<Mutex> m_tlsfAllocator;
+	Bool m_useTlsf = false;
+
+	PtrSize m_defragmentationBudget = 0;
+	Mutex m_relocationMtx; ///< Protects the relocatables and the stats.
+	DynamicArray<RelocatableAllocation> m_relocatables;
+	Array<DynamicArray<Range>, MAX_FRAMES_IN_FLIGHT> m_garbage; ///< The old ranges of the relocated allocations.
+	U32 m_frame = 0;
+	PtrSize m_relocatedSize = 0;
+	U32 m_relocationCount = 0;
+
+	Bool allocateInternal(PtrSize size, PtrSize& offset);
+
+	void freeInternal(PtrSize size, PtrSize offset);
+
+	void defragment();
 };
 
 enum class StagingGpuMemoryType : U8
@@ -131,6 +190,87 @@ private:
 	void initBuffer(StagingGpuMemoryType type, U32 alignment, PtrSize maxAllocSize, BufferUsageBit usage,
 					GrManager& gr);
 };
+
+/// Persistent GPU memory that holds the data of the scene objects (transforms etc). The objects own parts of it and
+/// update them using the GpuSceneMicroPatcher only when something changes.
+class GpuSceneMemoryPool
+{
+public:
+	GpuSceneMemoryPool() = default;
+
+	GpuSceneMemoryPool(const GpuSceneMemoryPool&) = delete; // Non-copyable
+
+	~GpuSceneMemoryPool();
+
+	GpuSceneMemoryPool& operator=(const GpuSceneMemoryPool&) = delete; // Non-copyable
+
+	ANKI_USE_RESULT Error init(GenericMemoryPoolAllocator<U8> alloc, GrManager* gr, const ConfigSet& cfg);
+
+	/// Allocate memory. The offset is aligned to 16 bytes. Thread-safe.
+	ANKI_USE_RESULT Error allocate(PtrSize size, PtrSize& offset);
+
+	/// Free memory. Thread-safe.
+	void free(PtrSize size, PtrSize offset);
+
+	BufferPtr getBuffer() const
+	{
+		return m_buffer;
+	}
+
+	void getMemoryStats(BuddyAllocatorBuilderStats& stats) const
+	{
+		m_buddyAllocator.getStats(stats);
+	}
+
+private:
+	BufferPtr m_buffer;
+	BuddyAllocatorBuilder<32, Mutex> m_buddyAllocator;
+};
+
+/// Gathers the small updates of the GPU scene that happen during the frame and applies them all at once using a
+/// compute job. The alternative would be to have every object upload its data to staging memory every frame.
+class GpuSceneMicroPatcher
+{
+public:
+	GpuSceneMicroPatcher() = default;
+
+	GpuSceneMicroPatcher(const GpuSceneMicroPatcher&) = delete; // Non-copyable
+
+	~GpuSceneMicroPatcher();
+
+	GpuSceneMicroPatcher& operator=(const GpuSceneMicroPatcher&) = delete; // Non-copyable
+
+	void init(GenericMemoryPoolAllocator<U8> alloc);
+
+	/// Copy data to the GPU scene. The copy will happen when patchGpuScene() runs. Thread-safe.
+	/// @param gpuSceneDestOffset The offset in the GPU scene. It should be a multiple of 4.
+	/// @param dataSize The size of the data. It should be a multiple of 4.
+	/// @param data The data. They are copied so they can go away right after this call.
+	void newCopy(PtrSize gpuSceneDestOffset, PtrSize dataSize, const void* data);
+
+	/// Check if there is anything to copy.
+	Bool patchingIsNeeded() const
+	{
+		return m_crntFramePatchHeaders.getSize() > 0;
+	}
+
+	/// Record the commands that do the copies and reset the state for the next batch of copies. The caller should
+	/// have bound the GpuSceneMicroPatching program.
+	void patchGpuScene(StagingGpuMemoryPool& stagingMem, CommandBuffer& cmdb, const BufferPtr& gpuSceneBuffer);
+
+	/// The number of bytes the last patchGpuScene() uploaded.
+	PtrSize getLastPatchedSize() const
+	{
+		return m_lastPatchedSize;
+	}
+
+private:
+	GenericMemoryPoolAllocator<U8> m_alloc;
+	DynamicArray<GpuSceneMicroPatch> m_crntFramePatchHeaders;
+	DynamicArray<U32> m_crntFramePatchData;
+	Mutex m_mtx;
+	PtrSize m_lastPatchedSize = 0;
+};
 /// @}
 
 } // end namespace anki
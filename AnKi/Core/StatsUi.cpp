@@ -85,6 +85,26 @@ void StatsUi::build(CanvasPtr canvas)
 		labelTime(m_visTestsTime.get(flush), "Visibility");
 		labelTime(m_physicsTime.get(flush), "Physics");
 
+		if(m_cpuHwCountersMask)
+		{
+			ImGui::Text("----");
+			ImGui::Text("CPU Counters (main thread):");
+			Array<U64, U32(CpuHwCounter::COUNT)> values;
+			for(CpuHwCounter c = CpuHwCounter::FIRST; c < CpuHwCounter::COUNT; ++c)
+			{
+				values[c] = m_cpuHwCounters[c].get(flush);
+				if(m_cpuHwCountersMask & (1u << U32(c)))
+				{
+					labelUint(values[c], CpuHwCounters::getCounterName(c));
+				}
+			}
+
+			if(values[CpuHwCounter::CYCLES])
+			{
+				ImGui::Text("IPC: %.2f", F64(values[CpuHwCounter::INSTRUCTIONS]) / F64(values[CpuHwCounter::CYCLES]));
+			}
+		}
+
 		ImGui::Text("----");
 		ImGui::Text("GPU:");
 		labelTime(m_gpuTime.get(flush), "Total frame");
@@ -112,10 +132,14 @@ void StatsUi::build(CanvasPtr canvas)
 		labelUint(m_grStats.m_deviceMemoryAllocationCount, "Device allocations");
 		labelBytes(m_globalVertexPoolStats.m_userAllocatedSize, "Vertex/Index GPU memory");
 		labelBytes(m_globalVertexPoolStats.m_realAllocatedSize, "Actual Vertex/Index GPU memory");
+		labelPercentage(m_globalVertexPoolStats.m_externalFragmentation, "Vertex/Index external fragmentation");
+		labelBytes(m_globalVertexPoolStats.m_relocatedSize, "Vertex/Index defragmentation moves");
 
 		ImGui::Text("----");
 		ImGui::Text("Vulkan:");
 		labelUint(m_grStats.m_commandBufferCount, "Cmd buffers");
+		labelUint(m_grStats.m_onDemandPipelineCount, "On-demand pipelines");
+		labelUint(m_grStats.m_prewarmedPipelineCount, "Pre-warmed pipelines");
 
 		ImGui::Text("----");
 		ImGui::Text("Other:");
@@ -7,8 +7,9 @@
 
 #include <AnKi/Core/Common.h>
 #include <AnKi/Ui/UiImmediateModeBuilder.h>
-#include <AnKi/Util/BuddyAllocatorBuilder.h>
+#include <AnKi/Core/GpuMemoryPools.h>
 #include <AnKi/Gr/GrManager.h>
+#include <AnKi/Util/CpuHwCounters.h>
 
 namespace anki {
 
@@ -75,6 +76,19 @@ public:
 		m_gpuWriteBandwidth.set(v);
 	}
 
+	/// @param deltas The values of this frame.
+	void setCpuHwCounters(const CpuHwCounterValues& deltas, const CpuHwCounters& counters)
+	{
+		for(CpuHwCounter c = CpuHwCounter::FIRST; c < CpuHwCounter::COUNT; ++c)
+		{
+			m_cpuHwCounters[c].set(deltas[c]);
+			if(counters.isCounterSupported(c))
+			{
+				m_cpuHwCountersMask |= 1u << U32(c);
+			}
+		}
+	}
+
 	void setAllocatedCpuMemory(PtrSize v)
 	{
 		m_allocatedCpuMem = v;
@@ -100,7 +114,7 @@ public:
 		m_drawableCount = v;
 	}
 
-	void setGlobalVertexMemoryPoolStats(const BuddyAllocatorBuilderStats& stats)
+	void setGlobalVertexMemoryPoolStats(const VertexGpuMemoryPoolStats& stats)
 	{
 		m_globalVertexPoolStats = stats;
 	}
@@ -142,6 +156,8 @@ private:
 	BufferedValue<Second> m_sceneUpdateTime;
 	BufferedValue<Second> m_visTestsTime;
 	BufferedValue<Second> m_physicsTime;
+	Array<BufferedValue<U64>, U32(CpuHwCounter::COUNT)> m_cpuHwCounters;
+	U32 m_cpuHwCountersMask = 0; ///< The supported counters.
 
 	// GPU
 	BufferedValue<Second> m_gpuTime;
@@ -153,7 +169,7 @@ private:
 	PtrSize m_allocatedCpuMem = 0;
 	U64 m_allocCount = 0;
 	U64 m_freeCount = 0;
-	BuddyAllocatorBuilderStats m_globalVertexPoolStats = {};
+	VertexGpuMemoryPoolStats m_globalVertexPoolStats = {};
 
 	// GR
 	GrManagerStats m_grStats = {};
@@ -171,6 +187,11 @@ private:
 		ImGui::Text("%s: %lu", name.cstr(), val);
 	}
 
+	static void labelPercentage(F32 val, CString name)
+	{
+		ImGui::Text("%s: %.1f%%", name.cstr(), val * 100.0f);
+	}
+
 	void labelBytes(PtrSize val, CString name) const;
 };
 /// @}
@@ -0,0 +1,259 @@
+// Copyright (C) 2009-2022, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Core/TraceFile.h>
+
+namespace anki {
+
+static U64 zigZagEncode(I64 val)
+{
+	return (U64(val) << 1) ^ U64(val >> 63);
+}
+
+static I64 zigZagDecode(U64 val)
+{
+	return I64(val >> 1) ^ -I64(val & 1);
+}
+
+static U64 secondsToNs(Second s)
+{
+	return U64(s * 1000000000.0);
+}
+
+Error TraceFileWriter::open(GenericMemoryPoolAllocator<U8> alloc, CString filename)
+{
+	close();
+	m_alloc = alloc;
+
+	ANKI_CHECK(m_file.open(filename, FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+	ANKI_CHECK(m_file.write(&TRACE_FILE_MAGIC[0], sizeof(TRACE_FILE_MAGIC)));
+	m_writtenSize = sizeof(TRACE_FILE_MAGIC);
+
+	return Error::NONE;
+}
+
+void TraceFileWriter::close()
+{
+	if(!m_file.isOpen())
+	{
+		return;
+	}
+
+	m_file.close();
+	m_nameIds.destroy(m_alloc);
+	m_threads.destroy(m_alloc);
+	m_buffer.destroy(m_alloc);
+	m_writtenSize = 0;
+}
+
+void TraceFileWriter::writeVarint(U64 val)
+{
+	do
+	{
+		U8 byte = U8(val & 0x7F);
+		val >>= 7;
+		if(val)
+		{
+			byte |= 0x80;
+		}
+		m_buffer.emplaceBack(m_alloc, byte);
+	} while(val);
+}
+
+Error TraceFileWriter::writeEvents(ThreadId tid, U64 frame, ConstWeakArray<TracerEvent> events)
+{
+	ANKI_ASSERT(isOpen());
+	if(events.getSize() == 0)
+	{
+		return Error::NONE;
+	}
+
+	m_buffer.resize(m_alloc, 0);
+
+	writeRecordType(TraceFileRecordType::FRAME);
+	writeVarint(frame);
+
+	writeRecordType(TraceFileRecordType::THREAD);
+	writeVarint(tid);
+
+	auto threadIt = m_threads.find(tid);
+	if(threadIt == m_threads.getEnd())
+	{
+		threadIt = m_threads.emplace(m_alloc, tid);
+	}
+	ThreadState& thread = *threadIt;
+
+	for(const TracerEvent& event : events)
+	{
+		// Intern the name
+		const U64 nameHash = event.m_name.computeHash();
+		U32 nameId;
+		auto nameIt = m_nameIds.find(nameHash);
+		if(nameIt != m_nameIds.getEnd())
+		{
+			nameId = *nameIt;
+		}
+		else
+		{
+			nameId = U32(m_nameIds.getSize());
+			m_nameIds.emplace(m_alloc, nameHash, nameId);
+
+			const U32 length = event.m_name.getLength();
+			writeRecordType(TraceFileRecordType::NAME);
+			writeVarint(nameId);
+			writeVarint(length);
+			const U32 offset = m_buffer.getSize();
+			m_buffer.resize(m_alloc, offset + length);
+			memcpy(&m_buffer[offset], event.m_name.cstr(), length);
+		}
+
+		// Write the event
+		const U64 startNs = secondsToNs(event.m_start);
+		writeRecordType(TraceFileRecordType::EVENT);
+		writeVarint(nameId);
+		writeVarint(zigZagEncode(I64(startNs - thread.m_prevTimestampNs)));
+		writeVarint(secondsToNs(event.m_duration));
+		thread.m_prevTimestampNs = startNs;
+	}
+
+	ANKI_CHECK(m_file.write(&m_buffer[0], m_buffer.getSizeInBytes()));
+	m_writtenSize += m_buffer.getSizeInBytes();
+	return Error::NONE;
+}
+
+TraceFileReader::~TraceFileReader()
+{
+	m_threads.destroy(m_alloc);
+}
+
+Error TraceFileReader::open(CString filename)
+{
+	File file;
+	ANKI_CHECK(file.open(filename, FileOpenFlag::READ | FileOpenFlag::BINARY));
+
+	Array<char, 8> magic;
+	if(file.getSize() < sizeof(magic))
+	{
+		ANKI_CORE_LOGE("Trace file is too small: %s", filename.cstr());
+		return Error::USER_DATA;
+	}
+
+	ANKI_CHECK(file.read(&magic[0], sizeof(magic)));
+	if(memcmp(&magic[0], &TRACE_FILE_MAGIC[0], sizeof(magic)) != 0)
+	{
+		ANKI_CORE_LOGE("Wrong magic of trace file: %s", filename.cstr());
+		return Error::USER_DATA;
+	}
+
+	m_data.create(U32(file.getSize() - sizeof(magic)));
+	if(m_data.getSize())
+	{
+		ANKI_CHECK(file.read(&m_data[0], m_data.getSize()));
+	}
+
+	m_offset = 0;
+	return Error::NONE;
+}
+
+Error TraceFileReader::readVarint(U64& val)
+{
+	val = 0;
+	for(U32 shift = 0; shift < 64; shift += 7)
+	{
+		if(m_offset >= m_data.getSize())
+		{
+			ANKI_CORE_LOGE("Trace file is truncated");
+			return Error::USER_DATA;
+		}
+
+		const U8 byte = m_data[m_offset++];
+		val |= U64(byte & 0x7F) << shift;
+		if((byte & 0x80) == 0)
+		{
+			return Error::NONE;
+		}
+	}
+
+	ANKI_CORE_LOGE("Trace file has a corrupted integer");
+	return Error::USER_DATA;
+}
+
+Error TraceFileReader::readNextEvent(TraceFileEvent& event, Bool& endOfFile)
+{
+	while(m_offset < m_data.getSize())
+	{
+		const U8 type = m_data[m_offset++];
+		U64 val;
+
+		switch(TraceFileRecordType(type))
+		{
+		case TraceFileRecordType::NAME:
+		{
+			ANKI_CHECK(readVarint(val));
+			if(val != m_names.getSize())
+			{
+				ANKI_CORE_LOGE("Trace file has names out of order");
+				return Error::USER_DATA;
+			}
+
+			U64 length;
+			ANKI_CHECK(readVarint(length));
+			if(m_offset + length > m_data.getSize())
+			{
+				ANKI_CORE_LOGE("Trace file is truncated");
+				return Error::USER_DATA;
+			}
+
+			const Char* str = reinterpret_cast<const Char*>(&m_data[m_offset]);
+			m_names.emplaceBack(m_alloc)->create(str, str + length);
+			m_offset += U32(length);
+			break;
+		}
+		case TraceFileRecordType::THREAD:
+			ANKI_CHECK(readVarint(m_currentTid));
+			break;
+		case TraceFileRecordType::FRAME:
+			ANKI_CHECK(readVarint(m_currentFrame));
+			break;
+		case TraceFileRecordType::EVENT:
+		{
+			U64 nameId, startDelta, duration;
+			ANKI_CHECK(readVarint(nameId));
+			ANKI_CHECK(readVarint(startDelta));
+			ANKI_CHECK(readVarint(duration));
+
+			if(nameId >= m_names.getSize())
+			{
+				ANKI_CORE_LOGE("Trace file has an event with unknown name");
+				return Error::USER_DATA;
+			}
+
+			auto threadIt = m_threads.find(m_currentTid);
+			if(threadIt == m_threads.getEnd())
+			{
+				threadIt = m_threads.emplace(m_alloc, m_currentTid);
+			}
+
+			threadIt->m_prevTimestampNs += U64(zigZagDecode(startDelta));
+
+			event.m_name = m_names[U32(nameId)].toCString();
+			event.m_tid = m_currentTid;
+			event.m_frame = m_currentFrame;
+			event.m_startNs = threadIt->m_prevTimestampNs;
+			event.m_durationNs = duration;
+			endOfFile = false;
+			return Error::NONE;
+		}
+		default:
+			ANKI_CORE_LOGE("Trace file has an unknown record: %u", type);
+			return Error::USER_DATA;
+		}
+	}
+
+	endOfFile = true;
+	return Error::NONE;
+}
+
+} // end namespace anki
@@ -0,0 +1,143 @@
+// Copyright (C) 2009-2022, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Core/Common.h>
+#include <AnKi/Util/File.h>
+#include <AnKi/Util/HashMap.h>
+#include <AnKi/Util/DynamicArray.h>
+#include <AnKi/Util/Tracer.h>
+
+namespace anki {
+
+/// @addtogroup core
+/// @{
+
+/// The binary trace file is a header followed by a stream of records. Every record starts with a TraceFileRecordType.
+/// The integers of the records are LEB128 variable length and the timestamps are in nanoseconds and they are stored as
+/// zig-zag encoded deltas from the previous timestamp of the same thread. Event names are interned: a NAME record
+/// defines a name and its ID before the first EVENT that references it.
+constexpr Array<char, 8> TRACE_FILE_MAGIC = {{'A', 'N', 'K', 'I', 'T', 'R', 'C', '1'}};
+
+/// @memberof TraceFileWriter
+enum class TraceFileRecordType : U8
+{
+	NAME, ///< ID, string length, string characters.
+	THREAD, ///< Thread ID. The next events belong to that thread.
+	EVENT, ///< Name ID, start delta, duration.
+	FRAME, ///< Frame number. The next events were flushed by that frame.
+
+	COUNT
+};
+
+/// @memberof TraceFileReader
+class TraceFileEvent
+{
+public:
+	CString m_name;
+	ThreadId m_tid;
+	U64 m_frame;
+	U64 m_startNs;
+	U64 m_durationNs;
+};
+
+/// Writes Tracer events to a binary file. It writes everything in one go per writeEvents() so the file is valid even if
+/// the application crashes.
+class TraceFileWriter
+{
+public:
+	TraceFileWriter() = default;
+
+	TraceFileWriter(const TraceFileWriter&) = delete; // Non-copyable
+
+	~TraceFileWriter()
+	{
+		close();
+	}
+
+	TraceFileWriter& operator=(const TraceFileWriter&) = delete; // Non-copyable
+
+	ANKI_USE_RESULT Error open(GenericMemoryPoolAllocator<U8> alloc, CString filename);
+
+	void close();
+
+	Bool isOpen() const
+	{
+		return m_file.isOpen();
+	}
+
+	/// Write a number of events of a single thread.
+	ANKI_USE_RESULT Error writeEvents(ThreadId tid, U64 frame, ConstWeakArray<TracerEvent> events);
+
+	/// Get the bytes written so far.
+	PtrSize getWrittenSize() const
+	{
+		return m_writtenSize;
+	}
+
+private:
+	class ThreadState
+	{
+	public:
+		U64 m_prevTimestampNs = 0;
+	};
+
+	GenericMemoryPoolAllocator<U8> m_alloc;
+	File m_file;
+	DynamicArray<U8> m_buffer; ///< Holds the records before they go to the file.
+	HashMap<U64, U32> m_nameIds; ///< Name hash to name ID.
+	HashMap<U64, ThreadState> m_threads;
+	PtrSize m_writtenSize = 0;
+
+	void writeVarint(U64 val);
+
+	void writeRecordType(TraceFileRecordType type)
+	{
+		m_buffer.emplaceBack(m_alloc, U8(type));
+	}
+};
+
+/// Reads the files of TraceFileWriter.
+class TraceFileReader
+{
+public:
+	TraceFileReader(GenericMemoryPoolAllocator<U8> alloc)
+		: m_alloc(alloc)
+		, m_data(alloc)
+		, m_names(alloc)
+	{
+	}
+
+	~TraceFileReader();
+
+	/// Read the whole file in memory.
+	ANKI_USE_RESULT Error open(CString filename);
+
+	/// Get the next event.
+	/// @param[out] event The event. Its name is valid for the lifetime of the reader.
+	/// @param[out] endOfFile Set to true if there are no more events.
+	ANKI_USE_RESULT Error readNextEvent(TraceFileEvent& event, Bool& endOfFile);
+
+private:
+	class ThreadState
+	{
+	public:
+		U64 m_prevTimestampNs = 0;
+	};
+
+	GenericMemoryPoolAllocator<U8> m_alloc;
+	DynamicArrayAuto<U8> m_data;
+	U32 m_offset = 0;
+	DynamicArrayAuto<StringAuto> m_names; ///< Indexed by name ID.
+	HashMap<U64, ThreadState> m_threads;
+	ThreadId m_currentTid = 0;
+	U64 m_currentFrame = 0;
+
+	ANKI_USE_RESULT Error readVarint(U64& val);
+};
+/// @}
+
+} // end namespace anki
@@ -176,10 +176,13 @@ public:
 
 	/// Supports or not 24bit, 48bit or 96bit texture formats.
 	Bool m_unalignedBbpTextureFormats = false;
+
+	/// Supports indirect drawcalls with more than one draw and with a non-zero first instance.
+	Bool m_multiDrawIndirect = false;
 };
 ANKI_END_PACKED_STRUCT
 static_assert(sizeof(GpuDeviceCapabilities)
-				  == sizeof(PtrSize) * 4 + sizeof(U32) * 7 + sizeof(U8) * 3 + sizeof(Bool) * 6,
+				  == sizeof(PtrSize) * 4 + sizeof(U32) * 7 + sizeof(U8) * 3 + sizeof(Bool) * 7,
 			  "Should be packed");
 
 /// The type of the allocator for heap allocations
@@ -43,6 +43,8 @@ public:
 	U32 m_hostMemoryAllocationCount = 0;
 
 	U32 m_commandBufferCount = 0;
+	U32 m_onDemandPipelineCount = 0; ///< Pipelines that were created while recording command buffers.
+	U32 m_prewarmedPipelineCount = 0; ///< Pipelines that were created in the background.
 };
 
 /// The graphics manager, owner of all graphics objects.
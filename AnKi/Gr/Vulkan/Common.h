@@ -108,6 +108,8 @@ using VulkanQueueFamilies = Array<U32, U32(VulkanQueueType::COUNT)>;
 constexpr U DESCRIPTOR_POOL_INITIAL_SIZE = 64;
 constexpr F32 DESCRIPTOR_POOL_SIZE_SCALE = 2.0f;
 constexpr U DESCRIPTOR_FRAME_BUFFERING = 60 * 5; ///< How many frames worth of descriptors to buffer.
+/// Threads that allocate descriptors without locking. The rest go to a slower path. Power of 2.
+constexpr U32 MAX_DESCRIPTOR_THREAD_ALLOCATORS = 128;
 
 /// There is no need to ask for a fence or a semaphore to be waited for more than 10 seconds. The GPU will timeout
 /// anyway.
@@ -279,6 +279,14 @@ public:
 	U64 m_hash;
 };
 
+/// A slot of the DSThreadAllocator's hash table.
+class DSCacheSlot
+{
+public:
+	U64 m_hash; ///< Zero means empty slot.
+	DS* m_ds;
+};
+
 /// Per thread allocator.
 class alignas(ANKI_CACHE_LINE_SIZE) DSThreadAllocator
 {
@@ -294,8 +302,13 @@ public:
 	U32 m_lastPoolDSCount = 0;
 	U32 m_lastPoolFreeDSCount = 0;
 
-	IntrusiveList<DS> m_list; ///< At the left of the list are the least used sets.
-	HashMap<U64, DS*> m_hashmap;
+	/// At the left of the list are the least used sets. It's always sorted by DS::m_lastFrameUsed so the front is the
+	/// only candidate for recycling.
+	IntrusiveList<DS> m_list;
+
+	/// Open addressing hash table with linear probing. Its size is always a power of 2.
+	DynamicArray<DSCacheSlot> m_slots;
+	U32 m_slotCount = 0; ///< Occupied slots.
 
 	DSThreadAllocator(const DSLayoutCacheEntry* layout, ThreadId tid)
 		: m_layoutEntry(layout)
@@ -316,18 +329,48 @@ public:
 		out = tryFindSet(hash);
 		if(out == nullptr)
 		{
+			ANKI_TRACE_INC_COUNTER(VK_DESCRIPTOR_SET_CACHE_MISS, 1);
 			ANKI_CHECK(newSet(hash, bindings, tmpAlloc, out));
 		}
+		else
+		{
+			ANKI_TRACE_INC_COUNTER(VK_DESCRIPTOR_SET_CACHE_HIT, 1);
+		}
 
 		return Error::NONE;
 	}
 
 private:
+	static constexpr U32 INITIAL_SLOT_COUNT = 64;
+
 	ANKI_USE_RESULT const DS* tryFindSet(U64 hash);
 	ANKI_USE_RESULT Error newSet(U64 hash, const Array<AnyBindingExtended, MAX_BINDINGS_PER_DESCRIPTOR_SET>& bindings,
 								 StackAllocator<U8>& tmpAlloc, const DS*& out);
 	void writeSet(const Array<AnyBindingExtended, MAX_BINDINGS_PER_DESCRIPTOR_SET>& bindings, const DS& set,
 				  StackAllocator<U8>& tmpAlloc);
+
+	/// Return the index of the slot that holds the hash or MAX_U32 if not found.
+	U32 findSlot(U64 hash) const
+	{
+		ANKI_ASSERT(hash > 0 && m_slots.getSize() > 0);
+		const U32 mask = m_slots.getSize() - 1;
+		U32 idx = U32(hash) & mask;
+		while(m_slots[idx].m_hash != 0)
+		{
+			if(m_slots[idx].m_hash == hash)
+			{
+				return idx;
+			}
+
+			idx = (idx + 1) & mask;
+		}
+
+		return MAX_U32;
+	}
+
+	void insertSlot(U64 hash, DS* ds);
+
+	void eraseSlot(U32 idx);
 };
 
 /// Cache entry. It's built around a specific descriptor set layout.
@@ -348,12 +391,23 @@ public:
 	Array<VkDescriptorPoolSize, U(DescriptorType::COUNT)> m_poolSizesCreateInf = {};
 	VkDescriptorPoolCreateInfo m_poolCreateInf = {};
 
-	DynamicArray<DSThreadAllocator*> m_threadAllocs;
+	/// Open addressing table of the thread allocators, indexed by the hash of the thread ID. Readers don't lock, the
+	/// allocators are published with release semantics and never removed until the entry dies.
+	Array<Atomic<DSThreadAllocator*>, MAX_DESCRIPTOR_THREAD_ALLOCATORS> m_threadAllocs;
+
+	/// Thread IDs are not recycled so the table might fill up. The rest of the allocators go here, sorted by thread ID.
+	DynamicArray<DSThreadAllocator*> m_overflowThreadAllocs;
+
+	/// Protects the m_overflowThreadAllocs. The write lock is also taken when creating new allocators.
 	RWMutex m_threadAllocsMtx;
 
 	DSLayoutCacheEntry(DescriptorSetFactory* factory)
 		: m_factory(factory)
 	{
+		for(Atomic<DSThreadAllocator*>& a : m_threadAllocs)
+		{
+			a.setNonAtomically(nullptr);
+		}
 	}
 
 	~DSLayoutCacheEntry();
@@ -362,6 +416,13 @@ public:
 
 	/// @note Thread-safe.
 	ANKI_USE_RESULT Error getOrCreateThreadAllocator(ThreadId tid, DSThreadAllocator*& alloc);
+
+private:
+	/// Search the table. If not found return the first free slot in freeSlot.
+	DSThreadAllocator* tryFindThreadAllocator(ThreadId tid, U32& freeSlot) const;
+
+	/// Search the m_overflowThreadAllocs. Needs m_threadAllocsMtx to be locked.
+	DSThreadAllocator* tryFindOverflowThreadAllocator(ThreadId tid) const;
 };
 
 DSThreadAllocator::~DSThreadAllocator()
@@ -382,12 +443,16 @@ DSThreadAllocator::~DSThreadAllocator()
 	}
 	m_pools.destroy(alloc);
 
-	m_hashmap.destroy(alloc);
+	m_slots.destroy(alloc);
 }
 
 Error DSThreadAllocator::init()
 {
 	ANKI_CHECK(createNewPool());
+
+	m_slots.create(m_layoutEntry->m_factory->m_alloc, INITIAL_SLOT_COUNT);
+	memset(m_slots.getBegin(), 0, m_slots.getSizeInBytes());
+
 	return Error::NONE;
 }
 
@@ -424,23 +489,94 @@ Error DSThreadAllocator::createNewPool()
 	return Error::NONE;
 }
 
+void DSThreadAllocator::insertSlot(U64 hash, DS* ds)
+{
+	ANKI_ASSERT(hash > 0 && ds);
+	ANKI_ASSERT(findSlot(hash) == MAX_U32);
+
+	// Grow if the load factor goes above 0.75
+	if((m_slotCount + 1) * 4 > m_slots.getSize() * 3)
+	{
+		DynamicArray<DSCacheSlot> oldSlots = std::move(m_slots);
+
+		m_slots.create(m_layoutEntry->m_factory->m_alloc, oldSlots.getSize() * 2);
+		memset(m_slots.getBegin(), 0, m_slots.getSizeInBytes());
+		m_slotCount = 0;
+
+		for(const DSCacheSlot& slot : oldSlots)
+		{
+			if(slot.m_hash != 0)
+			{
+				insertSlot(slot.m_hash, slot.m_ds);
+			}
+		}
+
+		oldSlots.destroy(m_layoutEntry->m_factory->m_alloc);
+	}
+
+	const U32 mask = m_slots.getSize() - 1;
+	U32 idx = U32(hash) & mask;
+	while(m_slots[idx].m_hash != 0)
+	{
+		idx = (idx + 1) & mask;
+	}
+
+	m_slots[idx].m_hash = hash;
+	m_slots[idx].m_ds = ds;
+	++m_slotCount;
+}
+
+void DSThreadAllocator::eraseSlot(U32 idx)
+{
+	ANKI_ASSERT(m_slots[idx].m_hash != 0);
+	ANKI_ASSERT(m_slotCount > 0);
+	const U32 mask = m_slots.getSize() - 1;
+
+	// Backward shift deletion to keep the probe sequences intact without tombstones
+	U32 hole = idx;
+	U32 next = (idx + 1) & mask;
+	while(m_slots[next].m_hash != 0)
+	{
+		const U32 home = U32(m_slots[next].m_hash) & mask;
+
+		// Move the slot to the hole if the hole is in the cyclic range [home, next)
+		const Bool canMove = ((next - home) & mask) >= ((next - hole) & mask);
+		if(canMove)
+		{
+			m_slots[hole] = m_slots[next];
+			hole = next;
+		}
+
+		next = (next + 1) & mask;
+	}
+
+	m_slots[hole].m_hash = 0;
+	m_slots[hole].m_ds = nullptr;
+	--m_slotCount;
+}
+
 const DS* DSThreadAllocator::tryFindSet(U64 hash)
 {
 	ANKI_ASSERT(hash > 0);
 
-	auto it = m_hashmap.find(hash);
-	if(it == m_hashmap.getEnd())
+	const U32 idx = findSlot(hash);
+	if(idx == MAX_U32)
 	{
 		return nullptr;
 	}
 	else
 	{
-		DS* ds = *it;
+		DS* ds = m_slots[idx].m_ds;
 
-		// Remove from the list and place at the end of the list
-		m_list.erase(ds);
-		m_list.pushBack(ds);
-		ds->m_lastFrameUsed = m_layoutEntry->m_factory->m_frameCount;
+		// Remove from the list and place at the end of the list. If it was already used this frame it's already in the
+		// last frame's bucket so skip the list manipulation
+		const U64 crntFrame = m_layoutEntry->m_factory->m_frameCount;
+		if(ds->m_lastFrameUsed != crntFrame)
+		{
+			m_list.erase(ds);
+			m_list.pushBack(ds);
+			ds->m_lastFrameUsed = crntFrame;
+		}
 
 		return ds;
 	}
@@ -451,29 +587,19 @@ Error DSThreadAllocator::newSet(U64 hash, const Array<AnyBindingExtended, MAX_BI
 {
 	DS* out = nullptr;
 
-	// First try to see if there are unused to recycle
+	// First try to see if there are unused to recycle. The list is sorted by age so only the front needs checking
 	const U64 crntFrame = m_layoutEntry->m_factory->m_frameCount;
-	auto it = m_list.getBegin();
-	const auto end = m_list.getEnd();
-	while(it != end)
+	if(!m_list.isEmpty() && crntFrame - m_list.getFront().m_lastFrameUsed > DESCRIPTOR_FRAME_BUFFERING)
 	{
-		DS* set = &(*it);
-		U64 frameDiff = crntFrame - set->m_lastFrameUsed;
-		if(frameDiff > DESCRIPTOR_FRAME_BUFFERING)
-		{
-			// Found something, recycle
-			auto it2 = m_hashmap.find(set->m_hash);
-			ANKI_ASSERT(it2 != m_hashmap.getEnd());
-			m_hashmap.erase(m_layoutEntry->m_factory->m_alloc, it2);
-			m_list.erase(set);
+		DS* set = &m_list.getFront();
 
-			m_list.pushBack(set);
-			m_hashmap.emplace(m_layoutEntry->m_factory->m_alloc, hash, set);
+		const U32 slotIdx = findSlot(set->m_hash);
+		ANKI_ASSERT(slotIdx != MAX_U32);
+		eraseSlot(slotIdx);
+		m_list.popFront();
 
-			out = set;
-			break;
-		}
-		++it;
+		ANKI_TRACE_INC_COUNTER(VK_DESCRIPTOR_SET_RECYCLE, 1);
+		out = set;
 	}
 
 	if(out == nullptr)
@@ -502,14 +628,13 @@ Error DSThreadAllocator::newSet(U64 hash, const Array<AnyBindingExtended, MAX_BI
 
 		out = m_layoutEntry->m_factory->m_alloc.newInstance<DS>();
 		out->m_handle = handle;
-
-		m_hashmap.emplace(m_layoutEntry->m_factory->m_alloc, hash, out);
-		m_list.pushBack(out);
 	}
 
 	ANKI_ASSERT(out);
 	out->m_lastFrameUsed = crntFrame;
 	out->m_hash = hash;
+	m_list.pushBack(out);
+	insertSlot(hash, out);
 
 	// Finally, write it
 	writeSet(bindings, *out, tmpAlloc);
@@ -652,12 +777,20 @@ DSLayoutCacheEntry::~DSLayoutCacheEntry()
 {
 	auto alloc = m_factory->m_alloc;
 
-	for(DSThreadAllocator* a : m_threadAllocs)
+	for(Atomic<DSThreadAllocator*>& a : m_threadAllocs)
 	{
-		alloc.deleteInstance(a);
+		DSThreadAllocator* threadAlloc = a.getNonAtomically();
+		if(threadAlloc)
+		{
+			alloc.deleteInstance(threadAlloc);
+		}
 	}
 
-	m_threadAllocs.destroy(alloc);
+	for(DSThreadAllocator* threadAlloc : m_overflowThreadAllocs)
+	{
+		alloc.deleteInstance(threadAlloc);
+	}
+	m_overflowThreadAllocs.destroy(alloc);
 
 	if(m_layoutHandle)
 	{
@@ -740,10 +873,33 @@ Error DSLayoutCacheEntry::init(const DescriptorBinding* bindings, U32 bindingCou
 	return Error::NONE;
 }
 
-Error DSLayoutCacheEntry::getOrCreateThreadAllocator(ThreadId tid, DSThreadAllocator*& alloc)
+DSThreadAllocator* DSLayoutCacheEntry::tryFindThreadAllocator(ThreadId tid, U32& freeSlot) const
 {
-	alloc = nullptr;
+	freeSlot = MAX_U32;
+	const U32 mask = m_threadAllocs.getSize() - 1;
+	U32 idx = U32(computeHash(&tid, sizeof(tid))) & mask;
 
+	for(U32 i = 0; i < m_threadAllocs.getSize(); ++i)
+	{
+		DSThreadAllocator* alloc = m_threadAllocs[idx].load(AtomicMemoryOrder::ACQUIRE);
+		if(alloc == nullptr)
+		{
+			freeSlot = idx;
+			return nullptr;
+		}
+		else if(alloc->m_tid == tid)
+		{
+			return alloc;
+		}
+
+		idx = (idx + 1) & mask;
+	}
+
+	return nullptr;
+}
+
+DSThreadAllocator* DSLayoutCacheEntry::tryFindOverflowThreadAllocator(ThreadId tid) const
+{
 	class Comp
 	{
 	public:
@@ -758,11 +914,21 @@ Error DSLayoutCacheEntry::getOrCreateThreadAllocator(ThreadId tid, DSThreadAlloc
 		}
 	};
 
-	// Find using binary search
+	auto it = binarySearch(m_overflowThreadAllocs.getBegin(), m_overflowThreadAllocs.getEnd(), tid, Comp());
+	return (it != m_overflowThreadAllocs.getEnd()) ? *it : nullptr;
+}
+
+Error DSLayoutCacheEntry::getOrCreateThreadAllocator(ThreadId tid, DSThreadAllocator*& alloc)
+{
+	// Lock-free search
+	U32 freeSlot;
+	alloc = tryFindThreadAllocator(tid, freeSlot);
+
+	if(alloc == nullptr && freeSlot == MAX_U32)
 	{
+		// The table is full, search the slow path
 		RLockGuard<RWMutex> lock(m_threadAllocsMtx);
-		auto it = binarySearch(m_threadAllocs.getBegin(), m_threadAllocs.getEnd(), tid, Comp());
-		alloc = (it != m_threadAllocs.getEnd()) ? *it : nullptr;
+		alloc = tryFindOverflowThreadAllocator(tid);
 	}
 
 	if(alloc == nullptr)
@@ -772,8 +938,11 @@ Error DSLayoutCacheEntry::getOrCreateThreadAllocator(ThreadId tid, DSThreadAlloc
 		WLockGuard<RWMutex> lock(m_threadAllocsMtx);
 
 		// Search again
-		auto it = binarySearch(m_threadAllocs.getBegin(), m_threadAllocs.getEnd(), tid, Comp());
-		alloc = (it != m_threadAllocs.getEnd()) ? *it : nullptr;
+		alloc = tryFindThreadAllocator(tid, freeSlot);
+		if(alloc == nullptr && freeSlot == MAX_U32)
+		{
+			alloc = tryFindOverflowThreadAllocator(tid);
+		}
 
 		// Create
 		if(alloc == nullptr)
@@ -781,14 +950,21 @@ Error DSLayoutCacheEntry::getOrCreateThreadAllocator(ThreadId tid, DSThreadAlloc
 			alloc = m_factory->m_alloc.newInstance<DSThreadAllocator>(this, tid);
 			ANKI_CHECK(alloc->init());
 
-			m_threadAllocs.resize(m_factory->m_alloc, m_threadAllocs.getSize() + 1);
-			m_threadAllocs[m_threadAllocs.getSize() - 1] = alloc;
+			if(freeSlot != MAX_U32)
+			{
+				// Publish it
+				m_threadAllocs[freeSlot].store(alloc, AtomicMemoryOrder::RELEASE);
+			}
+			else
+			{
+				m_overflowThreadAllocs.emplaceBack(m_factory->m_alloc, alloc);
 
-			// Sort for fast find
-			std::sort(m_threadAllocs.getBegin(), m_threadAllocs.getEnd(),
-					  [](const DSThreadAllocator* a, const DSThreadAllocator* b) {
-						  return a->m_tid < b->m_tid;
-					  });
+				// Sort for fast find
+				std::sort(m_overflowThreadAllocs.getBegin(), m_overflowThreadAllocs.getEnd(),
+						  [](const DSThreadAllocator* a, const DSThreadAllocator* b) {
+							  return a->m_tid < b->m_tid;
+						  });
+			}
 		}
 	}
 
@@ -943,10 +1119,9 @@ Error DescriptorSetFactory::init(const GrAllocator<U8>& alloc, VkDevice dev, U32
 
 void DescriptorSetFactory::destroy()
 {
-	for(DSLayoutCacheEntry* l : m_caches)
-	{
+	m_caches.iterate([this](U64, DSLayoutCacheEntry* l) {
 		m_alloc.deleteInstance(l);
-	}
+	});
 
 	m_caches.destroy(m_alloc);
 
@@ -1012,28 +1187,30 @@ Error DescriptorSetFactory::newDescriptorSetLayout(const DescriptorSetLayoutInit
 	}
 	else
 	{
-		LockGuard<SpinLock> lock(m_cachesMtx);
-
-		DSLayoutCacheEntry* cache = nullptr;
-		U count = 0;
-		for(DSLayoutCacheEntry* it : m_caches)
+		DSLayoutCacheEntry* cache;
+		DSLayoutCacheEntry* const* existing = m_caches.find(hash);
+		if(existing)
 		{
-			if(it->m_hash == hash)
-			{
-				cache = it;
-				break;
-			}
-			++count;
+			cache = *existing;
 		}
-
-		if(cache == nullptr)
+		else
 		{
-			cache = m_alloc.newInstance<DSLayoutCacheEntry>(this);
-			ANKI_CHECK(cache->init(bindings.getBegin(), bindingCount, hash));
+			LockGuard<SpinLock> lock(m_cachesMtx);
 
-			m_caches.resize(m_alloc, m_caches.getSize() + 1);
-			m_caches[m_caches.getSize() - 1] = cache;
+			existing = m_caches.find(hash);
+			if(existing)
+			{
+				cache = *existing;
+			}
+			else
+			{
+				cache = m_alloc.newInstance<DSLayoutCacheEntry>(this);
+				ANKI_CHECK(cache->init(bindings.getBegin(), bindingCount, hash));
+
+				m_caches.emplace(m_alloc, hash, cache);
+			}
 		}
+		ANKI_ASSERT(cache->m_hash == hash);
 
 		// Set the layout
 		layout.m_handle = cache->m_layoutHandle;
@@ -13,6 +13,7 @@
 #include <AnKi/Gr/Vulkan/AccelerationStructureImpl.h>
 #include <AnKi/Util/WeakArray.h>
 #include <AnKi/Util/BitSet.h>
+#include <AnKi/Util/ConcurrentHashMap.h>
 
 namespace anki {
 
@@ -428,8 +429,8 @@ private:
 	VkDevice m_dev = VK_NULL_HANDLE;
 	U64 m_frameCount = 0;
 
-	DynamicArray<DSLayoutCacheEntry*> m_caches;
-	SpinLock m_cachesMtx; ///< Not a mutex because after a while there will be no reason to lock
+	ConcurrentHashMap<U64, DSLayoutCacheEntry*> m_caches; ///< Layout hash to cache entry.
+	SpinLock m_cachesMtx; ///< Serializes the insertions to m_caches. The lookups don't lock.
 
 	BindlessDescriptorSet* m_bindless = nullptr;
 	U32 m_bindlessTextureCount = MAX_U32;
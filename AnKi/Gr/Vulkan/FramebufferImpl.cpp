@@ -52,6 +52,24 @@ Error FramebufferImpl::init(const FramebufferInitInfo& init)
 
 	initClearValues(init);
 
+	// Gather the compatibility info
+	for(U32 i = 0; i < init.m_colorAttachmentCount; ++i)
+	{
+		m_rpassCompatibility.m_colorFormats[i] =
+			static_cast<const TextureViewImpl&>(*init.m_colorAttachments[i].m_textureView).getTextureImpl().getFormat();
+	}
+
+	if(hasDepthStencil())
+	{
+		m_rpassCompatibility.m_depthStencilFormat =
+			static_cast<const TextureViewImpl&>(*init.m_depthStencilAttachment.m_textureView)
+				.getTextureImpl()
+				.getFormat();
+	}
+
+	m_rpassCompatibility.m_colorAttachmentCount = m_colorAttCount;
+	m_rpassCompatibility.m_sri = m_hasSri;
+
 	// Create a renderpass.
 	initRpassCreateInfo(init);
 	ANKI_VK_CHECK(vkCreateRenderPass2KHR(getDevice(), &m_rpassCi, nullptr, &m_compatibleRenderpassHandle));
@@ -61,6 +79,9 @@ Error FramebufferImpl::init(const FramebufferInitInfo& init)
 	// Create the FB
 	ANKI_CHECK(initFbs(init));
 
+	m_rpassCompatibility.m_presentable = m_presentableTex;
+	m_rpassCompatibilityHash = m_rpassCompatibility.computeHash();
+
 	return Error::NONE;
 }
 
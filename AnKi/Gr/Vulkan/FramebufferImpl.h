@@ -19,6 +19,26 @@ class FramebufferAttachmentInfo;
 /// @addtogroup vulkan
 /// @{
 
+/// The part of the render pass that defines render pass compatibility. A pipeline created with one render pass can be
+/// used with all compatible render passes.
+class RenderPassCompatibilityInfo
+{
+public:
+	Array<Format, MAX_COLOR_ATTACHMENTS> m_colorFormats = {};
+	Format m_depthStencilFormat = Format::NONE;
+	U8 m_colorAttachmentCount = 0;
+	Bool m_sri = false;
+	Bool m_presentable = false; ///< Not part of the compatibility rules but it changes the front face of the pipeline.
+	U8 m_padding = 0;
+
+	U64 computeHash() const
+	{
+		return anki::computeHash(this, sizeof(*this));
+	}
+};
+static_assert(sizeof(RenderPassCompatibilityInfo) == sizeof(U32) * (MAX_COLOR_ATTACHMENTS + 2),
+			  "Packed because it will be hashed");
+
 /// Framebuffer implementation.
 class FramebufferImpl final : public Framebuffer, public VulkanObject<Framebuffer, FramebufferImpl>
 {
@@ -39,6 +59,18 @@ public:
 		return m_compatibleRenderpassHandle;
 	}
 
+	const RenderPassCompatibilityInfo& getRenderPassCompatibilityInfo() const
+	{
+		return m_rpassCompatibility;
+	}
+
+	/// Framebuffers with the same hash can share pipelines.
+	U64 getRenderPassCompatibilityHash() const
+	{
+		ANKI_ASSERT(m_rpassCompatibilityHash);
+		return m_rpassCompatibilityHash;
+	}
+
 	/// Use it for binding. It's thread-safe
 	VkRenderPass getRenderPassHandle(const Array<VkImageLayout, MAX_COLOR_ATTACHMENTS>& colorLayouts,
 									 VkImageLayout dsLayout, VkImageLayout shadingRateImageLayout);
@@ -122,6 +154,9 @@ private:
 	Bool m_presentableTex = false;
 	Bool m_hasSri = false;
 
+	RenderPassCompatibilityInfo m_rpassCompatibility;
+	U64 m_rpassCompatibilityHash = 0;
+
 	class
 	{
 	public:
@@ -5,6 +5,7 @@
 
 #include <AnKi/Gr/GrManager.h>
 #include <AnKi/Gr/Vulkan/GrManagerImpl.h>
+#include <AnKi/Core/ConfigSet.h>
 
 #include <AnKi/Gr/Buffer.h>
 #include <AnKi/Gr/Texture.h>
@@ -33,7 +34,8 @@ GrManager::~GrManager()
 
 Error GrManager::newInstance(GrManagerInitInfo& init, GrManager*& gr)
 {
-	auto alloc = HeapAllocator<U8>(init.m_allocCallback, init.m_allocCallbackUserData, "Gr");
+	auto alloc = HeapAllocator<U8>(init.m_allocCallback, init.m_allocCallbackUserData, "Gr",
+								   init.m_config->getGrThreadCachingMemory());
 
 	GrManagerImpl* impl = alloc.newInstance<GrManagerImpl>();
 
@@ -101,6 +103,8 @@ GrManagerStats GrManager::getStats() const
 	out.m_hostMemoryAllocationCount = memStats.m_hostMemoryAllocationCount;
 
 	out.m_commandBufferCount = self.getCommandBufferFactory().getCreatedCommandBufferCount();
+	out.m_onDemandPipelineCount = self.getPipelineCacheInternal().getOnDemandPipelineCount();
+	out.m_prewarmedPipelineCount = self.getPipelineCacheInternal().getPrewarmedPipelineCount();
 
 	return out;
 }
@@ -768,6 +768,8 @@ Error GrManagerImpl::initDevice(const GrManagerInitInfo& init)
 			(m_config->getGrValidation() && m_devFeatures.robustBufferAccess) ? true : false;
 		ANKI_VK_LOGI("Robust buffer access is %s", (m_devFeatures.robustBufferAccess) ? "enabled" : "disabled");
 
+		m_capabilities.m_multiDrawIndirect = m_devFeatures.multiDrawIndirect && m_devFeatures.drawIndirectFirstInstance;
+
 		ci.pEnabledFeatures = &m_devFeatures;
 	}
 
@@ -142,6 +142,16 @@ public:
 		return m_pplineCache.m_cacheHandle;
 	}
 
+	PipelineCache& getPipelineCacheInternal()
+	{
+		return m_pplineCache;
+	}
+
+	const PipelineCache& getPipelineCacheInternal() const
+	{
+		return m_pplineCache;
+	}
+
 	PipelineLayoutFactory& getPipelineLayoutFactory()
 	{
 		return m_pplineLayoutFactory;
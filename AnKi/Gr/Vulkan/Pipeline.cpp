@@ -4,6 +4,7 @@
 // http://www.anki3d.org/LICENSE
 
 #include <AnKi/Gr/Vulkan/Pipeline.h>
+#include <AnKi/Gr/Vulkan/PipelineCache.h>
 #include <AnKi/Gr/Vulkan/GrManagerImpl.h>
 #include <AnKi/Gr/Utils/Functions.h>
 #include <AnKi/Util/Tracer.h>
@@ -22,6 +23,8 @@ void PipelineStateTracker::reset()
 	m_fbStencil = false;
 	m_defaultFb = false;
 	m_fbColorAttachmentMask.unsetAll();
+	m_rpassHash = 0;
+	m_rpassCompatibility = nullptr;
 }
 
 Bool PipelineStateTracker::updateHashes()
@@ -41,7 +44,7 @@ Bool PipelineStateTracker::updateHashes()
 	{
 		m_dirty.m_rpass = false;
 		stateDirty = true;
-		m_hashes.m_rpass = ptrToNumber(m_state.m_rpass);
+		m_hashes.m_rpass = m_rpassHash;
 	}
 
 	// Vertex
@@ -146,13 +149,13 @@ Bool PipelineStateTracker::updateHashes()
 	return stateDirty;
 }
 
-void PipelineStateTracker::updateSuperHash()
+U64 PipelineStateTracker::computeSuperHash(U64 progHash) const
 {
 	Array<U64, sizeof(Hashes) / sizeof(U64)> buff;
 	U count = 0;
 
 	// Prog
-	buff[count++] = m_hashes.m_prog;
+	buff[count++] = progHash;
 
 	// Rpass
 	buff[count++] = m_hashes.m_rpass;
@@ -202,7 +205,58 @@ void PipelineStateTracker::updateSuperHash()
 	}
 
 	// Super hash
-	m_hashes.m_superHash = computeHash(&buff[0], count * sizeof(buff[0]));
+	return computeHash(&buff[0], count * sizeof(buff[0]));
+}
+
+void PipelineStateTracker::fillRecord(U64 programHash, PipelineStateRecord& record) const
+{
+	ANKI_ASSERT(canBeRecorded());
+
+	// The record is written to disk as is. Zero it and copy the packed sub-states one by one so the padding is not
+	// garbage
+	zeroMemory(record);
+	record.m_hash = computeStableHash(programHash);
+	record.m_programHash = programHash;
+	record.m_state.m_vertex = m_state.m_vertex;
+	record.m_state.m_inputAssembler = m_state.m_inputAssembler;
+	record.m_state.m_rasterizer = m_state.m_rasterizer;
+	record.m_state.m_depth = m_state.m_depth;
+	record.m_state.m_stencil = m_state.m_stencil;
+	record.m_state.m_color = m_state.m_color;
+	record.m_rpass = *m_rpassCompatibility;
+	record.m_fbColorAttachmentMask = m_fbColorAttachmentMask;
+	record.m_fbDepth = m_fbDepth;
+	record.m_fbStencil = m_fbStencil;
+	record.m_pipelineStatisticsEnabled = m_pipelineStatisticsEnabled;
+}
+
+void PipelineStateTracker::setFromRecord(const PipelineStateRecord& record, const ShaderProgramImpl* prog,
+										 VkRenderPass rpass)
+{
+	ANKI_ASSERT(prog && rpass);
+
+	reset();
+	m_state = record.m_state;
+	m_state.m_prog = nullptr;
+	m_state.m_rpass = rpass;
+	bindShaderProgram(prog);
+
+	m_fbColorAttachmentMask = record.m_fbColorAttachmentMask;
+	m_fbDepth = record.m_fbDepth;
+	m_fbStencil = record.m_fbStencil;
+	m_defaultFb = record.m_rpass.m_presentable;
+	m_rpassHash = record.m_rpass.computeHash();
+	m_pipelineStatisticsEnabled = record.m_pipelineStatisticsEnabled;
+
+	// Everything that the program needs was set when the record was created
+	m_set.m_attribs = m_shaderAttributeMask;
+	for(U32 i = 0; i < MAX_VERTEX_ATTRIBUTES; ++i)
+	{
+		if(m_shaderAttributeMask.get(i))
+		{
+			m_set.m_vertBindings.set(m_state.m_vertex.m_attributes[i].m_binding);
+		}
+	}
 }
 
 const VkGraphicsPipelineCreateInfo& PipelineStateTracker::updatePipelineCreateInfo()
@@ -413,15 +467,32 @@ public:
 	}
 };
 
+void PipelineFactory::init(GrAllocator<U8> alloc, VkDevice dev, PipelineCache& pplineCache,
+						   const ShaderProgramImpl* prog, U64 programHash)
+{
+	ANKI_ASSERT(prog && programHash);
+	m_alloc = alloc;
+	m_dev = dev;
+	m_pplineCache = &pplineCache;
+	m_prog = prog;
+	m_programHash = programHash;
+
+	m_pplineCache->prewarmPipelines(*this);
+}
+
 void PipelineFactory::destroy()
 {
-	for(auto it : m_pplines)
+	if(m_pplineCache)
 	{
-		if(it.m_handle)
+		m_pplineCache->cancelPrewarm(*this);
+	}
+
+	m_pplines.iterate([this](U64, PipelineInternal& pp) {
+		if(pp.m_handle)
 		{
-			vkDestroyPipeline(m_dev, it.m_handle, nullptr);
+			vkDestroyPipeline(m_dev, pp.m_handle, nullptr);
 		}
-	}
+	});
 
 	m_pplines.destroy(m_alloc);
 }
@@ -440,26 +511,23 @@ void PipelineFactory::getOrCreatePipeline(PipelineStateTracker& state, Pipeline&
 	}
 
 	// Check if ppline exists
+	const PipelineInternal* existing = m_pplines.find(hash);
+	if(existing)
 	{
-		RLockGuard<RWMutex> lock(m_pplinesMtx);
-		auto it = m_pplines.find(hash);
-		if(it != m_pplines.getEnd())
-		{
-			ppline.m_handle = (*it).m_handle;
-			ANKI_TRACE_INC_COUNTER(VK_PIPELINES_CACHE_HIT, 1);
-			return;
-		}
+		ppline.m_handle = existing->m_handle;
+		ANKI_TRACE_INC_COUNTER(VK_PIPELINES_CACHE_HIT, 1);
+		return;
 	}
 
 	// Doesnt exist. Need to create it
 
-	WLockGuard<RWMutex> lock(m_pplinesMtx);
+	LockGuard<Mutex> lock(m_pplinesMtx);
 
 	// Check again
-	auto it = m_pplines.find(hash);
-	if(it != m_pplines.getEnd())
+	existing = m_pplines.find(hash);
+	if(existing)
 	{
-		ppline.m_handle = (*it).m_handle;
+		ppline.m_handle = existing->m_handle;
 		return;
 	}
 
@@ -469,7 +537,8 @@ void PipelineFactory::getOrCreatePipeline(PipelineStateTracker& state, Pipeline&
 
 	{
 		ANKI_TRACE_SCOPED_EVENT(VK_PIPELINE_CREATE);
-		ANKI_VK_CHECKF(vkCreateGraphicsPipelines(m_dev, m_pplineCache, 1, &ci, nullptr, &pp.m_handle));
+		ANKI_VK_CHECKF(
+			vkCreateGraphicsPipelines(m_dev, m_pplineCache->m_cacheHandle, 1, &ci, nullptr, &pp.m_handle));
 	}
 
 	ANKI_TRACE_INC_COUNTER(VK_PIPELINES_CACHE_MISS, 1);
@@ -477,9 +546,68 @@ void PipelineFactory::getOrCreatePipeline(PipelineStateTracker& state, Pipeline&
 	m_pplines.emplace(m_alloc, hash, pp);
 	ppline.m_handle = pp.m_handle;
 
+	// Remember it for the next run
+	m_pplineCache->m_onDemandPipelineCount.fetchAdd(1);
+	if(state.canBeRecorded())
+	{
+		PipelineStateRecord record;
+		state.fillRecord(m_programHash, record);
+		m_pplineCache->recordPipelineState(record);
+	}
+
 	// Print shader info
 	state.m_state.m_prog->getGrManagerImpl().printPipelineShaderInfo(pp.m_handle, state.m_state.m_prog->getName(),
 																	 state.m_state.m_prog->getStages(), hash);
 }
 
+Bool PipelineFactory::prewarmPipeline(const PipelineStateRecord& record, VkRenderPass rpass)
+{
+	ANKI_TRACE_SCOPED_EVENT(VK_PIPELINE_PREWARM);
+	ANKI_ASSERT(record.m_programHash == m_programHash);
+
+	PipelineStateTracker state;
+	state.setFromRecord(record, m_prog, rpass);
+
+	U64 hash;
+	Bool stateDirty;
+	state.flush(hash, stateDirty);
+
+	if(state.computeStableHash(m_programHash) != record.m_hash)
+	{
+		// The program's interface changed since the record was created, ignore it
+		return false;
+	}
+
+	// Check if ppline exists
+	if(m_pplines.find(hash))
+	{
+		return true;
+	}
+
+	// Create it without holding the lock
+	PipelineInternal pp;
+	const VkGraphicsPipelineCreateInfo& ci = state.updatePipelineCreateInfo();
+	if(vkCreateGraphicsPipelines(m_dev, m_pplineCache->m_cacheHandle, 1, &ci, nullptr, &pp.m_handle) != VK_SUCCESS)
+	{
+		ANKI_VK_LOGW("Failed to pre-warm a pipeline of program: %s", m_prog->getName().cstr());
+		return true;
+	}
+
+	LockGuard<Mutex> lock(m_pplinesMtx);
+
+	if(m_pplines.find(hash))
+	{
+		// Someone created it in the meantime
+		vkDestroyPipeline(m_dev, pp.m_handle, nullptr);
+	}
+	else
+	{
+		m_pplines.emplace(m_alloc, hash, pp);
+		m_pplineCache->m_prewarmedPipelineCount.fetchAdd(1);
+		ANKI_TRACE_INC_COUNTER(VK_PIPELINES_PREWARMED, 1);
+	}
+
+	return true;
+}
+
 } // end namespace anki
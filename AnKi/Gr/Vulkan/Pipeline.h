@@ -10,10 +10,14 @@
 #include <AnKi/Gr/Vulkan/ShaderProgramImpl.h>
 #include <AnKi/Gr/Framebuffer.h>
 #include <AnKi/Gr/Vulkan/FramebufferImpl.h>
-#include <AnKi/Util/HashMap.h>
+#include <AnKi/Util/ConcurrentHashMap.h>
 
 namespace anki {
 
+// Forward
+class PipelineCache;
+class PipelineStateRecord;
+
 /// @addtogroup vulkan
 /// @{
 
@@ -363,6 +367,8 @@ public:
 		m_defaultFb = fb->hasPresentableTexture();
 
 		m_state.m_rpass = fb->getCompatibleRenderPass();
+		m_rpassHash = fb->getRenderPassCompatibilityHash();
+		m_rpassCompatibility = &fb->getRenderPassCompatibilityInfo();
 		m_dirty.m_rpass = true;
 	}
 
@@ -370,6 +376,7 @@ public:
 	{
 		ANKI_ASSERT(m_state.m_rpass);
 		m_state.m_rpass = VK_NULL_HANDLE;
+		m_rpassCompatibility = nullptr;
 	}
 
 	void setPrimitiveTopology(PrimitiveTopology topology)
@@ -424,6 +431,27 @@ public:
 
 	void reset();
 
+	/// Same as the hash returned by flush() but with the program's UUID replaced by a hash that doesn't change between
+	/// runs. Call it after flush().
+	U64 computeStableHash(U64 programHash) const
+	{
+		return computeSuperHash(programHash);
+	}
+
+	/// Can the current state be stored in the PipelineCache? Call it after flush().
+	Bool canBeRecorded() const
+	{
+		return m_rpassCompatibility && !m_rpassCompatibility->m_sri;
+	}
+
+	/// Store the current state. Call it after flush().
+	void fillRecord(U64 programHash, PipelineStateRecord& record) const;
+
+	/// Set the state from a record that was created in a previous run. It's used to pre-warm pipelines.
+	/// @param prog The program the record was created with.
+	/// @param rpass A render pass compatible with the one the record was created with.
+	void setFromRecord(const PipelineStateRecord& record, const ShaderProgramImpl* prog, VkRenderPass rpass);
+
 private:
 	AllPipelineState m_state;
 
@@ -472,6 +500,8 @@ private:
 	Bool m_fbStencil = false;
 	Bool m_defaultFb = false;
 	BitSet<MAX_COLOR_ATTACHMENTS, U8> m_fbColorAttachmentMask = {false};
+	U64 m_rpassHash = 0; ///< Render pass compatibility hash. Doesn't change between runs.
+	const RenderPassCompatibilityInfo* m_rpassCompatibility = nullptr; ///< Valid only inside a render pass.
 
 	class Hashes
 	{
@@ -518,7 +548,27 @@ private:
 	Bool m_pipelineStatisticsEnabled = false;
 
 	Bool updateHashes();
-	void updateSuperHash();
+
+	void updateSuperHash()
+	{
+		m_hashes.m_superHash = computeSuperHash(m_hashes.m_prog);
+	}
+
+	U64 computeSuperHash(U64 progHash) const;
+};
+
+/// A pipeline state that gets stored to disk so the pipeline can be re-created early in a following run.
+class PipelineStateRecord
+{
+public:
+	U64 m_hash = 0; ///< @see PipelineStateTracker::computeStableHash.
+	U64 m_programHash = 0; ///< Hash of the program's shaders. It doesn't change between runs.
+	AllPipelineState m_state; ///< Its program and render pass are always null.
+	RenderPassCompatibilityInfo m_rpass;
+	BitSet<MAX_COLOR_ATTACHMENTS, U8> m_fbColorAttachmentMask = {false};
+	Bool m_fbDepth = false;
+	Bool m_fbStencil = false;
+	Bool m_pipelineStatisticsEnabled = false;
 };
 
 /// Small wrapper on top of the pipeline.
@@ -540,6 +590,8 @@ private:
 /// Given some state it creates/hashes pipelines.
 class PipelineFactory
 {
+	friend class PipelineCache;
+
 public:
 	PipelineFactory()
 	{
@@ -547,14 +599,12 @@ public:
 
 	~PipelineFactory()
 	{
+		ANKI_ASSERT(m_pendingPrewarmJobs == 0);
 	}
 
-	void init(GrAllocator<U8> alloc, VkDevice dev, VkPipelineCache pplineCache)
-	{
-		m_alloc = alloc;
-		m_dev = dev;
-		m_pplineCache = pplineCache;
-	}
+	/// Initialize and start pre-warming the pipelines that the program used in previous runs.
+	void init(GrAllocator<U8> alloc, VkDevice dev, PipelineCache& pplineCache, const ShaderProgramImpl* prog,
+			  U64 programHash);
 
 	void destroy();
 
@@ -567,10 +617,19 @@ private:
 
 	GrAllocator<U8> m_alloc;
 	VkDevice m_dev = VK_NULL_HANDLE;
-	VkPipelineCache m_pplineCache = VK_NULL_HANDLE;
+	PipelineCache* m_pplineCache = nullptr;
+	const ShaderProgramImpl* m_prog = nullptr;
+	U64 m_programHash = 0;
 
-	HashMap<U64, PipelineInternal, Hasher> m_pplines;
-	RWMutex m_pplinesMtx;
+	ConcurrentHashMap<U64, PipelineInternal, Hasher> m_pplines;
+	Mutex m_pplinesMtx; ///< Serializes the insertions to m_pplines. The lookups don't lock.
+
+	U32 m_pendingPrewarmJobs = 0; ///< Protected by the PipelineCache.
+
+	/// Create a pipeline from a record. Called by the PipelineCache's threads.
+	/// @note Thread-safe.
+	/// @return False if the record is stale.
+	Bool prewarmPipeline(const PipelineStateRecord& record, VkRenderPass rpass);
 };
 /// @}
 
@@ -4,12 +4,56 @@
 // http://www.anki3d.org/LICENSE
 
 #include <AnKi/Gr/Vulkan/PipelineCache.h>
+#include <AnKi/Gr/Vulkan/Pipeline.h>
 #include <AnKi/Core/ConfigSet.h>
 #include <AnKi/Util/Filesystem.h>
 #include <AnKi/Util/File.h>
+#include <AnKi/Util/Tracer.h>
+#include <algorithm>
 
 namespace anki {
 
+static constexpr U32 PIPELINE_STATES_FILE_VERSION = 3;
+static constexpr Array<char, 8> PIPELINE_STATES_FILE_MAGIC = {{'A', 'N', 'K', 'I', 'P', 'S', 'O', '1'}};
+
+class PipelineStatesFileHeader
+{
+public:
+	Array<char, 8> m_magic;
+	U32 m_version;
+	U32 m_recordSize;
+	U32 m_recordCount;
+	U32 m_hashAlgorithmVersion; ///< The records hold hashes so they are stale if the algorithm changes.
+	U32 m_recordLayoutHash; ///< @see computeRecordLayoutHash.
+	U32 m_padding;
+};
+
+/// The records are written as raw bytes. Hash their layout to catch changes that keep the size the same.
+static U32 computeRecordLayoutHash()
+{
+	const Array<U32, 16> layout = {{U32(sizeof(PipelineStateRecord)), U32(offsetof(PipelineStateRecord, m_state)),
+									U32(offsetof(PipelineStateRecord, m_rpass)),
+									U32(offsetof(PipelineStateRecord, m_fbColorAttachmentMask)),
+									U32(offsetof(AllPipelineState, m_vertex)),
+									U32(offsetof(AllPipelineState, m_inputAssembler)),
+									U32(offsetof(AllPipelineState, m_rasterizer)),
+									U32(offsetof(AllPipelineState, m_depth)),
+									U32(offsetof(AllPipelineState, m_stencil)),
+									U32(offsetof(AllPipelineState, m_color)),
+									U32(offsetof(RenderPassCompatibilityInfo, m_depthStencilFormat)),
+									U32(offsetof(RenderPassCompatibilityInfo, m_colorAttachmentCount)),
+									U32(sizeof(AllPipelineState)), U32(sizeof(RenderPassCompatibilityInfo)),
+									MAX_COLOR_ATTACHMENTS, MAX_VERTEX_ATTRIBUTES}};
+	return U32(computeHash(&layout[0], sizeof(layout)));
+}
+
+class PipelineCache::PrewarmJob : public IntrusiveListEnabled<PrewarmJob>
+{
+public:
+	PipelineFactory* m_factory = nullptr;
+	const PipelineStateRecord* m_record = nullptr;
+};
+
 Error PipelineCache::init(VkDevice dev, VkPhysicalDevice pdev, CString cacheDir, const ConfigSet& cfg,
 						  GrAllocator<U8> alloc)
 {
@@ -66,11 +110,75 @@ Error PipelineCache::init(VkDevice dev, VkPhysicalDevice pdev, CString cacheDir,
 
 	ANKI_VK_CHECK(vkCreatePipelineCache(dev, &ci, nullptr, &m_cacheHandle));
 
+	// Load the states of the previous runs
+	m_alloc = alloc;
+	m_dev = dev;
+	m_statesFilename.sprintf(alloc, "%s/vk_pipeline_states", &cacheDir[0]);
+	const Error err = loadStates();
+	if(err)
+	{
+		ANKI_VK_LOGW("Failed to load the pipeline states. Will ignore them: %s", &m_statesFilename[0]);
+		m_loadedRecords.destroy(m_alloc);
+		m_loadedRecordsUsed.destroy(m_alloc);
+		m_knownRecords.destroy(m_alloc);
+	}
+
+	// Start the pre-warming threads
+	if(m_loadedRecords.getSize() > 0)
+	{
+		m_threads.create(m_alloc, cfg.getGrPipelinePrewarmThreadCount());
+		for(Thread*& thread : m_threads)
+		{
+			thread = m_alloc.newInstance<Thread>("PplinePrewarm");
+			thread->start(this, [](ThreadCallbackInfo& info) -> Error {
+				return static_cast<PipelineCache*>(info.m_userData)->threadWorker();
+			});
+		}
+	}
+
 	return Error::NONE;
 }
 
 void PipelineCache::destroy(VkDevice dev, VkPhysicalDevice pdev, GrAllocator<U8> alloc)
 {
+	// Stop the threads. All factories should have cancelled their jobs by now
+	{
+		LockGuard<Mutex> lock(m_jobsMtx);
+		ANKI_ASSERT(m_jobs.isEmpty());
+		m_quit = true;
+		m_jobsCvar.notifyAll();
+	}
+
+	for(Thread* thread : m_threads)
+	{
+		const Error err = thread->join();
+		(void)err;
+		m_alloc.deleteInstance(thread);
+	}
+	m_threads.destroy(m_alloc);
+
+	for(VkRenderPass rpass : m_rpasses)
+	{
+		vkDestroyRenderPass(m_dev, rpass, nullptr);
+	}
+	m_rpasses.destroy(m_alloc);
+
+	// Store the states
+	if(m_newRecords.getSize() > 0 || getUsedLoadedRecordCount() != m_loadedRecords.getSize())
+	{
+		const Error err = storeStates();
+		if(err)
+		{
+			ANKI_VK_LOGE("An error occurred while storing the pipeline states to disk. Will ignore");
+		}
+	}
+
+	m_loadedRecords.destroy(m_alloc);
+	m_loadedRecordsUsed.destroy(m_alloc);
+	m_newRecords.destroy(m_alloc);
+	m_knownRecords.destroy(m_alloc);
+	m_statesFilename.destroy(m_alloc);
+
 	const Error err = destroyInternal(dev, pdev, alloc);
 	if(err)
 	{
@@ -119,4 +227,305 @@ Error PipelineCache::destroyInternal(VkDevice dev, VkPhysicalDevice pdev, GrAllo
 	return Error::NONE;
 }
 
+Error PipelineCache::loadStates()
+{
+	if(!fileExists(m_statesFilename.toCString()))
+	{
+		ANKI_VK_LOGI("Pipeline states file not found: %s", &m_statesFilename[0]);
+		return Error::NONE;
+	}
+
+	File file;
+	ANKI_CHECK(file.open(m_statesFilename.toCString(), FileOpenFlag::BINARY | FileOpenFlag::READ));
+
+	PipelineStatesFileHeader header;
+	ANKI_CHECK(file.read(&header, sizeof(header)));
+
+	if(memcmp(&header.m_magic[0], &PIPELINE_STATES_FILE_MAGIC[0], sizeof(header.m_magic)) != 0
+	   || header.m_version != PIPELINE_STATES_FILE_VERSION
+	   || header.m_recordSize != sizeof(PipelineStateRecord) || header.m_hashAlgorithmVersion != HASH_ALGORITHM_VERSION
+	   || header.m_recordLayoutHash != computeRecordLayoutHash())
+	{
+		ANKI_VK_LOGI("Pipeline states file is not compatible with this build: %s", &m_statesFilename[0]);
+		return Error::NONE;
+	}
+
+	if(file.getSize() != sizeof(header) + PtrSize(header.m_recordCount) * sizeof(PipelineStateRecord))
+	{
+		ANKI_VK_LOGE("Pipeline states file is corrupted: %s", &m_statesFilename[0]);
+		return Error::USER_DATA;
+	}
+
+	if(header.m_recordCount == 0)
+	{
+		return Error::NONE;
+	}
+
+	m_loadedRecords.create(m_alloc, header.m_recordCount);
+	ANKI_CHECK(file.read(&m_loadedRecords[0], m_loadedRecords.getSizeInBytes()));
+	m_loadedRecordsUsed.create(m_alloc, header.m_recordCount, false);
+
+	std::sort(m_loadedRecords.getBegin(), m_loadedRecords.getEnd(),
+			  [](const PipelineStateRecord& a, const PipelineStateRecord& b) {
+				  return a.m_programHash < b.m_programHash;
+			  });
+
+	for(const PipelineStateRecord& record : m_loadedRecords)
+	{
+		if(m_knownRecords.find(record.m_hash) == m_knownRecords.getEnd())
+		{
+			m_knownRecords.emplace(m_alloc, record.m_hash, true);
+		}
+	}
+
+	ANKI_VK_LOGI("Loaded %u pipeline states", m_loadedRecords.getSize());
+	return Error::NONE;
+}
+
+Error PipelineCache::storeStates()
+{
+	PipelineStatesFileHeader header = {};
+	header.m_magic = PIPELINE_STATES_FILE_MAGIC;
+	header.m_version = PIPELINE_STATES_FILE_VERSION;
+	header.m_recordSize = sizeof(PipelineStateRecord);
+	header.m_hashAlgorithmVersion = HASH_ALGORITHM_VERSION;
+	header.m_recordLayoutHash = computeRecordLayoutHash();
+	header.m_recordCount = getUsedLoadedRecordCount() + m_newRecords.getSize();
+
+	File file;
+	ANKI_CHECK(file.open(m_statesFilename.toCString(), FileOpenFlag::BINARY | FileOpenFlag::WRITE));
+	ANKI_CHECK(file.write(&header, sizeof(header)));
+
+	// Drop the records that were not used in this run
+	for(U32 i = 0; i < m_loadedRecords.getSize(); ++i)
+	{
+		if(m_loadedRecordsUsed[i])
+		{
+			ANKI_CHECK(file.write(&m_loadedRecords[i], sizeof(PipelineStateRecord)));
+		}
+	}
+
+	if(m_newRecords.getSize())
+	{
+		ANKI_CHECK(file.write(&m_newRecords[0], m_newRecords.getSizeInBytes()));
+	}
+
+	ANKI_VK_LOGI("Stored %u pipeline states (%u new, %u dropped)", header.m_recordCount, m_newRecords.getSize(),
+				 m_loadedRecords.getSize() - getUsedLoadedRecordCount());
+	return Error::NONE;
+}
+
+void PipelineCache::recordPipelineState(const PipelineStateRecord& record)
+{
+	ANKI_ASSERT(record.m_hash && record.m_programHash);
+	LockGuard<Mutex> lock(m_recordsMtx);
+
+	if(m_knownRecords.find(record.m_hash) == m_knownRecords.getEnd())
+	{
+		m_knownRecords.emplace(m_alloc, record.m_hash, true);
+		m_newRecords.emplaceBack(m_alloc, record);
+	}
+}
+
+U32 PipelineCache::getUsedLoadedRecordCount() const
+{
+	U32 count = 0;
+	for(Bool used : m_loadedRecordsUsed)
+	{
+		count += used;
+	}
+
+	return count;
+}
+
+void PipelineCache::prewarmPipelines(PipelineFactory& factory)
+{
+	// Find the range of the records of that program
+	const PipelineStateRecord* begin = std::lower_bound(
+		m_loadedRecords.getBegin(), m_loadedRecords.getEnd(), factory.m_programHash,
+		[](const PipelineStateRecord& record, U64 programHash) { return record.m_programHash < programHash; });
+
+	const PipelineStateRecord* end = begin;
+	while(end != m_loadedRecords.getEnd() && end->m_programHash == factory.m_programHash)
+	{
+		++end;
+	}
+
+	if(begin == end)
+	{
+		return;
+	}
+
+	// The program is in use so keep its records. The pre-warming will drop the stale ones
+	{
+		LockGuard<Mutex> lock(m_recordsMtx);
+		for(const PipelineStateRecord* record = begin; record != end; ++record)
+		{
+			m_loadedRecordsUsed[U32(record - m_loadedRecords.getBegin())] = true;
+		}
+	}
+
+	if(m_threads.getSize() == 0)
+	{
+		return;
+	}
+
+	// Push the jobs
+	LockGuard<Mutex> lock(m_jobsMtx);
+	for(const PipelineStateRecord* record = begin; record != end; ++record)
+	{
+		PrewarmJob* job = m_alloc.newInstance<PrewarmJob>();
+		job->m_factory = &factory;
+		job->m_record = record;
+		m_jobs.pushBack(job);
+		++factory.m_pendingPrewarmJobs;
+	}
+
+	m_jobsCvar.notifyAll();
+}
+
+void PipelineCache::cancelPrewarm(PipelineFactory& factory)
+{
+	LockGuard<Mutex> lock(m_jobsMtx);
+
+	// Remove the jobs that haven't started
+	auto it = m_jobs.getBegin();
+	while(it != m_jobs.getEnd() && factory.m_pendingPrewarmJobs > 0)
+	{
+		PrewarmJob* job = &(*it);
+		++it;
+
+		if(job->m_factory == &factory)
+		{
+			m_jobs.erase(job);
+			m_alloc.deleteInstance(job);
+			--factory.m_pendingPrewarmJobs;
+		}
+	}
+
+	// Wait for the running ones
+	while(factory.m_pendingPrewarmJobs > 0)
+	{
+		m_jobsCvar.wait(m_jobsMtx);
+	}
+}
+
+Error PipelineCache::threadWorker()
+{
+	while(true)
+	{
+		PrewarmJob* job = nullptr;
+
+		// Wait for work
+		{
+			LockGuard<Mutex> lock(m_jobsMtx);
+			while(m_jobs.isEmpty() && !m_quit)
+			{
+				m_jobsCvar.wait(m_jobsMtx);
+			}
+
+			if(m_quit)
+			{
+				break;
+			}
+
+			job = m_jobs.popFront();
+		}
+
+		// Do the work
+		VkRenderPass rpass;
+		if(!getOrCreateRenderPass(job->m_record->m_rpass, rpass))
+		{
+			if(!job->m_factory->prewarmPipeline(*job->m_record, rpass))
+			{
+				LockGuard<Mutex> lock(m_recordsMtx);
+				m_loadedRecordsUsed[U32(job->m_record - m_loadedRecords.getBegin())] = false;
+			}
+		}
+
+		// Signal the factory
+		{
+			LockGuard<Mutex> lock(m_jobsMtx);
+			ANKI_ASSERT(job->m_factory->m_pendingPrewarmJobs > 0);
+			--job->m_factory->m_pendingPrewarmJobs;
+			m_alloc.deleteInstance(job);
+			m_jobsCvar.notifyAll();
+		}
+	}
+
+	return Error::NONE;
+}
+
+Error PipelineCache::getOrCreateRenderPass(const RenderPassCompatibilityInfo& info, VkRenderPass& rpass)
+{
+	ANKI_ASSERT(!info.m_sri && "Not supported");
+	const U64 hash = info.computeHash();
+
+	LockGuard<Mutex> lock(m_rpassesMtx);
+
+	auto it = m_rpasses.find(hash);
+	if(it != m_rpasses.getEnd())
+	{
+		rpass = *it;
+		return Error::NONE;
+	}
+
+	// Only the formats and the attachment references need to match for compatibility
+	Array<VkAttachmentDescription, MAX_COLOR_ATTACHMENTS + 1> attachments = {};
+	Array<VkAttachmentReference, MAX_COLOR_ATTACHMENTS + 1> references = {};
+	U32 attachmentCount = 0;
+	for(U32 i = 0; i < info.m_colorAttachmentCount; ++i)
+	{
+		VkAttachmentDescription& desc = attachments[attachmentCount];
+		desc.format = convertFormat(info.m_colorFormats[i]);
+		desc.samples = VK_SAMPLE_COUNT_1_BIT;
+		desc.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		desc.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		desc.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		desc.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		desc.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		desc.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+		references[attachmentCount].attachment = attachmentCount;
+		references[attachmentCount].layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		++attachmentCount;
+	}
+
+	if(info.m_depthStencilFormat != Format::NONE)
+	{
+		VkAttachmentDescription& desc = attachments[attachmentCount];
+		desc.format = convertFormat(info.m_depthStencilFormat);
+		desc.samples = VK_SAMPLE_COUNT_1_BIT;
+		desc.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		desc.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		desc.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		desc.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		desc.initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+		desc.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+		references[attachmentCount].attachment = attachmentCount;
+		references[attachmentCount].layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+		++attachmentCount;
+	}
+
+	VkSubpassDescription subpass = {};
+	subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	subpass.colorAttachmentCount = info.m_colorAttachmentCount;
+	subpass.pColorAttachments = (info.m_colorAttachmentCount) ? &references[0] : nullptr;
+	subpass.pDepthStencilAttachment =
+		(info.m_depthStencilFormat != Format::NONE) ? &references[info.m_colorAttachmentCount] : nullptr;
+
+	VkRenderPassCreateInfo ci = {};
+	ci.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+	ci.attachmentCount = attachmentCount;
+	ci.pAttachments = (attachmentCount) ? &attachments[0] : nullptr;
+	ci.subpassCount = 1;
+	ci.pSubpasses = &subpass;
+
+	ANKI_VK_CHECK(vkCreateRenderPass(m_dev, &ci, nullptr, &rpass));
+	m_rpasses.emplace(m_alloc, hash, rpass);
+
+	return Error::NONE;
+}
+
 } // end namespace anki
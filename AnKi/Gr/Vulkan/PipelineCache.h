@@ -6,18 +6,27 @@
 #pragma once
 
 #include <AnKi/Gr/Vulkan/Common.h>
+#include <AnKi/Util/HashMap.h>
+#include <AnKi/Util/List.h>
+#include <AnKi/Util/Thread.h>
 
 namespace anki {
 
 // Forward
 class ConfigSet;
+class PipelineFactory;
+class PipelineStateRecord;
+class RenderPassCompatibilityInfo;
 
 /// @addtogroup vulkan
 /// @{
 
-/// On disk pipeline cache.
+/// On disk pipeline cache. It holds the driver's cache and also the pipeline states that were used in previous runs.
+/// Those states are used to create pipelines in the background as soon as their programs are created.
 class PipelineCache
 {
+	friend class PipelineFactory;
+
 public:
 	VkPipelineCache m_cacheHandle = VK_NULL_HANDLE;
 
@@ -26,11 +35,69 @@ public:
 
 	void destroy(VkDevice dev, VkPhysicalDevice pdev, GrAllocator<U8> alloc);
 
+	/// Remember a pipeline state so it can be pre-warmed in the next run.
+	/// @note It's thread-safe.
+	void recordPipelineState(const PipelineStateRecord& record);
+
+	/// Start creating in the background all pipelines the factory's program used in previous runs.
+	/// @note It's thread-safe.
+	void prewarmPipelines(PipelineFactory& factory);
+
+	/// Cancel the pending pre-warming of a factory and wait for the running one.
+	/// @note It's thread-safe.
+	void cancelPrewarm(PipelineFactory& factory);
+
+	/// Number of pipelines that were created while recording command buffers.
+	U32 getOnDemandPipelineCount() const
+	{
+		return m_onDemandPipelineCount.load();
+	}
+
+	/// Number of pipelines that were created in the background.
+	U32 getPrewarmedPipelineCount() const
+	{
+		return m_prewarmedPipelineCount.load();
+	}
+
 private:
+	class PrewarmJob;
+
+	GrAllocator<U8> m_alloc;
+	VkDevice m_dev = VK_NULL_HANDLE;
+
 	String m_dumpFilename;
 	PtrSize m_dumpSize = 0;
 
+	String m_statesFilename;
+	DynamicArray<PipelineStateRecord> m_loadedRecords; ///< Sorted by program hash. Read-only after init.
+	DynamicArray<Bool> m_loadedRecordsUsed; ///< The loaded records that are still valid and used in this run.
+	DynamicArray<PipelineStateRecord> m_newRecords;
+	HashMap<U64, Bool> m_knownRecords; ///< Hashes of all records, loaded and new.
+	Mutex m_recordsMtx; ///< Protects the new records and m_loadedRecordsUsed.
+
+	DynamicArray<Thread*> m_threads;
+	IntrusiveList<PrewarmJob> m_jobs;
+	Mutex m_jobsMtx;
+	ConditionVariable m_jobsCvar;
+	Bool m_quit = false;
+
+	HashMap<U64, VkRenderPass> m_rpasses; ///< Render passes for pre-warming. Indexed by compatibility hash.
+	Mutex m_rpassesMtx;
+
+	Atomic<U32> m_onDemandPipelineCount = {0};
+	Atomic<U32> m_prewarmedPipelineCount = {0};
+
 	ANKI_USE_RESULT Error destroyInternal(VkDevice dev, VkPhysicalDevice pdev, GrAllocator<U8> alloc);
+
+	ANKI_USE_RESULT Error loadStates();
+	ANKI_USE_RESULT Error storeStates();
+
+	/// Needs m_recordsMtx to be locked or no one else using the cache.
+	U32 getUsedLoadedRecordCount() const;
+
+	ANKI_USE_RESULT Error getOrCreateRenderPass(const RenderPassCompatibilityInfo& info, VkRenderPass& rpass);
+
+	Error threadWorker();
 };
 /// @}
 
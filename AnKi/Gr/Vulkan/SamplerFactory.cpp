@@ -127,12 +127,10 @@ void SamplerFactory::destroy()
 	}
 
 	GrAllocator<U8> alloc = m_gr->getAllocator();
-	for(auto it : m_map)
-	{
-		MicroSampler* const sampler = it;
+	m_map.iterate([&](U64, MicroSampler* sampler) {
 		ANKI_ASSERT(sampler->getRefcount().load() == 0 && "Someone still holds a reference to a sampler");
 		alloc.deleteInstance(sampler);
-	}
+	});
 
 	m_map.destroy(alloc);
 
@@ -147,13 +145,19 @@ Error SamplerFactory::newInstance(const SamplerInitInfo& inf, MicroSamplerPtr& p
 	MicroSampler* out = nullptr;
 	const U64 hash = inf.computeHash();
 
-	LockGuard<Mutex> lock(m_mtx);
+	MicroSampler* const* existing = m_map.find(hash);
+	if(existing)
+	{
+		psampler.reset(*existing);
+		return Error::NONE;
+	}
 
-	auto it = m_map.find(hash);
+	LockGuard<Mutex> lock(m_mtx);
 
-	if(it != m_map.getEnd())
+	existing = m_map.find(hash);
+	if(existing)
 	{
-		out = *it;
+		out = *existing;
 	}
 	else
 	{
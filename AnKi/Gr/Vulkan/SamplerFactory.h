@@ -6,7 +6,7 @@
 #pragma once
 
 #include <AnKi/Gr/Vulkan/FenceFactory.h>
-#include <AnKi/Util/HashMap.h>
+#include <AnKi/Util/ConcurrentHashMap.h>
 
 namespace anki {
 
@@ -90,8 +90,8 @@ public:
 
 private:
 	GrManagerImpl* m_gr = nullptr;
-	HashMap<U64, MicroSampler*> m_map;
-	Mutex m_mtx;
+	ConcurrentHashMap<U64, MicroSampler*> m_map;
+	Mutex m_mtx; ///< Serializes the insertions to m_map. The lookups don't lock.
 };
 /// @}
 
@@ -116,6 +116,13 @@ Error ShaderImpl::init(const ShaderInitInfo& inf)
 		}
 	}
 
+	// Compute the hash
+	m_contentHash = computeHash(&inf.m_binary[0], inf.m_binary.getSize());
+	if(m_specConstInfo.dataSize)
+	{
+		m_contentHash = appendHash(m_specConstInfo.pData, m_specConstInfo.dataSize, m_contentHash);
+	}
+
 	return Error::NONE;
 }
 
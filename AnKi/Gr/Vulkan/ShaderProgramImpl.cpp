@@ -220,9 +220,16 @@ Error ShaderProgramImpl::init(const ShaderProgramInitInfo& inf)
 	//
 	if(graphicsProg)
 	{
+		U64 programHash = 1;
+		for(const ShaderPtr& shader : m_shaders)
+		{
+			const U64 shaderHash = static_cast<const ShaderImpl&>(*shader).m_contentHash;
+			programHash = appendHash(&shaderHash, sizeof(shaderHash), programHash);
+		}
+
 		m_graphics.m_pplineFactory = getAllocator().newInstance<PipelineFactory>();
 		m_graphics.m_pplineFactory->init(getGrManagerImpl().getAllocator(), getGrManagerImpl().getDevice(),
-										 getGrManagerImpl().getPipelineCache());
+										 getGrManagerImpl().getPipelineCacheInternal(), this, programHash);
 	}
 
 	// Create the pipeline if compute
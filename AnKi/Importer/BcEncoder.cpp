@@ -0,0 +1,775 @@
+// Copyright (C) 2009-2022, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Importer/BcEncoder.h>
+#include <AnKi/Math.h>
+#include <AnKi/Util/F16.h>
+
+namespace anki {
+
+namespace {
+
+/// The pixels of a 4x4 block in SoA layout. Unused channels should be zero.
+class alignas(16) BlockPixels
+{
+public:
+	Array<Array<F32, 16>, 4> m_channels = {};
+
+	Vec3 getVec3(U32 pixel) const
+	{
+		return Vec3(m_channels[0][pixel], m_channels[1][pixel], m_channels[2][pixel]);
+	}
+};
+
+/// A palette of colors that the indices of a block point to.
+class Palette
+{
+public:
+	Array<Vec4, 16> m_colors;
+	U32 m_size = 0;
+};
+
+/// Writes bits to a 128bit block.
+class BitWriter
+{
+public:
+	Array<U64, 2> m_bits = {};
+	U32 m_pos = 0;
+
+	void write(U32 value, U32 bitCount)
+	{
+		ANKI_ASSERT(m_pos + bitCount <= 128);
+		for(U32 i = 0; i < bitCount; ++i, ++m_pos)
+		{
+			m_bits[m_pos / 64] |= U64((value >> i) & 1u) << (m_pos % 64);
+		}
+	}
+};
+
+/// The weights that BC6H uses to interpolate the endpoints with 4bit indices.
+constexpr Array<U32, 16> BC6H_WEIGHTS = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+/// Encoding of the endpoints of BC1 (and the color part of BC3). Endpoints are RGB565 and the values are in [0, 255].
+class Bc1Codec
+{
+public:
+	static U32 getMaxEndpoint(U32 channel)
+	{
+		return (channel == 1) ? 63 : 31;
+	}
+
+	static UVec3 quantize(const Vec3& v)
+	{
+		UVec3 out;
+		for(U32 c = 0; c < 3; ++c)
+		{
+			out[c] = U32(round(clamp(v[c], 0.0f, 255.0f) * F32(getMaxEndpoint(c)) / 255.0f));
+		}
+		return out;
+	}
+
+	static U32 pack(const UVec3& e)
+	{
+		return (e.x() << 11u) | (e.y() << 5u) | e.z();
+	}
+
+	static Vec3 expand(const UVec3& e)
+	{
+		return Vec3(F32((e.x() << 3u) | (e.x() >> 2u)), F32((e.y() << 2u) | (e.y() >> 4u)),
+					F32((e.z() << 3u) | (e.z() >> 2u)));
+	}
+
+	/// Build the 4 color palette. The endpoints might be swapped to force the 4 color mode.
+	static void buildPalette(UVec3& e0, UVec3& e1, Palette& palette)
+	{
+		if(pack(e0) < pack(e1))
+		{
+			std::swap(e0, e1);
+		}
+
+		const Vec3 c0 = expand(e0);
+		const Vec3 c1 = expand(e1);
+		palette.m_colors[0] = Vec4(c0, 0.0f);
+		if(pack(e0) == pack(e1))
+		{
+			palette.m_size = 1;
+		}
+		else
+		{
+			palette.m_colors[1] = Vec4(c1, 0.0f);
+			palette.m_colors[2] = Vec4((c0 * 2.0f + c1) / 3.0f, 0.0f);
+			palette.m_colors[3] = Vec4((c0 + c1 * 2.0f) / 3.0f, 0.0f);
+			palette.m_size = 4;
+		}
+	}
+
+	/// The weight of the 2nd endpoint for an index.
+	static F32 getWeight(U32 idx)
+	{
+		constexpr Array<F32, 4> weights = {0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f};
+		return weights[idx];
+	}
+};
+
+/// Encoding of the endpoints of the BC6H mode 11. Endpoints are 10bits and the values are the bits of half floats.
+class Bc6hCodec
+{
+public:
+	static U32 getMaxEndpoint(U32 channel)
+	{
+		return 1023;
+	}
+
+	/// The half float bits that a 10bit endpoint is decoded to.
+	static U32 unquantize(U32 q)
+	{
+		if(q == 0)
+		{
+			return 0;
+		}
+		else if(q == 1023)
+		{
+			return 0xFFFF;
+		}
+		else
+		{
+			return ((q << 16u) + 0x8000u) >> 10u;
+		}
+	}
+
+	static U32 finishUnquantize(U32 x)
+	{
+		return (x * 31u) >> 6u;
+	}
+
+	static UVec3 quantize(const Vec3& v)
+	{
+		UVec3 out;
+		for(U32 c = 0; c < 3; ++c)
+		{
+			const F32 h = clamp(v[c], 0.0f, F32(0x7BFF));
+			const I32 guess = I32(round((h - 15.0f) / 31.0f));
+
+			// The mapping is not exactly linear at the edges, try the neighbours
+			F32 bestDist = MAX_F32;
+			for(I32 q = guess - 1; q <= guess + 1; ++q)
+			{
+				const U32 uq = U32(clamp(q, 0, 1023));
+				const F32 dist = absolute(F32(finishUnquantize(unquantize(uq))) - h);
+				if(dist < bestDist)
+				{
+					bestDist = dist;
+					out[c] = uq;
+				}
+			}
+		}
+		return out;
+	}
+
+	static void buildPalette(UVec3& e0, UVec3& e1, Palette& palette)
+	{
+		const UVec3 u0(unquantize(e0.x()), unquantize(e0.y()), unquantize(e0.z()));
+		const UVec3 u1(unquantize(e1.x()), unquantize(e1.y()), unquantize(e1.z()));
+		for(U32 i = 0; i < 16; ++i)
+		{
+			const U32 w = BC6H_WEIGHTS[i];
+			Vec4& color = palette.m_colors[i];
+			for(U32 c = 0; c < 3; ++c)
+			{
+				color[c] = F32(finishUnquantize((u0[c] * (64u - w) + u1[c] * w + 32u) >> 6u));
+			}
+			color.w() = 0.0f;
+		}
+		palette.m_size = 16;
+	}
+
+	static F32 getWeight(U32 idx)
+	{
+		return F32(BC6H_WEIGHTS[idx]) / 64.0f;
+	}
+};
+
+} // end anonymous namespace
+
+/// Find the closest palette color of each pixel of the block. It's the hot spot of the encoder.
+/// @return The total squared error.
+static F32 fitIndices(const BlockPixels& block, const Palette& palette, Array<U8, 16>& indices)
+{
+	ANKI_ASSERT(palette.m_size > 0);
+
+#if ANKI_SIMD_SSE
+	__m128 totalError = _mm_setzero_ps();
+	for(U32 group = 0; group < 4; ++group)
+	{
+		const __m128 r = _mm_load_ps(&block.m_channels[0][group * 4]);
+		const __m128 g = _mm_load_ps(&block.m_channels[1][group * 4]);
+		const __m128 b = _mm_load_ps(&block.m_channels[2][group * 4]);
+		const __m128 a = _mm_load_ps(&block.m_channels[3][group * 4]);
+
+		__m128 bestError = _mm_set1_ps(MAX_F32);
+		__m128 bestIdx = _mm_setzero_ps();
+		for(U32 p = 0; p < palette.m_size; ++p)
+		{
+			const Vec4& color = palette.m_colors[p];
+			const __m128 dr = _mm_sub_ps(r, _mm_set1_ps(color.x()));
+			const __m128 dg = _mm_sub_ps(g, _mm_set1_ps(color.y()));
+			const __m128 db = _mm_sub_ps(b, _mm_set1_ps(color.z()));
+			const __m128 da = _mm_sub_ps(a, _mm_set1_ps(color.w()));
+			const __m128 error = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dr, dr), _mm_mul_ps(dg, dg)),
+											_mm_add_ps(_mm_mul_ps(db, db), _mm_mul_ps(da, da)));
+
+			const __m128 less = _mm_cmplt_ps(error, bestError);
+			bestError = _mm_min_ps(error, bestError);
+			bestIdx = _mm_blendv_ps(bestIdx, _mm_set1_ps(F32(p)), less);
+		}
+
+		totalError = _mm_add_ps(totalError, bestError);
+
+		alignas(16) Array<I32, 4> idx;
+		_mm_store_si128(reinterpret_cast<__m128i*>(&idx[0]), _mm_cvttps_epi32(bestIdx));
+		for(U32 i = 0; i < 4; ++i)
+		{
+			indices[group * 4 + i] = U8(idx[i]);
+		}
+	}
+
+	alignas(16) Array<F32, 4> errors;
+	_mm_store_ps(&errors[0], totalError);
+	return errors[0] + errors[1] + errors[2] + errors[3];
+#elif ANKI_SIMD_NEON
+	float32x4_t totalError = vdupq_n_f32(0.0f);
+	for(U32 group = 0; group < 4; ++group)
+	{
+		const float32x4_t r = vld1q_f32(&block.m_channels[0][group * 4]);
+		const float32x4_t g = vld1q_f32(&block.m_channels[1][group * 4]);
+		const float32x4_t b = vld1q_f32(&block.m_channels[2][group * 4]);
+		const float32x4_t a = vld1q_f32(&block.m_channels[3][group * 4]);
+
+		float32x4_t bestError = vdupq_n_f32(MAX_F32);
+		float32x4_t bestIdx = vdupq_n_f32(0.0f);
+		for(U32 p = 0; p < palette.m_size; ++p)
+		{
+			const Vec4& color = palette.m_colors[p];
+			const float32x4_t dr = vsubq_f32(r, vdupq_n_f32(color.x()));
+			const float32x4_t dg = vsubq_f32(g, vdupq_n_f32(color.y()));
+			const float32x4_t db = vsubq_f32(b, vdupq_n_f32(color.z()));
+			const float32x4_t da = vsubq_f32(a, vdupq_n_f32(color.w()));
+			float32x4_t error = vmulq_f32(dr, dr);
+			error = vmlaq_f32(error, dg, dg);
+			error = vmlaq_f32(error, db, db);
+			error = vmlaq_f32(error, da, da);
+
+			const uint32x4_t less = vcltq_f32(error, bestError);
+			bestError = vminq_f32(error, bestError);
+			bestIdx = vbslq_f32(less, vdupq_n_f32(F32(p)), bestIdx);
+		}
+
+		totalError = vaddq_f32(totalError, bestError);
+
+		Array<I32, 4> idx;
+		vst1q_s32(&idx[0], vcvtq_s32_f32(bestIdx));
+		for(U32 i = 0; i < 4; ++i)
+		{
+			indices[group * 4 + i] = U8(idx[i]);
+		}
+	}
+
+	Array<F32, 4> errors;
+	vst1q_f32(&errors[0], totalError);
+	return errors[0] + errors[1] + errors[2] + errors[3];
+#else
+	F32 totalError = 0.0f;
+	for(U32 i = 0; i < 16; ++i)
+	{
+		F32 bestError = MAX_F32;
+		for(U32 p = 0; p < palette.m_size; ++p)
+		{
+			F32 error = 0.0f;
+			for(U32 c = 0; c < 4; ++c)
+			{
+				const F32 d = block.m_channels[c][i] - palette.m_colors[p][c];
+				error += d * d;
+			}
+
+			if(error < bestError)
+			{
+				bestError = error;
+				indices[i] = U8(p);
+			}
+		}
+
+		totalError += bestError;
+	}
+
+	return totalError;
+#endif
+}
+
+/// Compute the initial endpoints of an RGB block.
+static void computeEndpoints(const BlockPixels& block, BcEncoderQuality quality, Vec3& e0, Vec3& e1)
+{
+	Vec3 minc(MAX_F32);
+	Vec3 maxc(MIN_F32);
+	Vec3 mean(0.0f);
+	for(U32 i = 0; i < 16; ++i)
+	{
+		const Vec3 p = block.getVec3(i);
+		minc = minc.min(p);
+		maxc = maxc.max(p);
+		mean += p;
+	}
+	mean /= 16.0f;
+
+	if(quality == BcEncoderQuality::FAST)
+	{
+		// Bounding box with a small inset
+		const Vec3 inset = (maxc - minc) / 16.0f;
+		e0 = maxc - inset;
+		e1 = minc + inset;
+		return;
+	}
+
+	// Covariance
+	Array<F32, 6> cov = {};
+	for(U32 i = 0; i < 16; ++i)
+	{
+		const Vec3 d = block.getVec3(i) - mean;
+		cov[0] += d.x() * d.x();
+		cov[1] += d.x() * d.y();
+		cov[2] += d.x() * d.z();
+		cov[3] += d.y() * d.y();
+		cov[4] += d.y() * d.z();
+		cov[5] += d.z() * d.z();
+	}
+
+	// Principal axis with power iteration
+	Vec3 axis = maxc - minc;
+	for(U32 it = 0; it < 8; ++it)
+	{
+		const Vec3 v(axis.x() * cov[0] + axis.y() * cov[1] + axis.z() * cov[2],
+					 axis.x() * cov[1] + axis.y() * cov[3] + axis.z() * cov[4],
+					 axis.x() * cov[2] + axis.y() * cov[4] + axis.z() * cov[5]);
+		const F32 len = v.getLength();
+		if(len < EPSILON)
+		{
+			break;
+		}
+		axis = v / len;
+	}
+
+	if(axis.getLengthSquared() < EPSILON)
+	{
+		// All pixels are the same
+		e0 = maxc;
+		e1 = minc;
+		return;
+	}
+	axis.normalize();
+
+	F32 minProj = MAX_F32;
+	F32 maxProj = MIN_F32;
+	for(U32 i = 0; i < 16; ++i)
+	{
+		const F32 proj = (block.getVec3(i) - mean).dot(axis);
+		minProj = min(minProj, proj);
+		maxProj = max(maxProj, proj);
+	}
+
+	e0 = mean + axis * maxProj;
+	e1 = mean + axis * minProj;
+}
+
+/// Find the RGB endpoints and the indices of a block.
+/// @return The error.
+template<typename TCodec>
+static F32 encodeRgbEndpoints(const BlockPixels& block, BcEncoderQuality quality, UVec3& bestE0, UVec3& bestE1,
+							  Array<U8, 16>& bestIndices)
+{
+	Palette palette;
+	Array<U8, 16> indices;
+	F32 bestError = MAX_F32;
+
+	auto evaluate = [&](UVec3 e0, UVec3 e1) -> Bool {
+		TCodec::buildPalette(e0, e1, palette);
+		const F32 error = fitIndices(block, palette, indices);
+		if(error < bestError)
+		{
+			bestError = error;
+			bestE0 = e0;
+			bestE1 = e1;
+			bestIndices = indices;
+			return true;
+		}
+		return false;
+	};
+
+	Vec3 e0f, e1f;
+	computeEndpoints(block, quality, e0f, e1f);
+	evaluate(TCodec::quantize(e0f), TCodec::quantize(e1f));
+
+	// Least squares refinement of the endpoints using the current indices
+	const U32 refinementCount =
+		(quality == BcEncoderQuality::FAST) ? 0 : ((quality == BcEncoderQuality::NORMAL) ? 1 : 3);
+	for(U32 r = 0; r < refinementCount && bestError > 0.0f; ++r)
+	{
+		F32 a = 0.0f, b = 0.0f, c = 0.0f;
+		Vec3 x(0.0f), y(0.0f);
+		for(U32 i = 0; i < 16; ++i)
+		{
+			const F32 t = TCodec::getWeight(bestIndices[i]);
+			const Vec3 p = block.getVec3(i);
+			a += (1.0f - t) * (1.0f - t);
+			b += t * t;
+			c += t * (1.0f - t);
+			x += p * (1.0f - t);
+			y += p * t;
+		}
+
+		const F32 det = a * b - c * c;
+		if(absolute(det) < EPSILON)
+		{
+			break;
+		}
+
+		e0f = (x * b - y * c) / det;
+		e1f = (y * a - x * c) / det;
+		if(!evaluate(TCodec::quantize(e0f), TCodec::quantize(e1f)))
+		{
+			break;
+		}
+	}
+
+	// Greedy search around the quantized endpoints
+	if(quality == BcEncoderQuality::HIGH)
+	{
+		for(U32 pass = 0; pass < 2 && bestError > 0.0f; ++pass)
+		{
+			Bool improved = false;
+			for(U32 endpoint = 0; endpoint < 2; ++endpoint)
+			{
+				for(U32 ch = 0; ch < 3; ++ch)
+				{
+					for(I32 delta = -1; delta <= 1; delta += 2)
+					{
+						UVec3 e0 = bestE0;
+						UVec3 e1 = bestE1;
+						UVec3& e = (endpoint == 0) ? e0 : e1;
+						const I32 newVal = I32(e[ch]) + delta;
+						if(newVal < 0 || newVal > I32(TCodec::getMaxEndpoint(ch)))
+						{
+							continue;
+						}
+
+						e[ch] = U32(newVal);
+						improved = evaluate(e0, e1) || improved;
+					}
+				}
+			}
+
+			if(!improved)
+			{
+				break;
+			}
+		}
+	}
+
+	return bestError;
+}
+
+static void encodeBc1Block(const Array<U8Vec4, 16>& pixels, BcEncoderQuality quality, U8* out)
+{
+	BlockPixels block;
+	for(U32 i = 0; i < 16; ++i)
+	{
+		for(U32 c = 0; c < 3; ++c)
+		{
+			block.m_channels[c][i] = F32(pixels[i][c]);
+		}
+	}
+
+	UVec3 e0, e1;
+	Array<U8, 16> indices;
+	encodeRgbEndpoints<Bc1Codec>(block, quality, e0, e1, indices);
+
+	const U16 c0 = U16(Bc1Codec::pack(e0));
+	const U16 c1 = U16(Bc1Codec::pack(e1));
+	U32 indexBits = 0;
+	for(U32 i = 0; i < 16; ++i)
+	{
+		indexBits |= U32(indices[i]) << (i * 2u);
+	}
+
+	memcpy(out, &c0, sizeof(c0));
+	memcpy(out + 2, &c1, sizeof(c1));
+	memcpy(out + 4, &indexBits, sizeof(indexBits));
+}
+
+/// Build the palette of a BC4 block. If a0 > a1 it has 8 interpolated values, else 6 plus 0 and 255.
+static void buildBc4Palette(U32 a0, U32 a1, Palette& palette)
+{
+	const F32 f0 = F32(a0);
+	const F32 f1 = F32(a1);
+	palette.m_colors[0] = Vec4(f0, 0.0f, 0.0f, 0.0f);
+	palette.m_colors[1] = Vec4(f1, 0.0f, 0.0f, 0.0f);
+	if(a0 > a1)
+	{
+		for(U32 i = 2; i < 8; ++i)
+		{
+			palette.m_colors[i] = Vec4((F32(8 - i) * f0 + F32(i - 1) * f1) / 7.0f, 0.0f, 0.0f, 0.0f);
+		}
+	}
+	else
+	{
+		for(U32 i = 2; i < 6; ++i)
+		{
+			palette.m_colors[i] = Vec4((F32(6 - i) * f0 + F32(i - 1) * f1) / 5.0f, 0.0f, 0.0f, 0.0f);
+		}
+		palette.m_colors[6] = Vec4(0.0f);
+		palette.m_colors[7] = Vec4(255.0f, 0.0f, 0.0f, 0.0f);
+	}
+	palette.m_size = 8;
+}
+
+static void encodeBc4Block(const Array<U8, 16>& values, BcEncoderQuality quality, U8* out)
+{
+	BlockPixels block;
+	U32 minv = 255, maxv = 0;
+	U32 innerMin = 255, innerMax = 0;
+	for(U32 i = 0; i < 16; ++i)
+	{
+		const U32 v = values[i];
+		block.m_channels[0][i] = F32(v);
+		minv = min(minv, v);
+		maxv = max(maxv, v);
+		if(v != 0 && v != 255)
+		{
+			innerMin = min(innerMin, v);
+			innerMax = max(innerMax, v);
+		}
+	}
+
+	Palette palette;
+	Array<U8, 16> indices;
+	Array<U8, 16> bestIndices;
+	F32 bestError = MAX_F32;
+	U32 bestA0 = 0, bestA1 = 0;
+
+	auto evaluate = [&](U32 a0, U32 a1) -> Bool {
+		buildBc4Palette(a0, a1, palette);
+		const F32 error = fitIndices(block, palette, indices);
+		if(error < bestError)
+		{
+			bestError = error;
+			bestA0 = a0;
+			bestA1 = a1;
+			bestIndices = indices;
+			return true;
+		}
+		return false;
+	};
+
+	// The 8 value mode that covers the whole range
+	evaluate(maxv, minv);
+
+	// The 6 value mode that gets 0 and 255 for free
+	if(quality != BcEncoderQuality::FAST && innerMin <= innerMax && bestError > 0.0f)
+	{
+		evaluate(innerMin, innerMax);
+	}
+
+	// Shrink or grow the endpoints of the best mode
+	if(quality == BcEncoderQuality::HIGH)
+	{
+		for(U32 pass = 0; pass < 4 && bestError > 0.0f; ++pass)
+		{
+			Bool improved = false;
+			for(U32 endpoint = 0; endpoint < 2; ++endpoint)
+			{
+				for(I32 delta = -1; delta <= 1; delta += 2)
+				{
+					I32 a0 = I32(bestA0);
+					I32 a1 = I32(bestA1);
+					I32& a = (endpoint == 0) ? a0 : a1;
+					a += delta;
+
+					// Don't switch modes
+					const Bool wasMode8 = bestA0 > bestA1;
+					if(a < 0 || a > 255 || (a0 > a1) != wasMode8)
+					{
+						continue;
+					}
+
+					improved = evaluate(U32(a0), U32(a1)) || improved;
+				}
+			}
+
+			if(!improved)
+			{
+				break;
+			}
+		}
+	}
+
+	U64 indexBits = 0;
+	for(U32 i = 0; i < 16; ++i)
+	{
+		indexBits |= U64(bestIndices[i]) << (i * 3u);
+	}
+
+	out[0] = U8(bestA0);
+	out[1] = U8(bestA1);
+	for(U32 i = 0; i < 6; ++i)
+	{
+		out[2 + i] = U8(indexBits >> (i * 8u));
+	}
+}
+
+static void encodeBc6hBlock(const Array<Vec3, 16>& pixels, BcEncoderQuality quality, U8* out)
+{
+	// Work with the bits of the half floats. It's close to a logarithmic space and it's what the hardware interpolates
+	BlockPixels block;
+	for(U32 i = 0; i < 16; ++i)
+	{
+		for(U32 c = 0; c < 3; ++c)
+		{
+			const F32 v = pixels[i][c];
+			const F32 clamped = (v > 0.0f) ? min(v, 65504.0f) : 0.0f; // Also takes care of NaNs
+			block.m_channels[c][i] = F32(F16(clamped).toU16());
+		}
+	}
+
+	UVec3 e0, e1;
+	Array<U8, 16> indices;
+	encodeRgbEndpoints<Bc6hCodec>(block, quality, e0, e1, indices);
+
+	// The MSB of the 1st index is implicitly zero
+	if(indices[0] >= 8)
+	{
+		std::swap(e0, e1);
+		for(U8& idx : indices)
+		{
+			idx = U8(15 - idx);
+		}
+	}
+
+	BitWriter writer;
+	writer.write(0x3, 5); // Mode 11: one region and 10bit endpoints
+	for(U32 c = 0; c < 3; ++c)
+	{
+		writer.write(e0[c], 10);
+	}
+	for(U32 c = 0; c < 3; ++c)
+	{
+		writer.write(e1[c], 10);
+	}
+	writer.write(indices[0], 3);
+	for(U32 i = 1; i < 16; ++i)
+	{
+		writer.write(indices[i], 4);
+	}
+	ANKI_ASSERT(writer.m_pos == 128);
+
+	memcpy(out, &writer.m_bits[0], 16);
+}
+
+BcEncoder::BcEncoder(BcFormat format, BcEncoderQuality quality, U32 width, U32 height, U32 channelCount)
+	: m_width(width)
+	, m_height(height)
+	, m_channelCount(channelCount)
+	, m_format(format)
+	, m_quality(quality)
+{
+	ANKI_ASSERT(format < BcFormat::COUNT);
+	ANKI_ASSERT(width > 0 && (width % 4) == 0 && height > 0 && (height % 4) == 0);
+	ANKI_ASSERT(channelCount > 0 && channelCount <= 4);
+	ANKI_ASSERT(format != BcFormat::BC6H || channelCount >= 3);
+}
+
+void BcEncoder::encode(ConstWeakArray<U8, PtrSize> pixels, U32 firstBlockRow, U32 blockRowCount,
+					   WeakArray<U8, PtrSize> out) const
+{
+	ANKI_ASSERT(pixels.getSizeInBytes() == getUncompressedSize());
+	ANKI_ASSERT(out.getSizeInBytes() == getCompressedSize());
+	ANKI_ASSERT(firstBlockRow + blockRowCount <= getBlockRowCount());
+
+	const U32 blocksPerRow = m_width / 4;
+	const U32 blockSize = getBcBlockSize(m_format);
+
+	for(U32 by = firstBlockRow; by < firstBlockRow + blockRowCount; ++by)
+	{
+		for(U32 bx = 0; bx < blocksPerRow; ++bx)
+		{
+			U8* outBlock = &out[(PtrSize(by) * blocksPerRow + bx) * blockSize];
+
+			if(m_format == BcFormat::BC6H)
+			{
+				const F32* inPixels = reinterpret_cast<const F32*>(&pixels[0]);
+				Array<Vec3, 16> blockPixels;
+				for(U32 y = 0; y < 4; ++y)
+				{
+					for(U32 x = 0; x < 4; ++x)
+					{
+						const F32* pixel = inPixels + (PtrSize(by * 4 + y) * m_width + bx * 4 + x) * m_channelCount;
+						blockPixels[y * 4 + x] = Vec3(pixel[0], pixel[1], pixel[2]);
+					}
+				}
+
+				encodeBc6hBlock(blockPixels, m_quality, outBlock);
+				continue;
+			}
+
+			Array<U8Vec4, 16> blockPixels;
+			for(U32 y = 0; y < 4; ++y)
+			{
+				for(U32 x = 0; x < 4; ++x)
+				{
+					const U8* pixel = &pixels[(PtrSize(by * 4 + y) * m_width + bx * 4 + x) * m_channelCount];
+					U8Vec4& blockPixel = blockPixels[y * 4 + x];
+					for(U32 c = 0; c < 4; ++c)
+					{
+						blockPixel[c] = (c < m_channelCount) ? pixel[c] : ((c == 3) ? 255 : 0);
+					}
+				}
+			}
+
+			switch(m_format)
+			{
+			case BcFormat::BC1:
+				encodeBc1Block(blockPixels, m_quality, outBlock);
+				break;
+			case BcFormat::BC3:
+			{
+				Array<U8, 16> alpha;
+				for(U32 i = 0; i < 16; ++i)
+				{
+					alpha[i] = blockPixels[i].w();
+				}
+				encodeBc4Block(alpha, m_quality, outBlock);
+				encodeBc1Block(blockPixels, m_quality, outBlock + 8);
+				break;
+			}
+			case BcFormat::BC4:
+			case BcFormat::BC5:
+			{
+				const U32 channelCount = (m_format == BcFormat::BC4) ? 1 : 2;
+				for(U32 c = 0; c < channelCount; ++c)
+				{
+					Array<U8, 16> values;
+					for(U32 i = 0; i < 16; ++i)
+					{
+						values[i] = blockPixels[i][c];
+					}
+					encodeBc4Block(values, m_quality, outBlock + c * 8);
+				}
+				break;
+			}
+			default:
+				ANKI_ASSERT(0);
+			}
+		}
+	}
+}
+
+} // end namespace anki
@@ -0,0 +1,94 @@
+// Copyright (C) 2009-2022, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Importer/Common.h>
+#include <AnKi/Util/WeakArray.h>
+
+namespace anki {
+
+/// @addtogroup importer
+/// @{
+
+/// The block compressed formats that BcEncoder can produce.
+enum class BcFormat : U8
+{
+	BC1, ///< RGB. 8 bytes per block.
+	BC3, ///< RGBA. 16 bytes per block.
+	BC4, ///< R. 8 bytes per block.
+	BC5, ///< RG. 16 bytes per block.
+	BC6H, ///< RGB unsigned half float. 16 bytes per block.
+
+	COUNT
+};
+
+/// Quality tiers of BcEncoder. Higher quality costs more time.
+enum class BcEncoderQuality : U8
+{
+	FAST, ///< Bounding box endpoints.
+	NORMAL, ///< Principal axis endpoints plus a least squares refinement.
+	HIGH, ///< Like NORMAL but with more refinement iterations and an endpoint search.
+};
+
+/// Get the size of a compressed 4x4 block.
+inline U32 getBcBlockSize(BcFormat format)
+{
+	return (format == BcFormat::BC1 || format == BcFormat::BC4) ? 8 : 16;
+}
+
+/// Block compression encoder. It works on uncompressed surfaces with dimensions that are a multiple of 4.
+class BcEncoder
+{
+public:
+	/// @param format The output format.
+	/// @param quality The quality of the compression.
+	/// @param width The width of the surface.
+	/// @param height The height of the surface.
+	/// @param channelCount The channel count of the input pixels. If it's more than the format needs the rest of the
+	///                     channels are ignored. For BC1 and BC3 a missing alpha is considered 1.0.
+	BcEncoder(BcFormat format, BcEncoderQuality quality, U32 width, U32 height, U32 channelCount);
+
+	/// Encode some rows of blocks. Can be called from multiple threads on different block rows.
+	/// @param pixels The uncompressed surface. U8 pixels for all formats except BC6H that expects F32.
+	/// @param firstBlockRow The first row of 4x4 blocks to compress.
+	/// @param blockRowCount The number of rows of blocks to compress.
+	/// @param out The compressed surface. Only the blocks of the given rows will be written.
+	void encode(ConstWeakArray<U8, PtrSize> pixels, U32 firstBlockRow, U32 blockRowCount,
+				WeakArray<U8, PtrSize> out) const;
+
+	/// Encode the whole surface.
+	void encode(ConstWeakArray<U8, PtrSize> pixels, WeakArray<U8, PtrSize> out) const
+	{
+		encode(pixels, 0, getBlockRowCount(), out);
+	}
+
+	U32 getBlockRowCount() const
+	{
+		return m_height / 4;
+	}
+
+	/// The size of the whole compressed surface.
+	PtrSize getCompressedSize() const
+	{
+		return PtrSize(m_width / 4) * (m_height / 4) * getBcBlockSize(m_format);
+	}
+
+	/// The size of the input surface.
+	PtrSize getUncompressedSize() const
+	{
+		return PtrSize(m_width) * m_height * m_channelCount * ((m_format == BcFormat::BC6H) ? sizeof(F32) : 1);
+	}
+
+private:
+	U32 m_width;
+	U32 m_height;
+	U32 m_channelCount;
+	BcFormat m_format;
+	BcEncoderQuality m_quality;
+};
+/// @}
+
+} // end namespace anki
@@ -7,6 +7,7 @@
 #include <AnKi/Util/System.h>
 #include <AnKi/Util/ThreadHive.h>
 #include <AnKi/Util/StringList.h>
+#include <AnKi/Util/Filesystem.h>
 
 #if ANKI_COMPILER_GCC_COMPATIBLE
 #	pragma GCC diagnostic push
@@ -148,7 +149,65 @@ static Bool stringsExist(const HashMapAuto<CString, StringAuto>& map, const std:
 	return false;
 }
 
+/// Bump it when the output of the importer changes so the outputs of previous imports get discarded.
+static constexpr U32 IMPORTER_VERSION = 1;
+
+static U64 hashString(const char* str, U64 hash)
+{
+	return (str) ? appendHash(str, strlen(str), hash) : hash;
+}
+
+template<typename T>
+static U64 hashValue(const T& value, U64 hash)
+{
+	return appendHash(&value, sizeof(value), hash);
+}
+
+/// Hash the elements of an accessor and not the whole buffer view.
+static U64 hashAccessor(const cgltf_accessor* accessor, U64 hash)
+{
+	if(!accessor)
+	{
+		return hash;
+	}
+
+	hash = hashValue(accessor->type, hash);
+	hash = hashValue(accessor->component_type, hash);
+	hash = hashValue(accessor->count, hash);
+	if(accessor->count == 0 || !accessor->buffer_view)
+	{
+		return hash;
+	}
+
+	const U8* base =
+		static_cast<const U8*>(accessor->buffer_view->buffer->data) + accessor->offset + accessor->buffer_view->offset;
+	const PtrSize stride = (accessor->buffer_view->stride) ? accessor->buffer_view->stride : accessor->stride;
+	const PtrSize size = stride * (accessor->count - 1) + accessor->stride;
+
+	return appendHash(base, size, hash);
+}
+
+/// Hash the modification time of an image because the materials scan the images.
+static U64 hashTexture(const cgltf_texture_view& view, U64 hash)
+{
+	if(!view.texture || !view.texture->image || !view.texture->image->uri)
+	{
+		return hash;
+	}
+
+	hash = hashString(view.texture->image->uri, hash);
+
+	U64 timestamp = 0;
+	if(fileExists(view.texture->image->uri) && getFileModificationTime(view.texture->image->uri, timestamp))
+	{
+		timestamp = 0;
+	}
+
+	return hashValue(timestamp, hash);
+}
+
 const char* GltfImporter::XML_HEADER = R"(<?xml version="1.0" encoding="UTF-8" ?>)";
+const char* GltfImporter::IMPORT_CACHE_FILENAME = "GltfImporterCache.txt";
 
 GltfImporter::GltfImporter(GenericMemoryPoolAllocator<U8> alloc)
 	: m_alloc(alloc)
@@ -173,6 +232,8 @@ Error GltfImporter::init(const GltfImporterInitInfo& initInfo)
 	m_rpath.create(initInfo.m_rpath);
 	m_texrpath.create(initInfo.m_texrpath);
 	m_optimizeMeshes = initInfo.m_optimizeMeshes;
+	m_generateMeshlets = initInfo.m_generateMeshlets;
+	m_incremental = initInfo.m_incremental;
 	m_comment.create(initInfo.m_comment);
 
 	m_lightIntensityScale = max(initInfo.m_lightIntensityScale, EPSILON);
@@ -193,6 +254,17 @@ Error GltfImporter::init(const GltfImporterInitInfo& initInfo)
 
 	ANKI_IMPORTER_LOGI("Having %u LODs with LOD factor %f", m_lodCount, m_lodFactor);
 
+	m_optionsHash = computeHash(&IMPORTER_VERSION, sizeof(IMPORTER_VERSION));
+	m_optionsHash = hashValue(HASH_ALGORITHM_VERSION, m_optionsHash);
+	m_optionsHash = hashValue(m_optimizeMeshes, m_optionsHash);
+	m_optionsHash = hashValue(m_generateMeshlets, m_optionsHash);
+	m_optionsHash = hashValue(m_lodCount, m_optionsHash);
+	m_optionsHash = hashValue(m_lodFactor, m_optionsHash);
+	m_optionsHash = hashValue(m_skipLodVertexCountThreshold, m_optionsHash);
+	m_optionsHash = hashValue(m_normalsMergeAngle, m_optionsHash);
+	m_optionsHash = hashString(m_rpath.cstr(), m_optionsHash);
+	m_optionsHash = hashString(m_texrpath.cstr(), m_optionsHash);
+
 	cgltf_options options = {};
 	cgltf_result res = cgltf_parse_file(&options, m_inputFname.cstr(), &m_gltf);
 	if(res != cgltf_result_success)
@@ -221,9 +293,14 @@ Error GltfImporter::writeAll()
 {
 	populateNodePtrToIdx();
 
+	if(m_incremental)
+	{
+		ANKI_CHECK(loadImportCache());
+	}
+
 	for(const cgltf_animation* anim = m_gltf->animations; anim < m_gltf->animations + m_gltf->animations_count; ++anim)
 	{
-		ANKI_CHECK(writeAnimation(*anim));
+		newAssetTask(AssetTask::Type::ANIMATION, anim);
 	}
 
 	StringAuto sceneFname(m_alloc);
@@ -232,25 +309,19 @@ Error GltfImporter::writeAll()
 	ANKI_CHECK(m_sceneFile.writeText("-- Generated by: %s\n", m_comment.cstr()));
 	ANKI_CHECK(m_sceneFile.writeText("local scene = getSceneGraph()\nlocal events = getEventManager()\n"));
 
-	// Nodes
-	Error err = Error::NONE;
-	for(const cgltf_scene* scene = m_gltf->scenes; scene < m_gltf->scenes + m_gltf->scenes_count && !err; ++scene)
+	// Nodes. They gather the tasks of the assets
+	for(const cgltf_scene* scene = m_gltf->scenes; scene < m_gltf->scenes + m_gltf->scenes_count; ++scene)
 	{
-		for(cgltf_node* const* node = scene->nodes; node < scene->nodes + scene->nodes_count && !err; ++node)
+		for(cgltf_node* const* node = scene->nodes; node < scene->nodes + scene->nodes_count; ++node)
 		{
-			err = visitNode(*(*node), Transform::getIdentity(), HashMapAuto<CString, StringAuto>(m_alloc));
+			ANKI_CHECK(visitNode(*(*node), Transform::getIdentity(), HashMapAuto<CString, StringAuto>(m_alloc)));
 		}
 	}
 
-	if(m_hive)
-	{
-		m_hive->waitAllTasks();
-	}
-
-	// Check error
+	// Write the assets
+	const Error err = runAssetTasks();
 	if(err)
 	{
-		ANKI_IMPORTER_LOGE("Error happened in main thread");
 		return err;
 	}
 
@@ -261,7 +332,402 @@ Error GltfImporter::writeAll()
 		return threadErr;
 	}
 
-	return err;
+	if(m_incremental)
+	{
+		ANKI_CHECK(storeImportCache());
+	}
+
+	return Error::NONE;
+}
+
+U64 GltfImporter::computeAssetTaskKey(AssetTask::Type type, const void* asset, U32 lod)
+{
+	U64 hash = computeHash(&asset, sizeof(asset));
+	hash = hashValue(type, hash);
+	return hashValue(lod, hash);
+}
+
+void GltfImporter::newAssetTask(AssetTask::Type type, const void* asset, U32 lod, RayTypeBit rayTypes)
+{
+	const U64 key = computeAssetTaskKey(type, asset, lod);
+	auto it = m_assetTaskIndices.find(key);
+	if(it != m_assetTaskIndices.getEnd())
+	{
+		// Already there, merge the ray types of the materials
+		m_assetTasks[*it].m_rayTypes |= rayTypes;
+		return;
+	}
+
+	m_assetTaskIndices.emplace(key, m_assetTasks.getSize());
+
+	AssetTask& task = *m_assetTasks.emplaceBack();
+	task.m_importer = this;
+	task.m_asset = asset;
+	task.m_lod = lod;
+	task.m_type = type;
+	task.m_rayTypes = rayTypes;
+}
+
+void GltfImporter::newModelAssetTasks(const cgltf_mesh& mesh, const cgltf_skin* skin, RayTypeBit rayTypes)
+{
+	// The model task depends on the mesh tasks so they should be adjacent. See runAssetTasks
+	const U64 modelKey = computeAssetTaskKey(AssetTask::Type::MODEL, &mesh, 0);
+	if(m_assetTaskIndices.find(modelKey) == m_assetTaskIndices.getEnd())
+	{
+		for(U32 lod = 0; lod < m_lodCount; ++lod)
+		{
+			if(lod == 0 || !skipMeshLod(mesh, lod))
+			{
+				newAssetTask(AssetTask::Type::MESH, &mesh, lod);
+			}
+		}
+
+		newAssetTask(AssetTask::Type::MODEL, &mesh);
+	}
+
+	for(U32 i = 0; i < mesh.primitives_count; ++i)
+	{
+		newAssetTask(AssetTask::Type::MATERIAL, mesh.primitives[i].material, 0, rayTypes);
+	}
+
+	if(skin)
+	{
+		newAssetTask(AssetTask::Type::SKELETON, skin);
+	}
+}
+
+Error GltfImporter::runAssetTasks()
+{
+	if(!m_hive)
+	{
+		for(const AssetTask& task : m_assetTasks)
+		{
+			ANKI_CHECK(runAssetTask(task));
+		}
+
+		return Error::NONE;
+	}
+
+	auto callback = [](void* userData, U32 threadId, ThreadHive& hive, ThreadHiveSemaphore* signalSemaphore) {
+		const AssetTask& task = *static_cast<const AssetTask*>(userData);
+		const Error err = task.m_importer->runAssetTask(task);
+		if(err)
+		{
+			task.m_importer->m_errorInThread.store(err._getCode());
+		}
+	};
+
+	DynamicArrayAuto<ThreadHiveTask> hiveTasks(m_alloc);
+	hiveTasks.create(m_assetTasks.getSize());
+
+	ThreadHiveSemaphore* meshesSemaphore = nullptr;
+	for(U32 i = 0; i < m_assetTasks.getSize(); ++i)
+	{
+		AssetTask& task = m_assetTasks[i];
+		ThreadHiveTask& hiveTask = hiveTasks[i];
+		hiveTask.m_callback = callback;
+		hiveTask.m_argument = &task;
+
+		if(task.m_type == AssetTask::Type::MESH)
+		{
+			if(task.m_lod == 0)
+			{
+				// The LODs are followed by the model, count them
+				U32 lodCount = 1;
+				while(m_assetTasks[i + lodCount].m_type == AssetTask::Type::MESH)
+				{
+					++lodCount;
+				}
+				ANKI_ASSERT(m_assetTasks[i + lodCount].m_type == AssetTask::Type::MODEL);
+
+				meshesSemaphore = m_hive->newSemaphore(lodCount);
+			}
+
+			hiveTask.m_signalSemaphore = meshesSemaphore;
+		}
+		else if(task.m_type == AssetTask::Type::MODEL)
+		{
+			hiveTask.m_waitSemaphore = meshesSemaphore;
+		}
+	}
+
+	m_hive->submitTasks(&hiveTasks[0], hiveTasks.getSize());
+	m_hive->waitAllTasks();
+
+	return Error::NONE;
+}
+
+Error GltfImporter::runAssetTask(const AssetTask& task)
+{
+	StringAuto filename(m_alloc);
+	U64 inputHash = 0;
+	switch(task.m_type)
+	{
+	case AssetTask::Type::MESH:
+	{
+		const cgltf_mesh& mesh = *static_cast<const cgltf_mesh*>(task.m_asset);
+		filename = computeMeshResourceFilename(mesh, task.m_lod);
+		inputHash = computeMeshInputHash(mesh, task.m_lod);
+		break;
+	}
+	case AssetTask::Type::MATERIAL:
+	{
+		const cgltf_material& mtl = *static_cast<const cgltf_material*>(task.m_asset);
+		filename = computeMaterialResourceFilename(mtl);
+		inputHash = computeMaterialInputHash(mtl, task.m_rayTypes);
+		break;
+	}
+	case AssetTask::Type::MODEL:
+	{
+		if(m_errorInThread.load())
+		{
+			// One of the meshes failed, don't bother
+			return Error::NONE;
+		}
+
+		const cgltf_mesh& mesh = *static_cast<const cgltf_mesh*>(task.m_asset);
+		filename = computeModelResourceFilename(mesh);
+		inputHash = computeModelInputHash(mesh);
+		break;
+	}
+	case AssetTask::Type::SKELETON:
+	{
+		const cgltf_skin& skin = *static_cast<const cgltf_skin*>(task.m_asset);
+		filename = computeSkeletonResourceFilename(skin);
+		inputHash = computeSkeletonInputHash(skin);
+		break;
+	}
+	case AssetTask::Type::ANIMATION:
+	{
+		const cgltf_animation& anim = *static_cast<const cgltf_animation*>(task.m_asset);
+		filename = fixFilename(computeAnimationResourceFilename(anim));
+		inputHash = computeAnimationInputHash(anim);
+		break;
+	}
+	default:
+		ANKI_ASSERT(0);
+	}
+
+	if(m_incremental && isUpToDate(filename, inputHash))
+	{
+		ANKI_IMPORTER_LOGI("Skipping %s. It's up to date", filename.cstr());
+		addImportCacheEntry(filename, inputHash);
+		return Error::NONE;
+	}
+
+	switch(task.m_type)
+	{
+	case AssetTask::Type::MESH:
+		ANKI_CHECK(writeMesh(*static_cast<const cgltf_mesh*>(task.m_asset), task.m_lod, computeLodFactor(task.m_lod)));
+		break;
+	case AssetTask::Type::MATERIAL:
+		ANKI_CHECK(writeMaterial(*static_cast<const cgltf_material*>(task.m_asset), task.m_rayTypes));
+		break;
+	case AssetTask::Type::MODEL:
+		ANKI_CHECK(writeModel(*static_cast<const cgltf_mesh*>(task.m_asset)));
+		break;
+	case AssetTask::Type::SKELETON:
+		ANKI_CHECK(writeSkeleton(*static_cast<const cgltf_skin*>(task.m_asset)));
+		break;
+	case AssetTask::Type::ANIMATION:
+		ANKI_CHECK(writeAnimation(*static_cast<const cgltf_animation*>(task.m_asset)));
+		break;
+	default:
+		ANKI_ASSERT(0);
+	}
+
+	if(m_incremental)
+	{
+		addImportCacheEntry(filename, inputHash);
+	}
+
+	return Error::NONE;
+}
+
+Error GltfImporter::loadImportCache()
+{
+	StringAuto fname(m_alloc);
+	fname.sprintf("%s%s", m_outDir.cstr(), IMPORT_CACHE_FILENAME);
+	if(!fileExists(fname))
+	{
+		return Error::NONE;
+	}
+
+	File file;
+	ANKI_CHECK(file.open(fname, FileOpenFlag::READ));
+	StringAuto txt(m_alloc);
+	ANKI_CHECK(file.readAllText(txt));
+
+	// Every line is "<input hash> <output filename>"
+	StringListAuto lines(m_alloc);
+	lines.splitString(txt, '\n');
+	for(const String& line : lines)
+	{
+		StringListAuto tokens(m_alloc);
+		tokens.splitString(line, ' ');
+		U64 inputHash;
+		if(tokens.getSize() != 2 || tokens.getFront().toNumber(inputHash))
+		{
+			ANKI_IMPORTER_LOGW("Ignoring the corrupted import cache: %s", fname.cstr());
+			m_importCache.destroy();
+			break;
+		}
+
+		const U64 filenameHash = computeHash(tokens.getBack().cstr(), tokens.getBack().getLength());
+		m_importCache.emplace(filenameHash, inputHash);
+	}
+
+	return Error::NONE;
+}
+
+Error GltfImporter::storeImportCache()
+{
+	StringAuto fname(m_alloc);
+	fname.sprintf("%s%s", m_outDir.cstr(), IMPORT_CACHE_FILENAME);
+
+	StringAuto txt(m_alloc);
+	m_newImportCache.join("\n", txt);
+
+	File file;
+	ANKI_CHECK(file.open(fname, FileOpenFlag::WRITE));
+	ANKI_CHECK(file.writeText("%s\n", txt.cstr()));
+
+	return Error::NONE;
+}
+
+Bool GltfImporter::isUpToDate(CString filename, U64 inputHash) const
+{
+	auto it = m_importCache.find(computeHash(filename.cstr(), filename.getLength()));
+	if(it == m_importCache.getEnd() || *it != inputHash)
+	{
+		return false;
+	}
+
+	StringAuto fullFilename(m_alloc);
+	fullFilename.sprintf("%s%s", m_outDir.cstr(), filename.cstr());
+	return fileExists(fullFilename);
+}
+
+void GltfImporter::addImportCacheEntry(CString filename, U64 inputHash)
+{
+	LockGuard<Mutex> lock(m_newImportCacheMtx);
+	m_newImportCache.pushBackSprintf("%" PRIu64 " %s", inputHash, filename.cstr());
+}
+
+U64 GltfImporter::hashExtras(const cgltf_extras& extras, U64 hash) const
+{
+	if(extras.end_offset > extras.start_offset)
+	{
+		hash = appendHash(m_gltf->json + extras.start_offset, extras.end_offset - extras.start_offset, hash);
+	}
+
+	return hash;
+}
+
+U64 GltfImporter::computeMeshInputHash(const cgltf_mesh& mesh, U32 lod) const
+{
+	U64 hash = hashString(mesh.name, m_optionsHash);
+	hash = hashValue(lod, hash);
+
+	for(U32 i = 0; i < mesh.primitives_count; ++i)
+	{
+		const cgltf_primitive& primitive = mesh.primitives[i];
+		hash = hashValue(primitive.type, hash);
+
+		for(U32 j = 0; j < primitive.attributes_count; ++j)
+		{
+			const cgltf_attribute& attrib = primitive.attributes[j];
+			hash = hashValue(attrib.type, hash);
+			hash = hashValue(attrib.index, hash);
+			hash = hashAccessor(attrib.data, hash);
+		}
+
+		hash = hashAccessor(primitive.indices, hash);
+	}
+
+	return hash;
+}
+
+U64 GltfImporter::computeMaterialInputHash(const cgltf_material& mtl, RayTypeBit usedRayTypes) const
+{
+	U64 hash = hashString(mtl.name, m_optionsHash);
+	hash = hashValue(usedRayTypes, hash);
+	hash = hashExtras(mtl.extras, hash);
+
+	const cgltf_pbr_metallic_roughness& pbr = mtl.pbr_metallic_roughness;
+	hash = hashValue(mtl.has_pbr_metallic_roughness, hash);
+	hash = hashValue(pbr.base_color_factor, hash);
+	hash = hashValue(pbr.metallic_factor, hash);
+	hash = hashValue(pbr.roughness_factor, hash);
+	hash = hashValue(mtl.emissive_factor, hash);
+	hash = hashTexture(pbr.base_color_texture, hash);
+	hash = hashTexture(pbr.metallic_roughness_texture, hash);
+	hash = hashTexture(mtl.normal_texture, hash);
+	hash = hashTexture(mtl.emissive_texture, hash);
+
+	return hash;
+}
+
+U64 GltfImporter::computeModelInputHash(const cgltf_mesh& mesh) const
+{
+	U64 hash = hashString(mesh.name, m_optionsHash);
+	hash = hashExtras(mesh.extras, hash);
+	hash = hashValue(getMeshTotalVertexCount(mesh), hash); // It decides the LOD count
+
+	for(U32 i = 0; i < mesh.primitives_count; ++i)
+	{
+		hash = hashString(mesh.primitives[i].material->name, hash);
+		hash = hashExtras(mesh.primitives[i].material->extras, hash);
+	}
+
+	return hash;
+}
+
+U64 GltfImporter::computeSkeletonInputHash(const cgltf_skin& skin)
+{
+	U64 hash = hashString(skin.name, m_optionsHash);
+	hash = hashAccessor(skin.inverse_bind_matrices, hash);
+
+	for(U32 i = 0; i < skin.joints_count; ++i)
+	{
+		const cgltf_node& boneNode = *skin.joints[i];
+		const StringAuto name = getNodeName(boneNode);
+		hash = appendHash(name.cstr(), name.getLength(), hash);
+
+		if(boneNode.parent)
+		{
+			const StringAuto parentName = getNodeName(*boneNode.parent);
+			hash = appendHash(parentName.cstr(), parentName.getLength(), hash);
+		}
+
+		Vec3 tsl;
+		Mat3 rot;
+		Vec3 scale;
+		getNodeTransform(boneNode, tsl, rot, scale);
+		hash = hashValue(tsl, hash);
+		hash = hashValue(rot, hash);
+		hash = hashValue(scale, hash);
+	}
+
+	return hash;
+}
+
+U64 GltfImporter::computeAnimationInputHash(const cgltf_animation& anim)
+{
+	U64 hash = hashString(anim.name, m_optionsHash);
+
+	for(U32 i = 0; i < anim.channels_count; ++i)
+	{
+		const cgltf_animation_channel& channel = anim.channels[i];
+		const StringAuto name = getNodeName(*channel.target_node);
+		hash = appendHash(name.cstr(), name.getLength(), hash);
+		hash = hashValue(channel.target_path, hash);
+		hash = hashValue(channel.sampler->interpolation, hash);
+		hash = hashAccessor(channel.sampler->input, hash);
+		hash = hashAccessor(channel.sampler->output, hash);
+	}
+
+	return hash;
 }
 
 Error GltfImporter::getExtras(const cgltf_extras& extras, HashMapAuto<CString, StringAuto>& out)
@@ -678,25 +1144,8 @@ Error GltfImporter::visitNode(const cgltf_node& node, const Transform& parentTrf
 		{
 			// Model node
 
-			// Async because it's slow
-			struct Ctx
-			{
-				GltfImporter* m_importer;
-				const cgltf_mesh* m_mesh;
-				Array<const cgltf_material*, 128> m_materials;
-				U32 m_materialCount = 0;
-				const cgltf_skin* m_skin;
-				RayTypeBit m_rayTypes;
-			};
-			Ctx* ctx = m_alloc.newInstance<Ctx>();
-			ctx->m_importer = this;
-			ctx->m_mesh = node.mesh;
-			for(U32 i = 0; i < node.mesh->primitives_count; ++i)
-			{
-				ctx->m_materials[ctx->m_materialCount++] = node.mesh->primitives[i].material;
-			}
-			ctx->m_skin = node.skin;
-			ctx->m_rayTypes = (skipRt) ? RayTypeBit::NONE : RayTypeBit::ALL;
+			const RayTypeBit rayTypes = (skipRt) ? RayTypeBit::NONE : RayTypeBit::ALL;
+			newModelAssetTasks(*node.mesh, node.skin, rayTypes);
 
 			HashMapAuto<CString, StringAuto>::Iterator it2;
 			const Bool selfCollision = (it2 = extras.find("collision_mesh")) != extras.getEnd() && *it2 == "self";
@@ -711,57 +1160,6 @@ Error GltfImporter::visitNode(const cgltf_node& node, const Transform& parentTrf
 				maxLod = 2;
 			}
 
-			// Thread task
-			auto callback = [](void* userData, U32 threadId, ThreadHive& hive, ThreadHiveSemaphore* signalSemaphore) {
-				Ctx& self = *static_cast<Ctx*>(userData);
-
-				// LOD 0
-				Error err = self.m_importer->writeMesh(*self.m_mesh, 0, self.m_importer->computeLodFactor(0));
-
-				// LOD 1
-				if(!err && self.m_importer->m_lodCount > 1 && !self.m_importer->skipMeshLod(*self.m_mesh, 1))
-				{
-					err = self.m_importer->writeMesh(*self.m_mesh, 1, self.m_importer->computeLodFactor(1));
-				}
-
-				// LOD 2
-				if(!err && self.m_importer->m_lodCount > 2 && !self.m_importer->skipMeshLod(*self.m_mesh, 2))
-				{
-					err = self.m_importer->writeMesh(*self.m_mesh, 2, self.m_importer->computeLodFactor(2));
-				}
-
-				for(U32 i = 0; i < self.m_materialCount && !err; ++i)
-				{
-					err = self.m_importer->writeMaterial(*self.m_materials[i], self.m_rayTypes);
-				}
-
-				if(!err)
-				{
-					err = self.m_importer->writeModel(*self.m_mesh);
-				}
-
-				if(!err && self.m_skin)
-				{
-					err = self.m_importer->writeSkeleton(*self.m_skin);
-				}
-
-				if(err)
-				{
-					self.m_importer->m_errorInThread.store(err._getCode());
-				}
-
-				self.m_importer->m_alloc.deleteInstance(&self);
-			};
-
-			if(m_hive)
-			{
-				m_hive->submitTask(callback, ctx);
-			}
-			else
-			{
-				callback(ctx, 0, *m_hive, nullptr);
-			}
-
 			ANKI_CHECK(writeModelNode(node, parentExtras));
 
 			Transform localTrf;
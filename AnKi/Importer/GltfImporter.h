@@ -10,6 +10,7 @@
 #include <AnKi/Util/StringList.h>
 #include <AnKi/Util/File.h>
 #include <AnKi/Util/HashMap.h>
+#include <AnKi/Util/Thread.h>
 #include <AnKi/Resource/Common.h>
 #include <AnKi/Math.h>
 #include <Cgltf/cgltf.h>
@@ -28,10 +29,12 @@ public:
 	CString m_rpath;
 	CString m_texrpath;
 	Bool m_optimizeMeshes = true;
+	Bool m_generateMeshlets = true; ///< Split the submeshes into meshlets for cluster culling.
 	F32 m_lodFactor = 1.0f;
 	U32 m_lodCount = 1;
 	F32 m_lightIntensityScale = 1.0f;
 	U32 m_threadCount = MAX_U32;
+	Bool m_incremental = true; ///< Skip the outputs whose inputs didn't change since the previous import.
 	CString m_comment;
 };
 
@@ -57,8 +60,29 @@ private:
 		}
 	};
 
+	/// An output file of the import. All of them run as tasks in the ThreadHive.
+	class AssetTask
+	{
+	public:
+		enum class Type : U8
+		{
+			MESH,
+			MATERIAL,
+			MODEL,
+			SKELETON,
+			ANIMATION
+		};
+
+		GltfImporter* m_importer;
+		const void* m_asset; ///< cgltf_mesh, cgltf_material, cgltf_skin or cgltf_animation.
+		U32 m_lod;
+		Type m_type;
+		RayTypeBit m_rayTypes;
+	};
+
 	// Data
 	static const char* XML_HEADER;
+	static const char* IMPORT_CACHE_FILENAME;
 
 	GenericMemoryPoolAllocator<U8> m_alloc;
 
@@ -79,10 +103,20 @@ private:
 
 	HashMapAuto<const void*, U32, PtrHasher> m_nodePtrToIdx{m_alloc}; ///< Need an index for the unnamed nodes.
 
+	DynamicArrayAuto<AssetTask> m_assetTasks{m_alloc};
+	HashMapAuto<U64, U32> m_assetTaskIndices{m_alloc}; ///< Write every asset once.
+
+	HashMapAuto<U64, U64> m_importCache{m_alloc}; ///< Hash of the output filename to the hash of its inputs.
+	StringListAuto m_newImportCache{m_alloc};
+	Mutex m_newImportCacheMtx;
+	U64 m_optionsHash = 0; ///< Hash of the options that affect all the outputs.
+
 	F32 m_lodFactor = 1.0f;
 	U32 m_lodCount = 1;
 	F32 m_lightIntensityScale = 1.0f;
 	Bool m_optimizeMeshes = false;
+	Bool m_generateMeshlets = false;
+	Bool m_incremental = false;
 	StringAuto m_comment{m_alloc};
 
 	/// Don't generate LODs for meshes with less vertices than this number.
@@ -135,6 +169,26 @@ private:
 	StringAuto computeAnimationResourceFilename(const cgltf_animation& anim) const;
 	StringAuto computeSkeletonResourceFilename(const cgltf_skin& skin) const;
 
+	// Task graph
+	/// The same cgltf object might be used by more than one task (eg the LODs of a mesh and its model).
+	static U64 computeAssetTaskKey(AssetTask::Type type, const void* asset, U32 lod);
+	void newModelAssetTasks(const cgltf_mesh& mesh, const cgltf_skin* skin, RayTypeBit rayTypes);
+	void newAssetTask(AssetTask::Type type, const void* asset, U32 lod = 0, RayTypeBit rayTypes = RayTypeBit::NONE);
+	ANKI_USE_RESULT Error runAssetTasks();
+	ANKI_USE_RESULT Error runAssetTask(const AssetTask& task);
+
+	// Incremental import
+	ANKI_USE_RESULT Error loadImportCache();
+	ANKI_USE_RESULT Error storeImportCache();
+	Bool isUpToDate(CString filename, U64 inputHash) const;
+	void addImportCacheEntry(CString filename, U64 inputHash);
+	U64 hashExtras(const cgltf_extras& extras, U64 hash) const;
+	U64 computeMeshInputHash(const cgltf_mesh& mesh, U32 lod) const;
+	U64 computeMaterialInputHash(const cgltf_material& mtl, RayTypeBit usedRayTypes) const;
+	U64 computeModelInputHash(const cgltf_mesh& mesh) const;
+	U64 computeSkeletonInputHash(const cgltf_skin& skin);
+	U64 computeAnimationInputHash(const cgltf_animation& anim);
+
 	// Resources
 	ANKI_USE_RESULT Error writeMesh(const cgltf_mesh& mesh, U32 lod, F32 decimateFactor);
 	ANKI_USE_RESULT Error writeMaterial(const cgltf_material& mtl, RayTypeBit usedRayTypes);
@@ -258,6 +258,52 @@ static void decimateSubmesh(F32 factor, SubMesh& submesh, GenericMemoryPoolAlloc
 	submesh.m_verts = std::move(newVerts);
 }
 
+/// Split a submesh into meshlets using meshoptimizer and compute their bounding volumes.
+/// @param firstVertex The offset of the submesh's vertices in the vertex buffers.
+static void buildSubmeshMeshlets(const SubMesh& submesh, U32 firstVertex, GenericMemoryPoolAllocator<U8> alloc,
+								 DynamicArrayAuto<MeshBinaryMeshlet>& meshlets,
+								 DynamicArrayAuto<U16>& meshletVertexIndices,
+								 DynamicArrayAuto<U8Vec4>& meshletPrimitives)
+{
+	const PtrSize maxMeshletCount =
+		meshopt_buildMeshletsBound(submesh.m_indices.getSize(), MESH_BINARY_MAX_MESHLET_VERTEX_COUNT,
+								   MESH_BINARY_MAX_MESHLET_PRIMITIVE_COUNT);
+	DynamicArrayAuto<meshopt_Meshlet> moMeshlets(alloc);
+	moMeshlets.create(U32(maxMeshletCount));
+	const U32 meshletCount = U32(meshopt_buildMeshlets(
+		&moMeshlets[0], &submesh.m_indices[0], submesh.m_indices.getSize(), submesh.m_verts.getSize(),
+		MESH_BINARY_MAX_MESHLET_VERTEX_COUNT, MESH_BINARY_MAX_MESHLET_PRIMITIVE_COUNT));
+
+	for(U32 i = 0; i < meshletCount; ++i)
+	{
+		const meshopt_Meshlet& in = moMeshlets[i];
+		const meshopt_Bounds bounds = meshopt_computeMeshletBounds(
+			&in, &submesh.m_verts[0].m_position[0], submesh.m_verts.getSize(), sizeof(TempVertex));
+
+		MeshBinaryMeshlet& out = *meshlets.emplaceBack();
+		out.m_firstVertex = meshletVertexIndices.getSize();
+		out.m_vertexCount = in.vertex_count;
+		out.m_firstPrimitive = meshletPrimitives.getSize();
+		out.m_primitiveCount = in.triangle_count;
+		out.m_sphereCenter = Vec3(bounds.center[0], bounds.center[1], bounds.center[2]);
+		out.m_sphereRadius = bounds.radius;
+		out.m_coneApex = Vec3(bounds.cone_apex[0], bounds.cone_apex[1], bounds.cone_apex[2]);
+		out.m_coneCutoff = bounds.cone_cutoff;
+		out.m_coneAxis = Vec3(bounds.cone_axis[0], bounds.cone_axis[1], bounds.cone_axis[2]);
+
+		for(U32 v = 0; v < in.vertex_count; ++v)
+		{
+			// The range was checked when the index buffer was written
+			meshletVertexIndices.emplaceBack(U16(in.vertices[v] + firstVertex));
+		}
+
+		for(U32 t = 0; t < in.triangle_count; ++t)
+		{
+			meshletPrimitives.emplaceBack(in.indices[t][0], in.indices[t][1], in.indices[t][2], U8(0));
+		}
+	}
+}
+
 U32 GltfImporter::getMeshTotalVertexCount(const cgltf_mesh& mesh)
 {
 	U32 totalVertexCount = 0;
@@ -621,6 +667,25 @@ Error GltfImporter::writeMesh(const cgltf_mesh& mesh, U32 lod, F32 decimateFacto
 		}
 	}
 
+	// Build the meshlets
+	DynamicArrayAuto<MeshBinarySubMeshMeshlets> subMeshMeshlets(m_alloc);
+	DynamicArrayAuto<MeshBinaryMeshlet> meshlets(m_alloc);
+	DynamicArrayAuto<U16> meshletVertexIndices(m_alloc);
+	DynamicArrayAuto<U8Vec4> meshletPrimitives(m_alloc);
+	if(m_generateMeshlets && totalVertexCount <= MAX_U16 + 1)
+	{
+		U32 firstVertex = 0;
+		for(const SubMesh& submesh : submeshes)
+		{
+			MeshBinarySubMeshMeshlets& range = *subMeshMeshlets.emplaceBack();
+			range.m_firstMeshlet = meshlets.getSize();
+			buildSubmeshMeshlets(submesh, firstVertex, m_alloc, meshlets, meshletVertexIndices, meshletPrimitives);
+			range.m_meshletCount = meshlets.getSize() - range.m_firstMeshlet;
+
+			firstVertex += submesh.m_verts.getSize();
+		}
+	}
+
 	// Chose the formats of the attributes
 	MeshBinaryHeader header;
 	memset(&header, 0, sizeof(header));
@@ -696,6 +761,10 @@ Error GltfImporter::writeMesh(const cgltf_mesh& mesh, U32 lod, F32 decimateFacto
 		{
 			header.m_flags |= MeshBinaryFlag::CONVEX;
 		}
+		if(meshlets.getSize() > 0)
+		{
+			header.m_flags |= MeshBinaryFlag::MESHLETS;
+		}
 		header.m_indexType = IndexType::U16;
 		header.m_totalIndexCount = totalIndexCount;
 		header.m_totalVertexCount = totalVertexCount;
@@ -816,6 +885,29 @@ Error GltfImporter::writeMesh(const cgltf_mesh& mesh, U32 lod, F32 decimateFacto
 		ANKI_CHECK(alignBufferInFile(header.m_totalVertexCount * sizeof(BoneInfoVertex), file));
 	}
 
+	// Write the meshlets
+	if(meshlets.getSize() > 0)
+	{
+		MeshBinaryMeshletsHeader meshletsHeader;
+		memset(&meshletsHeader, 0, sizeof(meshletsHeader));
+		meshletsHeader.m_meshletCount = meshlets.getSize();
+		meshletsHeader.m_meshletVertexCount = meshletVertexIndices.getSize();
+		meshletsHeader.m_meshletPrimitiveCount = meshletPrimitives.getSize();
+
+		ANKI_CHECK(file.write(&meshletsHeader, sizeof(meshletsHeader)));
+		ANKI_CHECK(file.write(&subMeshMeshlets[0], subMeshMeshlets.getSizeInBytes()));
+		ANKI_CHECK(alignBufferInFile(sizeof(meshletsHeader) + subMeshMeshlets.getSizeInBytes(), file));
+
+		ANKI_CHECK(file.write(&meshlets[0], meshlets.getSizeInBytes()));
+		ANKI_CHECK(alignBufferInFile(meshlets.getSizeInBytes(), file));
+
+		ANKI_CHECK(file.write(&meshletVertexIndices[0], meshletVertexIndices.getSizeInBytes()));
+		ANKI_CHECK(alignBufferInFile(meshletVertexIndices.getSizeInBytes(), file));
+
+		ANKI_CHECK(file.write(&meshletPrimitives[0], meshletPrimitives.getSizeInBytes()));
+		ANKI_CHECK(alignBufferInFile(meshletPrimitives.getSizeInBytes(), file));
+	}
+
 	return Error::NONE;
 }
 
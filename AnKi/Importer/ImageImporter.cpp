@@ -10,6 +10,8 @@
 #include <AnKi/Util/Process.h>
 #include <AnKi/Util/File.h>
 #include <AnKi/Util/Filesystem.h>
+#include <AnKi/Util/ThreadHive.h>
+#include <AnKi/Util/System.h>
 
 namespace anki {
 
@@ -540,53 +542,6 @@ static ANKI_USE_RESULT Error loadFirstMipmap(const ImageImporterConfig& config,
 	return Error::NONE;
 }
 
-template<typename TStorageVec>
-static void generateSurfaceMipmap(ConstWeakArray<U8, PtrSize> inBuffer, U32 inWidth, U32 inHeight,
-								  WeakArray<U8, PtrSize> outBuffer)
-{
-	constexpr U32 channelCount = TStorageVec::getSize();
-	using FVecType = typename std::conditional_t<channelCount == 3, Vec3, Vec4>;
-
-	const ConstWeakArray<TStorageVec, PtrSize> inPixels(reinterpret_cast<const TStorageVec*>(&inBuffer[0]),
-														inBuffer.getSizeInBytes() / sizeof(TStorageVec));
-	WeakArray<TStorageVec, PtrSize> outPixels(reinterpret_cast<TStorageVec*>(&outBuffer[0]),
-											  outBuffer.getSizeInBytes() / sizeof(TStorageVec));
-
-	const U32 outWidth = inWidth >> 1;
-	const U32 outHeight = inHeight >> 1;
-
-	for(U32 h = 0; h < outHeight; ++h)
-	{
-		for(U32 w = 0; w < outWidth; ++w)
-		{
-			// Gather input
-			FVecType average(0.0f);
-			for(U32 y = 0; y < 2; ++y)
-			{
-				for(U32 x = 0; x < 2; ++x)
-				{
-					const U32 idx = (h * 2 + y) * inWidth + (w * 2 + x);
-					const TStorageVec inPixel = inPixels[idx];
-					for(U32 c = 0; c < channelCount; ++c)
-					{
-						average[c] += F32(inPixel[c]) * 0.25f;
-					}
-				}
-			}
-
-			TStorageVec uaverage;
-			for(U32 c = 0; c < channelCount; ++c)
-			{
-				uaverage[c] = typename TStorageVec::Scalar(average[c]);
-			}
-
-			// Store
-			const U32 idx = h * outWidth + w;
-			outPixels[idx] = uaverage;
-		}
-	}
-}
-
 static ANKI_USE_RESULT Error compressS3tc(GenericMemoryPoolAllocator<U8> alloc, CString tempDirectory,
 										  CString compressonatorPath, ConstWeakArray<U8, PtrSize> inPixels, U32 inWidth,
 										  U32 inHeight, U32 channelCount, Bool hdr, WeakArray<U8, PtrSize> outPixels)
@@ -701,6 +656,90 @@ static ANKI_USE_RESULT Error compressS3tc(GenericMemoryPoolAllocator<U8> alloc,
 	return Error::NONE;
 }
 
+/// Compress all the surfaces of all mips with the built-in BC encoder. The surfaces are split in batches of block rows
+/// that run in parallel.
+static void compressS3tcBuiltin(const ImageImporterConfig& config, ImageImporterContext& ctx, U32 mipCount)
+{
+	class Job
+	{
+	public:
+		BcEncoder m_encoder;
+		ConstWeakArray<U8, PtrSize> m_inPixels;
+		WeakArray<U8, PtrSize> m_outPixels;
+		U32 m_firstBlockRow;
+		U32 m_blockRowCount;
+
+		Job(const BcEncoder& encoder, ConstWeakArray<U8, PtrSize> inPixels, WeakArray<U8, PtrSize> outPixels,
+			U32 firstBlockRow, U32 blockRowCount)
+			: m_encoder(encoder)
+			, m_inPixels(inPixels)
+			, m_outPixels(outPixels)
+			, m_firstBlockRow(firstBlockRow)
+			, m_blockRowCount(blockRowCount)
+		{
+		}
+	};
+
+	const BcFormat format = (ctx.m_hdr) ? BcFormat::BC6H : ((ctx.m_channelCount == 3) ? BcFormat::BC1 : BcFormat::BC3);
+	constexpr U32 BLOCKS_PER_JOB = 1024;
+
+	DynamicArrayAuto<Job> jobs(ctx.getAllocator());
+	for(U32 mip = 0; mip < mipCount; ++mip)
+	{
+		for(U32 l = 0; l < ctx.m_layerCount; ++l)
+		{
+			for(U32 f = 0; f < ctx.m_faceCount; ++f)
+			{
+				const U32 idx = l * ctx.m_faceCount + f;
+				SurfaceOrVolumeData& surface = ctx.m_mipmaps[mip].m_surfacesOrVolume[idx];
+
+				const U32 width = ctx.m_width >> mip;
+				const U32 height = ctx.m_height >> mip;
+				const BcEncoder encoder(format, config.m_s3tcQuality, width, height, ctx.m_channelCount);
+
+				surface.m_s3tcPixels.create(encoder.getCompressedSize());
+
+				const U32 blockRowsPerJob = max(1u, BLOCKS_PER_JOB / (width / 4));
+				for(U32 row = 0; row < encoder.getBlockRowCount(); row += blockRowsPerJob)
+				{
+					jobs.emplaceBack(encoder, ConstWeakArray<U8, PtrSize>(surface.m_pixels),
+									 WeakArray<U8, PtrSize>(surface.m_s3tcPixels), row,
+									 min(blockRowsPerJob, encoder.getBlockRowCount() - row));
+				}
+			}
+		}
+	}
+
+	auto callback = [](void* userData, U32 threadId, ThreadHive& hive, ThreadHiveSemaphore* signalSemaphore) {
+		const Job& job = *static_cast<const Job*>(userData);
+		job.m_encoder.encode(job.m_inPixels, job.m_firstBlockRow, job.m_blockRowCount, job.m_outPixels);
+	};
+
+	const U32 threadCount = min(getCpuCoresCount(), config.m_threadCount);
+	if(threadCount > 1 && jobs.getSize() > 1)
+	{
+		ThreadHive hive(threadCount, ctx.getAllocator(), true);
+
+		DynamicArrayAuto<ThreadHiveTask> tasks(ctx.getAllocator());
+		tasks.create(jobs.getSize());
+		for(U32 i = 0; i < jobs.getSize(); ++i)
+		{
+			tasks[i].m_callback = callback;
+			tasks[i].m_argument = &jobs[i];
+		}
+
+		hive.submitTasks(&tasks[0], tasks.getSize());
+		hive.waitAllTasks();
+	}
+	else
+	{
+		for(Job& job : jobs)
+		{
+			job.m_encoder.encode(job.m_inPixels, job.m_firstBlockRow, job.m_blockRowCount, job.m_outPixels);
+		}
+	}
+}
+
 static ANKI_USE_RESULT Error compressAstc(GenericMemoryPoolAllocator<U8> alloc, CString tempDirectory,
 										  CString astcencPath, ConstWeakArray<U8, PtrSize> inPixels, U32 inWidth,
 										  U32 inHeight, U32 inChannelCount, UVec2 blockSize, Bool hdr,
@@ -1025,48 +1064,9 @@ static ANKI_USE_RESULT Error importImageInternal(const ImageImporterConfig& conf
 		if(config.m_type != ImageBinaryType::_3D)
 		{
 			ctx.m_mipmaps[mip].m_surfacesOrVolume.create(ctx.m_faceCount * ctx.m_layerCount, alloc);
-			for(U32 l = 0; l < ctx.m_layerCount; ++l)
+			for(SurfaceOrVolumeData& outSurface : ctx.m_mipmaps[mip].m_surfacesOrVolume)
 			{
-				for(U32 f = 0; f < ctx.m_faceCount; ++f)
-				{
-					const U32 idx = l * ctx.m_faceCount + f;
-					const SurfaceOrVolumeData& inSurface = ctx.m_mipmaps[mip - 1].m_surfacesOrVolume[idx];
-					SurfaceOrVolumeData& outSurface = ctx.m_mipmaps[mip].m_surfacesOrVolume[idx];
-					outSurface.m_pixels.create((ctx.m_width >> mip) * (ctx.m_height >> mip) * ctx.m_pixelSize);
-
-					if(ctx.m_channelCount == 3)
-					{
-						if(ctx.m_hdr)
-						{
-							generateSurfaceMipmap<Vec3>(ConstWeakArray<U8, PtrSize>(inSurface.m_pixels),
-														ctx.m_width >> (mip - 1), ctx.m_height >> (mip - 1),
-														WeakArray<U8, PtrSize>(outSurface.m_pixels));
-						}
-						else
-						{
-							generateSurfaceMipmap<U8Vec3>(ConstWeakArray<U8, PtrSize>(inSurface.m_pixels),
-														  ctx.m_width >> (mip - 1), ctx.m_height >> (mip - 1),
-														  WeakArray<U8, PtrSize>(outSurface.m_pixels));
-						}
-					}
-					else
-					{
-						ANKI_ASSERT(ctx.m_channelCount == 4);
-
-						if(ctx.m_hdr)
-						{
-							generateSurfaceMipmap<Vec4>(ConstWeakArray<U8, PtrSize>(inSurface.m_pixels),
-														ctx.m_width >> (mip - 1), ctx.m_height >> (mip - 1),
-														WeakArray<U8, PtrSize>(outSurface.m_pixels));
-						}
-						else
-						{
-							generateSurfaceMipmap<U8Vec4>(ConstWeakArray<U8, PtrSize>(inSurface.m_pixels),
-														  ctx.m_width >> (mip - 1), ctx.m_height >> (mip - 1),
-														  WeakArray<U8, PtrSize>(outSurface.m_pixels));
-						}
-					}
-				}
+				outSurface.m_pixels.create((ctx.m_width >> mip) * (ctx.m_height >> mip) * ctx.m_pixelSize);
 			}
 		}
 		else
@@ -1075,10 +1075,53 @@ static ANKI_USE_RESULT Error importImageInternal(const ImageImporterConfig& conf
 		}
 	}
 
+	if(mipCount > 1 && config.m_type != ImageBinaryType::_3D)
+	{
+		MipmapGeneratorFlag flags = MipmapGeneratorFlag::NONE;
+		if(config.m_sRgbMipmaps && !ctx.m_hdr)
+		{
+			flags |= MipmapGeneratorFlag::SRGB;
+		}
+		if(config.m_normalMap)
+		{
+			flags |= MipmapGeneratorFlag::NORMAL_MAP;
+		}
+
+		MipmapGenerator generator(alloc, config.m_mipmapFilter, ctx.m_channelCount, ctx.m_hdr, flags);
+
+		DynamicArrayAuto<WeakArray<U8, PtrSize>> mips(alloc);
+		mips.create(mipCount);
+		for(U32 idx = 0; idx < ctx.m_faceCount * ctx.m_layerCount; ++idx)
+		{
+			for(U32 mip = 0; mip < mipCount; ++mip)
+			{
+				mips[mip] = WeakArray<U8, PtrSize>(ctx.m_mipmaps[mip].m_surfacesOrVolume[idx].m_pixels);
+			}
+
+			generator.addSurface(ConstWeakArray<WeakArray<U8, PtrSize>>(mips), ctx.m_width, ctx.m_height);
+		}
+
+		const U32 threadCount = min(getCpuCoresCount(), config.m_threadCount);
+		if(threadCount > 1)
+		{
+			ThreadHive hive(threadCount, alloc, true);
+			generator.generate(&hive);
+		}
+		else
+		{
+			generator.generate(nullptr);
+		}
+	}
+
 	// Compress
-	if(!!(config.m_compressions & ImageBinaryDataCompression::S3TC))
+	if(!!(config.m_compressions & ImageBinaryDataCompression::S3TC) && !config.m_useCompressonator)
+	{
+		ANKI_IMPORTER_LOGV("Will compress in S3TC using the built-in encoder");
+		compressS3tcBuiltin(config, ctx, mipCount);
+	}
+	else if(!!(config.m_compressions & ImageBinaryDataCompression::S3TC))
 	{
-		ANKI_IMPORTER_LOGV("Will compress in S3TC");
+		ANKI_IMPORTER_LOGV("Will compress in S3TC using compressonator");
 
 		for(U32 mip = 0; mip < mipCount; ++mip)
 		{
@@ -4,6 +4,8 @@
 // http://www.anki3d.org/LICENSE
 
 #include <AnKi/Importer/Common.h>
+#include <AnKi/Importer/BcEncoder.h>
+#include <AnKi/Importer/MipmapGenerator.h>
 #include <AnKi/Util/String.h>
 #include <AnKi/Util/WeakArray.h>
 #include <AnKi/Resource/ImageBinary.h>
@@ -28,11 +30,17 @@ public:
 	Bool m_noAlpha = true;
 	CString m_tempDirectory;
 	CString m_compressonatorPath; ///< Optional.
+	Bool m_useCompressonator = false; ///< Use compressonatorcli for S3TC instead of the built-in encoder.
+	BcEncoderQuality m_s3tcQuality = BcEncoderQuality::NORMAL; ///< Quality of the built-in S3TC encoder.
+	U32 m_threadCount = MAX_U32; ///< The max number of threads for mip generation and the built-in encoder.
 	CString m_astcencPath; ///< Optional.
 	UVec2 m_astcBlockSize = UVec2(8u);
 	Bool m_sRgbToLinear = false;
 	Bool m_linearToSRgb = false;
 	Bool m_flipImage = true;
+	MipmapFilter m_mipmapFilter = MipmapFilter::BOX;
+	Bool m_sRgbMipmaps = false; ///< The pixels are sRGB. Generate the mips in linear space.
+	Bool m_normalMap = false; ///< The image is a normal map. Renormalize the mips.
 };
 
 /// Converts images to AnKi's specific format.
@@ -0,0 +1,391 @@
+// Copyright (C) 2009-2022, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Importer/MipmapGenerator.h>
+#include <AnKi/Util/ThreadHive.h>
+
+namespace anki {
+
+/// Some rows of a mip of a surface. That's the unit of work.
+class MipmapGenerator::Tile
+{
+public:
+	const MipmapGenerator* m_generator;
+	U32 m_surface;
+	U32 m_mip;
+	U32 m_firstRow;
+	U32 m_rowCount;
+	U32 m_tileCountOfMip; ///< The number of tiles of the same mip of the same surface.
+};
+
+/// The target number of output pixels of a tile.
+constexpr U32 PIXELS_PER_TILE = 64 * 1024;
+
+static F32 sinc(F32 x)
+{
+	if(absolute(x) < 1.0e-5f)
+	{
+		return 1.0f;
+	}
+
+	const F32 px = PI * x;
+	return sin(px) / px;
+}
+
+/// Modified Bessel function of the first kind of order zero.
+static F32 bessel0(F32 x)
+{
+	F32 sum = 1.0f;
+	F32 term = 1.0f;
+	const F32 halfXSquared = x * x * 0.25f;
+	for(U32 k = 1; k < 32; ++k)
+	{
+		term *= halfXSquared / F32(k * k);
+		sum += term;
+		if(term < sum * 1.0e-7f)
+		{
+			break;
+		}
+	}
+	return sum;
+}
+
+static F32 sRgbToLinear(F32 c)
+{
+	return (c <= 0.04045f) ? c / 12.92f : pow((c + 0.055f) / 1.055f, 2.4f);
+}
+
+static F32 linearToSRgb(F32 c)
+{
+	return (c <= 0.0031308f) ? c * 12.92f : 1.055f * pow(c, 1.0f / 2.4f) - 0.055f;
+}
+
+MipmapGenerator::MipmapGenerator(GenericMemoryPoolAllocator<U8> alloc, MipmapFilter filter, U32 channelCount, Bool hdr,
+								 MipmapGeneratorFlag flags)
+	: m_alloc(alloc)
+	, m_surfaces(alloc)
+	, m_mips(alloc)
+	, m_weights(alloc)
+	, m_channelCount(channelCount)
+	, m_hdr(hdr)
+	, m_flags(flags)
+{
+	ANKI_ASSERT(channelCount == 3 || channelCount == 4);
+	ANKI_ASSERT(!(!!(flags & MipmapGeneratorFlag::SRGB) && (hdr || !!(flags & MipmapGeneratorFlag::NORMAL_MAP))));
+
+	// Compute the weights of the filter. The filter is defined in the space of the output pixels so for a 2x reduction
+	// the taps are at -R+0.5, ..., R-0.5 source pixels from the center of the output pixel
+	const F32 support = (filter == MipmapFilter::BOX) ? 0.5f : 3.0f;
+	const U32 radius = U32(support * 2.0f);
+	m_weights.create(radius * 2);
+	F32 weightSum = 0.0f;
+	for(U32 k = 0; k < radius * 2; ++k)
+	{
+		const F32 t = (F32(k) - F32(radius) + 0.5f) / 2.0f;
+		F32 w;
+		switch(filter)
+		{
+		case MipmapFilter::BOX:
+			w = 1.0f;
+			break;
+		case MipmapFilter::KAISER:
+		{
+			constexpr F32 alpha = 4.0f;
+			const F32 x = t / support;
+			w = sinc(t) * bessel0(alpha * sqrt(max(0.0f, 1.0f - x * x))) / bessel0(alpha);
+			break;
+		}
+		case MipmapFilter::LANCZOS:
+			w = sinc(t) * sinc(t / support);
+			break;
+		default:
+			ANKI_ASSERT(0);
+			w = 1.0f;
+		}
+
+		m_weights[k] = w;
+		weightSum += w;
+	}
+
+	for(F32& w : m_weights)
+	{
+		w /= weightSum;
+	}
+
+	// Tables
+	for(U32 c = 0; c < 4; ++c)
+	{
+		for(U32 i = 0; i < 256; ++i)
+		{
+			const F32 f = F32(i) / 255.0f;
+			if(c < 3 && !!(m_flags & MipmapGeneratorFlag::SRGB))
+			{
+				m_decodeTable[c][i] = sRgbToLinear(f);
+			}
+			else if(c < 3 && !!(m_flags & MipmapGeneratorFlag::NORMAL_MAP))
+			{
+				m_decodeTable[c][i] = f * 2.0f - 1.0f;
+			}
+			else
+			{
+				m_decodeTable[c][i] = f;
+			}
+		}
+	}
+
+	for(U32 i = 0; i < m_linearToSRgbTable.getSize(); ++i)
+	{
+		const F32 f = linearToSRgb(F32(i) / F32(m_linearToSRgbTable.getSize() - 1));
+		m_linearToSRgbTable[i] = U8(clamp(f, 0.0f, 1.0f) * 255.0f + 0.5f);
+	}
+}
+
+void MipmapGenerator::addSurface(ConstWeakArray<WeakArray<U8, PtrSize>> mips, U32 width, U32 height)
+{
+	ANKI_ASSERT(mips.getSize() > 0);
+	ANKI_ASSERT(isPowerOfTwo(width) && isPowerOfTwo(height));
+	ANKI_ASSERT((width >> (mips.getSize() - 1)) > 0 && (height >> (mips.getSize() - 1)) > 0);
+
+	Surface& surface = *m_surfaces.emplaceBack();
+	surface.m_firstMip = m_mips.getSize();
+	surface.m_mipCount = mips.getSize();
+	surface.m_width = width;
+	surface.m_height = height;
+
+	const PtrSize pixelSize = m_channelCount * ((m_hdr) ? sizeof(F32) : sizeof(U8));
+	for(U32 mip = 0; mip < mips.getSize(); ++mip)
+	{
+		ANKI_ASSERT(mips[mip].getSizeInBytes() == PtrSize(width >> mip) * (height >> mip) * pixelSize);
+		(void)pixelSize;
+		m_mips.emplaceBack(mips[mip]);
+	}
+}
+
+void MipmapGenerator::decodeRow(ConstWeakArray<U8, PtrSize> pixels, U32 width, U32 row, Vec4* out) const
+{
+	if(m_hdr)
+	{
+		const F32* in = reinterpret_cast<const F32*>(&pixels[0]) + PtrSize(row) * width * m_channelCount;
+		for(U32 x = 0; x < width; ++x, in += m_channelCount)
+		{
+			out[x] = Vec4(in[0], in[1], in[2], (m_channelCount == 4) ? in[3] : 0.0f);
+		}
+	}
+	else
+	{
+		const U8* in = &pixels[PtrSize(row) * width * m_channelCount];
+		for(U32 x = 0; x < width; ++x, in += m_channelCount)
+		{
+			out[x] = Vec4(m_decodeTable[0][in[0]], m_decodeTable[1][in[1]], m_decodeTable[2][in[2]],
+						  (m_channelCount == 4) ? m_decodeTable[3][in[3]] : 0.0f);
+		}
+	}
+}
+
+void MipmapGenerator::encodeRow(const Vec4* in, U32 width, U32 row, WeakArray<U8, PtrSize> pixels) const
+{
+	const Bool normalMap = !!(m_flags & MipmapGeneratorFlag::NORMAL_MAP);
+
+	if(m_hdr)
+	{
+		F32* out = reinterpret_cast<F32*>(&pixels[0]) + PtrSize(row) * width * m_channelCount;
+		for(U32 x = 0; x < width; ++x, out += m_channelCount)
+		{
+			Vec4 v = in[x];
+			if(normalMap)
+			{
+				const F32 len = v.xyz().getLength();
+				v = Vec4((len > EPSILON) ? v.xyz() / len : Vec3(0.0f, 0.0f, 1.0f), v.w());
+			}
+			else
+			{
+				// Remove the negative lobes of the filter
+				v = v.max(Vec4(0.0f));
+			}
+
+			for(U32 c = 0; c < m_channelCount; ++c)
+			{
+				out[c] = v[c];
+			}
+		}
+	}
+	else
+	{
+		const Bool srgb = !!(m_flags & MipmapGeneratorFlag::SRGB);
+		const F32 srgbTableScale = F32(m_linearToSRgbTable.getSize() - 1);
+		U8* out = &pixels[PtrSize(row) * width * m_channelCount];
+		for(U32 x = 0; x < width; ++x, out += m_channelCount)
+		{
+			Vec4 v = in[x];
+			if(normalMap)
+			{
+				const F32 len = v.xyz().getLength();
+				const Vec3 n = (len > EPSILON) ? v.xyz() / len : Vec3(0.0f, 0.0f, 1.0f);
+				v = Vec4(n * 0.5f + 0.5f, v.w());
+			}
+
+			v = v.max(Vec4(0.0f)).min(Vec4(1.0f));
+
+			for(U32 c = 0; c < m_channelCount; ++c)
+			{
+				out[c] = (srgb && c < 3) ? m_linearToSRgbTable[U32(v[c] * srgbTableScale + 0.5f)]
+										 : U8(v[c] * 255.0f + 0.5f);
+			}
+		}
+	}
+}
+
+void MipmapGenerator::downsample(U32 surfaceIdx, U32 mip, U32 firstRow, U32 rowCount) const
+{
+	ANKI_ASSERT(mip > 0);
+	const Surface& surface = m_surfaces[surfaceIdx];
+	const ConstWeakArray<U8, PtrSize> src = m_mips[surface.m_firstMip + mip - 1];
+	const WeakArray<U8, PtrSize> dst = m_mips[surface.m_firstMip + mip];
+	const U32 srcWidth = surface.m_width >> (mip - 1);
+	const U32 srcHeight = surface.m_height >> (mip - 1);
+	const U32 dstWidth = srcWidth >> 1;
+	ANKI_ASSERT(firstRow + rowCount <= (srcHeight >> 1));
+
+	const U32 tapCount = m_weights.getSize();
+	const I32 radius = I32(tapCount / 2);
+
+	// Decode the source rows that the tile needs and filter them horizontally
+	const I32 firstSrcRow = I32(firstRow * 2) + 1 - radius;
+	const U32 srcRowCount = rowCount * 2 - 2 + tapCount;
+
+	DynamicArrayAuto<Vec4> paddedRow(m_alloc);
+	paddedRow.create(srcWidth + tapCount);
+	DynamicArrayAuto<Vec4> horizontal(m_alloc);
+	horizontal.create(srcRowCount * dstWidth);
+
+	for(U32 r = 0; r < srcRowCount; ++r)
+	{
+		const U32 srcRow = U32(clamp(firstSrcRow + I32(r), 0, I32(srcHeight) - 1));
+		decodeRow(src, srcWidth, srcRow, &paddedRow[radius]);
+
+		// Clamp to edge
+		for(I32 i = 0; i < radius; ++i)
+		{
+			paddedRow[i] = paddedRow[radius];
+			paddedRow[radius + srcWidth + i] = paddedRow[radius + srcWidth - 1];
+		}
+
+		// The taps of output pixel x start from source pixel 2x+1-R which is 2x+1 in the padded row
+		Vec4* out = &horizontal[r * dstWidth];
+		for(U32 x = 0; x < dstWidth; ++x)
+		{
+			const Vec4* taps = &paddedRow[x * 2 + 1];
+			Vec4 sum = taps[0] * m_weights[0];
+			for(U32 k = 1; k < tapCount; ++k)
+			{
+				sum += taps[k] * m_weights[k];
+			}
+			out[x] = sum;
+		}
+	}
+
+	// Filter vertically one row at a time and encode
+	DynamicArrayAuto<Vec4> outRow(m_alloc);
+	outRow.create(dstWidth);
+	for(U32 y = 0; y < rowCount; ++y)
+	{
+		const Vec4* taps = &horizontal[y * 2 * dstWidth];
+
+		const Vec4 w0(m_weights[0]);
+		for(U32 x = 0; x < dstWidth; ++x)
+		{
+			outRow[x] = taps[x] * w0;
+		}
+
+		for(U32 k = 1; k < tapCount; ++k)
+		{
+			const Vec4* tapRow = taps + k * dstWidth;
+			const Vec4 w(m_weights[k]);
+			for(U32 x = 0; x < dstWidth; ++x)
+			{
+				outRow[x] += tapRow[x] * w;
+			}
+		}
+
+		encodeRow(&outRow[0], dstWidth, firstRow + y, dst);
+	}
+}
+
+void MipmapGenerator::generate(ThreadHive* hive)
+{
+	// Split all the mips of all surfaces into tiles
+	DynamicArrayAuto<Tile> tiles(m_alloc);
+	for(U32 s = 0; s < m_surfaces.getSize(); ++s)
+	{
+		const Surface& surface = m_surfaces[s];
+		for(U32 mip = 1; mip < surface.m_mipCount; ++mip)
+		{
+			const U32 width = surface.m_width >> mip;
+			const U32 height = surface.m_height >> mip;
+			const U32 rowsPerTile = max(1u, PIXELS_PER_TILE / width);
+			const U32 tileCount = (height + rowsPerTile - 1) / rowsPerTile;
+
+			for(U32 row = 0; row < height; row += rowsPerTile)
+			{
+				Tile& tile = *tiles.emplaceBack();
+				tile.m_generator = this;
+				tile.m_surface = s;
+				tile.m_mip = mip;
+				tile.m_firstRow = row;
+				tile.m_rowCount = min(rowsPerTile, height - row);
+				tile.m_tileCountOfMip = tileCount;
+			}
+		}
+	}
+
+	if(tiles.getSize() == 0)
+	{
+		return;
+	}
+
+	if(hive == nullptr || hive->getThreadCount() <= 1 || tiles.getSize() == 1)
+	{
+		// The tiles are sorted so the mips will be generated in order
+		for(const Tile& tile : tiles)
+		{
+			downsample(tile.m_surface, tile.m_mip, tile.m_firstRow, tile.m_rowCount);
+		}
+		return;
+	}
+
+	// The tiles of a mip can run in parallel. A mip waits for all the tiles of the previous mip of the same surface.
+	// Different surfaces are independent
+	DynamicArrayAuto<ThreadHiveTask> tasks(m_alloc);
+	tasks.create(tiles.getSize());
+	ThreadHiveSemaphore* waitSemaphore = nullptr;
+	ThreadHiveSemaphore* signalSemaphore = nullptr;
+	for(U32 i = 0; i < tiles.getSize(); ++i)
+	{
+		const Tile& tile = tiles[i];
+		const Bool firstTileOfMip =
+			i == 0 || tiles[i - 1].m_mip != tile.m_mip || tiles[i - 1].m_surface != tile.m_surface;
+		if(firstTileOfMip)
+		{
+			waitSemaphore = (tile.m_mip == 1) ? nullptr : signalSemaphore;
+
+			const Bool lastMip = tile.m_mip == m_surfaces[tile.m_surface].m_mipCount - 1;
+			signalSemaphore = (lastMip) ? nullptr : hive->newSemaphore(tile.m_tileCountOfMip);
+		}
+
+		ThreadHiveTask& task = tasks[i];
+		task.m_callback = [](void* userData, U32 threadId, ThreadHive& hive, ThreadHiveSemaphore* signalSemaphore) {
+			const Tile& tile = *static_cast<const Tile*>(userData);
+			tile.m_generator->downsample(tile.m_surface, tile.m_mip, tile.m_firstRow, tile.m_rowCount);
+		};
+		task.m_argument = &tiles[i];
+		task.m_waitSemaphore = waitSemaphore;
+		task.m_signalSemaphore = signalSemaphore;
+	}
+
+	hive->submitTasks(&tasks[0], tasks.getSize());
+	hive->waitAllTasks();
+}
+
+} // end namespace anki
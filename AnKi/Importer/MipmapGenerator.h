@@ -0,0 +1,103 @@
+// Copyright (C) 2009-2022, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Importer/Common.h>
+#include <AnKi/Util/DynamicArray.h>
+#include <AnKi/Util/Enum.h>
+#include <AnKi/Util/WeakArray.h>
+#include <AnKi/Math.h>
+
+namespace anki {
+
+// Forward
+class ThreadHive;
+
+/// @addtogroup importer
+/// @{
+
+/// The filter that MipmapGenerator uses to downsample.
+enum class MipmapFilter : U8
+{
+	BOX, ///< 2x2 average.
+	KAISER, ///< Kaiser windowed sinc. Sharper than box with little ringing.
+	LANCZOS, ///< Lanczos3. The sharpest but it rings on hard edges.
+
+	COUNT
+};
+
+/// Flags for MipmapGenerator.
+enum class MipmapGeneratorFlag : U8
+{
+	NONE = 0,
+	SRGB = 1 << 0, ///< The RGB of the pixels is sRGB. Filter in linear space. Only for U8 pixels.
+	NORMAL_MAP = 1 << 1, ///< The RGB of the pixels is a normal. Renormalize after filtering.
+};
+ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(MipmapGeneratorFlag)
+
+/// Generates the mip chains of 2D surfaces. The surfaces are split into tiles of rows and the filtering works on rows
+/// of Vec4 so it runs on the SIMD paths of the math library.
+class MipmapGenerator
+{
+public:
+	/// @param alloc The allocator for the temporary memory. It should be thread-safe.
+	/// @param filter The filter.
+	/// @param channelCount The channel count of the pixels. 3 or 4.
+	/// @param hdr If true the pixels are F32 else U8.
+	/// @param flags Extra flags.
+	MipmapGenerator(GenericMemoryPoolAllocator<U8> alloc, MipmapFilter filter, U32 channelCount, Bool hdr,
+					MipmapGeneratorFlag flags = MipmapGeneratorFlag::NONE);
+
+	MipmapGenerator(const MipmapGenerator&) = delete; // Non-copyable
+
+	MipmapGenerator& operator=(const MipmapGenerator&) = delete; // Non-copyable
+
+	/// Add a surface. The memory should stay valid until generate() returns.
+	/// @param mips The mips of the surface. The 1st is the input and the rest will be populated. Every mip should be
+	///             half the size of the previous.
+	/// @param width The width of the 1st mip. Should be a power of two.
+	/// @param height The height of the 1st mip. Should be a power of two.
+	void addSurface(ConstWeakArray<WeakArray<U8, PtrSize>> mips, U32 width, U32 height);
+
+	/// Generate the mips of all the surfaces.
+	/// @param hive If not nullptr the tiles of all surfaces will run in parallel in that hive. It will wait for all
+	///             the tasks of the hive.
+	void generate(ThreadHive* hive);
+
+private:
+	class Surface
+	{
+	public:
+		U32 m_firstMip;
+		U32 m_mipCount;
+		U32 m_width;
+		U32 m_height;
+	};
+
+	class Tile;
+
+	GenericMemoryPoolAllocator<U8> m_alloc;
+	DynamicArrayAuto<Surface> m_surfaces;
+	DynamicArrayAuto<WeakArray<U8, PtrSize>> m_mips;
+	DynamicArrayAuto<F32> m_weights; ///< The weights of the taps of the filter.
+	Array<Array<F32, 256>, 4> m_decodeTable; ///< U8 to linear F32 for each channel.
+	Array<U8, 4096> m_linearToSRgbTable;
+	U32 m_channelCount;
+	Bool m_hdr;
+	MipmapGeneratorFlag m_flags;
+
+	/// Downsample some rows of a mip.
+	void downsample(U32 surfaceIdx, U32 mip, U32 firstRow, U32 rowCount) const;
+
+	/// Decode a row to linear Vec4s.
+	void decodeRow(ConstWeakArray<U8, PtrSize> pixels, U32 width, U32 row, Vec4* out) const;
+
+	/// Encode a row from linear Vec4s.
+	void encodeRow(const Vec4* in, U32 width, U32 row, WeakArray<U8, PtrSize> pixels) const;
+};
+/// @}
+
+} // end namespace anki
@@ -0,0 +1,688 @@
+// Copyright (C) 2009-2022, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Math/Batch.h>
+
+#if ANKI_SIMD_AVX2
+#	include <immintrin.h>
+#endif
+
+// The NEON paths haven't been built for an ARM target yet so ARM builds use the scalar code. Define ANKI_BATCH_NEON to
+// opt in until they are.
+#if ANKI_SIMD_NEON && defined(ANKI_BATCH_NEON)
+#	define ANKI_BATCH_SIMD_NEON 1
+#else
+#	define ANKI_BATCH_SIMD_NEON 0
+#endif
+
+namespace anki {
+
+static_assert(sizeof(Quat) == sizeof(F32) * 4, "Wrong size");
+
+template<typename T>
+static const F32* getFloats(const T& x)
+{
+	return reinterpret_cast<const F32*>(&x);
+}
+
+template<typename T>
+static F32* getFloats(T& x)
+{
+	return reinterpret_cast<F32*>(&x);
+}
+
+#if ANKI_SIMD_SSE
+#	define ANKI_SPLAT(v, i) _mm_shuffle_ps((v), (v), _MM_SHUFFLE(i, i, i, i))
+
+/// Deinterleave 4 Vec3 that are stored in 3 registers to 3 registers that hold the x, y and z of all of them.
+static void deinterleaveVec3s(__m128 a, __m128 b, __m128 c, __m128& x, __m128& y, __m128& z)
+{
+	// a: x0 y0 z0 x1, b: y1 z1 x2 y2, c: z2 x3 y3 z3
+	const __m128 x2y2z2x3 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 0, 3, 2));
+	x = _mm_shuffle_ps(a, x2y2z2x3, _MM_SHUFFLE(3, 0, 3, 0));
+
+	const __m128 y0z0y1y1 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 2, 1));
+	const __m128 y2z1y3z3 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(3, 2, 1, 3));
+	y = _mm_shuffle_ps(y0z0y1y1, y2z1y3z3, _MM_SHUFFLE(2, 0, 2, 0));
+
+	const __m128 z0z0z1z1 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2));
+	const __m128 z2z2z3z3 = _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0));
+	z = _mm_shuffle_ps(z0z0z1z1, z2z2z3z3, _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+/// The opposite of deinterleaveVec3s().
+static void interleaveVec3s(__m128 x, __m128 y, __m128 z, __m128& a, __m128& b, __m128& c)
+{
+	const __m128 x0y0x1y1 = _mm_unpacklo_ps(x, y);
+	const __m128 x2y2x3y3 = _mm_unpackhi_ps(x, y);
+
+	const __m128 z0z0x1x1 = _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0));
+	a = _mm_shuffle_ps(x0y0x1y1, z0z0x1x1, _MM_SHUFFLE(2, 0, 1, 0));
+
+	const __m128 y1y1z1z1 = _mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1));
+	b = _mm_shuffle_ps(y1y1z1z1, x2y2x3y3, _MM_SHUFFLE(1, 0, 2, 0));
+
+	const __m128 z2z2x3x3 = _mm_shuffle_ps(z, x2y2x3y3, _MM_SHUFFLE(2, 2, 2, 2));
+	const __m128 y3y3z3z3 = _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3));
+	c = _mm_shuffle_ps(z2z2x3x3, y3y3z3z3, _MM_SHUFFLE(2, 0, 2, 0));
+}
+#elif ANKI_BATCH_SIMD_NEON
+/// out = acc + b * a[i]
+#	define ANKI_MADD_LANE(acc, b, a, i) \
+		vmlaq_lane_f32((acc), (b), ((i) < 2) ? vget_low_f32(a) : vget_high_f32(a), (i) % 2)
+
+static void transpose(float32x4_t& a, float32x4_t& b, float32x4_t& c, float32x4_t& d)
+{
+	const float32x4x2_t ab = vtrnq_f32(a, b);
+	const float32x4x2_t cd = vtrnq_f32(c, d);
+	a = vcombine_f32(vget_low_f32(ab.val[0]), vget_low_f32(cd.val[0]));
+	b = vcombine_f32(vget_low_f32(ab.val[1]), vget_low_f32(cd.val[1]));
+	c = vcombine_f32(vget_high_f32(ab.val[0]), vget_high_f32(cd.val[0]));
+	d = vcombine_f32(vget_high_f32(ab.val[1]), vget_high_f32(cd.val[1]));
+}
+#endif
+
+#if ANKI_SIMD_AVX2
+#	define ANKI_SPLAT256(v, i) _mm256_shuffle_ps((v), (v), _MM_SHUFFLE(i, i, i, i))
+
+static __m256 broadcastRow(const F32* row)
+{
+	return _mm256_broadcast_ps(reinterpret_cast<const __m128*>(row));
+}
+
+static __m256 loadTwo(const F32* lo, const F32* hi)
+{
+	return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(lo)), _mm_loadu_ps(hi), 1);
+}
+
+static void storeTwo(__m256 v, F32* lo, F32* hi)
+{
+	_mm_storeu_ps(lo, _mm256_castps256_ps128(v));
+	_mm_storeu_ps(hi, _mm256_extractf128_ps(v, 1));
+}
+#endif
+
+void multiplyMat4s(const Mat4* a, const Mat4* b, Mat4* out, U32 count)
+{
+	ANKI_ASSERT(a && b && out);
+
+	for(U32 n = 0; n < count; ++n)
+	{
+		const F32* am = getFloats(a[n]);
+		const F32* bm = getFloats(b[n]);
+		F32* outm = getFloats(out[n]);
+
+#if ANKI_SIMD_AVX2
+		// Compute 2 rows at a time
+		const __m256 b0 = broadcastRow(bm + 0);
+		const __m256 b1 = broadcastRow(bm + 4);
+		const __m256 b2 = broadcastRow(bm + 8);
+		const __m256 b3 = broadcastRow(bm + 12);
+
+		const __m256 a01 = _mm256_loadu_ps(am);
+		const __m256 a23 = _mm256_loadu_ps(am + 8);
+
+		__m256 r01 = _mm256_mul_ps(ANKI_SPLAT256(a01, 0), b0);
+		r01 = _mm256_fmadd_ps(ANKI_SPLAT256(a01, 1), b1, r01);
+		r01 = _mm256_fmadd_ps(ANKI_SPLAT256(a01, 2), b2, r01);
+		r01 = _mm256_fmadd_ps(ANKI_SPLAT256(a01, 3), b3, r01);
+
+		__m256 r23 = _mm256_mul_ps(ANKI_SPLAT256(a23, 0), b0);
+		r23 = _mm256_fmadd_ps(ANKI_SPLAT256(a23, 1), b1, r23);
+		r23 = _mm256_fmadd_ps(ANKI_SPLAT256(a23, 2), b2, r23);
+		r23 = _mm256_fmadd_ps(ANKI_SPLAT256(a23, 3), b3, r23);
+
+		_mm256_storeu_ps(outm, r01);
+		_mm256_storeu_ps(outm + 8, r23);
+#elif ANKI_SIMD_SSE
+		const __m128 b0 = _mm_load_ps(bm + 0);
+		const __m128 b1 = _mm_load_ps(bm + 4);
+		const __m128 b2 = _mm_load_ps(bm + 8);
+		const __m128 b3 = _mm_load_ps(bm + 12);
+
+		for(U32 i = 0; i < 4; ++i)
+		{
+			const __m128 ar = _mm_load_ps(am + i * 4);
+			__m128 r = _mm_mul_ps(ANKI_SPLAT(ar, 0), b0);
+			r = _mm_add_ps(_mm_mul_ps(ANKI_SPLAT(ar, 1), b1), r);
+			r = _mm_add_ps(_mm_mul_ps(ANKI_SPLAT(ar, 2), b2), r);
+			r = _mm_add_ps(_mm_mul_ps(ANKI_SPLAT(ar, 3), b3), r);
+			_mm_store_ps(outm + i * 4, r);
+		}
+#elif ANKI_BATCH_SIMD_NEON
+		const float32x4_t b0 = vld1q_f32(bm + 0);
+		const float32x4_t b1 = vld1q_f32(bm + 4);
+		const float32x4_t b2 = vld1q_f32(bm + 8);
+		const float32x4_t b3 = vld1q_f32(bm + 12);
+
+		for(U32 i = 0; i < 4; ++i)
+		{
+			const float32x4_t ar = vld1q_f32(am + i * 4);
+			float32x4_t r = vmulq_lane_f32(b0, vget_low_f32(ar), 0);
+			r = ANKI_MADD_LANE(r, b1, ar, 1);
+			r = ANKI_MADD_LANE(r, b2, ar, 2);
+			r = ANKI_MADD_LANE(r, b3, ar, 3);
+			vst1q_f32(outm + i * 4, r);
+		}
+#else
+		out[n] = a[n] * b[n];
+		(void)am;
+		(void)bm;
+		(void)outm;
+#endif
+	}
+}
+
+void multiplyMat4s(const Mat4& a, const Mat4* b, Mat4* out, U32 count)
+{
+	ANKI_ASSERT(b && out);
+
+#if ANKI_SIMD_AVX2
+	// The a(i, k) factors of 2 rows at a time
+	Array2d<__m256, 2, 4> as;
+	for(U32 i = 0; i < 2; ++i)
+	{
+		const __m256 ar = _mm256_loadu_ps(getFloats(a) + i * 8);
+		as[i][0] = ANKI_SPLAT256(ar, 0);
+		as[i][1] = ANKI_SPLAT256(ar, 1);
+		as[i][2] = ANKI_SPLAT256(ar, 2);
+		as[i][3] = ANKI_SPLAT256(ar, 3);
+	}
+
+	for(U32 n = 0; n < count; ++n)
+	{
+		const F32* bm = getFloats(b[n]);
+		const __m256 b0 = broadcastRow(bm + 0);
+		const __m256 b1 = broadcastRow(bm + 4);
+		const __m256 b2 = broadcastRow(bm + 8);
+		const __m256 b3 = broadcastRow(bm + 12);
+
+		for(U32 i = 0; i < 2; ++i)
+		{
+			__m256 r = _mm256_mul_ps(as[i][0], b0);
+			r = _mm256_fmadd_ps(as[i][1], b1, r);
+			r = _mm256_fmadd_ps(as[i][2], b2, r);
+			r = _mm256_fmadd_ps(as[i][3], b3, r);
+			_mm256_storeu_ps(getFloats(out[n]) + i * 8, r);
+		}
+	}
+#elif ANKI_SIMD_SSE
+	// Splat the a(i, k) factors once
+	Array2d<__m128, 4, 4> as;
+	for(U32 i = 0; i < 4; ++i)
+	{
+		const __m128 ar = _mm_load_ps(getFloats(a) + i * 4);
+		as[i][0] = ANKI_SPLAT(ar, 0);
+		as[i][1] = ANKI_SPLAT(ar, 1);
+		as[i][2] = ANKI_SPLAT(ar, 2);
+		as[i][3] = ANKI_SPLAT(ar, 3);
+	}
+
+	for(U32 n = 0; n < count; ++n)
+	{
+		const F32* bm = getFloats(b[n]);
+		const __m128 b0 = _mm_load_ps(bm + 0);
+		const __m128 b1 = _mm_load_ps(bm + 4);
+		const __m128 b2 = _mm_load_ps(bm + 8);
+		const __m128 b3 = _mm_load_ps(bm + 12);
+
+		for(U32 i = 0; i < 4; ++i)
+		{
+			__m128 r = _mm_mul_ps(as[i][0], b0);
+			r = _mm_add_ps(_mm_mul_ps(as[i][1], b1), r);
+			r = _mm_add_ps(_mm_mul_ps(as[i][2], b2), r);
+			r = _mm_add_ps(_mm_mul_ps(as[i][3], b3), r);
+			_mm_store_ps(getFloats(out[n]) + i * 4, r);
+		}
+	}
+#elif ANKI_BATCH_SIMD_NEON
+	for(U32 n = 0; n < count; ++n)
+	{
+		// Copy it since the output might alias
+		const Mat4 bm = b[n];
+		multiplyMat4s(&a, &bm, &out[n], 1);
+	}
+#else
+	for(U32 n = 0; n < count; ++n)
+	{
+		out[n] = a * b[n];
+	}
+#endif
+}
+
+void combineTransformations(const Mat3x4* a, const Mat3x4* b, Mat3x4* out, U32 count)
+{
+	ANKI_ASSERT(a && b && out);
+
+	for(U32 n = 0; n < count; ++n)
+	{
+		const F32* am = getFloats(a[n]);
+		const F32* bm = getFloats(b[n]);
+		F32* outm = getFloats(out[n]);
+
+#if ANKI_SIMD_AVX2
+		// Same as the Mat4 multiplication where the 4th row of b is (0, 0, 0, 1)
+		const __m256 b0 = broadcastRow(bm + 0);
+		const __m256 b1 = broadcastRow(bm + 4);
+		const __m256 b2 = broadcastRow(bm + 8);
+		const __m256 b3 = _mm256_setr_ps(0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+
+		const __m256 a01 = _mm256_loadu_ps(am);
+		const __m128 a2 = _mm_load_ps(am + 8);
+
+		__m256 r01 = _mm256_mul_ps(ANKI_SPLAT256(a01, 0), b0);
+		r01 = _mm256_fmadd_ps(ANKI_SPLAT256(a01, 1), b1, r01);
+		r01 = _mm256_fmadd_ps(ANKI_SPLAT256(a01, 2), b2, r01);
+		r01 = _mm256_fmadd_ps(ANKI_SPLAT256(a01, 3), b3, r01);
+
+		__m128 r2 = _mm_mul_ps(ANKI_SPLAT(a2, 0), _mm256_castps256_ps128(b0));
+		r2 = _mm_fmadd_ps(ANKI_SPLAT(a2, 1), _mm256_castps256_ps128(b1), r2);
+		r2 = _mm_fmadd_ps(ANKI_SPLAT(a2, 2), _mm256_castps256_ps128(b2), r2);
+		r2 = _mm_fmadd_ps(ANKI_SPLAT(a2, 3), _mm256_castps256_ps128(b3), r2);
+
+		_mm256_storeu_ps(outm, r01);
+		_mm_store_ps(outm + 8, r2);
+#elif ANKI_SIMD_SSE
+		const __m128 b0 = _mm_load_ps(bm + 0);
+		const __m128 b1 = _mm_load_ps(bm + 4);
+		const __m128 b2 = _mm_load_ps(bm + 8);
+		const __m128 b3 = _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f);
+
+		for(U32 i = 0; i < 3; ++i)
+		{
+			const __m128 ar = _mm_load_ps(am + i * 4);
+			__m128 r = _mm_mul_ps(ANKI_SPLAT(ar, 0), b0);
+			r = _mm_add_ps(_mm_mul_ps(ANKI_SPLAT(ar, 1), b1), r);
+			r = _mm_add_ps(_mm_mul_ps(ANKI_SPLAT(ar, 2), b2), r);
+			r = _mm_add_ps(_mm_mul_ps(ANKI_SPLAT(ar, 3), b3), r);
+			_mm_store_ps(outm + i * 4, r);
+		}
+#elif ANKI_BATCH_SIMD_NEON
+		const float32x4_t b0 = vld1q_f32(bm + 0);
+		const float32x4_t b1 = vld1q_f32(bm + 4);
+		const float32x4_t b2 = vld1q_f32(bm + 8);
+		const float32x4_t b3 = {0.0f, 0.0f, 0.0f, 1.0f};
+
+		for(U32 i = 0; i < 3; ++i)
+		{
+			const float32x4_t ar = vld1q_f32(am + i * 4);
+			float32x4_t r = vmulq_lane_f32(b0, vget_low_f32(ar), 0);
+			r = ANKI_MADD_LANE(r, b1, ar, 1);
+			r = ANKI_MADD_LANE(r, b2, ar, 2);
+			r = ANKI_MADD_LANE(r, b3, ar, 3);
+			vst1q_f32(outm + i * 4, r);
+		}
+#else
+		out[n] = a[n].combineTransformations(b[n]);
+		(void)am;
+		(void)bm;
+		(void)outm;
+#endif
+	}
+}
+
+void combineTransformations(const Mat3x4& a, const Mat3x4* b, Mat3x4* out, U32 count)
+{
+	ANKI_ASSERT(b && out);
+
+#if ANKI_SIMD_SSE
+	// Splat the a(i, k) factors once
+	Array2d<__m128, 3, 4> as;
+	for(U32 i = 0; i < 3; ++i)
+	{
+		const __m128 ar = _mm_load_ps(getFloats(a) + i * 4);
+		as[i][0] = ANKI_SPLAT(ar, 0);
+		as[i][1] = ANKI_SPLAT(ar, 1);
+		as[i][2] = ANKI_SPLAT(ar, 2);
+		as[i][3] = _mm_mul_ps(ANKI_SPLAT(ar, 3), _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f));
+	}
+
+	for(U32 n = 0; n < count; ++n)
+	{
+		const F32* bm = getFloats(b[n]);
+		const __m128 b0 = _mm_load_ps(bm + 0);
+		const __m128 b1 = _mm_load_ps(bm + 4);
+		const __m128 b2 = _mm_load_ps(bm + 8);
+
+		for(U32 i = 0; i < 3; ++i)
+		{
+#	if ANKI_SIMD_AVX2
+			__m128 r = _mm_fmadd_ps(as[i][0], b0, as[i][3]);
+			r = _mm_fmadd_ps(as[i][1], b1, r);
+			r = _mm_fmadd_ps(as[i][2], b2, r);
+#	else
+			__m128 r = _mm_add_ps(_mm_mul_ps(as[i][0], b0), as[i][3]);
+			r = _mm_add_ps(_mm_mul_ps(as[i][1], b1), r);
+			r = _mm_add_ps(_mm_mul_ps(as[i][2], b2), r);
+#	endif
+			_mm_store_ps(getFloats(out[n]) + i * 4, r);
+		}
+	}
+#elif ANKI_BATCH_SIMD_NEON
+	for(U32 n = 0; n < count; ++n)
+	{
+		// Copy it since the output might alias
+		const Mat3x4 bm = b[n];
+		combineTransformations(&a, &bm, &out[n], 1);
+	}
+#else
+	for(U32 n = 0; n < count; ++n)
+	{
+		out[n] = a.combineTransformations(b[n]);
+	}
+#endif
+}
+
+void transformPoints(const Mat3x4& m, const Vec3* points, Vec3* out, U32 count)
+{
+	ANKI_ASSERT(points && out);
+	U32 n = 0;
+	const F32* in = reinterpret_cast<const F32*>(points);
+	F32* outf = reinterpret_cast<F32*>(out);
+
+#if ANKI_SIMD_SSE
+	// Process the points in SoA form
+	Array<__m128, 12> ms;
+	for(U32 i = 0; i < 12; ++i)
+	{
+		ms[i] = _mm_set1_ps(m[i]);
+	}
+
+#	if ANKI_SIMD_AVX2
+	// 8 at a time
+	Array<__m256, 12> ms256;
+	for(U32 i = 0; i < 12; ++i)
+	{
+		ms256[i] = _mm256_set1_ps(m[i]);
+	}
+
+	for(; n + 8 <= count; n += 8)
+	{
+		const F32* p = in + n * 3;
+
+		// Each 128bit lane holds 4 points. Since the shuffles work per lane deinterleave them like the SSE version
+		const __m256 a = loadTwo(p + 0, p + 12);
+		const __m256 b = loadTwo(p + 4, p + 16);
+		const __m256 c = loadTwo(p + 8, p + 20);
+
+		const __m256 x2y2z2x3 = _mm256_shuffle_ps(b, c, _MM_SHUFFLE(1, 0, 3, 2));
+		const __m256 x = _mm256_shuffle_ps(a, x2y2z2x3, _MM_SHUFFLE(3, 0, 3, 0));
+		const __m256 y0z0y1y1 = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 2, 1));
+		const __m256 y2z1y3z3 = _mm256_shuffle_ps(b, c, _MM_SHUFFLE(3, 2, 1, 3));
+		const __m256 y = _mm256_shuffle_ps(y0z0y1y1, y2z1y3z3, _MM_SHUFFLE(2, 0, 2, 0));
+		const __m256 z0z0z1z1 = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2));
+		const __m256 z2z2z3z3 = _mm256_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0));
+		const __m256 z = _mm256_shuffle_ps(z0z0z1z1, z2z2z3z3, _MM_SHUFFLE(2, 0, 2, 0));
+
+		const __m256 ox =
+			_mm256_fmadd_ps(ms256[0], x, _mm256_fmadd_ps(ms256[1], y, _mm256_fmadd_ps(ms256[2], z, ms256[3])));
+		const __m256 oy =
+			_mm256_fmadd_ps(ms256[4], x, _mm256_fmadd_ps(ms256[5], y, _mm256_fmadd_ps(ms256[6], z, ms256[7])));
+		const __m256 oz =
+			_mm256_fmadd_ps(ms256[8], x, _mm256_fmadd_ps(ms256[9], y, _mm256_fmadd_ps(ms256[10], z, ms256[11])));
+
+		const __m256 x0y0x1y1 = _mm256_unpacklo_ps(ox, oy);
+		const __m256 x2y2x3y3 = _mm256_unpackhi_ps(ox, oy);
+		const __m256 z0z0x1x1 = _mm256_shuffle_ps(oz, ox, _MM_SHUFFLE(1, 1, 0, 0));
+		const __m256 oa = _mm256_shuffle_ps(x0y0x1y1, z0z0x1x1, _MM_SHUFFLE(2, 0, 1, 0));
+		const __m256 y1y1z1z1 = _mm256_shuffle_ps(oy, oz, _MM_SHUFFLE(1, 1, 1, 1));
+		const __m256 ob = _mm256_shuffle_ps(y1y1z1z1, x2y2x3y3, _MM_SHUFFLE(1, 0, 2, 0));
+		const __m256 z2z2x3x3 = _mm256_shuffle_ps(oz, x2y2x3y3, _MM_SHUFFLE(2, 2, 2, 2));
+		const __m256 y3y3z3z3 = _mm256_shuffle_ps(oy, oz, _MM_SHUFFLE(3, 3, 3, 3));
+		const __m256 oc = _mm256_shuffle_ps(z2z2x3x3, y3y3z3z3, _MM_SHUFFLE(2, 0, 2, 0));
+
+		F32* o = outf + n * 3;
+		storeTwo(oa, o + 0, o + 12);
+		storeTwo(ob, o + 4, o + 16);
+		storeTwo(oc, o + 8, o + 20);
+	}
+#	endif
+
+	for(; n + 4 <= count; n += 4)
+	{
+		const F32* p = in + n * 3;
+		__m128 x, y, z;
+		deinterleaveVec3s(_mm_loadu_ps(p), _mm_loadu_ps(p + 4), _mm_loadu_ps(p + 8), x, y, z);
+
+		const __m128 ox =
+			_mm_add_ps(_mm_add_ps(_mm_mul_ps(ms[0], x), _mm_mul_ps(ms[1], y)), _mm_add_ps(_mm_mul_ps(ms[2], z), ms[3]));
+		const __m128 oy =
+			_mm_add_ps(_mm_add_ps(_mm_mul_ps(ms[4], x), _mm_mul_ps(ms[5], y)), _mm_add_ps(_mm_mul_ps(ms[6], z), ms[7]));
+		const __m128 oz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ms[8], x), _mm_mul_ps(ms[9], y)),
+									 _mm_add_ps(_mm_mul_ps(ms[10], z), ms[11]));
+
+		__m128 a, b, c;
+		interleaveVec3s(ox, oy, oz, a, b, c);
+		F32* o = outf + n * 3;
+		_mm_storeu_ps(o, a);
+		_mm_storeu_ps(o + 4, b);
+		_mm_storeu_ps(o + 8, c);
+	}
+#elif ANKI_BATCH_SIMD_NEON
+	Array<float32x4_t, 12> ms;
+	for(U32 i = 0; i < 12; ++i)
+	{
+		ms[i] = vdupq_n_f32(m[i]);
+	}
+
+	for(; n + 4 <= count; n += 4)
+	{
+		// vld3 deinterleaves
+		const float32x4x3_t p = vld3q_f32(in + n * 3);
+
+		float32x4x3_t o;
+		o.val[0] = vmlaq_f32(vmlaq_f32(vmlaq_f32(ms[3], ms[0], p.val[0]), ms[1], p.val[1]), ms[2], p.val[2]);
+		o.val[1] = vmlaq_f32(vmlaq_f32(vmlaq_f32(ms[7], ms[4], p.val[0]), ms[5], p.val[1]), ms[6], p.val[2]);
+		o.val[2] = vmlaq_f32(vmlaq_f32(vmlaq_f32(ms[11], ms[8], p.val[0]), ms[9], p.val[1]), ms[10], p.val[2]);
+
+		vst3q_f32(outf + n * 3, o);
+	}
+#endif
+
+	(void)in;
+	(void)outf;
+	for(; n < count; ++n)
+	{
+		out[n] = m * Vec4(points[n], 1.0f);
+	}
+}
+
+void transformPoints(const Mat4& m, const Vec4* points, Vec4* out, U32 count)
+{
+	ANKI_ASSERT(points && out);
+	U32 n = 0;
+
+#if ANKI_SIMD_SSE || ANKI_BATCH_SIMD_NEON
+	// out = col0 * x + col1 * y + col2 * z + col3 * w
+	const Mat4 t = m.getTransposed();
+#endif
+
+#if ANKI_SIMD_AVX2
+	// 2 points at a time
+	const __m256 c01 = broadcastRow(getFloats(t));
+	const __m256 c11 = broadcastRow(getFloats(t) + 4);
+	const __m256 c21 = broadcastRow(getFloats(t) + 8);
+	const __m256 c31 = broadcastRow(getFloats(t) + 12);
+
+	for(; n + 2 <= count; n += 2)
+	{
+		const __m256 p = _mm256_loadu_ps(getFloats(points[n]));
+		__m256 r = _mm256_mul_ps(ANKI_SPLAT256(p, 0), c01);
+		r = _mm256_fmadd_ps(ANKI_SPLAT256(p, 1), c11, r);
+		r = _mm256_fmadd_ps(ANKI_SPLAT256(p, 2), c21, r);
+		r = _mm256_fmadd_ps(ANKI_SPLAT256(p, 3), c31, r);
+		_mm256_storeu_ps(getFloats(out[n]), r);
+	}
+#endif
+
+#if ANKI_SIMD_SSE
+	const __m128 c0 = _mm_load_ps(getFloats(t));
+	const __m128 c1 = _mm_load_ps(getFloats(t) + 4);
+	const __m128 c2 = _mm_load_ps(getFloats(t) + 8);
+	const __m128 c3 = _mm_load_ps(getFloats(t) + 12);
+
+	for(; n < count; ++n)
+	{
+		const __m128 p = _mm_load_ps(getFloats(points[n]));
+		__m128 r = _mm_mul_ps(ANKI_SPLAT(p, 0), c0);
+		r = _mm_add_ps(_mm_mul_ps(ANKI_SPLAT(p, 1), c1), r);
+		r = _mm_add_ps(_mm_mul_ps(ANKI_SPLAT(p, 2), c2), r);
+		r = _mm_add_ps(_mm_mul_ps(ANKI_SPLAT(p, 3), c3), r);
+		_mm_store_ps(getFloats(out[n]), r);
+	}
+#elif ANKI_BATCH_SIMD_NEON
+	const float32x4_t c0 = vld1q_f32(getFloats(t));
+	const float32x4_t c1 = vld1q_f32(getFloats(t) + 4);
+	const float32x4_t c2 = vld1q_f32(getFloats(t) + 8);
+	const float32x4_t c3 = vld1q_f32(getFloats(t) + 12);
+
+	for(; n < count; ++n)
+	{
+		const float32x4_t p = vld1q_f32(getFloats(points[n]));
+		float32x4_t r = vmulq_lane_f32(c0, vget_low_f32(p), 0);
+		r = ANKI_MADD_LANE(r, c1, p, 1);
+		r = ANKI_MADD_LANE(r, c2, p, 2);
+		r = ANKI_MADD_LANE(r, c3, p, 3);
+		vst1q_f32(getFloats(out[n]), r);
+	}
+#else
+	for(; n < count; ++n)
+	{
+		out[n] = m * points[n];
+	}
+#endif
+}
+
+void makeMat3x4s(const Vec3* translations, const Quat* rotations, const F32* scales, Mat3x4* out, U32 count)
+{
+	ANKI_ASSERT(translations && rotations && scales && out);
+	U32 n = 0;
+
+	// 4 at a time in SoA form. It's the same math as Mat3::setRotationPart(const Quat&)
+#if ANKI_SIMD_SSE
+	const __m128 one = _mm_set1_ps(1.0f);
+	for(; n + 4 <= count; n += 4)
+	{
+		__m128 x = _mm_load_ps(getFloats(rotations[n + 0]));
+		__m128 y = _mm_load_ps(getFloats(rotations[n + 1]));
+		__m128 z = _mm_load_ps(getFloats(rotations[n + 2]));
+		__m128 w = _mm_load_ps(getFloats(rotations[n + 3]));
+		_MM_TRANSPOSE4_PS(x, y, z, w);
+
+		const F32* t = reinterpret_cast<const F32*>(translations + n);
+		__m128 tx, ty, tz;
+		deinterleaveVec3s(_mm_loadu_ps(t), _mm_loadu_ps(t + 4), _mm_loadu_ps(t + 8), tx, ty, tz);
+
+		const __m128 s = _mm_loadu_ps(scales + n);
+
+		const __m128 xs = _mm_add_ps(x, x);
+		const __m128 ys = _mm_add_ps(y, y);
+		const __m128 zs = _mm_add_ps(z, z);
+		const __m128 wx = _mm_mul_ps(w, xs);
+		const __m128 wy = _mm_mul_ps(w, ys);
+		const __m128 wz = _mm_mul_ps(w, zs);
+		const __m128 xx = _mm_mul_ps(x, xs);
+		const __m128 xy = _mm_mul_ps(x, ys);
+		const __m128 xz = _mm_mul_ps(x, zs);
+		const __m128 yy = _mm_mul_ps(y, ys);
+		const __m128 yz = _mm_mul_ps(y, zs);
+		const __m128 zz = _mm_mul_ps(z, zs);
+
+		__m128 r0 = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), s);
+		__m128 r1 = _mm_mul_ps(_mm_sub_ps(xy, wz), s);
+		__m128 r2 = _mm_mul_ps(_mm_add_ps(xz, wy), s);
+		__m128 r3 = tx;
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+		_mm_store_ps(getFloats(out[n + 0]), r0);
+		_mm_store_ps(getFloats(out[n + 1]), r1);
+		_mm_store_ps(getFloats(out[n + 2]), r2);
+		_mm_store_ps(getFloats(out[n + 3]), r3);
+
+		r0 = _mm_mul_ps(_mm_add_ps(xy, wz), s);
+		r1 = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), s);
+		r2 = _mm_mul_ps(_mm_sub_ps(yz, wx), s);
+		r3 = ty;
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+		_mm_store_ps(getFloats(out[n + 0]) + 4, r0);
+		_mm_store_ps(getFloats(out[n + 1]) + 4, r1);
+		_mm_store_ps(getFloats(out[n + 2]) + 4, r2);
+		_mm_store_ps(getFloats(out[n + 3]) + 4, r3);
+
+		r0 = _mm_mul_ps(_mm_sub_ps(xz, wy), s);
+		r1 = _mm_mul_ps(_mm_add_ps(yz, wx), s);
+		r2 = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), s);
+		r3 = tz;
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+		_mm_store_ps(getFloats(out[n + 0]) + 8, r0);
+		_mm_store_ps(getFloats(out[n + 1]) + 8, r1);
+		_mm_store_ps(getFloats(out[n + 2]) + 8, r2);
+		_mm_store_ps(getFloats(out[n + 3]) + 8, r3);
+	}
+#elif ANKI_BATCH_SIMD_NEON
+	const float32x4_t one = vdupq_n_f32(1.0f);
+	for(; n + 4 <= count; n += 4)
+	{
+		// vld4 and vld3 deinterleave
+		const float32x4x4_t q = vld4q_f32(getFloats(rotations[n]));
+		const float32x4_t x = q.val[0];
+		const float32x4_t y = q.val[1];
+		const float32x4_t z = q.val[2];
+		const float32x4_t w = q.val[3];
+
+		const float32x4x3_t t = vld3q_f32(reinterpret_cast<const F32*>(translations + n));
+		const float32x4_t s = vld1q_f32(scales + n);
+
+		const float32x4_t xs = x + x;
+		const float32x4_t ys = y + y;
+		const float32x4_t zs = z + z;
+		const float32x4_t wx = w * xs;
+		const float32x4_t wy = w * ys;
+		const float32x4_t wz = w * zs;
+		const float32x4_t xx = x * xs;
+		const float32x4_t xy = x * ys;
+		const float32x4_t xz = x * zs;
+		const float32x4_t yy = y * ys;
+		const float32x4_t yz = y * zs;
+		const float32x4_t zz = z * zs;
+
+		float32x4_t r0 = (one - (yy + zz)) * s;
+		float32x4_t r1 = (xy - wz) * s;
+		float32x4_t r2 = (xz + wy) * s;
+		float32x4_t r3 = t.val[0];
+		transpose(r0, r1, r2, r3);
+		vst1q_f32(getFloats(out[n + 0]), r0);
+		vst1q_f32(getFloats(out[n + 1]), r1);
+		vst1q_f32(getFloats(out[n + 2]), r2);
+		vst1q_f32(getFloats(out[n + 3]), r3);
+
+		r0 = (xy + wz) * s;
+		r1 = (one - (xx + zz)) * s;
+		r2 = (yz - wx) * s;
+		r3 = t.val[1];
+		transpose(r0, r1, r2, r3);
+		vst1q_f32(getFloats(out[n + 0]) + 4, r0);
+		vst1q_f32(getFloats(out[n + 1]) + 4, r1);
+		vst1q_f32(getFloats(out[n + 2]) + 4, r2);
+		vst1q_f32(getFloats(out[n + 3]) + 4, r3);
+
+		r0 = (xz - wy) * s;
+		r1 = (yz + wx) * s;
+		r2 = (one - (xx + yy)) * s;
+		r3 = t.val[2];
+		transpose(r0, r1, r2, r3);
+		vst1q_f32(getFloats(out[n + 0]) + 8, r0);
+		vst1q_f32(getFloats(out[n + 1]) + 8, r1);
+		vst1q_f32(getFloats(out[n + 2]) + 8, r2);
+		vst1q_f32(getFloats(out[n + 3]) + 8, r3);
+	}
+#endif
+
+	for(; n < count; ++n)
+	{
+		out[n] = Mat3x4(translations[n], rotations[n], scales[n]);
+	}
+}
+
+} // end namespace anki
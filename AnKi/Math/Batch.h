@@ -0,0 +1,45 @@
+// Copyright (C) 2009-2022, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Math/Mat.h>
+#include <AnKi/Math/Quat.h>
+
+namespace anki {
+
+/// @addtogroup math
+/// @{
+
+/// @name Batched operations
+/// Operations on arrays of math objects. They have SSE, AVX2 (see ANKI_SIMD_AVX2) and NEON implementations that are
+/// selected at compile time. The NEON ones are opt-in (see ANKI_BATCH_NEON) and ARM builds use the scalar code by
+/// default. The output array can be the same as one of the input arrays but it can't partially overlap with them.
+/// @{
+
+/// out[i] = a[i] * b[i]
+void multiplyMat4s(const Mat4* a, const Mat4* b, Mat4* out, U32 count);
+
+/// out[i] = a * b[i]
+void multiplyMat4s(const Mat4& a, const Mat4* b, Mat4* out, U32 count);
+
+/// out[i] = a[i].combineTransformations(b[i])
+void combineTransformations(const Mat3x4* a, const Mat3x4* b, Mat3x4* out, U32 count);
+
+/// out[i] = a.combineTransformations(b[i])
+void combineTransformations(const Mat3x4& a, const Mat3x4* b, Mat3x4* out, U32 count);
+
+/// out[i] = m * Vec4(points[i], 1.0)
+void transformPoints(const Mat3x4& m, const Vec3* points, Vec3* out, U32 count);
+
+/// out[i] = m * points[i]
+void transformPoints(const Mat4& m, const Vec4* points, Vec4* out, U32 count);
+
+/// out[i] = Mat3x4(translations[i], rotations[i], scales[i])
+void makeMat3x4s(const Vec3* translations, const Quat* rotations, const F32* scales, Mat3x4* out, U32 count);
+/// @}
+/// @}
+
+} // end namespace anki
@@ -182,6 +182,12 @@ public:
 	{
 	}
 
+	ANKI_ENABLE_METHOD(J == 4 && I == 4)
+	explicit TMat(const TMat<T, 3, 4>& m3)
+	{
+		setRows(m3.getRow(0), m3.getRow(1), m3.getRow(2), RowVec(T(0), T(0), T(0), T(1)));
+	}
+
 	// 3x4 specific constructors
 
 	ANKI_ENABLE_METHOD(J == 3 && I == 4)
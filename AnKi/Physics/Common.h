@@ -23,7 +23,7 @@
 #	pragma warning(push)
 #	pragma warning(disable : 4305)
 #endif
-#define BT_THREADSAFE 0
+#define BT_THREADSAFE 1
 #define BT_NO_PROFILE 1
 #include <btBulletCollisionCommon.h>
 #include <btBulletDynamicsCommon.h>
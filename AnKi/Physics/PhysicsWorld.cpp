@@ -9,7 +9,12 @@
 #include <AnKi/Physics/PhysicsTrigger.h>
 #include <AnKi/Physics/PhysicsPlayerController.h>
 #include <AnKi/Util/Rtti.h>
+#include <AnKi/Util/ThreadHive.h>
 #include <BulletCollision/Gimpact/btGImpactCollisionAlgorithm.h>
+#include <BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h>
+#include <BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
+#include <BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolverMt.h>
+#include <BulletCollision/CollisionDispatch/btManifoldResult.h>
 
 namespace anki {
 
@@ -139,6 +144,256 @@ public:
 	}
 };
 
+/// Bullet's task scheduler on top of the ThreadHive. It splits the loops in batches, one for every thread of the hive
+/// and one for the calling thread.
+class PhysicsWorld::MyTaskScheduler : public btITaskScheduler
+{
+public:
+	ThreadHive* m_hive;
+	Atomic<U32> m_running = {0}; ///< The loops that Bullet starts from inside a loop run serially.
+
+	MyTaskScheduler(ThreadHive* hive)
+		: btITaskScheduler("AnKi")
+		, m_hive(hive)
+	{
+		ANKI_ASSERT(hive);
+	}
+
+	int getMaxNumThreads() const override
+	{
+		return int(m_hive->getThreadCount() + 1);
+	}
+
+	int getNumThreads() const override
+	{
+		return getMaxNumThreads();
+	}
+
+	void setNumThreads(int numThreads) override
+	{
+		// The hive decides
+	}
+
+	void parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody& body) override
+	{
+		run(iBegin, iEnd, grainSize, &body, nullptr);
+	}
+
+	btScalar parallelSum(int iBegin, int iEnd, int grainSize, const btIParallelSumBody& body) override
+	{
+		return run(iBegin, iEnd, grainSize, nullptr, &body);
+	}
+
+private:
+	class Batch
+	{
+	public:
+		const btIParallelForBody* m_forBody;
+		const btIParallelSumBody* m_sumBody;
+		I32 m_begin;
+		I32 m_end;
+		btScalar m_sum;
+
+		void run()
+		{
+			if(m_forBody)
+			{
+				m_forBody->forLoop(m_begin, m_end);
+				m_sum = 0.0f;
+			}
+			else
+			{
+				m_sum = m_sumBody->sumLoop(m_begin, m_end);
+			}
+		}
+	};
+
+	btScalar run(I32 iBegin, I32 iEnd, I32 grainSize, const btIParallelForBody* forBody,
+				 const btIParallelSumBody* sumBody)
+	{
+		const I32 count = iEnd - iBegin;
+		grainSize = max(grainSize, 1);
+		const U32 batchCount = min(m_hive->getThreadCount() + 1, U32((count + grainSize - 1) / grainSize));
+
+		Array<Batch, ThreadHive::MAX_THREADS + 1> batches;
+		if(batchCount <= 1 || m_running.exchange(1) != 0)
+		{
+			// Not worth it or called from one of the batches, run serially
+			batches[0] = {forBody, sumBody, iBegin, iEnd, 0.0f};
+			batches[0].run();
+			return batches[0].m_sum;
+		}
+
+		Array<ThreadHiveTask, ThreadHive::MAX_THREADS> tasks;
+		for(U32 i = 0; i < batchCount; ++i)
+		{
+			Batch& batch = batches[i];
+			batch.m_forBody = forBody;
+			batch.m_sumBody = sumBody;
+			batch.m_begin = iBegin + I32(I64(count) * i / batchCount);
+			batch.m_end = iBegin + I32(I64(count) * (i + 1) / batchCount);
+
+			if(i > 0)
+			{
+				tasks[i - 1] = ANKI_THREAD_HIVE_TASK({ self->run(); }, &batch, nullptr, nullptr);
+			}
+		}
+
+		// The 1st batch runs in this thread
+		m_hive->submitTasks(&tasks[0], batchCount - 1);
+		batches[0].run();
+		m_hive->waitAllTasks();
+
+		btScalar sum = 0.0f;
+		for(U32 i = 0; i < batchCount; ++i)
+		{
+			sum += batches[i].m_sum;
+		}
+
+		m_running.store(0);
+		return sum;
+	}
+};
+
+static Bool materialMaskPasses(const btBroadphaseProxy* proxy, PhysicsMaterialBit materialMask)
+{
+	const btCollisionObject* cobj = static_cast<const btCollisionObject*>(proxy->m_clientObject);
+	const PhysicsObject* pobj = static_cast<const PhysicsObject*>(cobj->getUserPointer());
+	return pobj && !!(dcast<const PhysicsFilteredObject*>(pobj)->getMaterialGroup() & materialMask);
+}
+
+static PhysicsFilteredObject* getFilteredObject(const btCollisionObject* cobj)
+{
+	PhysicsObject* pobj = static_cast<PhysicsObject*>(cobj->getUserPointer());
+	ANKI_ASSERT(pobj);
+	return dcast<PhysicsFilteredObject*>(pobj);
+}
+
+/// Closest hit of a PhysicsWorldQuery ray.
+class PhysicsWorldQueryRayCallback final : public btCollisionWorld::ClosestRayResultCallback
+{
+public:
+	PhysicsMaterialBit m_materialMask;
+
+	PhysicsWorldQueryRayCallback(const PhysicsWorldQuery& q)
+		: btCollisionWorld::ClosestRayResultCallback(toBt(q.m_from), toBt(q.m_to))
+		, m_materialMask(q.m_materialMask)
+	{
+	}
+
+	Bool needsCollision(btBroadphaseProxy* proxy) const override
+	{
+		return materialMaskPasses(proxy, m_materialMask);
+	}
+};
+
+/// Closest hit of a PhysicsWorldQuery sweep.
+class PhysicsWorldQuerySweepCallback final : public btCollisionWorld::ClosestConvexResultCallback
+{
+public:
+	PhysicsMaterialBit m_materialMask;
+
+	PhysicsWorldQuerySweepCallback(const PhysicsWorldQuery& q)
+		: btCollisionWorld::ClosestConvexResultCallback(toBt(q.m_from), toBt(q.m_to))
+		, m_materialMask(q.m_materialMask)
+	{
+	}
+
+	Bool needsCollision(btBroadphaseProxy* proxy) const override
+	{
+		return materialMaskPasses(proxy, m_materialMask);
+	}
+};
+
+/// Gathers the 1st overlapping object of a PhysicsWorldQuery overlap test. It doesn't touch the dispatcher of the world
+/// so it can run in many threads.
+class PhysicsWorldQueryOverlapCallback final : public btBroadphaseAabbCallback
+{
+public:
+	/// Keeps the 1st penetrating contact point.
+	class Result final : public btManifoldResult
+	{
+	public:
+		Bool m_hit = false;
+		btVector3 m_position;
+		btVector3 m_normal;
+
+		Result(const btCollisionObjectWrapper* queryWrap, const btCollisionObjectWrapper* objWrap)
+			: btManifoldResult(queryWrap, objWrap)
+		{
+		}
+
+		void addContactPoint(const btVector3& normalOnBInWorld, const btVector3& pointInWorld, btScalar depth) override
+		{
+			if(m_hit || depth > 0.0f)
+			{
+				return;
+			}
+
+			m_hit = true;
+			if(m_manifoldPtr && m_manifoldPtr->getBody0() != m_body0Wrap->getCollisionObject())
+			{
+				// The algorithm swapped the objects
+				m_position = pointInWorld + normalOnBInWorld * depth;
+				m_normal = -normalOnBInWorld;
+			}
+			else
+			{
+				m_position = pointInWorld;
+				m_normal = normalOnBInWorld;
+			}
+		}
+	};
+
+	const btCollisionWorld* m_world;
+	btCollisionDispatcher* m_dispatcher;
+	btCollisionObject* m_queryObject;
+	PhysicsMaterialBit m_materialMask;
+	PhysicsWorldQueryResult* m_result;
+
+	Bool process(const btBroadphaseProxy* proxy) override
+	{
+		if(m_result->m_object || !materialMaskPasses(proxy, m_materialMask))
+		{
+			return true;
+		}
+
+		const btCollisionObject* cobj = static_cast<const btCollisionObject*>(proxy->m_clientObject);
+		btCollisionObjectWrapper queryWrap(nullptr, m_queryObject->getCollisionShape(), m_queryObject,
+										   m_queryObject->getWorldTransform(), -1, -1);
+		btCollisionObjectWrapper objWrap(nullptr, cobj->getCollisionShape(), cobj, cobj->getWorldTransform(), -1, -1);
+
+		btCollisionAlgorithm* algorithm =
+			m_dispatcher->findAlgorithm(&queryWrap, &objWrap, nullptr, BT_CLOSEST_POINT_ALGORITHMS);
+		if(algorithm)
+		{
+			Result result(&queryWrap, &objWrap);
+			algorithm->processCollision(&queryWrap, &objWrap, m_world->getDispatchInfo(), &result);
+			algorithm->~btCollisionAlgorithm();
+			m_dispatcher->freeCollisionAlgorithm(algorithm);
+
+			if(result.m_hit)
+			{
+				m_result->m_object = getFilteredObject(cobj);
+				m_result->m_position = toAnki(result.m_position);
+				m_result->m_normal = toAnki(result.m_normal);
+				m_result->m_fraction = 0.0f;
+			}
+		}
+
+		return true;
+	}
+};
+
+/// A range of queries that runs in a ThreadHive task.
+class PhysicsWorld::QueryBatch
+{
+public:
+	const PhysicsWorld* m_world;
+	ConstWeakArray<PhysicsWorldQuery> m_queries;
+	WeakArray<PhysicsWorldQueryResult> m_results;
+};
+
 PhysicsWorld::PhysicsWorld()
 {
 }
@@ -149,9 +404,21 @@ PhysicsWorld::~PhysicsWorld()
 
 	ANKI_ASSERT(m_objectsCreatedCount.load() == 0 && "Forgot to delete some objects");
 
-	m_world.destroy();
-	m_solver.destroy();
-	m_dispatcher.destroy();
+	m_alloc.deleteInstance(m_world);
+	m_alloc.deleteInstance(m_solver);
+	m_alloc.deleteInstance(m_solverMt);
+	m_alloc.deleteInstance(m_dispatcher);
+
+	if(m_taskScheduler)
+	{
+		if(btGetTaskScheduler() == m_taskScheduler)
+		{
+			btSetTaskScheduler(btGetSequentialTaskScheduler());
+		}
+
+		m_alloc.deleteInstance(m_taskScheduler);
+	}
+
 	m_collisionConfig.destroy();
 	m_broadphase.destroy();
 	m_gpc.destroy();
@@ -160,7 +427,7 @@ PhysicsWorld::~PhysicsWorld()
 	g_alloc = nullptr;
 }
 
-Error PhysicsWorld::init(AllocAlignedCallback allocCb, void* allocCbData)
+Error PhysicsWorld::init(AllocAlignedCallback allocCb, void* allocCbData, ThreadHive* hive)
 {
 	m_alloc = HeapAllocator<U8>(allocCb, allocCbData);
 	m_tmpAlloc = StackAllocator<U8>(allocCb, allocCbData, 1_KB, 2.0f);
@@ -178,12 +445,36 @@ Error PhysicsWorld::init(AllocAlignedCallback allocCb, void* allocCbData)
 
 	m_collisionConfig.init();
 
-	m_dispatcher.init(m_collisionConfig.get());
-	btGImpactCollisionAlgorithm::registerAlgorithm(m_dispatcher.get());
+	if(hive)
+	{
+		ANKI_PHYS_LOGI("Stepping the world using %u job threads", hive->getThreadCount());
+
+		// Bullet uses a global scheduler so there can be only one multithreaded world
+		m_taskScheduler = m_alloc.newInstance<MyTaskScheduler>(hive);
+		btSetTaskScheduler(m_taskScheduler);
+
+		m_dispatcher = m_alloc.newInstance<btCollisionDispatcherMt>(m_collisionConfig.get());
+		btGImpactCollisionAlgorithm::registerAlgorithm(m_dispatcher);
+
+		btConstraintSolverPoolMt* solverPool =
+			m_alloc.newInstance<btConstraintSolverPoolMt>(m_taskScheduler->getMaxNumThreads());
+		m_solver = solverPool;
+		m_solverMt = m_alloc.newInstance<btSequentialImpulseConstraintSolverMt>();
+
+		m_world = m_alloc.newInstance<btDiscreteDynamicsWorldMt>(m_dispatcher, m_broadphase.get(), solverPool,
+																 m_solverMt, m_collisionConfig.get());
+	}
+	else
+	{
+		m_dispatcher = m_alloc.newInstance<btCollisionDispatcher>(m_collisionConfig.get());
+		btGImpactCollisionAlgorithm::registerAlgorithm(m_dispatcher);
 
-	m_solver.init();
+		m_solver = m_alloc.newInstance<btSequentialImpulseConstraintSolver>();
+
+		m_world = m_alloc.newInstance<btDiscreteDynamicsWorld>(m_dispatcher, m_broadphase.get(), m_solver,
+																m_collisionConfig.get());
+	}
 
-	m_world.init(m_dispatcher.get(), m_broadphase.get(), m_solver.get(), m_collisionConfig.get());
 	m_world->setGravity(btVector3(0.0f, -9.8f, 0.0f));
 
 	return Error::NONE;
@@ -289,6 +580,130 @@ void PhysicsWorld::rayCast(WeakArray<PhysicsWorldRayCastCallback*> rayCasts) con
 	}
 }
 
+void PhysicsWorld::query(ConstWeakArray<PhysicsWorldQuery> queries, WeakArray<PhysicsWorldQueryResult> results,
+						 ThreadHive* hive) const
+{
+	ANKI_ASSERT(queries.getSize() == results.getSize());
+
+	// Many batches per thread because the cost of the queries varies a lot
+	constexpr U32 MIN_QUERIES_PER_BATCH = 32;
+	const U32 maxBatchCount = (queries.getSize() + MIN_QUERIES_PER_BATCH - 1) / MIN_QUERIES_PER_BATCH;
+	const U32 batchCount = (hive) ? min(hive->getThreadCount() * 4, maxBatchCount) : 1;
+	if(batchCount <= 1)
+	{
+		queryInternal(queries, results);
+		return;
+	}
+
+	DynamicArrayAuto<QueryBatch> batches(m_alloc);
+	batches.create(batchCount);
+	DynamicArrayAuto<ThreadHiveTask> tasks(m_alloc);
+	tasks.create(batchCount);
+	for(U32 i = 0; i < batchCount; ++i)
+	{
+		const U32 begin = U32(U64(queries.getSize()) * i / batchCount);
+		const U32 end = U32(U64(queries.getSize()) * (i + 1) / batchCount);
+
+		QueryBatch& batch = batches[i];
+		batch.m_world = this;
+		batch.m_queries = ConstWeakArray<PhysicsWorldQuery>(&queries[begin], end - begin);
+		batch.m_results = WeakArray<PhysicsWorldQueryResult>(&results[begin], end - begin);
+
+		tasks[i] = ANKI_THREAD_HIVE_TASK({ self->m_world->queryInternal(self->m_queries, self->m_results); }, &batch,
+										 nullptr, nullptr);
+	}
+
+	hive->submitTasks(&tasks[0], batchCount);
+	hive->waitAllTasks();
+}
+
+void PhysicsWorld::queryInternal(ConstWeakArray<PhysicsWorldQuery> queries,
+								 WeakArray<PhysicsWorldQueryResult> results) const
+{
+	// The overlap tests need their own dispatcher because the dispatcher of the world is not thread-safe
+	ClassWrapper<btCollisionDispatcher> dispatcher;
+	Bool dispatcherInitialized = false;
+
+	for(U32 i = 0; i < queries.getSize(); ++i)
+	{
+		const PhysicsWorldQuery& q = queries[i];
+		PhysicsWorldQueryResult& result = results[i];
+		result = PhysicsWorldQueryResult();
+
+		switch(q.m_type)
+		{
+		case PhysicsWorldQueryType::RAY:
+		{
+			PhysicsWorldQueryRayCallback callback(q);
+			m_world->rayTest(toBt(q.m_from), toBt(q.m_to), callback);
+			if(callback.hasHit())
+			{
+				result.m_object = getFilteredObject(callback.m_collisionObject);
+				result.m_position = toAnki(callback.m_hitPointWorld);
+				result.m_normal = toAnki(callback.m_hitNormalWorld.normalized());
+				result.m_fraction = callback.m_closestHitFraction;
+			}
+			break;
+		}
+		case PhysicsWorldQueryType::SPHERE_SWEEP:
+		case PhysicsWorldQueryType::CAPSULE_SWEEP:
+		{
+			btSphereShape sphere(q.m_radius);
+			btCapsuleShape capsule(q.m_radius, q.m_halfHeight * 2.0f);
+			const btConvexShape* shape = (q.m_type == PhysicsWorldQueryType::SPHERE_SWEEP)
+											 ? static_cast<const btConvexShape*>(&sphere)
+											 : static_cast<const btConvexShape*>(&capsule);
+
+			const btTransform from(btMatrix3x3::getIdentity(), toBt(q.m_from));
+			const btTransform to(btMatrix3x3::getIdentity(), toBt(q.m_to));
+			PhysicsWorldQuerySweepCallback callback(q);
+			m_world->convexSweepTest(shape, from, to, callback);
+			if(callback.hasHit())
+			{
+				result.m_object = getFilteredObject(callback.m_hitCollisionObject);
+				result.m_position = toAnki(callback.m_hitPointWorld);
+				result.m_normal = toAnki(callback.m_hitNormalWorld.normalized());
+				result.m_fraction = callback.m_closestHitFraction;
+			}
+			break;
+		}
+		case PhysicsWorldQueryType::SPHERE_OVERLAP:
+		{
+			if(!dispatcherInitialized)
+			{
+				dispatcher.init(const_cast<btDefaultCollisionConfiguration*>(m_collisionConfig.get()));
+				btGImpactCollisionAlgorithm::registerAlgorithm(dispatcher.get());
+				dispatcherInitialized = true;
+			}
+
+			btSphereShape sphere(q.m_radius);
+			btCollisionObject queryObject;
+			queryObject.setCollisionShape(&sphere);
+			queryObject.setWorldTransform(btTransform(btMatrix3x3::getIdentity(), toBt(q.m_from)));
+
+			PhysicsWorldQueryOverlapCallback callback;
+			callback.m_world = m_world;
+			callback.m_dispatcher = dispatcher.get();
+			callback.m_queryObject = &queryObject;
+			callback.m_materialMask = q.m_materialMask;
+			callback.m_result = &result;
+
+			btVector3 aabbMin, aabbMax;
+			sphere.getAabb(queryObject.getWorldTransform(), aabbMin, aabbMax);
+			m_world->getBroadphase()->aabbTest(aabbMin, aabbMax, callback);
+			break;
+		}
+		default:
+			ANKI_ASSERT(0);
+		}
+	}
+
+	if(dispatcherInitialized)
+	{
+		dispatcher.destroy();
+	}
+}
+
 PhysicsTriggerFilteredPair* PhysicsWorld::getOrCreatePhysicsTriggerFilteredPair(PhysicsTrigger* trigger,
 																				PhysicsFilteredObject* filtered,
 																				Bool& isNew)
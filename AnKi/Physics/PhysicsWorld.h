@@ -13,6 +13,9 @@
 
 namespace anki {
 
+// Forward
+class ThreadHive;
+
 /// @addtogroup physics
 /// @{
 
@@ -36,6 +39,37 @@ public:
 	virtual void processResult(PhysicsFilteredObject& obj, const Vec3& worldNormal, const Vec3& worldPosition) = 0;
 };
 
+/// The type of a PhysicsWorldQuery.
+enum class PhysicsWorldQueryType : U8
+{
+	RAY, ///< Closest hit of a ray.
+	SPHERE_SWEEP, ///< Closest hit of a moving sphere.
+	CAPSULE_SWEEP, ///< Closest hit of a moving capsule. The capsule is aligned to the Y axis.
+	SPHERE_OVERLAP ///< Any object that overlaps a sphere.
+};
+
+/// A query for PhysicsWorld::query.
+class PhysicsWorldQuery
+{
+public:
+	Vec3 m_from;
+	Vec3 m_to; ///< Ignored by the overlap tests.
+	F32 m_radius = 0.0f; ///< The radius of the sphere or the capsule.
+	F32 m_halfHeight = 0.0f; ///< Half the height of the cylinder part of the capsule.
+	PhysicsMaterialBit m_materialMask = PhysicsMaterialBit::ALL; ///< Materials to check.
+	PhysicsWorldQueryType m_type = PhysicsWorldQueryType::RAY;
+};
+
+/// The result of a PhysicsWorldQuery.
+class PhysicsWorldQueryResult
+{
+public:
+	PhysicsFilteredObject* m_object = nullptr; ///< The object that got hit or nullptr if nothing got hit.
+	Vec3 m_position = Vec3(0.0f); ///< The hit point in world space.
+	Vec3 m_normal = Vec3(0.0f); ///< The normal of the object at m_position in world space.
+	F32 m_fraction = 1.0f; ///< Where between m_from and m_to the hit happened. 0.0 for the overlaps.
+};
+
 /// The master container for all physics related stuff.
 class PhysicsWorld
 {
@@ -43,7 +77,9 @@ public:
 	PhysicsWorld();
 	~PhysicsWorld();
 
-	ANKI_USE_RESULT Error init(AllocAlignedCallback allocCb, void* allocCbData);
+	/// @param hive If not nullptr the world will be stepped in parallel using the threads of the hive. The hive should
+	///             be idle when update() is called.
+	ANKI_USE_RESULT Error init(AllocAlignedCallback allocCb, void* allocCbData, ThreadHive* hive = nullptr);
 
 	template<typename T, typename... TArgs>
 	PhysicsPtr<T> newInstance(TArgs&&... args)
@@ -86,6 +122,14 @@ public:
 
 	void rayCast(WeakArray<PhysicsWorldRayCastCallback*> rayCasts) const;
 
+	/// Run a batch of queries against the world. It's thread-safe as long as update() doesn't run at the same time.
+	/// @param queries The queries.
+	/// @param results One result for every query.
+	/// @param hive If not nullptr the queries will be split among the threads of the hive. It will wait for all the
+	///             tasks of the hive.
+	void query(ConstWeakArray<PhysicsWorldQuery> queries, WeakArray<PhysicsWorldQueryResult> results,
+			   ThreadHive* hive = nullptr) const;
+
 	void rayCast(PhysicsWorldRayCastCallback& raycast) const
 	{
 		PhysicsWorldRayCastCallback* ptr = &raycast;
@@ -116,6 +160,8 @@ public:
 private:
 	class MyOverlapFilterCallback;
 	class MyRaycastCallback;
+	class MyTaskScheduler;
+	class QueryBatch;
 
 	HeapAllocator<U8> m_alloc;
 	StackAllocator<U8> m_tmpAlloc;
@@ -125,9 +171,11 @@ private:
 	MyOverlapFilterCallback* m_filterCallback = nullptr;
 
 	ClassWrapper<btDefaultCollisionConfiguration> m_collisionConfig;
-	ClassWrapper<btCollisionDispatcher> m_dispatcher;
-	ClassWrapper<btSequentialImpulseConstraintSolver> m_solver;
-	ClassWrapper<btDiscreteDynamicsWorld> m_world;
+	btCollisionDispatcher* m_dispatcher = nullptr;
+	btConstraintSolver* m_solver = nullptr;
+	btConstraintSolver* m_solverMt = nullptr; ///< Solves the large islands. Only when multithreaded.
+	btDiscreteDynamicsWorld* m_world = nullptr;
+	MyTaskScheduler* m_taskScheduler = nullptr;
 
 	Array<IntrusiveList<PhysicsObject>, U(PhysicsObjectType::COUNT)> m_objectLists;
 	IntrusiveList<PhysicsObject> m_markedForCreation;
@@ -139,6 +187,9 @@ private:
 #endif
 
 	void destroyMarkedForDeletion();
+
+	/// Run some queries serially.
+	void queryInternal(ConstWeakArray<PhysicsWorldQuery> queries, WeakArray<PhysicsWorldQueryResult> results) const;
 };
 /// @}
 
@@ -7,6 +7,7 @@
 #include <AnKi/Renderer/RenderQueue.h>
 #include <AnKi/Resource/ImageResource.h>
 #include <AnKi/Renderer/Renderer.h>
+#include <AnKi/Core/GpuMemoryPools.h>
 #include <AnKi/Util/Tracer.h>
 #include <AnKi/Util/Logger.h>
 #include <AnKi/Shaders/Include/MaterialTypes.h>
@@ -25,6 +26,8 @@ public:
 	Array<U8, MAX_INSTANCE_COUNT> m_cachedRenderElementLods;
 	Array<const void*, MAX_INSTANCE_COUNT> m_userData;
 	U32 m_cachedRenderElementCount = 0;
+	U32 m_firstCachedRenderElementSlot = 0;
+	RenderableDrawerGpuCullingInfo* m_gpuCulling = nullptr;
 	U8 m_minLod = 0;
 	U8 m_maxLod = 0;
 };
@@ -41,7 +44,8 @@ RenderableDrawer::~RenderableDrawer()
 
 void RenderableDrawer::drawRange(Pass pass, const Mat4& viewMat, const Mat4& viewProjMat, const Mat4& prevViewProjMat,
 								 CommandBufferPtr cmdb, SamplerPtr sampler, const RenderableQueueElement* begin,
-								 const RenderableQueueElement* end, U32 minLod, U32 maxLod)
+								 const RenderableQueueElement* end, U32 minLod, U32 maxLod,
+								 RenderableDrawerGpuCullingInfo* gpuCulling)
 {
 	ANKI_ASSERT(begin && end && begin < end);
 
@@ -72,10 +76,12 @@ void RenderableDrawer::drawRange(Pass pass, const Mat4& viewMat, const Mat4& vie
 	ctx.m_queueCtx.m_globalUniforms.m_buffer = globalUniformsToken.m_buffer;
 	ctx.m_queueCtx.m_globalUniforms.m_offset = globalUniformsToken.m_offset;
 	ctx.m_queueCtx.m_globalUniforms.m_range = globalUniformsToken.m_range;
+	ctx.m_queueCtx.m_gpuSceneBuffer = m_r->getGpuSceneMemory().getBuffer();
 
 	ANKI_ASSERT(minLod < MAX_LOD_COUNT && maxLod < MAX_LOD_COUNT);
 	ctx.m_minLod = U8(minLod);
 	ctx.m_maxLod = U8(maxLod);
+	ctx.m_gpuCulling = gpuCulling;
 
 	for(; begin != end; ++begin)
 	{
@@ -93,9 +99,28 @@ void RenderableDrawer::flushDrawcall(DrawContext& ctx)
 	ctx.m_queueCtx.m_key.setLod(ctx.m_cachedRenderElementLods[0]);
 	ctx.m_queueCtx.m_key.setInstanceCount(ctx.m_cachedRenderElementCount);
 
+	if(ctx.m_gpuCulling)
+	{
+		// The callback will fill the rest if it supports indirect drawcalls
+		const U32 slot = ctx.m_firstCachedRenderElementSlot;
+		GpuCullingDraw& draw = ctx.m_gpuCulling->m_draws[slot];
+		draw.m_instanceCount = ctx.m_cachedRenderElementCount;
+
+		ctx.m_queueCtx.m_indirectDraw.m_buffer = ctx.m_gpuCulling->m_indirectArgsBuffer;
+		ctx.m_queueCtx.m_indirectDraw.m_offset = slot * sizeof(GpuCullingDrawIndexedIndirectArgs);
+		ctx.m_queueCtx.m_indirectDraw.m_draw = &draw;
+	}
+
 	ctx.m_cachedRenderElements[0].m_callback(
 		ctx.m_queueCtx, ConstWeakArray<void*>(const_cast<void**>(&ctx.m_userData[0]), ctx.m_cachedRenderElementCount));
 
+	if(ctx.m_gpuCulling && ctx.m_queueCtx.m_indirectDraw.m_draw->m_indexCount > 0)
+	{
+		// The callback drew indirectly, add it to the drawcalls the GPU will cull
+		const U32 idx = ctx.m_gpuCulling->m_drawCount.fetchAdd(1);
+		ctx.m_gpuCulling->m_drawSlots[idx] = ctx.m_firstCachedRenderElementSlot;
+	}
+
 	// Rendered something, reset the cached transforms
 	if(ctx.m_cachedRenderElementCount > 1)
 	{
@@ -125,6 +150,25 @@ void RenderableDrawer::drawSingle(DrawContext& ctx)
 		flushDrawcall(ctx);
 	}
 
+	if(ctx.m_gpuCulling)
+	{
+		// Every element has a slot. Assume it's not the 1st of a drawcall, flushDrawcall will say otherwise
+		const U32 slot = U32(&rqel - ctx.m_gpuCulling->m_firstElement);
+
+		GpuCullingInstance& instance = ctx.m_gpuCulling->m_instances[slot];
+		instance.m_aabbMin = rqel.m_aabbMin;
+		instance.m_aabbMax = rqel.m_aabbMax;
+
+		GpuCullingDraw& draw = ctx.m_gpuCulling->m_draws[slot];
+		draw.m_instanceCount = 0;
+		draw.m_indexCount = 0;
+
+		if(ctx.m_cachedRenderElementCount == 0)
+		{
+			ctx.m_firstCachedRenderElementSlot = slot;
+		}
+	}
+
 	// Cache the new one
 	ctx.m_cachedRenderElements[ctx.m_cachedRenderElementCount] = rqel;
 	ctx.m_cachedRenderElementLods[ctx.m_cachedRenderElementCount] = overridenLod;
@@ -8,6 +8,7 @@
 #include <AnKi/Renderer/Common.h>
 #include <AnKi/Resource/RenderingKey.h>
 #include <AnKi/Gr.h>
+#include <AnKi/Shaders/Include/GpuCullingTypes.h>
 
 namespace anki {
 
@@ -18,6 +19,22 @@ class DrawContext;
 /// @addtogroup renderer
 /// @{
 
+/// The info RenderableDrawer::drawRange needs to build drawcalls that will be culled on the GPU. Every renderable has a
+/// slot in the arrays below and a merged drawcall uses the slots of its renderables.
+class RenderableDrawerGpuCullingInfo
+{
+public:
+	const RenderableQueueElement* m_firstElement = nullptr; ///< The element that has the 1st slot.
+	WeakArray<GpuCullingInstance> m_instances;
+	WeakArray<GpuCullingDraw> m_draws;
+	BufferPtr m_indirectArgsBuffer; ///< Holds GpuCullingDrawIndexedIndirectArgs, one per slot.
+
+	/// The slots of the indirect drawcalls. The drawer appends to it from many threads so it's filled up to m_drawCount
+	/// and in no particular order.
+	WeakArray<U32> m_drawSlots;
+	Atomic<U32> m_drawCount = {0};
+};
+
 /// It uses the render queue to batch and render.
 class RenderableDrawer
 {
@@ -31,9 +48,11 @@ public:
 
 	~RenderableDrawer();
 
+	/// @param gpuCulling If it's not nullptr the drawcalls that support it will be indirect and culled on the GPU.
 	void drawRange(Pass pass, const Mat4& viewMat, const Mat4& viewProjMat, const Mat4& prevViewProjMat,
 				   CommandBufferPtr cmdb, SamplerPtr sampler, const RenderableQueueElement* begin,
-				   const RenderableQueueElement* end, U32 minLod = 0, U32 maxLod = MAX_LOD_COUNT - 1);
+				   const RenderableQueueElement* end, U32 minLod = 0, U32 maxLod = MAX_LOD_COUNT - 1,
+				   RenderableDrawerGpuCullingInfo* gpuCulling = nullptr);
 
 private:
 	Renderer* m_r;
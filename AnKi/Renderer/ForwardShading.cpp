@@ -12,6 +12,7 @@
 #include <AnKi/Renderer/DepthDownscale.h>
 #include <AnKi/Renderer/LensFlare.h>
 #include <AnKi/Renderer/VolumetricLightingAccumulation.h>
+#include <AnKi/Renderer/GpuSceneUpload.h>
 
 namespace anki {
 
@@ -67,6 +68,7 @@ void ForwardShading::setDependencies(const RenderingContext& ctx, GraphicsRender
 {
 	pass.newDependency({m_r->getDepthDownscale().getHiZRt(), TextureUsageBit::SAMPLED_FRAGMENT, HIZ_HALF_DEPTH});
 	pass.newDependency({m_r->getVolumetricLightingAccumulation().getRt(), TextureUsageBit::SAMPLED_FRAGMENT});
+	pass.newDependency({m_r->getGpuSceneUpload().getGpuSceneBufferHandle(), BufferUsageBit::STORAGE_GEOMETRY_READ});
 
 	if(ctx.m_renderQueue->m_lensFlares.getSize())
 	{
@@ -7,6 +7,8 @@
 #include <AnKi/Renderer/Renderer.h>
 #include <AnKi/Renderer/RenderQueue.h>
 #include <AnKi/Renderer/VrsSriGeneration.h>
+#include <AnKi/Renderer/GpuCulling.h>
+#include <AnKi/Renderer/GpuSceneUpload.h>
 #include <AnKi/Util/Logger.h>
 #include <AnKi/Util/Tracer.h>
 #include <AnKi/Core/ConfigSet.h>
@@ -154,7 +156,8 @@ void GBuffer::runInThread(const RenderingContext& ctx, RenderPassWorkContext& rg
 										ctx.m_matrices.m_jitter * ctx.m_prevMatrices.m_viewProjection, cmdb,
 										m_r->getSamplers().m_trilinearRepeatAnisoResolutionScalingBias,
 										ctx.m_renderQueue->m_renderables.getBegin() + colorStart,
-										ctx.m_renderQueue->m_renderables.getBegin() + colorEnd);
+										ctx.m_renderQueue->m_renderables.getBegin() + colorEnd, 0, MAX_LOD_COUNT - 1,
+										m_r->getGpuCulling().getDrawerInfo());
 	}
 }
 
@@ -238,6 +241,15 @@ void GBuffer::populateRenderGraph(RenderingContext& ctx)
 	{
 		pass.newDependency(RenderPassDependency(sriRt, TextureUsageBit::FRAMEBUFFER_SHADING_RATE));
 	}
+
+	pass.newDependency(RenderPassDependency(m_r->getGpuSceneUpload().getGpuSceneBufferHandle(),
+											BufferUsageBit::STORAGE_GEOMETRY_READ));
+
+	const BufferHandle indirectArgsHandle = m_r->getGpuCulling().getIndirectArgsBufferHandle();
+	if(indirectArgsHandle.isValid())
+	{
+		pass.newDependency(RenderPassDependency(indirectArgsHandle, BufferUsageBit::INDIRECT_DRAW));
+	}
 }
 
 } // end namespace anki
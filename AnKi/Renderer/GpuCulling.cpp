@@ -0,0 +1,240 @@
+// Copyright (C) 2009-2022, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Renderer/GpuCulling.h>
+#include <AnKi/Renderer/Renderer.h>
+#include <AnKi/Renderer/RenderQueue.h>
+#include <AnKi/Renderer/DepthDownscale.h>
+#include <AnKi/Core/ConfigSet.h>
+#include <AnKi/Util/Tracer.h>
+#include <AnKi/Shaders/Include/GpuCullingFunctions.h>
+
+namespace anki {
+
+static_assert(sizeof(GpuCullingDrawIndexedIndirectArgs) == sizeof(DrawElementsIndirectInfo), "See file");
+
+GpuCulling::~GpuCulling()
+{
+}
+
+Error GpuCulling::init()
+{
+	const Error err = initInternal();
+	if(err)
+	{
+		ANKI_R_LOGE("Failed to initialize GPU culling");
+	}
+
+	return err;
+}
+
+Error GpuCulling::initInternal()
+{
+	if(!getGrManager().getDeviceCapabilities().m_multiDrawIndirect)
+	{
+		ANKI_R_LOGV("Multi-draw indirect is not supported. GPU culling will be disabled");
+		return Error::NONE;
+	}
+
+	ANKI_R_LOGV("Initializing GPU culling");
+
+	ANKI_CHECK(getResourceManager().loadResource("Shaders/GpuCulling.ankiprog", m_prog));
+	const ShaderProgramResourceVariant* variant;
+	m_prog->getOrCreateVariant(variant);
+	m_grProg = variant->getProgram();
+
+	return Error::NONE;
+}
+
+void GpuCulling::populateRenderGraph(RenderingContext& ctx)
+{
+	m_runCtx.m_indirectArgsBuffHandle = {};
+
+	const U32 slotCount = ctx.m_renderQueue->m_renderables.getSize();
+	if(!m_grProg.isCreated() || !getConfig().getRGpuDrivenDrawcalls() || slotCount == 0)
+	{
+		return;
+	}
+
+	ANKI_TRACE_SCOPED_EVENT(R_GPU_CULLING);
+
+	// Allocate the memory the drawer will fill
+	m_runCtx.m_slotCount = slotCount;
+	RenderableDrawerGpuCullingInfo& info = m_runCtx.m_drawerInfo;
+	info.m_firstElement = ctx.m_renderQueue->m_renderables.getBegin();
+	info.m_instances = WeakArray<GpuCullingInstance>(
+		allocateStorage<GpuCullingInstance*>(slotCount * sizeof(GpuCullingInstance), m_runCtx.m_instancesToken),
+		slotCount);
+	info.m_draws = WeakArray<GpuCullingDraw>(
+		allocateStorage<GpuCullingDraw*>(slotCount * sizeof(GpuCullingDraw), m_runCtx.m_drawsToken), slotCount);
+	info.m_drawSlots =
+		WeakArray<U32>(allocateStorage<U32*>(slotCount * sizeof(U32), m_runCtx.m_drawSlotsToken), slotCount);
+	info.m_drawCount.setNonAtomically(0);
+
+	// Grow the indirect buffer if needed. The previous frames will hold a reference to the old one
+	const PtrSize argsSize = slotCount * sizeof(GpuCullingDrawIndexedIndirectArgs);
+	if(!m_indirectArgsBuff.isCreated() || m_indirectArgsBuff->getSize() < argsSize)
+	{
+		BufferInitInfo buffInit("GpuCullingIndirectArgs");
+		buffInit.m_size = nextPowerOfTwo(argsSize);
+		buffInit.m_usage = BufferUsageBit::STORAGE_COMPUTE_WRITE | BufferUsageBit::INDIRECT_DRAW
+						   | BufferUsageBit::TRANSFER_DESTINATION;
+		m_indirectArgsBuff = getGrManager().newBuffer(buffInit);
+	}
+
+	info.m_indirectArgsBuffer = m_indirectArgsBuff;
+
+	// Create the pass
+	RenderGraphDescription& rgraph = ctx.m_renderGraphDescr;
+	// The buffer is persistent and the previous frame used it for drawing. Import it with that usage so there is a
+	// barrier between the previous draws and the writes of this frame
+	m_runCtx.m_indirectArgsBuffHandle = rgraph.importBuffer(m_indirectArgsBuff, BufferUsageBit::INDIRECT_DRAW);
+
+	ComputeRenderPassDescription& pass = rgraph.newComputeRenderPass("GPU culling");
+
+	// The instances and the drawcalls are written while the G-buffer second level command buffers are recorded and
+	// those are recorded before the first level ones. So by the time the work callback runs they are ready
+	if(getConfig().getRGpuCullingOnCpu())
+	{
+		pass.newDependency({m_runCtx.m_indirectArgsBuffHandle, BufferUsageBit::TRANSFER_DESTINATION});
+
+		pass.setWork([this, &ctx](RenderPassWorkContext& rgraphCtx) {
+			runOnCpu(ctx, rgraphCtx);
+		});
+	}
+	else
+	{
+		pass.newDependency({m_runCtx.m_indirectArgsBuffHandle, BufferUsageBit::STORAGE_COMPUTE_WRITE});
+		pass.newDependency({m_r->getDepthDownscale().getHiZRt(), TextureUsageBit::SAMPLED_COMPUTE});
+
+		pass.setWork([this, &ctx](RenderPassWorkContext& rgraphCtx) {
+			runOnGpu(ctx, rgraphCtx);
+		});
+	}
+}
+
+void GpuCulling::runOnGpu(const RenderingContext& ctx, RenderPassWorkContext& rgraphCtx)
+{
+	const U32 drawCount = m_runCtx.m_drawerInfo.m_drawCount.load();
+	if(drawCount == 0)
+	{
+		return;
+	}
+
+	CommandBufferPtr& cmdb = rgraphCtx.m_commandBuffer;
+
+	cmdb->bindShaderProgram(m_grProg);
+
+	GpuCullingUniforms* unis = allocateAndBindUniforms<GpuCullingUniforms*>(sizeof(GpuCullingUniforms), cmdb, 0, 0);
+	unis->m_previousViewProjectionMatrix = ctx.m_prevMatrices.m_viewProjectionJitter;
+	unis->m_hizSize = m_r->getInternalResolution() / 2;
+	// The HiZ has garbage in the 1st frame
+	unis->m_hizMipCount = (m_r->getFrameCount() > 0) ? m_r->getDepthDownscale().getMipmapCount() : 0;
+	unis->m_drawCount = drawCount;
+
+	bindStorage(cmdb, 0, 1, m_runCtx.m_instancesToken);
+	bindStorage(cmdb, 0, 2, m_runCtx.m_drawsToken);
+	bindStorage(cmdb, 0, 3, m_runCtx.m_drawSlotsToken);
+	rgraphCtx.bindStorageBuffer(0, 4, m_runCtx.m_indirectArgsBuffHandle);
+	cmdb->bindSampler(0, 5, m_r->getSamplers().m_nearestNearestClamp);
+	rgraphCtx.bindColorTexture(0, 6, m_r->getDepthDownscale().getHiZRt());
+
+	// One thread per drawcall
+	cmdb->dispatchCompute((drawCount + GPU_CULLING_WORKGROUP_SIZE - 1) / GPU_CULLING_WORKGROUP_SIZE, 1, 1);
+}
+
+void GpuCulling::runOnCpu(const RenderingContext& ctx, RenderPassWorkContext& rgraphCtx)
+{
+	ANKI_TRACE_SCOPED_EVENT(R_GPU_CULLING);
+	CommandBufferPtr& cmdb = rgraphCtx.m_commandBuffer;
+
+	// Use the HiZ the CPU has
+	F32* depthValues;
+	U32 width;
+	U32 height;
+	m_r->getDepthDownscale().getClientDepthMapInfo(depthValues, width, height);
+
+	GpuCullingUniforms unis;
+	unis.m_previousViewProjectionMatrix = ctx.m_prevMatrices.m_viewProjectionJitter;
+	unis.m_hizSize = UVec2(width, height);
+	unis.m_hizMipCount = 1;
+	unis.m_drawCount = m_runCtx.m_drawerInfo.m_drawCount.load();
+
+	ConstWeakArray<F32> hizDepths;
+	if(m_r->getFrameCount() > 0)
+	{
+		hizDepths = ConstWeakArray<F32>(depthValues, width * height);
+	}
+
+	StagingGpuMemoryToken argsToken;
+	GpuCullingDrawIndexedIndirectArgs* args = allocateStorage<GpuCullingDrawIndexedIndirectArgs*>(
+		m_runCtx.m_slotCount * sizeof(GpuCullingDrawIndexedIndirectArgs), argsToken);
+
+	cullOnCpu(unis, hizDepths, m_runCtx.m_drawerInfo.m_instances, m_runCtx.m_drawerInfo.m_draws,
+			  ConstWeakArray<U32>(m_runCtx.m_drawerInfo.m_drawSlots.getBegin(), unis.m_drawCount),
+			  WeakArray<GpuCullingDrawIndexedIndirectArgs>(args, m_runCtx.m_slotCount));
+
+	cmdb->copyBufferToBuffer(argsToken.m_buffer, argsToken.m_offset, m_indirectArgsBuff, 0,
+							 m_runCtx.m_slotCount * sizeof(GpuCullingDrawIndexedIndirectArgs));
+}
+
+void GpuCulling::cullOnCpu(const GpuCullingUniforms& unis, ConstWeakArray<F32> hizDepths,
+						   ConstWeakArray<GpuCullingInstance> instances, ConstWeakArray<GpuCullingDraw> draws,
+						   ConstWeakArray<U32> drawSlots, WeakArray<GpuCullingDrawIndexedIndirectArgs> indirectArgs)
+{
+	ANKI_ASSERT(instances.getSize() == draws.getSize() && draws.getSize() == indirectArgs.getSize());
+	ANKI_ASSERT(hizDepths.getSize() == 0 || hizDepths.getSize() == unis.m_hizSize.x() * unis.m_hizSize.y());
+	ANKI_ASSERT(drawSlots.getSize() == unis.m_drawCount);
+
+	for(U32 slot : drawSlots)
+	{
+		const GpuCullingDraw& draw = draws[slot];
+		ANKI_ASSERT(draw.m_instanceCount > 0 && draw.m_instanceCount <= MAX_INSTANCE_COUNT
+					&& slot + draw.m_instanceCount <= draws.getSize() && draw.m_indexCount > 0);
+
+		// Test the instances
+		UVec2 visibleMask(0u);
+		for(U32 i = 0; i < draw.m_instanceCount; ++i)
+		{
+			const GpuCullingInstance& instance = instances[slot + i];
+			const GpuCullingScreenBounds bounds = gpuCullingComputeScreenBounds(
+				instance.m_aabbMin, instance.m_aabbMax, unis.m_previousViewProjectionMatrix);
+
+			Bool visible = true;
+			if(hizDepths.getSize() > 0 && !bounds.m_crossesNearPlane)
+			{
+				// Take the max depth of all the texels the bounds touch
+				const U32 minX = min(U32(bounds.m_uvMin.x() * F32(unis.m_hizSize.x())), unis.m_hizSize.x() - 1);
+				const U32 maxX = min(U32(bounds.m_uvMax.x() * F32(unis.m_hizSize.x())), unis.m_hizSize.x() - 1);
+				const U32 minY = min(U32(bounds.m_uvMin.y() * F32(unis.m_hizSize.y())), unis.m_hizSize.y() - 1);
+				const U32 maxY = min(U32(bounds.m_uvMax.y() * F32(unis.m_hizSize.y())), unis.m_hizSize.y() - 1);
+
+				F32 maxDepth = 0.0f;
+				for(U32 y = minY; y <= maxY; ++y)
+				{
+					for(U32 x = minX; x <= maxX; ++x)
+					{
+						maxDepth = max(maxDepth, hizDepths[y * unis.m_hizSize.x() + x]);
+					}
+				}
+
+				visible = !gpuCullingIsOccluded(bounds, maxDepth);
+			}
+
+			if(visible)
+			{
+				visibleMask[i / 32] |= 1u << (i % 32);
+			}
+		}
+
+		// Compact
+		for(U32 i = 0; i < draw.m_instanceCount; ++i)
+		{
+			indirectArgs[slot + i] = gpuCullingBuildIndirectArgs(visibleMask, draw, i);
+		}
+	}
+}
+
+} // end namespace anki
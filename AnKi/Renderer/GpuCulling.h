@@ -0,0 +1,82 @@
+// Copyright (C) 2009-2022, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Renderer/RendererObject.h>
+#include <AnKi/Renderer/Drawer.h>
+#include <AnKi/Resource/ShaderProgramResource.h>
+
+namespace anki {
+
+/// @addtogroup renderer
+/// @{
+
+/// Culls the G-buffer renderables against the HiZ of the previous frame and builds indirect drawcalls out of the
+/// visible instances. The RenderableDrawer fills the instances and the drawcalls while recording the G-buffer and a
+/// compute pass that runs before the G-buffer writes the indirect commands.
+class GpuCulling : public RendererObject
+{
+public:
+	GpuCulling(Renderer* r)
+		: RendererObject(r)
+	{
+	}
+
+	~GpuCulling();
+
+	ANKI_USE_RESULT Error init();
+
+	/// Populate the rendergraph. Needs to be called before the G-buffer populates its own.
+	void populateRenderGraph(RenderingContext& ctx);
+
+	/// Returns nullptr if the GPU culling is disabled this frame.
+	RenderableDrawerGpuCullingInfo* getDrawerInfo()
+	{
+		return (m_runCtx.m_indirectArgsBuffHandle.isValid()) ? &m_runCtx.m_drawerInfo : nullptr;
+	}
+
+	/// Get it to set a dependency. It's invalid if the GPU culling is disabled this frame.
+	BufferHandle getIndirectArgsBufferHandle() const
+	{
+		return m_runCtx.m_indirectArgsBuffHandle;
+	}
+
+	/// The CPU version of the culling. Used for validation.
+	/// @param unis The m_hizSize is the size of hizDepths and the m_hizMipCount is ignored.
+	/// @param hizDepths A single level depth map that holds the max depth. If it's empty the occlusion test is skipped.
+	/// @param instances The instances, one per slot.
+	/// @param draws The drawcalls, one per slot.
+	/// @param drawSlots The slots of the drawcalls to cull. Its size should be equal to m_drawCount.
+	/// @param indirectArgs The output commands, one per slot. The slots of the rest of the drawcalls are not touched.
+	static void cullOnCpu(const GpuCullingUniforms& unis, ConstWeakArray<F32> hizDepths,
+						  ConstWeakArray<GpuCullingInstance> instances, ConstWeakArray<GpuCullingDraw> draws,
+						  ConstWeakArray<U32> drawSlots, WeakArray<GpuCullingDrawIndexedIndirectArgs> indirectArgs);
+
+private:
+	ShaderProgramResourcePtr m_prog;
+	ShaderProgramPtr m_grProg;
+
+	BufferPtr m_indirectArgsBuff;
+
+	class
+	{
+	public:
+		RenderableDrawerGpuCullingInfo m_drawerInfo;
+		StagingGpuMemoryToken m_instancesToken;
+		StagingGpuMemoryToken m_drawsToken;
+		StagingGpuMemoryToken m_drawSlotsToken;
+		BufferHandle m_indirectArgsBuffHandle;
+		U32 m_slotCount = 0;
+	} m_runCtx;
+
+	ANKI_USE_RESULT Error initInternal();
+
+	void runOnGpu(const RenderingContext& ctx, RenderPassWorkContext& rgraphCtx);
+	void runOnCpu(const RenderingContext& ctx, RenderPassWorkContext& rgraphCtx);
+};
+/// @}
+
+} // end namespace anki
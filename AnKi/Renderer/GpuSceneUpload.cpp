@@ -0,0 +1,52 @@
+// Copyright (C) 2009-2022, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Renderer/GpuSceneUpload.h>
+#include <AnKi/Renderer/Renderer.h>
+#include <AnKi/Core/GpuMemoryPools.h>
+#include <AnKi/Util/Tracer.h>
+
+namespace anki {
+
+GpuSceneUpload::~GpuSceneUpload()
+{
+}
+
+Error GpuSceneUpload::init()
+{
+	ANKI_CHECK(getResourceManager().loadResource("Shaders/GpuSceneMicroPatching.ankiprog", m_prog));
+	const ShaderProgramResourceVariant* variant;
+	m_prog->getOrCreateVariant(variant);
+	m_grProg = variant->getProgram();
+
+	return Error::NONE;
+}
+
+void GpuSceneUpload::populateRenderGraph(RenderingContext& ctx)
+{
+	RenderGraphDescription& rgraph = ctx.m_renderGraphDescr;
+
+	// The GPU scene is left in that state by the previous frame. The import will take care of the write-after-read
+	m_runCtx.m_gpuSceneBuffHandle =
+		rgraph.importBuffer(m_r->getGpuSceneMemory().getBuffer(), BufferUsageBit::STORAGE_GEOMETRY_READ);
+
+	if(!m_r->getGpuSceneMicroPatcher().patchingIsNeeded())
+	{
+		return;
+	}
+
+	ComputeRenderPassDescription& pass = rgraph.newComputeRenderPass("GPU scene patching");
+	pass.newDependency({m_runCtx.m_gpuSceneBuffHandle, BufferUsageBit::STORAGE_COMPUTE_WRITE});
+
+	pass.setWork([this](RenderPassWorkContext& rgraphCtx) {
+		CommandBufferPtr& cmdb = rgraphCtx.m_commandBuffer;
+
+		cmdb->bindShaderProgram(m_grProg);
+		m_r->getGpuSceneMicroPatcher().patchGpuScene(m_r->getStagingGpuMemory(), *cmdb,
+													 m_r->getGpuSceneMemory().getBuffer());
+	});
+}
+
+} // end namespace anki
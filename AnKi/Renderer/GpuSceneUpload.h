@@ -0,0 +1,50 @@
+// Copyright (C) 2009-2022, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Renderer/RendererObject.h>
+#include <AnKi/Resource/ShaderProgramResource.h>
+
+namespace anki {
+
+/// @addtogroup renderer
+/// @{
+
+/// Applies the GPU scene changes of the frame before anything else reads the GPU scene.
+class GpuSceneUpload : public RendererObject
+{
+public:
+	GpuSceneUpload(Renderer* r)
+		: RendererObject(r)
+	{
+	}
+
+	~GpuSceneUpload();
+
+	ANKI_USE_RESULT Error init();
+
+	/// Populate the rendergraph. Needs to be called before any other pass that reads the GPU scene.
+	void populateRenderGraph(RenderingContext& ctx);
+
+	/// Passes that read the GPU scene need to depend on it.
+	BufferHandle getGpuSceneBufferHandle() const
+	{
+		return m_runCtx.m_gpuSceneBuffHandle;
+	}
+
+private:
+	ShaderProgramResourcePtr m_prog;
+	ShaderProgramPtr m_grProg;
+
+	class
+	{
+	public:
+		BufferHandle m_gpuSceneBuffHandle;
+	} m_runCtx;
+};
+/// @}
+
+} // end namespace anki
@@ -6,6 +6,7 @@
 #include <AnKi/Renderer/IndirectDiffuseProbes.h>
 #include <AnKi/Renderer/Renderer.h>
 #include <AnKi/Renderer/RenderQueue.h>
+#include <AnKi/Renderer/GpuSceneUpload.h>
 #include <AnKi/Core/ConfigSet.h>
 #include <AnKi/Util/Tracer.h>
 #include <AnKi/Collision/Aabb.h>
@@ -285,6 +286,7 @@ void IndirectDiffuseProbes::populateRenderGraph(RenderingContext& rctx)
 
 		TextureSubresourceInfo subresource(DepthStencilAspectBit::DEPTH);
 		pass.newDependency({giCtx->m_gbufferDepthRt, TextureUsageBit::ALL_FRAMEBUFFER_ATTACHMENT, subresource});
+		pass.newDependency({m_r->getGpuSceneUpload().getGpuSceneBufferHandle(), BufferUsageBit::STORAGE_GEOMETRY_READ});
 	}
 
 	// Shadow pass. Optional
@@ -322,6 +324,7 @@ void IndirectDiffuseProbes::populateRenderGraph(RenderingContext& rctx)
 
 		TextureSubresourceInfo subresource(DepthStencilAspectBit::DEPTH);
 		pass.newDependency({giCtx->m_shadowsRt, TextureUsageBit::ALL_FRAMEBUFFER_ATTACHMENT, subresource});
+		pass.newDependency({m_r->getGpuSceneUpload().getGpuSceneBufferHandle(), BufferUsageBit::STORAGE_GEOMETRY_READ});
 	}
 	else
 	{
@@ -40,8 +40,9 @@ Error MainRenderer::init(const MainRendererInitInfo& inf)
 	m_rDrawToDefaultFb = inf.m_config->getRRenderScaling() == 1.0f;
 
 	m_r.reset(m_alloc.newInstance<Renderer>());
-	ANKI_CHECK(m_r->init(inf.m_threadHive, inf.m_resourceManager, inf.m_gr, inf.m_stagingMemory, inf.m_ui, m_alloc,
-						 inf.m_config, inf.m_globTimestamp, m_swapchainResolution));
+	ANKI_CHECK(m_r->init(inf.m_threadHive, inf.m_resourceManager, inf.m_gr, inf.m_stagingMemory,
+						 inf.m_gpuSceneMemory, inf.m_gpuSceneMicroPatcher, inf.m_ui, m_alloc, inf.m_config,
+						 inf.m_globTimestamp, m_swapchainResolution));
 
 	// Init other
 	if(!m_rDrawToDefaultFb)
@@ -79,7 +80,7 @@ Error MainRenderer::init(const MainRendererInitInfo& inf)
 
 Error MainRenderer::render(RenderQueue& rqueue, TexturePtr presentTex)
 {
-	ANKI_TRACE_SCOPED_EVENT(RENDER);
+	ANKI_TRACE_SCOPED_HW_EVENT(RENDER);
 
 	m_stats.m_renderingCpuTime = (m_statsEnabled) ? HighRezTimer::getCurrentTime() : -1.0;
 
@@ -15,6 +15,8 @@ namespace anki {
 class ResourceManager;
 class ConfigSet;
 class StagingGpuMemoryPool;
+class GpuSceneMemoryPool;
+class GpuSceneMicroPatcher;
 class UiManager;
 
 /// @addtogroup renderer
@@ -41,6 +43,8 @@ public:
 	ResourceManager* m_resourceManager = nullptr;
 	GrManager* m_gr = nullptr;
 	StagingGpuMemoryPool* m_stagingMemory = nullptr;
+	GpuSceneMemoryPool* m_gpuSceneMemory = nullptr;
+	GpuSceneMicroPatcher* m_gpuSceneMicroPatcher = nullptr;
 	UiManager* m_ui = nullptr;
 	ConfigSet* m_config = nullptr;
 	Timestamp* m_globTimestamp = nullptr;
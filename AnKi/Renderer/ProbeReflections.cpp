@@ -8,6 +8,7 @@
 #include <AnKi/Renderer/FinalComposite.h>
 #include <AnKi/Renderer/GBuffer.h>
 #include <AnKi/Renderer/RenderQueue.h>
+#include <AnKi/Renderer/GpuSceneUpload.h>
 #include <AnKi/Core/ConfigSet.h>
 #include <AnKi/Util/Tracer.h>
 #include <AnKi/Resource/MeshResource.h>
@@ -541,6 +542,7 @@ void ProbeReflections::populateRenderGraph(RenderingContext& rctx)
 
 		TextureSubresourceInfo subresource(DepthStencilAspectBit::DEPTH);
 		pass.newDependency({m_ctx.m_gbufferDepthRt, TextureUsageBit::ALL_FRAMEBUFFER_ATTACHMENT, subresource});
+		pass.newDependency({m_r->getGpuSceneUpload().getGpuSceneBufferHandle(), BufferUsageBit::STORAGE_GEOMETRY_READ});
 	}
 
 	// Shadow pass. Optional
@@ -585,6 +587,7 @@ void ProbeReflections::populateRenderGraph(RenderingContext& rctx)
 
 		TextureSubresourceInfo subresource(DepthStencilAspectBit::DEPTH);
 		pass.newDependency({m_ctx.m_shadowMapRt, TextureUsageBit::ALL_FRAMEBUFFER_ATTACHMENT, subresource});
+		pass.newDependency({m_r->getGpuSceneUpload().getGpuSceneBufferHandle(), BufferUsageBit::STORAGE_GEOMETRY_READ});
 	}
 	else
 	{
@@ -10,6 +10,7 @@
 #include <AnKi/Ui/Canvas.h>
 #include <AnKi/Shaders/Include/ClusteredShadingTypes.h>
 #include <AnKi/Shaders/Include/ModelTypes.h>
+#include <AnKi/Shaders/Include/GpuCullingTypes.h>
 
 namespace anki {
 
@@ -53,6 +54,19 @@ public:
 		PtrSize m_offset;
 		PtrSize m_range;
 	} m_globalUniforms; ///< Points to a MaterialGlobalUniforms structure.
+
+	BufferPtr m_gpuSceneBuffer; ///< The buffer that holds the GpuSceneRenderable structures.
+
+	/// If m_buffer is valid the callback may replace its drawcall with a drawElementsIndirect that has one command per
+	/// instance starting from m_offset. The GPU will cull the instances and write the commands. If the callback does
+	/// that it should write the index count and the first index into m_draw.
+	class
+	{
+	public:
+		BufferPtr m_buffer;
+		PtrSize m_offset = 0;
+		GpuCullingDraw* m_draw = nullptr;
+	} m_indirectDraw;
 };
 
 /// Draw callback for drawing.
@@ -73,6 +87,9 @@ public:
 
 	U8 m_lod; ///< Don't set this. Visibility will.
 
+	Vec3 m_aabbMin; ///< World space. Don't set this. Visibility will.
+	Vec3 m_aabbMax; ///< World space. Don't set this. Visibility will.
+
 	RenderableQueueElement()
 	{
 	}
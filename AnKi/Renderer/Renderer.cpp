@@ -42,6 +42,8 @@
 #include <AnKi/Renderer/Scale.h>
 #include <AnKi/Renderer/IndirectDiffuse.h>
 #include <AnKi/Renderer/VrsSriGeneration.h>
+#include <AnKi/Renderer/GpuCulling.h>
+#include <AnKi/Renderer/GpuSceneUpload.h>
 
 namespace anki {
 
@@ -61,8 +63,8 @@ Renderer::~Renderer()
 }
 
 Error Renderer::init(ThreadHive* hive, ResourceManager* resources, GrManager* gl, StagingGpuMemoryPool* stagingMem,
-					 UiManager* ui, HeapAllocator<U8> alloc, ConfigSet* config, Timestamp* globTimestamp,
-					 UVec2 swapchainSize)
+					 GpuSceneMemoryPool* gpuSceneMem, GpuSceneMicroPatcher* gpuSceneMicroPatcher, UiManager* ui,
+					 HeapAllocator<U8> alloc, ConfigSet* config, Timestamp* globTimestamp, UVec2 swapchainSize)
 {
 	ANKI_TRACE_SCOPED_EVENT(R_INIT);
 
@@ -71,6 +73,8 @@ Error Renderer::init(ThreadHive* hive, ResourceManager* resources, GrManager* gl
 	m_resources = resources;
 	m_gr = gl;
 	m_stagingMem = stagingMem;
+	m_gpuSceneMem = gpuSceneMem;
+	m_gpuSceneMicroPatcher = gpuSceneMicroPatcher;
 	m_ui = ui;
 	m_alloc = alloc;
 	m_config = config;
@@ -137,6 +141,9 @@ Error Renderer::initInternal(UVec2 swapchainResolution)
 	ANKI_CHECK(m_resources->loadResource("Shaders/ClearTextureCompute.ankiprog", m_clearTexComputeProg));
 
 	// Init the stages. Careful with the order!!!!!!!!!!
+	m_gpuSceneUpload.reset(m_alloc.newInstance<GpuSceneUpload>(this));
+	ANKI_CHECK(m_gpuSceneUpload->init());
+
 	m_genericCompute.reset(m_alloc.newInstance<GenericCompute>(this));
 	ANKI_CHECK(m_genericCompute->init());
 
@@ -152,6 +159,9 @@ Error Renderer::initInternal(UVec2 swapchainResolution)
 	m_vrsSriGeneration.reset(m_alloc.newInstance<VrsSriGeneration>(this));
 	ANKI_CHECK(m_vrsSriGeneration->init());
 
+	m_gpuCulling.reset(m_alloc.newInstance<GpuCulling>(this));
+	ANKI_CHECK(m_gpuCulling->init());
+
 	m_gbuffer.reset(m_alloc.newInstance<GBuffer>(this));
 	ANKI_CHECK(m_gbuffer->init());
 
@@ -336,6 +346,7 @@ Error Renderer::populateRenderGraph(RenderingContext& ctx)
 	m_vrsSriGeneration->importRenderTargets(ctx);
 
 	// Populate render graph. WARNING Watch the order
+	m_gpuSceneUpload->populateRenderGraph(ctx);
 	m_genericCompute->populateRenderGraph(ctx);
 	m_clusterBinning->populateRenderGraph(ctx);
 	if(m_accelerationStructureBuilder)
@@ -346,6 +357,7 @@ Error Renderer::populateRenderGraph(RenderingContext& ctx)
 	m_indirectDiffuseProbes->populateRenderGraph(ctx);
 	m_probeReflections->populateRenderGraph(ctx);
 	m_volumetricLightingAccumulation->populateRenderGraph(ctx);
+	m_gpuCulling->populateRenderGraph(ctx);
 	m_gbuffer->populateRenderGraph(ctx);
 	m_motionVectors->populateRenderGraph(ctx);
 	m_gbufferPost->populateRenderGraph(ctx);
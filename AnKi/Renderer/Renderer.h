@@ -19,6 +19,8 @@ namespace anki {
 class ConfigSet;
 class ResourceManager;
 class StagingGpuMemoryPool;
+class GpuSceneMemoryPool;
+class GpuSceneMicroPatcher;
 class UiManager;
 
 /// @addtogroup renderer
@@ -73,7 +75,8 @@ public:
 
 	/// Init the renderer.
 	ANKI_USE_RESULT Error init(ThreadHive* hive, ResourceManager* resources, GrManager* gr,
-							   StagingGpuMemoryPool* stagingMem, UiManager* ui, HeapAllocator<U8> alloc,
+							   StagingGpuMemoryPool* stagingMem, GpuSceneMemoryPool* gpuSceneMem,
+							   GpuSceneMicroPatcher* gpuSceneMicroPatcher, UiManager* ui, HeapAllocator<U8> alloc,
 							   ConfigSet* config, Timestamp* globTimestamp, UVec2 swapchainSize);
 
 	/// This function does all the rendering stages and produces a final result.
@@ -176,6 +179,18 @@ public:
 		return *m_stagingMem;
 	}
 
+	GpuSceneMemoryPool& getGpuSceneMemory()
+	{
+		ANKI_ASSERT(m_gpuSceneMem);
+		return *m_gpuSceneMem;
+	}
+
+	GpuSceneMicroPatcher& getGpuSceneMicroPatcher()
+	{
+		ANKI_ASSERT(m_gpuSceneMicroPatcher);
+		return *m_gpuSceneMicroPatcher;
+	}
+
 	ThreadHive& getThreadHive()
 	{
 		ANKI_ASSERT(m_threadHive);
@@ -230,6 +245,8 @@ private:
 	ResourceManager* m_resources = nullptr;
 	ThreadHive* m_threadHive = nullptr;
 	StagingGpuMemoryPool* m_stagingMem = nullptr;
+	GpuSceneMemoryPool* m_gpuSceneMem = nullptr;
+	GpuSceneMicroPatcher* m_gpuSceneMicroPatcher = nullptr;
 	GrManager* m_gr = nullptr;
 	UiManager* m_ui = nullptr;
 	Timestamp* m_globTimestamp = nullptr;
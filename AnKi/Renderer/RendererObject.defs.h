@@ -4,6 +4,8 @@
 // http://www.anki3d.org/LICENSE
 
 ANKI_RENDERER_OBJECT_DEF(GBuffer, gbuffer)
+ANKI_RENDERER_OBJECT_DEF(GpuCulling, gpuCulling)
+ANKI_RENDERER_OBJECT_DEF(GpuSceneUpload, gpuSceneUpload)
 ANKI_RENDERER_OBJECT_DEF(GBufferPost, gbufferPost)
 ANKI_RENDERER_OBJECT_DEF(ShadowMapping, shadowMapping)
 ANKI_RENDERER_OBJECT_DEF(LightShading, lightShading)
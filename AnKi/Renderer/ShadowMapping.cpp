@@ -6,6 +6,7 @@
 #include <AnKi/Renderer/ShadowMapping.h>
 #include <AnKi/Renderer/Renderer.h>
 #include <AnKi/Renderer/RenderQueue.h>
+#include <AnKi/Renderer/GpuSceneUpload.h>
 #include <AnKi/Core/ConfigSet.h>
 #include <AnKi/Util/ThreadHive.h>
 #include <AnKi/Util/Tracer.h>
@@ -266,6 +267,8 @@ void ShadowMapping::populateRenderGraph(RenderingContext& ctx)
 
 			TextureSubresourceInfo subresource = TextureSubresourceInfo(DepthStencilAspectBit::DEPTH);
 			pass.newDependency({m_scratch.m_rt, TextureUsageBit::ALL_FRAMEBUFFER_ATTACHMENT, subresource});
+			pass.newDependency(
+				{m_r->getGpuSceneUpload().getGpuSceneBufferHandle(), BufferUsageBit::STORAGE_GEOMETRY_READ});
 		}
 
 		// Atlas pass
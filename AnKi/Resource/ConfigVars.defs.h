@@ -15,3 +15,7 @@ ANKI_CONFIG_VAR_STRING(RsrcDataPathExcludedStrings, "AndroidProject",
 ANKI_CONFIG_VAR_PTR_SIZE(RsrcTransferScratchMemorySize, 256_MB, 1_MB, 4_GB,
 						 "Memory that is used fot texture and buffer uploads")
 ANKI_CONFIG_VAR_BOOL(RsrcForceFullFpPrecision, false, "Force full floating point precision")
+ANKI_CONFIG_VAR_BOOL(RsrcLazyShaderCompilation, false,
+					 "Compile the stale shader programs on first use and in the background instead of at startup")
+ANKI_CONFIG_VAR_BOOL(RsrcThreadCachingMemory, true,
+					 "Serve the small allocations of the resources from per-thread caches")
@@ -26,7 +26,8 @@ static const Array<BuiltinVarInfo, U(BuiltinMaterialVariableId::COUNT)> BUILTIN_
 	 {"m_ankiTransform", ShaderVariableDataType::MAT3X4, true},
 	 {"m_ankiPreviousTransform", ShaderVariableDataType::MAT3X4, true},
 	 {"m_ankiRotation", ShaderVariableDataType::MAT3, true},
-	 {"u_ankiGlobalSampler", ShaderVariableDataType::SAMPLER, false}}};
+	 {"u_ankiGlobalSampler", ShaderVariableDataType::SAMPLER, false},
+	 {"m_ankiGpuSceneRenderableOffset", ShaderVariableDataType::U32, true}}};
 
 static ANKI_USE_RESULT Error checkBuiltin(CString name, ShaderVariableDataType dataType, Bool instanced,
 										  BuiltinMaterialVariableId& outId)
@@ -243,6 +244,7 @@ Error MaterialResource::load(const ResourceFilename& filename, Bool async)
 	}
 
 	ANKI_CHECK(findGlobalUniformsUbo());
+	ANKI_CHECK(findGpuSceneStorageBlock());
 
 	return Error::NONE;
 }
@@ -864,19 +866,16 @@ const MaterialVariant& MaterialResource::getOrCreateVariant(const RenderingKey&
 		m_variantMatrix[key.getPass()][key.getLod()][instanced][key.isSkinned()][key.hasVelocity()];
 
 	// Check if it's initialized
+	if(variant.m_initialized.load(AtomicMemoryOrder::ACQUIRE))
 	{
-		RLockGuard<RWMutex> lock(m_variantMatrixMtx);
-		if(variant.m_prog.isCreated())
-		{
-			return variant;
-		}
+		return variant;
 	}
 
 	// Not initialized, init it
-	WLockGuard<RWMutex> lock(m_variantMatrixMtx);
+	LockGuard<Mutex> lock(m_variantMatrixMtx);
 
 	// Check again
-	if(variant.m_prog.isCreated())
+	if(variant.m_initialized.load(AtomicMemoryOrder::RELAXED))
 	{
 		return variant;
 	}
@@ -944,6 +943,7 @@ const MaterialVariant& MaterialResource::getOrCreateVariant(const RenderingKey&
 
 	// Init the variant
 	initVariant(*progVariant, variant, instanced);
+	variant.m_initialized.store(true, AtomicMemoryOrder::RELEASE);
 
 	return variant;
 }
@@ -1306,4 +1306,32 @@ Error MaterialResource::findGlobalUniformsUbo()
 	return Error::NONE;
 }
 
+Error MaterialResource::findGpuSceneStorageBlock()
+{
+	const ShaderProgramBinary& binary = m_prog->getBinary();
+	for(const ShaderProgramBinaryBlock& block : binary.m_storageBlocks)
+	{
+		if(block.m_name.getBegin() == CString("b_ankiGpuScene"))
+		{
+			if(block.m_set != m_descriptorSetIdx)
+			{
+				ANKI_RESOURCE_LOGE("The set of b_ankiGpuScene should be %u", m_descriptorSetIdx);
+				return Error::USER_DATA;
+			}
+
+			m_gpuSceneBinding = block.m_binding;
+		}
+	}
+
+	// The offset is the only way to find the data in the GPU scene
+	const Bool hasOffset = tryFindVariableInternal("m_ankiGpuSceneRenderableOffset") != nullptr;
+	if(hasOffset != supportsGpuScene())
+	{
+		ANKI_RESOURCE_LOGE("b_ankiGpuScene and m_ankiGpuSceneRenderableOffset should be used together");
+		return Error::USER_DATA;
+	}
+
+	return Error::NONE;
+}
+
 } // end namespace anki
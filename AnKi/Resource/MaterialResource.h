@@ -29,6 +29,7 @@ enum class BuiltinMaterialVariableId : U8
 	PREVIOUS_TRANSFORM,
 	ROTATION,
 	GLOBAL_SAMPLER,
+	GPU_SCENE_RENDERABLE_OFFSET,
 
 	COUNT,
 	FIRST = 0,
@@ -271,6 +272,7 @@ private:
 	BitSet<128, U32> m_activeVars = {false};
 	U32 m_perDrawUboSize = 0;
 	U32 m_perInstanceUboSizeSingleInstance = 0;
+	Atomic<Bool> m_initialized = {false}; ///< Set after all the rest are. Allows lock-free reads of the variant.
 };
 
 /// Material resource.
@@ -384,6 +386,18 @@ public:
 		return m_globalUniformsUboBinding;
 	}
 
+	/// The material reads the transforms from the GPU scene and not from the per-instance uniforms.
+	Bool supportsGpuScene() const
+	{
+		return m_gpuSceneBinding != MAX_U32;
+	}
+
+	U32 getGpuSceneStorageBlockBinding() const
+	{
+		ANKI_ASSERT(supportsGpuScene());
+		return m_gpuSceneBinding;
+	}
+
 	const MaterialVariant& getOrCreateVariant(const RenderingKey& key) const;
 
 	U32 getShaderGroupHandleIndex(RayType type) const
@@ -433,10 +447,11 @@ private:
 	U32 m_boneTrfsBinding = MAX_U32;
 	U32 m_prevFrameBoneTrfsBinding = MAX_U32;
 	U32 m_globalUniformsUboBinding = MAX_U32;
+	U32 m_gpuSceneBinding = MAX_U32;
 
 	/// Matrix of variants.
 	mutable Array5d<MaterialVariant, U(Pass::COUNT), MAX_LOD_COUNT, 2, 2, 2> m_variantMatrix;
-	mutable RWMutex m_variantMatrixMtx;
+	mutable Mutex m_variantMatrixMtx; ///< Serializes the initialization of the variants.
 
 	DynamicArray<MaterialVariable> m_vars;
 
@@ -491,6 +506,8 @@ private:
 	ANKI_USE_RESULT Error parseRtMaterial(XmlElement rootEl);
 
 	ANKI_USE_RESULT Error findGlobalUniformsUbo();
+
+	ANKI_USE_RESULT Error findGpuSceneStorageBlock();
 };
 /// @}
 
@@ -19,13 +19,17 @@ static constexpr const char* MESH_MAGIC = "ANKIMES5";
 
 constexpr U32 MESH_BINARY_BUFFER_ALIGNMENT = 16;
 
+constexpr U32 MESH_BINARY_MAX_MESHLET_VERTEX_COUNT = 64;
+constexpr U32 MESH_BINARY_MAX_MESHLET_PRIMITIVE_COUNT = 124;
+
 enum class MeshBinaryFlag : U32
 {
 	NONE = 0,
 	QUAD = 1 << 0,
 	CONVEX = 1 << 1,
+	MESHLETS = 1 << 2, ///< The file has the meshlet section.
 
-	ALL = QUAD | CONVEX,
+	ALL = QUAD | CONVEX | MESHLETS,
 };
 ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(MeshBinaryFlag)
 
@@ -125,6 +129,130 @@ public:
 	}
 };
 
+/// A cluster of triangles of a sub mesh with its culling info.
+class MeshBinaryMeshlet
+{
+public:
+	/// Offset in the meshlet vertex indices.
+	U32 m_firstVertex;
+
+	U32 m_vertexCount;
+
+	/// Offset in the meshlet primitives.
+	U32 m_firstPrimitive;
+
+	U32 m_primitiveCount;
+
+	/// Bounding sphere center.
+	Vec3 m_sphereCenter;
+
+	/// Bounding sphere radius.
+	F32 m_sphereRadius;
+
+	/// The apex of the normal cone.
+	Vec3 m_coneApex;
+
+	/// The cos of the half angle of the normal cone. 1.0 means it can't be cone culled.
+	F32 m_coneCutoff;
+
+	/// The axis of the normal cone.
+	Vec3 m_coneAxis;
+
+	template<typename TSerializer, typename TClass>
+	static void serializeCommon(TSerializer& s, TClass self)
+	{
+		s.doValue("m_firstVertex", offsetof(MeshBinaryMeshlet, m_firstVertex), self.m_firstVertex);
+		s.doValue("m_vertexCount", offsetof(MeshBinaryMeshlet, m_vertexCount), self.m_vertexCount);
+		s.doValue("m_firstPrimitive", offsetof(MeshBinaryMeshlet, m_firstPrimitive), self.m_firstPrimitive);
+		s.doValue("m_primitiveCount", offsetof(MeshBinaryMeshlet, m_primitiveCount), self.m_primitiveCount);
+		s.doValue("m_sphereCenter", offsetof(MeshBinaryMeshlet, m_sphereCenter), self.m_sphereCenter);
+		s.doValue("m_sphereRadius", offsetof(MeshBinaryMeshlet, m_sphereRadius), self.m_sphereRadius);
+		s.doValue("m_coneApex", offsetof(MeshBinaryMeshlet, m_coneApex), self.m_coneApex);
+		s.doValue("m_coneCutoff", offsetof(MeshBinaryMeshlet, m_coneCutoff), self.m_coneCutoff);
+		s.doValue("m_coneAxis", offsetof(MeshBinaryMeshlet, m_coneAxis), self.m_coneAxis);
+	}
+
+	template<typename TDeserializer>
+	void deserialize(TDeserializer& deserializer)
+	{
+		serializeCommon<TDeserializer, MeshBinaryMeshlet&>(deserializer, *this);
+	}
+
+	template<typename TSerializer>
+	void serialize(TSerializer& serializer) const
+	{
+		serializeCommon<TSerializer, const MeshBinaryMeshlet&>(serializer, *this);
+	}
+};
+
+/// The meshlets of a sub mesh.
+class MeshBinarySubMeshMeshlets
+{
+public:
+	U32 m_firstMeshlet;
+	U32 m_meshletCount;
+
+	template<typename TSerializer, typename TClass>
+	static void serializeCommon(TSerializer& s, TClass self)
+	{
+		s.doValue("m_firstMeshlet", offsetof(MeshBinarySubMeshMeshlets, m_firstMeshlet), self.m_firstMeshlet);
+		s.doValue("m_meshletCount", offsetof(MeshBinarySubMeshMeshlets, m_meshletCount), self.m_meshletCount);
+	}
+
+	template<typename TDeserializer>
+	void deserialize(TDeserializer& deserializer)
+	{
+		serializeCommon<TDeserializer, MeshBinarySubMeshMeshlets&>(deserializer, *this);
+	}
+
+	template<typename TSerializer>
+	void serialize(TSerializer& serializer) const
+	{
+		serializeCommon<TSerializer, const MeshBinarySubMeshMeshlets&>(serializer, *this);
+	}
+};
+
+/// It follows the vertex buffers if MeshBinaryFlag::MESHLETS is set. After it there are
+/// MeshBinaryHeader::m_subMeshCount MeshBinarySubMeshMeshlets, the MeshBinaryMeshlet array, the meshlet vertex indices
+/// (U16 indices to the vertex buffers) and the meshlet primitives (U8Vec4 with 3 indices to the meshlet vertices). The
+/// header plus the MeshBinarySubMeshMeshlets and every array after it are aligned to MESH_BINARY_BUFFER_ALIGNMENT.
+class MeshBinaryMeshletsHeader
+{
+public:
+	U32 m_meshletCount;
+
+	/// The total number of meshlet vertex indices.
+	U32 m_meshletVertexCount;
+
+	/// The total number of meshlet primitives.
+	U32 m_meshletPrimitiveCount;
+
+	U32 m_padding;
+
+	template<typename TSerializer, typename TClass>
+	static void serializeCommon(TSerializer& s, TClass self)
+	{
+		s.doValue("m_meshletCount", offsetof(MeshBinaryMeshletsHeader, m_meshletCount), self.m_meshletCount);
+		s.doValue("m_meshletVertexCount", offsetof(MeshBinaryMeshletsHeader, m_meshletVertexCount),
+				  self.m_meshletVertexCount);
+		s.doValue("m_meshletPrimitiveCount", offsetof(MeshBinaryMeshletsHeader, m_meshletPrimitiveCount),
+				  self.m_meshletPrimitiveCount);
+		s.doValue("m_padding", offsetof(MeshBinaryMeshletsHeader, m_padding), self.m_padding);
+	}
+
+	template<typename TDeserializer>
+	void deserialize(TDeserializer& deserializer)
+	{
+		serializeCommon<TDeserializer, MeshBinaryMeshletsHeader&>(deserializer, *this);
+	}
+
+	template<typename TSerializer>
+	void serialize(TSerializer& serializer) const
+	{
+		serializeCommon<TSerializer, const MeshBinaryMeshletsHeader&>(serializer, *this);
+	}
+};
+
 /// The 1st things that appears in a mesh binary. @note The index and vertex buffers are aligned to
 /// MESH_BINARY_BUFFER_ALIGNMENT bytes.
 class MeshBinaryHeader
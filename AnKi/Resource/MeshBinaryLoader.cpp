@@ -13,9 +13,16 @@ MeshBinaryLoader::MeshBinaryLoader(ResourceManager* manager)
 {
 }
 
+MeshBinaryLoader::MeshBinaryLoader(ResourceManager* manager, GenericMemoryPoolAllocator<U8> alloc)
+	: MeshBinaryLoader(&manager->getFilesystem(), alloc)
+{
+}
+
 MeshBinaryLoader::~MeshBinaryLoader()
 {
 	m_subMeshes.destroy(m_alloc);
+	m_subMeshMeshlets.destroy(m_alloc);
+	m_meshlets.destroy(m_alloc);
 }
 
 Error MeshBinaryLoader::load(const ResourceFilename& filename)
@@ -23,7 +30,7 @@ Error MeshBinaryLoader::load(const ResourceFilename& filename)
 	auto& alloc = m_alloc;
 
 	// Load header
-	ANKI_CHECK(m_manager->getFilesystem().openFile(filename, m_file));
+	ANKI_CHECK(m_fs->openFile(filename, m_file));
 	ANKI_CHECK(m_file->read(&m_header, sizeof(m_header)));
 	ANKI_CHECK(checkHeader());
 
@@ -63,6 +70,75 @@ Error MeshBinaryLoader::load(const ResourceFilename& filename)
 		}
 	}
 
+	if(hasMeshlets())
+	{
+		ANKI_CHECK(loadMeshlets());
+	}
+
+	return Error::NONE;
+}
+
+Error MeshBinaryLoader::loadMeshlets()
+{
+	ANKI_CHECK(m_file->seek(getMeshletsOffset(), FileSeekOrigin::BEGINNING));
+	ANKI_CHECK(m_file->read(&m_meshletsHeader, sizeof(m_meshletsHeader)));
+
+	const MeshBinaryMeshletsHeader& h = m_meshletsHeader;
+	if(h.m_meshletCount == 0 || h.m_meshletVertexCount == 0 || h.m_meshletPrimitiveCount == 0)
+	{
+		ANKI_RESOURCE_LOGE("Wrong meshlet counts");
+		return Error::USER_DATA;
+	}
+
+	// Check the file size
+	const PtrSize totalSize = getMeshletsOffset() + getAlignedMeshletsHeaderSize() + getAlignedMeshletArraySize()
+							  + getAlignedRoundUp(MESH_BINARY_BUFFER_ALIGNMENT, getMeshletVertexIndicesSize())
+							  + getAlignedRoundUp(MESH_BINARY_BUFFER_ALIGNMENT, getMeshletPrimitivesSize());
+	if(totalSize != m_file->getSize())
+	{
+		ANKI_RESOURCE_LOGE("Unexpected file size");
+		return Error::USER_DATA;
+	}
+
+	// Read the ranges and the meshlets
+	m_subMeshMeshlets.create(m_alloc, m_header.m_subMeshCount);
+	ANKI_CHECK(m_file->read(&m_subMeshMeshlets[0], m_subMeshMeshlets.getSizeInBytes()));
+
+	m_meshlets.create(m_alloc, h.m_meshletCount);
+	ANKI_CHECK(m_file->seek(getMeshletsOffset() + getAlignedMeshletsHeaderSize(), FileSeekOrigin::BEGINNING));
+	ANKI_CHECK(m_file->read(&m_meshlets[0], m_meshlets.getSizeInBytes()));
+
+	// Checks
+	U32 meshletSum = 0;
+	for(const MeshBinarySubMeshMeshlets& range : m_subMeshMeshlets)
+	{
+		if(range.m_firstMeshlet != meshletSum)
+		{
+			ANKI_RESOURCE_LOGE("Incorrect sub mesh meshlet info");
+			return Error::USER_DATA;
+		}
+
+		meshletSum += range.m_meshletCount;
+	}
+
+	if(meshletSum != h.m_meshletCount)
+	{
+		ANKI_RESOURCE_LOGE("Incorrect sub mesh meshlet info");
+		return Error::USER_DATA;
+	}
+
+	for(const MeshBinaryMeshlet& meshlet : m_meshlets)
+	{
+		if(meshlet.m_vertexCount == 0 || meshlet.m_vertexCount > MESH_BINARY_MAX_MESHLET_VERTEX_COUNT
+		   || meshlet.m_primitiveCount == 0 || meshlet.m_primitiveCount > MESH_BINARY_MAX_MESHLET_PRIMITIVE_COUNT
+		   || meshlet.m_firstVertex + meshlet.m_vertexCount > h.m_meshletVertexCount
+		   || meshlet.m_firstPrimitive + meshlet.m_primitiveCount > h.m_meshletPrimitiveCount)
+		{
+			ANKI_RESOURCE_LOGE("Incorrect meshlet info");
+			return Error::USER_DATA;
+		}
+	}
+
 	return Error::NONE;
 }
 
@@ -200,18 +276,9 @@ Error MeshBinaryLoader::checkHeader() const
 		}
 	}
 
-	// Check the file size
-	PtrSize totalSize = sizeof(m_header);
-
-	totalSize += sizeof(MeshBinarySubMesh) * m_header.m_subMeshCount;
-	totalSize += getAlignedIndexBufferSize();
-
-	for(U32 i = 0; i < m_header.m_vertexBufferCount; ++i)
-	{
-		totalSize += getAlignedVertexBufferSize(i);
-	}
-
-	if(totalSize != m_file->getSize())
+	// Check the file size. If there are meshlets the size will be checked when they are loaded
+	const PtrSize totalSize = getMeshletsOffset();
+	if((!hasMeshlets() && totalSize != m_file->getSize()) || (hasMeshlets() && totalSize >= m_file->getSize()))
 	{
 		ANKI_RESOURCE_LOGE("Unexpected file size");
 		return Error::USER_DATA;
@@ -252,6 +319,33 @@ Error MeshBinaryLoader::storeVertexBuffer(U32 bufferIdx, void* ptr, PtrSize size
 	return Error::NONE;
 }
 
+Error MeshBinaryLoader::storeMeshletVertexIndices(void* ptr, PtrSize size)
+{
+	ANKI_ASSERT(ptr);
+	ANKI_ASSERT(hasMeshlets());
+	ANKI_ASSERT(size == getMeshletVertexIndicesSize());
+
+	const PtrSize seek = getMeshletsOffset() + getAlignedMeshletsHeaderSize() + getAlignedMeshletArraySize();
+	ANKI_CHECK(m_file->seek(seek, FileSeekOrigin::BEGINNING));
+	ANKI_CHECK(m_file->read(ptr, size));
+
+	return Error::NONE;
+}
+
+Error MeshBinaryLoader::storeMeshletPrimitives(void* ptr, PtrSize size)
+{
+	ANKI_ASSERT(ptr);
+	ANKI_ASSERT(hasMeshlets());
+	ANKI_ASSERT(size == getMeshletPrimitivesSize());
+
+	const PtrSize seek = getMeshletsOffset() + getAlignedMeshletsHeaderSize() + getAlignedMeshletArraySize()
+						 + getAlignedRoundUp(MESH_BINARY_BUFFER_ALIGNMENT, getMeshletVertexIndicesSize());
+	ANKI_CHECK(m_file->seek(seek, FileSeekOrigin::BEGINNING));
+	ANKI_CHECK(m_file->read(ptr, size));
+
+	return Error::NONE;
+}
+
 Error MeshBinaryLoader::storeIndicesAndPosition(DynamicArrayAuto<U32>& indices, DynamicArrayAuto<Vec3>& positions)
 {
 	ANKI_ASSERT(isLoaded());
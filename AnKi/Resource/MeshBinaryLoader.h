@@ -21,10 +21,13 @@ class MeshBinaryLoader
 public:
 	MeshBinaryLoader(ResourceManager* manager);
 
-	MeshBinaryLoader(ResourceManager* manager, GenericMemoryPoolAllocator<U8> alloc)
-		: m_manager(manager)
+	MeshBinaryLoader(ResourceManager* manager, GenericMemoryPoolAllocator<U8> alloc);
+
+	MeshBinaryLoader(ResourceFilesystem* fs, GenericMemoryPoolAllocator<U8> alloc)
+		: m_fs(fs)
 		, m_alloc(alloc)
 	{
+		ANKI_ASSERT(fs);
 	}
 
 	~MeshBinaryLoader();
@@ -38,6 +41,12 @@ public:
 	/// Instead of calling storeIndexBuffer and storeVertexBuffer use this method to get those buffers into the CPU.
 	ANKI_USE_RESULT Error storeIndicesAndPosition(DynamicArrayAuto<U32>& indices, DynamicArrayAuto<Vec3>& positions);
 
+	/// Store the U16 vertex indices of all meshlets. Only if hasMeshlets() is true.
+	ANKI_USE_RESULT Error storeMeshletVertexIndices(void* ptr, PtrSize size);
+
+	/// Store the U8Vec4 primitives of all meshlets. Only if hasMeshlets() is true.
+	ANKI_USE_RESULT Error storeMeshletPrimitives(void* ptr, PtrSize size);
+
 	const MeshBinaryHeader& getHeader() const
 	{
 		ANKI_ASSERT(isLoaded());
@@ -55,8 +64,32 @@ public:
 		return ConstWeakArray<MeshBinarySubMesh>(m_subMeshes);
 	}
 
+	Bool hasMeshlets() const
+	{
+		ANKI_ASSERT(isLoaded());
+		return !!(m_header.m_flags & MeshBinaryFlag::MESHLETS);
+	}
+
+	const MeshBinaryMeshletsHeader& getMeshletsHeader() const
+	{
+		ANKI_ASSERT(hasMeshlets());
+		return m_meshletsHeader;
+	}
+
+	/// The meshlet range of each sub mesh. Empty if there are no meshlets.
+	ConstWeakArray<MeshBinarySubMeshMeshlets> getSubMeshMeshlets() const
+	{
+		return ConstWeakArray<MeshBinarySubMeshMeshlets>(m_subMeshMeshlets);
+	}
+
+	/// The meshlets of all sub meshes. Empty if there are no meshlets.
+	ConstWeakArray<MeshBinaryMeshlet> getMeshlets() const
+	{
+		return ConstWeakArray<MeshBinaryMeshlet>(m_meshlets);
+	}
+
 private:
-	ResourceManager* m_manager;
+	ResourceFilesystem* m_fs;
 	GenericMemoryPoolAllocator<U8> m_alloc;
 	ResourceFilePtr m_file;
 
@@ -64,6 +97,10 @@ private:
 
 	DynamicArray<MeshBinarySubMesh> m_subMeshes;
 
+	MeshBinaryMeshletsHeader m_meshletsHeader = {};
+	DynamicArray<MeshBinarySubMeshMeshlets> m_subMeshMeshlets;
+	DynamicArray<MeshBinaryMeshlet> m_meshlets;
+
 	Bool isLoaded() const
 	{
 		return m_file.get() != nullptr;
@@ -95,7 +132,45 @@ private:
 		return getAlignedRoundUp(MESH_BINARY_BUFFER_ALIGNMENT, getVertexBufferSize(bufferIdx));
 	}
 
+	/// The offset of the meshlet section in the file. It's after the vertex buffers.
+	PtrSize getMeshletsOffset() const
+	{
+		ANKI_ASSERT(isLoaded());
+		PtrSize offset = sizeof(m_header) + sizeof(MeshBinarySubMesh) * m_header.m_subMeshCount;
+		offset += getAlignedIndexBufferSize();
+		for(U32 i = 0; i < m_header.m_vertexBufferCount; ++i)
+		{
+			offset += getAlignedVertexBufferSize(i);
+		}
+		return offset;
+	}
+
+	/// The size of the MeshBinaryMeshletsHeader plus the MeshBinarySubMeshMeshlets.
+	PtrSize getAlignedMeshletsHeaderSize() const
+	{
+		const PtrSize size =
+			sizeof(MeshBinaryMeshletsHeader) + sizeof(MeshBinarySubMeshMeshlets) * m_header.m_subMeshCount;
+		return getAlignedRoundUp(MESH_BINARY_BUFFER_ALIGNMENT, size);
+	}
+
+	PtrSize getAlignedMeshletArraySize() const
+	{
+		return getAlignedRoundUp(MESH_BINARY_BUFFER_ALIGNMENT,
+								 sizeof(MeshBinaryMeshlet) * m_meshletsHeader.m_meshletCount);
+	}
+
+	PtrSize getMeshletVertexIndicesSize() const
+	{
+		return sizeof(U16) * m_meshletsHeader.m_meshletVertexCount;
+	}
+
+	PtrSize getMeshletPrimitivesSize() const
+	{
+		return sizeof(U8Vec4) * m_meshletsHeader.m_meshletPrimitiveCount;
+	}
+
 	ANKI_USE_RESULT Error checkHeader() const;
+	ANKI_USE_RESULT Error loadMeshlets();
 	ANKI_USE_RESULT Error checkFormat(VertexAttributeId type, ConstWeakArray<Format> supportedFormats,
 									  U32 vertexBufferIdx, U32 relativeOffset) const;
 };
@@ -56,19 +56,22 @@ MeshResource::MeshResource(ResourceManager* manager)
 
 MeshResource::~MeshResource()
 {
-	m_subMeshes.destroy(getAllocator());
-	m_vertexBufferInfos.destroy(getAllocator());
-
-	if(m_vertexBuffersOffset != MAX_PTR_SIZE)
+	// Free first because the memory pool might be relocating and patching this object. The pool serializes the free
+	// with the relocation so the offsets can't change after the free
+	if(m_vertexBuffersOffset.load() != MAX_PTR_SIZE)
 	{
-		getManager().getVertexGpuMemory().free(m_vertexBuffersSize, m_vertexBuffersOffset);
+		getManager().getVertexGpuMemory().free(m_vertexBuffersSize, m_vertexBuffersOffset.load());
 	}
 
-	if(m_indexBufferOffset != MAX_PTR_SIZE)
+	if(m_indexBufferOffset.load() != MAX_PTR_SIZE)
 	{
 		const PtrSize indexBufferSize = PtrSize(m_indexCount) * ((m_indexType == IndexType::U32) ? 4 : 2);
-		getManager().getVertexGpuMemory().free(indexBufferSize, m_indexBufferOffset);
+		getManager().getVertexGpuMemory().free(indexBufferSize, m_indexBufferOffset.load());
 	}
+
+	m_subMeshes.destroy(getAllocator());
+	m_meshlets.destroy(getAllocator());
+	m_vertexBufferInfos.destroy(getAllocator());
 }
 
 Bool MeshResource::isCompatible(const MeshResource& other) const
@@ -113,6 +116,31 @@ Error MeshResource::load(const ResourceFilename& filename, Bool async)
 		m_subMeshes[i].m_indexCount = loader.getSubMeshes()[i].m_indexCount;
 		m_subMeshes[i].m_aabb.setMin(loader.getSubMeshes()[i].m_aabbMin);
 		m_subMeshes[i].m_aabb.setMax(loader.getSubMeshes()[i].m_aabbMax);
+		m_subMeshes[i].m_firstMeshlet = 0;
+		m_subMeshes[i].m_meshletCount = 0;
+	}
+
+	//
+	// Meshlets
+	//
+	if(loader.hasMeshlets())
+	{
+		for(U32 i = 0; i < m_subMeshes.getSize(); ++i)
+		{
+			m_subMeshes[i].m_firstMeshlet = loader.getSubMeshMeshlets()[i].m_firstMeshlet;
+			m_subMeshes[i].m_meshletCount = loader.getSubMeshMeshlets()[i].m_meshletCount;
+		}
+
+		m_meshlets.create(getAllocator(), loader.getMeshlets().getSize());
+		for(U32 i = 0; i < m_meshlets.getSize(); ++i)
+		{
+			const MeshBinaryMeshlet& in = loader.getMeshlets()[i];
+			Meshlet& out = m_meshlets[i];
+			out.m_boundingSphere = Sphere(in.m_sphereCenter, in.m_sphereRadius);
+			out.m_coneApex = in.m_coneApex;
+			out.m_coneAxis = in.m_coneAxis;
+			out.m_coneCutoff = in.m_coneCutoff;
+		}
 	}
 
 	//
@@ -123,7 +151,9 @@ Error MeshResource::load(const ResourceFilename& filename, Bool async)
 	m_indexType = header.m_indexType;
 
 	const PtrSize indexBufferSize = PtrSize(m_indexCount) * ((m_indexType == IndexType::U32) ? 4 : 2);
-	ANKI_CHECK(getManager().getVertexGpuMemory().allocate(indexBufferSize, m_indexBufferOffset));
+	PtrSize indexBufferOffset;
+	ANKI_CHECK(getManager().getVertexGpuMemory().allocate(indexBufferSize, indexBufferOffset));
+	m_indexBufferOffset.store(indexBufferOffset);
 
 	//
 	// Vertex stuff
@@ -142,13 +172,9 @@ Error MeshResource::load(const ResourceFilename& filename, Bool async)
 		m_vertexBuffersSize += m_vertexCount * m_vertexBufferInfos[i].m_stride;
 	}
 
-	ANKI_CHECK(getManager().getVertexGpuMemory().allocate(m_vertexBuffersSize, m_vertexBuffersOffset));
-
-	// Readjust the individual offset now that we have a global offset
-	for(U32 i = 0; i < header.m_vertexBufferCount; ++i)
-	{
-		m_vertexBufferInfos[i].m_offset += m_vertexBuffersOffset;
-	}
+	PtrSize vertexBuffersOffset;
+	ANKI_CHECK(getManager().getVertexGpuMemory().allocate(m_vertexBuffersSize, vertexBuffersOffset));
+	m_vertexBuffersOffset.store(vertexBuffersOffset);
 
 	for(VertexAttributeId attrib = VertexAttributeId::FIRST; attrib < VertexAttributeId::COUNT; ++attrib)
 	{
@@ -178,8 +204,8 @@ Error MeshResource::load(const ResourceFilename& filename, Bool async)
 		cmdbinit.m_flags = CommandBufferFlag::SMALL_BATCH | CommandBufferFlag::GENERAL_WORK;
 		CommandBufferPtr cmdb = getManager().getGrManager().newCommandBuffer(cmdbinit);
 
-		cmdb->fillBuffer(m_vertexBuffer, m_vertexBuffersOffset, m_vertexBuffersSize, 0);
-		cmdb->fillBuffer(m_vertexBuffer, m_indexBufferOffset, indexBufferSize, 0);
+		cmdb->fillBuffer(m_vertexBuffer, vertexBuffersOffset, m_vertexBuffersSize, 0);
+		cmdb->fillBuffer(m_vertexBuffer, indexBufferOffset, indexBufferSize, 0);
 
 		cmdb->setBufferBarrier(m_vertexBuffer, BufferUsageBit::TRANSFER_DESTINATION, BufferUsageBit::VERTEX, 0,
 							   MAX_PTR_SIZE);
@@ -196,7 +222,7 @@ Error MeshResource::load(const ResourceFilename& filename, Bool async)
 		inf.m_type = AccelerationStructureType::BOTTOM_LEVEL;
 
 		inf.m_bottomLevel.m_indexBuffer = m_vertexBuffer;
-		inf.m_bottomLevel.m_indexBufferOffset = m_indexBufferOffset;
+		inf.m_bottomLevel.m_indexBufferOffset = indexBufferOffset;
 		inf.m_bottomLevel.m_indexCount = m_indexCount;
 		inf.m_bottomLevel.m_indexType = m_indexType;
 
@@ -222,30 +248,6 @@ Error MeshResource::load(const ResourceFilename& filename, Bool async)
 	// Fill the GPU descriptor
 	if(rayTracingEnabled)
 	{
-		m_meshGpuDescriptor.m_indexBufferPtr = m_vertexBuffer->getGpuAddress() + m_indexBufferOffset;
-
-		U32 bufferIdx;
-		Format format;
-		U32 relativeOffset;
-		getVertexAttributeInfo(VertexAttributeId::POSITION, bufferIdx, format, relativeOffset);
-		BufferPtr buffer;
-		PtrSize offset;
-		PtrSize stride;
-		getVertexBufferInfo(bufferIdx, buffer, offset, stride);
-		m_meshGpuDescriptor.m_vertexBufferPtrs[VertexAttributeBufferId::POSITION] = buffer->getGpuAddress() + offset;
-
-		getVertexAttributeInfo(VertexAttributeId::NORMAL, bufferIdx, format, relativeOffset);
-		getVertexBufferInfo(bufferIdx, buffer, offset, stride);
-		m_meshGpuDescriptor.m_vertexBufferPtrs[VertexAttributeBufferId::NORMAL_TANGENT_UV0] =
-			buffer->getGpuAddress() + offset;
-
-		if(hasBoneWeights())
-		{
-			getVertexAttributeInfo(VertexAttributeId::BONE_WEIGHTS, bufferIdx, format, relativeOffset);
-			getVertexBufferInfo(bufferIdx, buffer, offset, stride);
-			m_meshGpuDescriptor.m_vertexBufferPtrs[VertexAttributeBufferId::BONE] = buffer->getGpuAddress() + offset;
-		}
-
 		m_meshGpuDescriptor.m_indexCount = m_indexCount;
 		m_meshGpuDescriptor.m_vertexCount = m_vertexCount;
 		m_meshGpuDescriptor.m_aabbMin = header.m_aabbMin;
@@ -267,7 +269,55 @@ Error MeshResource::load(const ResourceFilename& filename, Bool async)
 	return Error::NONE;
 }
 
-Error MeshResource::loadAsync(MeshBinaryLoader& loader) const
+MeshGpuDescriptor MeshResource::getMeshGpuDescriptor() const
+{
+	MeshGpuDescriptor desc = m_meshGpuDescriptor;
+
+	desc.m_indexBufferPtr = m_vertexBuffer->getGpuAddress() + m_indexBufferOffset.load(AtomicMemoryOrder::ACQUIRE);
+
+	U32 bufferIdx;
+	Format format;
+	U32 relativeOffset;
+	getVertexAttributeInfo(VertexAttributeId::POSITION, bufferIdx, format, relativeOffset);
+	BufferPtr buffer;
+	PtrSize offset;
+	PtrSize stride;
+	getVertexBufferInfo(bufferIdx, buffer, offset, stride);
+	desc.m_vertexBufferPtrs[VertexAttributeBufferId::POSITION] = buffer->getGpuAddress() + offset;
+
+	getVertexAttributeInfo(VertexAttributeId::NORMAL, bufferIdx, format, relativeOffset);
+	getVertexBufferInfo(bufferIdx, buffer, offset, stride);
+	desc.m_vertexBufferPtrs[VertexAttributeBufferId::NORMAL_TANGENT_UV0] = buffer->getGpuAddress() + offset;
+
+	if(hasBoneWeights())
+	{
+		getVertexAttributeInfo(VertexAttributeId::BONE_WEIGHTS, bufferIdx, format, relativeOffset);
+		getVertexBufferInfo(bufferIdx, buffer, offset, stride);
+		desc.m_vertexBufferPtrs[VertexAttributeBufferId::BONE] = buffer->getGpuAddress() + offset;
+	}
+
+	return desc;
+}
+
+void MeshResource::relocateCallback(void* userData, PtrSize oldOffset, PtrSize newOffset)
+{
+	MeshResource& self = *static_cast<MeshResource*>(userData);
+
+	// Other threads might be reading the offsets. They will see either the old or the new range and both contain the
+	// same data until the old range is released, MAX_FRAMES_IN_FLIGHT frames later. The BLAS holds a copy of the
+	// positions so it doesn't need a rebuild
+	if(oldOffset == self.m_indexBufferOffset.load())
+	{
+		self.m_indexBufferOffset.store(newOffset, AtomicMemoryOrder::RELEASE);
+	}
+	else
+	{
+		ANKI_ASSERT(oldOffset == self.m_vertexBuffersOffset.load());
+		self.m_vertexBuffersOffset.store(newOffset, AtomicMemoryOrder::RELEASE);
+	}
+}
+
+Error MeshResource::loadAsync(MeshBinaryLoader& loader)
 {
 	GrManager& gr = getManager().getGrManager();
 	TransferGpuAllocator& transferAlloc = getManager().getTransferGpuAllocator();
@@ -291,8 +341,8 @@ Error MeshResource::loadAsync(MeshBinaryLoader& loader) const
 
 		ANKI_CHECK(loader.storeIndexBuffer(data, indexBufferSize));
 
-		cmdb->copyBufferToBuffer(handles[1].getBuffer(), handles[1].getOffset(), m_vertexBuffer, m_indexBufferOffset,
-								 handles[1].getRange());
+		cmdb->copyBufferToBuffer(handles[1].getBuffer(), handles[1].getOffset(), m_vertexBuffer,
+								 m_indexBufferOffset.load(), handles[1].getRange());
 	}
 
 	// Write vert buff
@@ -315,8 +365,8 @@ Error MeshResource::loadAsync(MeshBinaryLoader& loader) const
 		ANKI_ASSERT(offset == m_vertexBuffersSize);
 
 		// Copy
-		cmdb->copyBufferToBuffer(handles[0].getBuffer(), handles[0].getOffset(), m_vertexBuffer, m_vertexBuffersOffset,
-								 handles[0].getRange());
+		cmdb->copyBufferToBuffer(handles[0].getBuffer(), handles[0].getOffset(), m_vertexBuffer,
+								 m_vertexBuffersOffset.load(), handles[0].getRange());
 	}
 
 	// Build the BLAS
@@ -348,6 +398,12 @@ Error MeshResource::loadAsync(MeshBinaryLoader& loader) const
 	transferAlloc.release(handles[0], fence);
 	transferAlloc.release(handles[1], fence);
 
+	// The upload is submitted, the memory can move around from now on
+	VertexGpuMemoryPool& vertexMem = getManager().getVertexGpuMemory();
+	vertexMem.makeRelocatable(PtrSize(m_indexCount) * ((m_indexType == IndexType::U32) ? 4 : 2),
+							  m_indexBufferOffset.load(), relocateCallback, this);
+	vertexMem.makeRelocatable(m_vertexBuffersSize, m_vertexBuffersOffset.load(), relocateCallback, this);
+
 	return Error::NONE;
 }
 
@@ -9,6 +9,7 @@
 #include <AnKi/Math.h>
 #include <AnKi/Gr.h>
 #include <AnKi/Collision/Aabb.h>
+#include <AnKi/Collision/Sphere.h>
 #include <AnKi/Shaders/Include/ModelTypes.h>
 
 namespace anki {
@@ -23,6 +24,23 @@ class MeshBinaryLoader;
 class MeshResource : public ResourceObject
 {
 public:
+	/// The culling info of a cluster of triangles of a submesh.
+	class Meshlet
+	{
+	public:
+		Sphere m_boundingSphere;
+		Vec3 m_coneApex;
+		Vec3 m_coneAxis;
+		F32 m_coneCutoff; ///< The cos of the half angle of the normal cone.
+
+		/// Check if all the triangles of the meshlet face away from a point.
+		Bool isBackFacing(const Vec3& cameraPosition) const
+		{
+			const Vec3 dir = m_coneApex - cameraPosition;
+			return dir.dot(m_coneAxis) >= m_coneCutoff * dir.getLength();
+		}
+	};
+
 	/// Default constructor
 	MeshResource(ResourceManager* manager);
 
@@ -54,11 +72,19 @@ public:
 		return m_subMeshes.getSize();
 	}
 
+	/// Get the meshlets of a submesh. Empty if the mesh file doesn't have meshlets.
+	ConstWeakArray<Meshlet> getSubMeshMeshlets(U32 subMeshId) const
+	{
+		const SubMesh& sm = m_subMeshes[subMeshId];
+		return (sm.m_meshletCount) ? ConstWeakArray<Meshlet>(&m_meshlets[sm.m_firstMeshlet], sm.m_meshletCount)
+								   : ConstWeakArray<Meshlet>();
+	}
+
 	/// Get all info around vertex indices.
 	void getIndexBufferInfo(BufferPtr& buff, PtrSize& buffOffset, U32& indexCount, IndexType& indexType) const
 	{
 		buff = m_vertexBuffer;
-		buffOffset = m_indexBufferOffset;
+		buffOffset = m_indexBufferOffset.load(AtomicMemoryOrder::ACQUIRE);
 		indexCount = m_indexCount;
 		indexType = m_indexType;
 	}
@@ -73,7 +99,7 @@ public:
 	void getVertexBufferInfo(const U32 buffIdx, BufferPtr& buff, PtrSize& offset, PtrSize& stride) const
 	{
 		buff = m_vertexBuffer;
-		offset = m_vertexBufferInfos[buffIdx].m_offset;
+		offset = m_vertexBuffersOffset.load(AtomicMemoryOrder::ACQUIRE) + m_vertexBufferInfos[buffIdx].m_offset;
 		stride = m_vertexBufferInfos[buffIdx].m_stride;
 	}
 
@@ -105,10 +131,8 @@ public:
 		return m_blas;
 	}
 
-	const MeshGpuDescriptor& getMeshGpuDescriptor() const
-	{
-		return m_meshGpuDescriptor;
-	}
+	/// Get the GPU descriptor. It's returned by value because the addresses change when the memory is relocated.
+	MeshGpuDescriptor getMeshGpuDescriptor() const;
 
 	/// Get the buffer that contains all the indices of all submesses.
 	BufferPtr getIndexBuffer() const
@@ -131,13 +155,15 @@ private:
 	public:
 		U32 m_firstIndex;
 		U32 m_indexCount;
+		U32 m_firstMeshlet;
+		U32 m_meshletCount;
 		Aabb m_aabb;
 	};
 
 	class VertBuffInfo
 	{
 	public:
-		PtrSize m_offset; ///< Offset from the base of m_vertexBuffer.
+		PtrSize m_offset; ///< Offset from m_vertexBuffersOffset.
 		U32 m_stride;
 	};
 
@@ -150,16 +176,18 @@ private:
 	};
 
 	DynamicArray<SubMesh> m_subMeshes;
+	DynamicArray<Meshlet> m_meshlets;
 	DynamicArray<VertBuffInfo> m_vertexBufferInfos;
 	Array<AttribInfo, U(VertexAttributeId::COUNT)> m_attributes;
 
 	BufferPtr m_vertexBuffer; ///< Contains all data (vertices and indices).
 
-	PtrSize m_vertexBuffersOffset = MAX_PTR_SIZE; ///< Used for deallocation.
+	/// The defragmentation might change it while other threads read it so it's published with a single atomic store.
+	Atomic<PtrSize> m_vertexBuffersOffset = {MAX_PTR_SIZE};
 	PtrSize m_vertexBuffersSize = 0; ///< Used for deallocation.
 	U32 m_vertexCount = 0;
 
-	PtrSize m_indexBufferOffset = MAX_PTR_SIZE; ///< The offset from the base of m_vertexBuffer.
+	Atomic<PtrSize> m_indexBufferOffset = {MAX_PTR_SIZE}; ///< The offset from the base of m_vertexBuffer.
 	U32 m_indexCount = 0; ///< Total index count as if all submeshes are a single submesh.
 	IndexType m_indexType;
 
@@ -167,9 +195,12 @@ private:
 
 	// RT
 	AccelerationStructurePtr m_blas;
-	MeshGpuDescriptor m_meshGpuDescriptor;
+	MeshGpuDescriptor m_meshGpuDescriptor; ///< The addresses are not stored here, see getMeshGpuDescriptor().
+
+	ANKI_USE_RESULT Error loadAsync(MeshBinaryLoader& loader);
 
-	ANKI_USE_RESULT Error loadAsync(MeshBinaryLoader& loader) const;
+	/// @copydoc VertexGpuMemoryRelocationCallback
+	static void relocateCallback(void* userData, PtrSize oldOffset, PtrSize newOffset);
 };
 /// @}
 
@@ -64,7 +64,11 @@ void ModelPatch::getRenderingInfo(const RenderingKey& key, ModelRenderingInfo& i
 				const VertexBufferInfo& inBinding = m_vertexBufferInfos[meshLod][outAttribInfo.m_bufferBinding];
 				outBinding.m_buffer = inBinding.m_buffer;
 				ANKI_ASSERT(outBinding.m_buffer.isCreated());
-				outBinding.m_offset = inBinding.m_offset;
+				// The offset is not cached because the vertex memory might get defragmented
+				BufferPtr buffer;
+				PtrSize stride;
+				m_meshes[meshLod]->getVertexBufferInfo(outAttribInfo.m_bufferBinding, buffer, outBinding.m_offset,
+													   stride);
 				ANKI_ASSERT(outBinding.m_offset != MAX_PTR_SIZE);
 				outBinding.m_stride = inBinding.m_stride;
 				ANKI_ASSERT(outBinding.m_stride != MAX_PTR_SIZE);
@@ -82,7 +86,12 @@ void ModelPatch::getRenderingInfo(const RenderingKey& key, ModelRenderingInfo& i
 
 	// Index buff
 	inf.m_indexBuffer = m_indexBufferInfos[meshLod].m_buffer;
-	inf.m_indexBufferOffset = m_indexBufferInfos[meshLod].m_offset;
+	{
+		BufferPtr buffer;
+		U32 indexCount;
+		IndexType indexType;
+		m_meshes[meshLod]->getIndexBufferInfo(buffer, inf.m_indexBufferOffset, indexCount, indexType);
+	}
 	inf.m_indexCount = m_indexBufferInfos[meshLod].m_indexCount;
 	inf.m_firstIndex = m_indexBufferInfos[meshLod].m_firstIndex;
 	inf.m_indexType = m_indexType;
@@ -218,8 +227,7 @@ Error ModelPatch::init(ModelResource* model, ConstWeakArray<CString> meshFNames,
 					PtrSize offset, stride;
 					mesh.getVertexBufferInfo(m_vertexAttributeInfos[attrib].m_bufferBinding, outVertBufferInfo.m_buffer,
 											 offset, stride);
-					outVertBufferInfo.m_offset = offset & 0xFFFFFFFFFFFF;
-					outVertBufferInfo.m_stride = stride & 0xFFFF;
+					outVertBufferInfo.m_stride = stride;
 				}
 			}
 		}
@@ -236,7 +244,6 @@ Error ModelPatch::init(ModelResource* model, ConstWeakArray<CString> meshFNames,
 				PtrSize offset;
 				mesh.getIndexBufferInfo(outIndexBufferInfo.m_buffer, offset, outIndexBufferInfo.m_indexCount,
 										indexType);
-				outIndexBufferInfo.m_offset = offset;
 				outIndexBufferInfo.m_firstIndex = 0;
 				m_indexType = indexType;
 			}
@@ -246,7 +253,6 @@ Error ModelPatch::init(ModelResource* model, ConstWeakArray<CString> meshFNames,
 				PtrSize offset;
 				mesh.getIndexBufferInfo(outIndexBufferInfo.m_buffer, offset, outIndexBufferInfo.m_indexCount,
 										indexType);
-				outIndexBufferInfo.m_offset = offset;
 				m_indexType = indexType;
 
 				Aabb aabb;
@@ -147,8 +147,7 @@ private:
 	{
 	public:
 		BufferPtr m_buffer;
-		PtrSize m_stride : 16;
-		PtrSize m_offset : 48;
+		PtrSize m_stride;
 	};
 
 	Array2d<VertexBufferInfo, MAX_LOD_COUNT, U(VertexAttributeBufferId::COUNT)> m_vertexBufferInfos;
@@ -157,7 +156,6 @@ private:
 	{
 	public:
 		BufferPtr m_buffer;
-		PtrSize m_offset;
 		U32 m_firstIndex = MAX_U32;
 		U32 m_indexCount = MAX_U32;
 	};
@@ -507,4 +507,58 @@ Error ResourceFilesystem::openFile(const ResourceFilename& filename, ResourceFil
 	return Error::NONE;
 }
 
+Error ResourceFilesystem::getFileModificationTime(const ResourceFilename& filename, U64& timestamp) const
+{
+	// Search like openFile() does
+	for(const Path& p : m_paths)
+	{
+		if(p.m_isCache)
+		{
+			StringAuto newFname(m_alloc);
+			newFname.sprintf("%s/%s", &p.m_path[0], &filename[0]);
+
+			if(fileExists(newFname.toCString()))
+			{
+				return anki::getFileModificationTime(newFname, timestamp);
+			}
+
+			continue;
+		}
+
+		for(const String& pfname : p.m_files)
+		{
+			if(pfname != filename)
+			{
+				continue;
+			}
+
+			if(p.m_isArchive)
+			{
+				// Can't know about individual files, use the time of the whole archive
+				return anki::getFileModificationTime(p.m_path, timestamp);
+			}
+			else if(p.m_isSpecial)
+			{
+				// Unknown
+				timestamp = 0;
+				return Error::NONE;
+			}
+			else
+			{
+				StringAuto newFname(m_alloc);
+				newFname.sprintf("%s/%s", &p.m_path[0], &filename[0]);
+				return anki::getFileModificationTime(newFname, timestamp);
+			}
+		}
+	}
+
+	if(fileExists(filename))
+	{
+		return anki::getFileModificationTime(filename, timestamp);
+	}
+
+	// Don't log, a missing file is a common case for the callers that check if something is stale
+	return Error::USER_DATA;
+}
+
 } // end namespace anki
@@ -94,6 +94,12 @@ public:
 	/// Search the path list to find the file. Then open the file for reading. It's thread-safe.
 	ANKI_USE_RESULT Error openFile(const ResourceFilename& filename, ResourceFilePtr& file);
 
+	/// Get the time the file was last modified. If the file is inside an archive it returns the time of the archive. If
+	/// the time can't be known it returns zero. If the file is not found it returns an error without logging it. It's
+	/// thread-safe.
+	/// @see anki::getFileModificationTime
+	ANKI_USE_RESULT Error getFileModificationTime(const ResourceFilename& filename, U64& timestamp) const;
+
 	/// Iterate all the filenames from all paths provided.
 	template<typename TFunc>
 	ANKI_USE_RESULT Error iterateAllFilenames(TFunc func) const
@@ -206,6 +206,11 @@ public:
 		return *m_shaderProgramSystem;
 	}
 
+	ShaderProgramResourceSystem& getShaderProgramResourceSystem()
+	{
+		return *m_shaderProgramSystem;
+	}
+
 	VertexGpuMemoryPool& getVertexGpuMemory()
 	{
 		ANKI_ASSERT(m_vertexMem);
@@ -49,6 +49,9 @@ ShaderProgramResource::~ShaderProgramResource()
 
 Error ShaderProgramResource::load(const ResourceFilename& filename, Bool async)
 {
+	// The compilation of the program might have been deferred
+	ANKI_CHECK(getManager().getShaderProgramResourceSystem().ensureProgramCompiled(filename));
+
 	// Load the binary from the cache. It should have been compiled there
 	StringAuto baseFilename(getTempAllocator());
 	getFilepathFilename(filename, baseFilename);
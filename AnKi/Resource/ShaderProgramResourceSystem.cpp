@@ -16,6 +16,157 @@
 
 namespace anki {
 
+constexpr const char* SHADER_META_FILE_MAGIC = "ANKIMET1";
+
+/// The meta file that accompanies every shader binary in the cache. It's followed by MetaFileDependency *
+/// m_dependencyCount and then by the filenames of the dependencies.
+class MetaFileHeader
+{
+public:
+	Array<U8, 8> m_magic = {};
+	U64 m_hash = 0; ///< The hash of the parsed source combined with the m_gpuHash.
+	U64 m_gpuHash = 0;
+	ShaderTypeBit m_shaderTypes = ShaderTypeBit::NONE;
+	U16 m_padding = 0;
+	U32 m_dependencyCount = 0;
+};
+
+/// A file that a shader program depends on. The program file itself and all the files it includes.
+class MetaFileDependency
+{
+public:
+	U64 m_timestamp = 0;
+	U64 m_contentHash = 0;
+	U32 m_filenameLength = 0;
+	U32 m_padding = 0;
+};
+
+static U64 computeShaderSourceHash(const StringAuto& txt)
+{
+	return (txt.getLength()) ? computeHash(txt.cstr(), txt.getLength()) : 1;
+}
+
+/// If the meta file is missing or it's from an older version the header will be zero.
+static Error readMetaFile(CString fname, GenericMemoryPoolAllocator<U8> alloc, MetaFileHeader& header,
+						  StringListAuto& depFilenames, DynamicArrayAuto<MetaFileDependency>& deps)
+{
+	header = {};
+
+	if(!fileExists(fname))
+	{
+		return Error::NONE;
+	}
+
+	File file;
+	ANKI_CHECK(file.open(fname, FileOpenFlag::READ | FileOpenFlag::BINARY));
+	if(file.getSize() < sizeof(header))
+	{
+		return Error::NONE;
+	}
+
+	ANKI_CHECK(file.read(&header, sizeof(header)));
+	if(memcmp(&header.m_magic[0], SHADER_META_FILE_MAGIC, sizeof(header.m_magic)) != 0)
+	{
+		header = {};
+		return Error::NONE;
+	}
+
+	if(header.m_hash == 0 || header.m_shaderTypes == ShaderTypeBit::NONE)
+	{
+		ANKI_RESOURCE_LOGE("Wrong data found in the metafile: %s", fname.cstr());
+		return Error::USER_DATA;
+	}
+
+	deps.create(header.m_dependencyCount);
+	if(header.m_dependencyCount)
+	{
+		ANKI_CHECK(file.read(&deps[0], deps.getSizeInBytes()));
+	}
+
+	for(const MetaFileDependency& dep : deps)
+	{
+		StringAuto depFname(alloc);
+		depFname.create('\0', dep.m_filenameLength);
+		ANKI_CHECK(file.read(&depFname[0], dep.m_filenameLength));
+		depFilenames.pushBack(depFname);
+	}
+
+	return Error::NONE;
+}
+
+static Error writeMetaFile(CString fname, const MetaFileHeader& header, const StringListAuto& depFilenames,
+						   DynamicArrayAuto<MetaFileDependency>& deps)
+{
+	ANKI_ASSERT(depFilenames.getSize() == deps.getSize() && header.m_dependencyCount == deps.getSize());
+
+	File file;
+	ANKI_CHECK(file.open(fname, FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+	ANKI_CHECK(file.write(&header, sizeof(header)));
+
+	U32 count = 0;
+	for(const String& depFname : depFilenames)
+	{
+		deps[count++].m_filenameLength = depFname.getLength();
+	}
+
+	if(deps.getSize())
+	{
+		ANKI_CHECK(file.write(&deps[0], deps.getSizeInBytes()));
+	}
+
+	for(const String& depFname : depFilenames)
+	{
+		ANKI_CHECK(file.write(depFname.cstr(), depFname.getLength()));
+	}
+
+	return Error::NONE;
+}
+
+/// Check if the files a program depends on have changed. Only the files with a different timestamp are read.
+static Error checkDependencies(ResourceFilesystem& fs, GenericMemoryPoolAllocator<U8> alloc,
+							   const StringListAuto& depFilenames, DynamicArrayAuto<MetaFileDependency>& deps,
+							   Bool& upToDate, Bool& timestampsChanged)
+{
+	upToDate = true;
+	timestampsChanged = false;
+
+	U32 count = 0;
+	for(const String& depFname : depFilenames)
+	{
+		MetaFileDependency& dep = deps[count++];
+
+		U64 timestamp;
+		if(fs.getFileModificationTime(depFname, timestamp))
+		{
+			// Probably deleted, the program has to be parsed to know more
+			upToDate = false;
+			break;
+		}
+
+		if(timestamp != 0 && timestamp == dep.m_timestamp)
+		{
+			continue;
+		}
+
+		// Timestamp changed, check the contents
+		ResourceFilePtr file;
+		StringAuto txt(alloc);
+		ANKI_CHECK(fs.openFile(depFname, file));
+		ANKI_CHECK(file->readAllText(txt));
+
+		if(computeShaderSourceHash(txt) != dep.m_contentHash)
+		{
+			upToDate = false;
+			break;
+		}
+
+		dep.m_timestamp = timestamp;
+		timestampsChanged = true;
+	}
+
+	return Error::NONE;
+}
+
 U64 ShaderProgramRaytracingLibrary::generateShaderGroupGroupHash(CString resourceFilename, U64 mutationHash,
 																 GenericMemoryPoolAllocator<U8> alloc)
 {
@@ -28,6 +179,29 @@ U64 ShaderProgramRaytracingLibrary::generateShaderGroupGroupHash(CString resourc
 
 ShaderProgramResourceSystem::~ShaderProgramResourceSystem()
 {
+	if(m_deferredThreadStarted)
+	{
+		{
+			LockGuard<Mutex> lock(m_deferredMtx);
+			m_quitDeferredThread = true;
+		}
+
+		const Error err = m_deferredThread.join();
+		if(err)
+		{
+			ANKI_RESOURCE_LOGE("The shader compilation thread failed");
+		}
+	}
+
+	m_alloc.deleteInstance(m_onDemandHive);
+
+	for(DeferredProgram& prog : m_deferredPrograms)
+	{
+		prog.m_filename.destroy(m_alloc);
+		prog.m_baseFilename.destroy(m_alloc);
+	}
+	m_deferredPrograms.destroy(m_alloc);
+
 	m_cacheDir.destroy(m_alloc);
 	m_rtLibraries.destroy(m_alloc);
 }
@@ -36,42 +210,54 @@ Error ShaderProgramResourceSystem::init()
 {
 	ANKI_TRACE_SCOPED_EVENT(COMPILE_SHADERS);
 
+	const Bool deferCompilation = m_gr->getConfig().getRsrcLazyShaderCompilation();
+
 	StringListAuto rtProgramFilenames(m_alloc);
-	ANKI_CHECK(compileAllShaders(m_cacheDir, *m_gr, *m_fs, m_alloc, rtProgramFilenames));
+	StringListAuto deferredProgramFilenames(m_alloc);
+	ANKI_CHECK(compileAllShaders(m_cacheDir, *m_gr, *m_fs, m_alloc, deferCompilation, rtProgramFilenames,
+								 deferredProgramFilenames));
 
 	if(m_gr->getDeviceCapabilities().m_rayTracingEnabled)
 	{
 		ANKI_CHECK(createRayTracingPrograms(m_cacheDir, rtProgramFilenames, *m_gr, m_alloc, m_rtLibraries));
 	}
 
+	// Start compiling the deferred programs in the background
+	if(!deferredProgramFilenames.isEmpty())
+	{
+		m_deferredPrograms.create(m_alloc, U32(deferredProgramFilenames.getSize()));
+		U32 count = 0;
+		for(const String& fname : deferredProgramFilenames)
+		{
+			StringAuto baseFname(m_alloc);
+			getFilepathFilename(fname, baseFname);
+
+			m_deferredPrograms[count].m_filename.create(m_alloc, fname);
+			m_deferredPrograms[count].m_baseFilename.create(m_alloc, baseFname);
+			++count;
+		}
+
+		m_deferredThread.start(this, [](ThreadCallbackInfo& info) -> Error {
+			return static_cast<ShaderProgramResourceSystem*>(info.m_userData)->deferredThreadMain();
+		});
+		m_deferredThreadStarted = true;
+	}
+
 	return Error::NONE;
 }
 
 Error ShaderProgramResourceSystem::compileAllShaders(CString cacheDir, GrManager& gr, ResourceFilesystem& fs,
-													 GenericMemoryPoolAllocator<U8>& alloc,
-													 StringListAuto& rtProgramFilenames)
+													 GenericMemoryPoolAllocator<U8>& alloc, Bool deferCompilation,
+													 StringListAuto& rtProgramFilenames,
+													 StringListAuto& deferredProgramFilenames)
 {
-	class MetaFileData
-	{
-	public:
-		U64 m_hash;
-		ShaderTypeBit m_shaderTypes;
-		Array<U16, 3> m_padding = {};
-	};
-
 	ANKI_RESOURCE_LOGI("Compiling shader programs");
 	U32 shadersCompileCount = 0;
+	U32 shadersDeferredCount = 0;
 	U32 shadersTotalCount = 0;
 
-	ThreadHive threadHive(getCpuCoresCount(), alloc, false);
-
-	// Compute hash for both
-	ShaderCompilerOptions compilerOptions;
-	compilerOptions.m_forceFullFloatingPointPrecision = gr.getConfig().getRsrcForceFullFpPrecision();
-	compilerOptions.m_mobilePlatform = ANKI_PLATFORM_MOBILE;
-	U64 gpuHash = computeHash(&compilerOptions, sizeof(compilerOptions));
-	gpuHash = appendHash(&SHADER_BINARY_VERSION, sizeof(SHADER_BINARY_VERSION), gpuHash);
-
+	// Gather the programs
+	StringListAuto programFilenames(alloc);
 	ANKI_CHECK(fs.iterateAllFilenames([&](CString fname) -> Error {
 		// Check file extension
 		StringAuto extension(alloc);
@@ -89,160 +275,430 @@ Error ShaderProgramResourceSystem::compileAllShaders(CString cacheDir, GrManager
 			return Error::NONE;
 		}
 
-		// Get some filenames
-		StringAuto baseFname(alloc);
-		getFilepathFilename(fname, baseFname);
-		StringAuto metaFname(alloc);
-		metaFname.sprintf("%s/%smeta", cacheDir.cstr(), baseFname.cstr());
+		programFilenames.pushBack(fname);
+		return Error::NONE;
+	}));
+
+	// Check and compile the programs in parallel. The variants of all programs are compiled in the same hive
+	class Program
+	{
+	public:
+		CString m_filename;
+		ProgramCompileStatus m_status = ProgramCompileStatus::UP_TO_DATE;
+		ShaderTypeBit m_shaderTypes = ShaderTypeBit::NONE;
+		Error m_err = Error::NONE;
+	};
+
+	class Ctx
+	{
+	public:
+		CString m_cacheDir;
+		GrManager* m_gr;
+		ResourceFilesystem* m_fs;
+		GenericMemoryPoolAllocator<U8> m_alloc;
+		ThreadHive* m_variantHive;
+		Bool m_deferCompilation;
+		WeakArray<Program> m_programs;
+		Atomic<U32> m_nextProgram = {0};
+	};
+
+	DynamicArrayAuto<Program> programs(alloc, U32(programFilenames.getSize()));
+	U32 count = 0;
+	for(const String& fname : programFilenames)
+	{
+		programs[count++].m_filename = fname;
+	}
+
+	ThreadHive variantHive(getCpuCoresCount(), alloc, false);
+
+	Ctx ctx;
+	ctx.m_cacheDir = cacheDir;
+	ctx.m_gr = &gr;
+	ctx.m_fs = &fs;
+	ctx.m_alloc = alloc;
+	ctx.m_variantHive = &variantHive;
+	ctx.m_deferCompilation = deferCompilation;
+	ctx.m_programs = programs;
+
+	if(programs.getSize())
+	{
+		const U32 threadCount = min(programs.getSize(), getCpuCoresCount());
+		ThreadHive programHive(threadCount, alloc, false);
+
+		for(U32 i = 0; i < threadCount; ++i)
+		{
+			programHive.submitTask(
+				[](void* userData, U32 threadId, ThreadHive& hive, ThreadHiveSemaphore* signalSemaphore) {
+					Ctx& ctx = *static_cast<Ctx*>(userData);
+
+					U32 idx;
+					while((idx = ctx.m_nextProgram.fetchAdd(1)) < ctx.m_programs.getSize())
+					{
+						Program& prog = ctx.m_programs[idx];
+
+						// RT programs are needed to create the libraries so they can't be deferred
+						const Bool rtProgram = prog.m_filename.find("/Rt") != CString::NPOS;
+
+						prog.m_err = compileProgram(prog.m_filename, ctx.m_cacheDir, *ctx.m_gr, *ctx.m_fs, ctx.m_alloc,
+													*ctx.m_variantHive, ctx.m_deferCompilation && !rtProgram,
+													prog.m_status, prog.m_shaderTypes);
+					}
+				},
+				&ctx);
+		}
+
+		programHive.waitAllTasks();
+	}
+
+	for(const Program& prog : programs)
+	{
+		ANKI_CHECK(prog.m_err);
+
+		if(prog.m_status == ProgramCompileStatus::COMPILED)
+		{
+			++shadersCompileCount;
+		}
+		else if(prog.m_status == ProgramCompileStatus::DEFERRED)
+		{
+			++shadersDeferredCount;
+			deferredProgramFilenames.pushBack(prog.m_filename);
+		}
 
-		// Get the hash from the meta file
-		U64 metafileHash = 0;
-		ShaderTypeBit metafileShaderTypes = ShaderTypeBit::NONE;
-		if(fileExists(metaFname))
+		// Gather RT programs
+		if(!!(prog.m_shaderTypes & ShaderTypeBit::ALL_RAY_TRACING))
 		{
-			File metaFile;
-			ANKI_CHECK(metaFile.open(metaFname, FileOpenFlag::READ | FileOpenFlag::BINARY));
-			MetaFileData data;
-			ANKI_CHECK(metaFile.read(&data, sizeof(data)));
+			rtProgramFilenames.pushBack(prog.m_filename);
+		}
+	}
+
+	ANKI_RESOURCE_LOGI("Compiled %u shader programs out of %u. %u will be compiled on demand", shadersCompileCount,
+					   shadersTotalCount, shadersDeferredCount);
+	return Error::NONE;
+}
 
-			if(data.m_hash == 0 || data.m_shaderTypes == ShaderTypeBit::NONE)
+Error ShaderProgramResourceSystem::compileProgram(CString fname, CString cacheDir, GrManager& gr,
+												  ResourceFilesystem& fs, GenericMemoryPoolAllocator<U8>& alloc,
+												  ThreadHive& threadHive, Bool deferCompilation,
+												  ProgramCompileStatus& status, ShaderTypeBit& shaderTypes)
+{
+	// Compute hash for both
+	ShaderCompilerOptions compilerOptions;
+	compilerOptions.m_forceFullFloatingPointPrecision = gr.getConfig().getRsrcForceFullFpPrecision();
+	compilerOptions.m_mobilePlatform = ANKI_PLATFORM_MOBILE;
+	U64 gpuHash = computeHash(&compilerOptions, sizeof(compilerOptions));
+	gpuHash = appendHash(&SHADER_BINARY_VERSION, sizeof(SHADER_BINARY_VERSION), gpuHash);
+	gpuHash = appendHash(&HASH_ALGORITHM_VERSION, sizeof(HASH_ALGORITHM_VERSION), gpuHash);
+
+	// Get some filenames
+	StringAuto baseFname(alloc);
+	getFilepathFilename(fname, baseFname);
+	StringAuto metaFname(alloc);
+	metaFname.sprintf("%s/%smeta", cacheDir.cstr(), baseFname.cstr());
+
+	// Read the meta file
+	MetaFileHeader meta;
+	StringListAuto depFilenames(alloc);
+	DynamicArrayAuto<MetaFileDependency> deps(alloc);
+	ANKI_CHECK(readMetaFile(metaFname, alloc, meta, depFilenames, deps));
+	shaderTypes = meta.m_shaderTypes;
+
+	// If the compiler and the files the program depends on haven't changed the binary is up to date. That avoids the
+	// parsing
+	if(meta.m_hash != 0 && meta.m_gpuHash == gpuHash && deps.getSize() > 0)
+	{
+		Bool upToDate, timestampsChanged;
+		ANKI_CHECK(checkDependencies(fs, alloc, depFilenames, deps, upToDate, timestampsChanged));
+
+		if(upToDate)
+		{
+			if(timestampsChanged)
 			{
-				ANKI_RESOURCE_LOGE("Wrong data found in the metafile: %s", metaFname.cstr());
-				return Error::USER_DATA;
+				ANKI_CHECK(writeMetaFile(metaFname, meta, depFilenames, deps));
 			}
 
-			metafileHash = data.m_hash;
-			metafileShaderTypes = data.m_shaderTypes;
+			status = ProgramCompileStatus::UP_TO_DATE;
+			return Error::NONE;
 		}
+	}
+
+	// Load interface. It also gathers the dependencies of the program
+	class FSystem : public ShaderProgramFilesystemInterface
+	{
+	public:
+		ResourceFilesystem* m_fsystem = nullptr;
+		StringListAuto* m_depFilenames = nullptr;
+		DynamicArrayAuto<MetaFileDependency>* m_deps = nullptr;
 
-		// Load interface
-		class FSystem : public ShaderProgramFilesystemInterface
+		Error readAllText(CString filename, StringAuto& txt) final
 		{
-		public:
-			ResourceFilesystem* m_fsystem = nullptr;
+			ResourceFilePtr file;
+			ANKI_CHECK(m_fsystem->openFile(filename, file));
+			ANKI_CHECK(file->readAllText(txt));
 
-			Error readAllText(CString filename, StringAuto& txt) final
+			for(const String& depFname : *m_depFilenames)
 			{
-				ResourceFilePtr file;
-				ANKI_CHECK(m_fsystem->openFile(filename, file));
-				ANKI_CHECK(file->readAllText(txt));
-				return Error::NONE;
+				if(depFname == filename)
+				{
+					return Error::NONE;
+				}
 			}
-		} fsystem;
-		fsystem.m_fsystem = &fs;
 
-		// Skip interface
-		class Skip : public ShaderProgramPostParseInterface
+			MetaFileDependency dep;
+			ANKI_CHECK(m_fsystem->getFileModificationTime(filename, dep.m_timestamp));
+			dep.m_contentHash = computeShaderSourceHash(txt);
+			m_deps->emplaceBack(dep);
+			m_depFilenames->pushBack(filename);
+
+			return Error::NONE;
+		}
+	} fsystem;
+	StringListAuto newDepFilenames(alloc);
+	DynamicArrayAuto<MetaFileDependency> newDeps(alloc);
+	fsystem.m_fsystem = &fs;
+	fsystem.m_depFilenames = &newDepFilenames;
+	fsystem.m_deps = &newDeps;
+
+	// Skip interface
+	class Skip : public ShaderProgramPostParseInterface
+	{
+	public:
+		U64 m_metafileHash;
+		U64 m_newHash;
+		U64 m_gpuHash;
+		CString m_fname;
+		Bool m_deferCompilation;
+
+		Bool skipCompilation(U64 hash)
 		{
-		public:
-			U64 m_metafileHash;
-			U64 m_newHash;
-			U64 m_gpuHash;
-			CString m_fname;
+			ANKI_ASSERT(hash != 0);
+			const Array<U64, 2> hashes = {hash, m_gpuHash};
+			const U64 finalHash = computeHash(hashes.getBegin(), hashes.getSizeInBytes());
 
-			Bool skipCompilation(U64 hash)
-			{
-				ANKI_ASSERT(hash != 0);
-				const Array<U64, 2> hashes = {hash, m_gpuHash};
-				const U64 finalHash = computeHash(hashes.getBegin(), hashes.getSizeInBytes());
+			m_newHash = finalHash;
+			const Bool skip = finalHash == m_metafileHash;
 
-				m_newHash = finalHash;
-				const Bool skip = finalHash == m_metafileHash;
+			if(!skip && !m_deferCompilation)
+			{
+				ANKI_RESOURCE_LOGI("\t%s", m_fname.cstr());
+			}
 
-				if(!skip)
-				{
-					ANKI_RESOURCE_LOGI("\t%s", m_fname.cstr());
-				}
+			// When deferring only the parsing is needed to find if the binary is stale
+			return skip || m_deferCompilation;
+		};
+	} skip;
+	skip.m_metafileHash = meta.m_hash;
+	skip.m_newHash = 0;
+	skip.m_gpuHash = gpuHash;
+	skip.m_fname = fname;
+	skip.m_deferCompilation = deferCompilation;
+
+	// Threading interface. Many programs share the same hive so wait only for the tasks of this program
+	class TaskManager : public ShaderProgramAsyncTaskInterface
+	{
+	public:
+		ThreadHive* m_hive = nullptr;
+		GenericMemoryPoolAllocator<U8> m_alloc;
+		Mutex m_mtx;
+		ConditionVariable m_condVar;
+		U32 m_pendingTaskCount = 0;
 
-				return skip;
-			};
-		} skip;
-		skip.m_metafileHash = metafileHash;
-		skip.m_newHash = 0;
-		skip.m_gpuHash = gpuHash;
-		skip.m_fname = fname;
-
-		// Threading interface
-		class TaskManager : public ShaderProgramAsyncTaskInterface
+		void enqueueTask(void (*callback)(void* userData), void* userData)
 		{
-		public:
-			ThreadHive* m_hive = nullptr;
-			GenericMemoryPoolAllocator<U8> m_alloc;
+			class Ctx
+			{
+			public:
+				void (*m_callback)(void* userData);
+				void* m_userData;
+				TaskManager* m_taskManager;
+			};
+			Ctx* ctx = m_alloc.newInstance<Ctx>();
+			ctx->m_callback = callback;
+			ctx->m_userData = userData;
+			ctx->m_taskManager = this;
 
-			void enqueueTask(void (*callback)(void* userData), void* userData)
 			{
-				class Ctx
-				{
-				public:
-					void (*m_callback)(void* userData);
-					void* m_userData;
-					GenericMemoryPoolAllocator<U8> m_alloc;
-				};
-				Ctx* ctx = m_alloc.newInstance<Ctx>();
-				ctx->m_callback = callback;
-				ctx->m_userData = userData;
-				ctx->m_alloc = m_alloc;
-
-				m_hive->submitTask(
-					[](void* userData, U32 threadId, ThreadHive& hive, ThreadHiveSemaphore* signalSemaphore) {
-						Ctx* ctx = static_cast<Ctx*>(userData);
-						ctx->m_callback(ctx->m_userData);
-						auto alloc = ctx->m_alloc;
-						alloc.deleteInstance(ctx);
-					},
-					ctx);
-			}
-
-			Error joinTasks()
-			{
-				m_hive->waitAllTasks();
-				return Error::NONE;
-			}
-		} taskManager;
-		taskManager.m_hive = &threadHive;
-		taskManager.m_alloc = alloc;
-
-		// Compile
-		ShaderProgramBinaryWrapper binary(alloc);
-		ANKI_CHECK(compileShaderProgram(fname, fsystem, &skip, &taskManager, alloc, compilerOptions, binary));
-
-		const Bool cachedBinIsUpToDate = metafileHash == skip.m_newHash;
-		if(!cachedBinIsUpToDate)
+				LockGuard<Mutex> lock(m_mtx);
+				++m_pendingTaskCount;
+			}
+
+			m_hive->submitTask(
+				[](void* userData, U32 threadId, ThreadHive& hive, ThreadHiveSemaphore* signalSemaphore) {
+					Ctx* ctx = static_cast<Ctx*>(userData);
+					ctx->m_callback(ctx->m_userData);
+
+					TaskManager& self = *ctx->m_taskManager;
+					auto alloc = self.m_alloc;
+					alloc.deleteInstance(ctx);
+
+					LockGuard<Mutex> lock(self.m_mtx);
+					ANKI_ASSERT(self.m_pendingTaskCount > 0);
+					--self.m_pendingTaskCount;
+					if(self.m_pendingTaskCount == 0)
+					{
+						self.m_condVar.notifyAll();
+					}
+				},
+				ctx);
+		}
+
+		Error joinTasks()
 		{
-			++shadersCompileCount;
+			LockGuard<Mutex> lock(m_mtx);
+			while(m_pendingTaskCount > 0)
+			{
+				m_condVar.wait(m_mtx);
+			}
+			return Error::NONE;
 		}
+	} taskManager;
+	taskManager.m_hive = &threadHive;
+	taskManager.m_alloc = alloc;
+
+	// Compile
+	ShaderProgramBinaryWrapper binary(alloc);
+	ANKI_CHECK(compileShaderProgram(fname, fsystem, &skip, &taskManager, alloc, compilerOptions, binary));
+
+	// Update the dependencies
+	meta.m_dependencyCount = newDeps.getSize();
+
+	const Bool cachedBinIsUpToDate = meta.m_hash == skip.m_newHash;
+	if(cachedBinIsUpToDate)
+	{
+		// Store the dependencies. The next time the parsing will be avoided
+		meta.m_gpuHash = gpuHash;
+		ANKI_CHECK(writeMetaFile(metaFname, meta, newDepFilenames, newDeps));
+
+		status = ProgramCompileStatus::UP_TO_DATE;
+		return Error::NONE;
+	}
 
-		// Update the meta file
-		if(!cachedBinIsUpToDate)
+	if(deferCompilation)
+	{
+		status = ProgramCompileStatus::DEFERRED;
+		return Error::NONE;
+	}
+
+	status = ProgramCompileStatus::COMPILED;
+
+	// Save the binary to the cache. Do that before updating the meta file in case the compilation is interrupted
+	StringAuto storeFname(alloc);
+	storeFname.sprintf("%s/%sbin", cacheDir.cstr(), baseFname.cstr());
+	ANKI_CHECK(binary.serializeToFile(storeFname));
+
+	// Update the meta file
+	memcpy(&meta.m_magic[0], SHADER_META_FILE_MAGIC, sizeof(meta.m_magic));
+	meta.m_hash = skip.m_newHash;
+	meta.m_gpuHash = gpuHash;
+	meta.m_shaderTypes = binary.getBinary().m_presentShaderTypes;
+	shaderTypes = meta.m_shaderTypes;
+	ANKI_CHECK(writeMetaFile(metaFname, meta, newDepFilenames, newDeps));
+
+	return Error::NONE;
+}
+
+Error ShaderProgramResourceSystem::ensureProgramCompiled(CString filename)
+{
+	if(m_deferredPrograms.isEmpty())
+	{
+		return Error::NONE;
+	}
+
+	StringAuto baseFname(m_alloc);
+	getFilepathFilename(filename, baseFname);
+
+	DeferredProgram* prog = nullptr;
+	for(DeferredProgram& p : m_deferredPrograms)
+	{
+		if(p.m_baseFilename == baseFname)
 		{
-			File metaFile;
-			ANKI_CHECK(metaFile.open(metaFname, FileOpenFlag::WRITE | FileOpenFlag::BINARY));
-
-			MetaFileData data;
-			data.m_hash = skip.m_newHash;
-			data.m_shaderTypes = binary.getBinary().m_presentShaderTypes;
-			metafileShaderTypes = data.m_shaderTypes;
-			ANKI_CHECK(metaFile.write(&data, sizeof(data)));
+			prog = &p;
+			break;
 		}
+	}
+
+	if(prog == nullptr)
+	{
+		// Wasn't deferred, the binary is already there
+		return Error::NONE;
+	}
+
+	m_deferredMtx.lock();
+	while(prog->m_state == DeferredProgramState::COMPILING)
+	{
+		// The background thread is compiling it, wait
+		m_deferredCondVar.wait(m_deferredMtx);
+	}
+	const DeferredProgramState state = prog->m_state;
+	if(state == DeferredProgramState::PENDING)
+	{
+		prog->m_state = DeferredProgramState::COMPILING;
+	}
+	m_deferredMtx.unlock();
 
-		// Save the binary to the cache
-		if(!cachedBinIsUpToDate)
+	if(state == DeferredProgramState::PENDING)
+	{
+		// Someone needs it now. Compile it in this thread using the cores the background thread leaves free
+		LockGuard<Mutex> lock(m_onDemandMtx);
+		if(m_onDemandHive == nullptr)
 		{
-			StringAuto storeFname(alloc);
-			storeFname.sprintf("%s/%sbin", cacheDir.cstr(), baseFname.cstr());
-			ANKI_CHECK(binary.serializeToFile(storeFname));
+			const U32 threadCount = max(1u, getCpuCoresCount() - getCpuCoresCount() / 2);
+			m_onDemandHive = m_alloc.newInstance<ThreadHive>(threadCount, m_alloc, false);
 		}
 
-		// Gather RT programs
-		if(!!(metafileShaderTypes & ShaderTypeBit::ALL_RAY_TRACING))
+		compileDeferredProgram(*prog, *m_onDemandHive);
+	}
+
+	LockGuard<Mutex> lock(m_deferredMtx);
+	return (prog->m_state == DeferredProgramState::DONE) ? Error::NONE : Error::USER_DATA;
+}
+
+void ShaderProgramResourceSystem::compileDeferredProgram(DeferredProgram& prog, ThreadHive& hive)
+{
+	ANKI_TRACE_SCOPED_EVENT(COMPILE_SHADERS);
+	ANKI_RESOURCE_LOGI("Compiling deferred shader program: %s", prog.m_filename.cstr());
+
+	ProgramCompileStatus status;
+	ShaderTypeBit shaderTypes;
+	const Error err = compileProgram(prog.m_filename, m_cacheDir, *m_gr, *m_fs, m_alloc, hive, false, status,
+									 shaderTypes);
+	if(err)
+	{
+		ANKI_RESOURCE_LOGE("Failed to compile deferred shader program: %s", prog.m_filename.cstr());
+	}
+
+	LockGuard<Mutex> lock(m_deferredMtx);
+	ANKI_ASSERT(prog.m_state == DeferredProgramState::COMPILING);
+	prog.m_state = (err) ? DeferredProgramState::FAILED : DeferredProgramState::DONE;
+	m_deferredCondVar.notifyAll();
+}
+
+Error ShaderProgramResourceSystem::deferredThreadMain()
+{
+	// Use half the cores to leave some room for the rest of the engine
+	ThreadHive threadHive(max(1u, getCpuCoresCount() / 2), m_alloc, false);
+
+	for(DeferredProgram& prog : m_deferredPrograms)
+	{
 		{
-			rtProgramFilenames.pushBack(fname);
+			LockGuard<Mutex> lock(m_deferredMtx);
+
+			if(m_quitDeferredThread)
+			{
+				break;
+			}
+
+			if(prog.m_state != DeferredProgramState::PENDING)
+			{
+				// Someone else took it
+				continue;
+			}
+
+			prog.m_state = DeferredProgramState::COMPILING;
 		}
 
-		return Error::NONE;
-	}));
+		compileDeferredProgram(prog, threadHive);
+	}
 
-	ANKI_RESOURCE_LOGI("Compiled %u shader programs out of %u", shadersCompileCount, shadersTotalCount);
 	return Error::NONE;
 }
 
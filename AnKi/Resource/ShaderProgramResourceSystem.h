@@ -9,10 +9,14 @@
 #include <AnKi/Gr/ShaderProgram.h>
 #include <AnKi/Util/HashMap.h>
 #include <AnKi/Util/StringList.h>
+#include <AnKi/Util/Thread.h>
 #include <AnKi/ShaderCompiler/ShaderProgramBinary.h>
 
 namespace anki {
 
+// Forward
+class ThreadHive;
+
 /// @addtogroup resource
 /// @{
 
@@ -81,6 +85,7 @@ public:
 		: m_alloc(alloc)
 		, m_gr(gr)
 		, m_fs(fs)
+		, m_deferredThread("ShaderCompiler")
 	{
 		m_cacheDir.create(alloc, cacheDir);
 	}
@@ -94,16 +99,72 @@ public:
 		return m_rtLibraries;
 	}
 
+	/// Make sure that the cached binary of a program is up to date. If the compilation of the program was deferred
+	/// (see RsrcLazyShaderCompilation) it will compile it now or wait for the background thread to finish compiling it.
+	/// @note It's thread-safe.
+	ANKI_USE_RESULT Error ensureProgramCompiled(CString filename);
+
 private:
+	enum class ProgramCompileStatus : U8
+	{
+		UP_TO_DATE,
+		COMPILED,
+		DEFERRED
+	};
+
+	enum class DeferredProgramState : U8
+	{
+		PENDING,
+		COMPILING,
+		DONE,
+		FAILED
+	};
+
+	/// A stale program that will be compiled on first use or by the background thread.
+	class DeferredProgram
+	{
+	public:
+		String m_filename;
+		String m_baseFilename; ///< The cache uses that to name the binaries.
+		DeferredProgramState m_state = DeferredProgramState::PENDING;
+	};
+
 	GenericMemoryPoolAllocator<U8> m_alloc;
 	String m_cacheDir;
 	GrManager* m_gr;
 	ResourceFilesystem* m_fs;
 	DynamicArray<ShaderProgramRaytracingLibrary> m_rtLibraries;
 
-	/// Iterate all programs in the filesystem and compile them to AnKi's binary format.
+	/// @name Deferred compilation
+	/// @{
+	DynamicArray<DeferredProgram> m_deferredPrograms; ///< It doesn't change after init().
+	Mutex m_deferredMtx;
+	ConditionVariable m_deferredCondVar;
+	Thread m_deferredThread;
+	Bool m_deferredThreadStarted = false;
+	Bool m_quitDeferredThread = false;
+
+	/// Compiles the programs that are needed before the background thread gets to them. Created on first use.
+	ThreadHive* m_onDemandHive = nullptr;
+	Mutex m_onDemandMtx; ///< Protects m_onDemandHive and serializes the on-demand compilations.
+	/// @}
+
+	/// Iterate all programs in the filesystem and compile them to AnKi's binary format. If deferCompilation is true
+	/// the stale programs (except the ray tracing ones) are not compiled but they are added to
+	/// deferredProgramFilenames.
 	static Error compileAllShaders(CString cacheDir, GrManager& gr, ResourceFilesystem& fs,
-								   GenericMemoryPoolAllocator<U8>& alloc, StringListAuto& rtProgramFilenames);
+								   GenericMemoryPoolAllocator<U8>& alloc, Bool deferCompilation,
+								   StringListAuto& rtProgramFilenames, StringListAuto& deferredProgramFilenames);
+
+	/// Compile a single program if the cached binary is stale.
+	static Error compileProgram(CString fname, CString cacheDir, GrManager& gr, ResourceFilesystem& fs,
+								GenericMemoryPoolAllocator<U8>& alloc, ThreadHive& hive, Bool deferCompilation,
+								ProgramCompileStatus& status, ShaderTypeBit& shaderTypes);
+
+	/// Compile a deferred program and signal the waiters.
+	void compileDeferredProgram(DeferredProgram& prog, ThreadHive& hive);
+
+	Error deferredThreadMain();
 
 	static Error createRayTracingPrograms(CString cacheDir, const StringListAuto& rtProgramFilenames, GrManager& gr,
 										  GenericMemoryPoolAllocator<U8>& alloc,
@@ -8,6 +8,7 @@
 #include <AnKi/Scene/SceneGraph.h>
 #include <AnKi/Resource/ModelResource.h>
 #include <AnKi/Resource/ResourceManager.h>
+#include <AnKi/Core/GpuMemoryPools.h>
 
 namespace anki {
 
@@ -22,6 +23,11 @@ ModelComponent::ModelComponent(SceneNode* node)
 ModelComponent::~ModelComponent()
 {
 	m_modelPatchMergeKeys.destroy(m_node->getAllocator());
+
+	if(m_gpuSceneRenderableOffset != MAX_PTR_SIZE)
+	{
+		m_node->getSceneGraph().getGpuSceneMemory().free(sizeof(GpuSceneRenderable), m_gpuSceneRenderableOffset);
+	}
 }
 
 Error ModelComponent::loadModelResource(CString filename)
@@ -43,6 +49,13 @@ Error ModelComponent::loadModelResource(CString filename)
 		m_modelPatchMergeKeys[i] = computeHash(&toHash[0], sizeof(toHash));
 	}
 
+	// Allocate the space for the transforms. They will be uploaded by the node
+	if(m_gpuSceneRenderableOffset == MAX_PTR_SIZE)
+	{
+		ANKI_CHECK(m_node->getSceneGraph().getGpuSceneMemory().allocate(sizeof(GpuSceneRenderable),
+																		  m_gpuSceneRenderableOffset));
+	}
+
 	return Error::NONE;
 }
 
@@ -48,10 +48,19 @@ public:
 		return m_model.isCreated();
 	}
 
+	/// The offset of the node's GpuSceneRenderable in the GPU scene buffer.
+	U32 getGpuSceneRenderableOffset() const
+	{
+		ANKI_ASSERT(m_gpuSceneRenderableOffset != MAX_PTR_SIZE);
+		return U32(m_gpuSceneRenderableOffset);
+	}
+
 private:
 	SceneNode* m_node = nullptr;
 	ModelResourcePtr m_model;
 
+	PtrSize m_gpuSceneRenderableOffset = MAX_PTR_SIZE;
+
 	DynamicArray<U64> m_modelPatchMergeKeys;
 	Bool m_dirty = true;
 };
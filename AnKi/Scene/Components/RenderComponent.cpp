@@ -15,10 +15,11 @@ ANKI_SCENE_COMPONENT_STATICS(RenderComponent)
 
 void RenderComponent::allocateAndSetupUniforms(const MaterialResourcePtr& mtl, const RenderQueueDrawContext& ctx,
 											   ConstWeakArray<Mat3x4> transforms, ConstWeakArray<Mat3x4> prevTransforms,
-											   StagingGpuMemoryPool& alloc)
+											   StagingGpuMemoryPool& alloc, ConstWeakArray<U32> gpuSceneOffsets)
 {
 	ANKI_ASSERT(transforms.getSize() <= MAX_INSTANCE_COUNT);
 	ANKI_ASSERT(prevTransforms.getSize() == transforms.getSize());
+	ANKI_ASSERT(!mtl->supportsGpuScene() || gpuSceneOffsets.getSize() == transforms.getSize());
 
 	const MaterialVariant& variant = mtl->getOrCreateVariant(ctx.m_key);
 	const U32 set = mtl->getDescriptorSetIndex();
@@ -54,6 +55,13 @@ void RenderComponent::allocateAndSetupUniforms(const MaterialResourcePtr& mtl, c
 										   ctx.m_globalUniforms.m_buffer, ctx.m_globalUniforms.m_offset,
 										   ctx.m_globalUniforms.m_range);
 
+	if(mtl->supportsGpuScene())
+	{
+		ANKI_ASSERT(ctx.m_gpuSceneBuffer.isCreated());
+		ctx.m_commandBuffer->bindStorageBuffer(set, mtl->getGpuSceneStorageBlockBinding(), ctx.m_gpuSceneBuffer, 0,
+											   MAX_PTR_SIZE);
+	}
+
 	// Iterate variables
 	for(const MaterialVariable& mvar : mtl->getVariables())
 	{
@@ -64,6 +72,30 @@ void RenderComponent::allocateAndSetupUniforms(const MaterialResourcePtr& mtl, c
 
 		switch(mvar.getDataType())
 		{
+		case ShaderVariableDataType::U32:
+		{
+			switch(mvar.getBuiltin())
+			{
+			case BuiltinMaterialVariableId::NONE:
+			{
+				const U32 val = mvar.getValue<U32>();
+				variant.writeShaderBlockMemory(mvar, &val, 1, perDrawUniformsBegin, perDrawUniformsEnd);
+				break;
+			}
+			case BuiltinMaterialVariableId::GPU_SCENE_RENDERABLE_OFFSET:
+			{
+				ANKI_ASSERT(gpuSceneOffsets.getSize() > 0);
+				variant.writeShaderBlockMemory(mvar, &gpuSceneOffsets[0], gpuSceneOffsets.getSize(),
+											   (mvar.isInstanced()) ? perInstanceUniformsBegin : perDrawUniformsBegin,
+											   (mvar.isInstanced()) ? perInstanceUniformsEnd : perDrawUniformsEnd);
+				break;
+			}
+			default:
+				ANKI_ASSERT(0);
+			}
+
+			break;
+		}
 		case ShaderVariableDataType::F32:
 		{
 			const F32 val = mvar.getValue<F32>();
@@ -101,9 +101,12 @@ public:
 	}
 
 	/// Helper function.
+	/// @param gpuSceneOffsets The offsets of the GpuSceneRenderable of every instance. Only needed if the material
+	///                        supports the GPU scene.
 	static void allocateAndSetupUniforms(const MaterialResourcePtr& mtl, const RenderQueueDrawContext& ctx,
 										 ConstWeakArray<Mat3x4> transforms, ConstWeakArray<Mat3x4> prevTransforms,
-										 StagingGpuMemoryPool& alloc);
+										 StagingGpuMemoryPool& alloc,
+										 ConstWeakArray<U32> gpuSceneOffsets = ConstWeakArray<U32>());
 
 private:
 	RenderQueueDrawCallback m_callback = nullptr;
@@ -23,23 +23,34 @@ SkinComponent::SkinComponent(SceneNode* node)
 
 SkinComponent::~SkinComponent()
 {
-	m_boneTrfs[0].destroy(m_node->getAllocator());
-	m_boneTrfs[1].destroy(m_node->getAllocator());
-	m_animationTrfs.destroy(m_node->getAllocator());
+	destroyBoneArrays();
+}
+
+void SkinComponent::destroyBoneArrays()
+{
+	SceneAllocator<U8> alloc = m_node->getAllocator();
+	m_boneTrfs[0].destroy(alloc);
+	m_boneTrfs[1].destroy(alloc);
+	m_animationTranslations.destroy(alloc);
+	m_animationRotations.destroy(alloc);
+	m_animationScales.destroy(alloc);
+	m_animationMatrices.destroy(alloc);
 }
 
 Error SkinComponent::loadSkeletonResource(CString fname)
 {
 	ANKI_CHECK(m_node->getSceneGraph().getResourceManager().loadResource(fname, m_skeleton));
 
-	m_boneTrfs[0].destroy(m_node->getAllocator());
-	m_boneTrfs[1].destroy(m_node->getAllocator());
-	m_animationTrfs.destroy(m_node->getAllocator());
+	destroyBoneArrays();
 
-	m_boneTrfs[0].create(m_node->getAllocator(), m_skeleton->getBones().getSize(), Mat4::getIdentity());
-	m_boneTrfs[1].create(m_node->getAllocator(), m_skeleton->getBones().getSize(), Mat4::getIdentity());
-	m_animationTrfs.create(m_node->getAllocator(), m_skeleton->getBones().getSize(),
-						   {Vec3(0.0f), Quat::getIdentity(), 1.0f});
+	SceneAllocator<U8> alloc = m_node->getAllocator();
+	const U32 boneCount = m_skeleton->getBones().getSize();
+	m_boneTrfs[0].create(alloc, boneCount, Mat4::getIdentity());
+	m_boneTrfs[1].create(alloc, boneCount, Mat4::getIdentity());
+	m_animationTranslations.create(alloc, boneCount, Vec3(0.0f));
+	m_animationRotations.create(alloc, boneCount, Quat::getIdentity());
+	m_animationScales.create(alloc, boneCount, 1.0f);
+	m_animationMatrices.create(alloc, boneCount, Mat3x4::getIdentity());
 
 	return Error::NONE;
 }
@@ -153,17 +164,17 @@ Error SkinComponent::update(SceneNode& node, Second prevTime, Second crntTime, B
 
 				if(factor < 1.0f)
 				{
-					const Trf& prevTrf = m_animationTrfs[boneIdx];
-
-					position = linearInterpolate(prevTrf.m_translation, position, factor);
-					rotation = prevTrf.m_rotation.slerp(rotation, factor);
-					scale = linearInterpolate(prevTrf.m_scale, scale, factor);
+					position = linearInterpolate(m_animationTranslations[boneIdx], position, factor);
+					rotation = m_animationRotations[boneIdx].slerp(rotation, factor);
+					scale = linearInterpolate(m_animationScales[boneIdx], scale, factor);
 				}
 			}
 
 			// Store
 			bonesAnimated.set(boneIdx);
-			m_animationTrfs[boneIdx] = {position, rotation, scale};
+			m_animationTranslations[boneIdx] = position;
+			m_animationRotations[boneIdx] = rotation;
+			m_animationScales[boneIdx] = scale;
 		}
 	}
 
@@ -175,6 +186,10 @@ Error SkinComponent::update(SceneNode& node, Second prevTime, Second crntTime, B
 		m_prevBoneTrfs = m_crntBoneTrfs;
 		m_crntBoneTrfs = m_crntBoneTrfs ^ 1;
 
+		// Compute the matrices of all bones in one go. It's cheaper than computing only the animated ones one by one
+		makeMat3x4s(&m_animationTranslations[0], &m_animationRotations[0], &m_animationScales[0],
+					&m_animationMatrices[0], m_animationMatrices.getSize());
+
 		// Walk the bone hierarchy to add additional transforms
 		visitBones(m_skeleton->getRootBone(), Mat4::getIdentity(), bonesAnimated, minExtend, maxExtend);
 
@@ -199,8 +214,7 @@ void SkinComponent::visitBones(const Bone& bone, const Mat4& parentTrf, const Bi
 
 	if(bonesAnimated.get(bone.getIndex()))
 	{
-		const Trf& t = m_animationTrfs[bone.getIndex()];
-		outMat = parentTrf * Mat4(t.m_translation.xyz1(), Mat3(t.m_rotation), t.m_scale);
+		outMat = parentTrf * Mat4(m_animationMatrices[bone.getIndex()]);
 	}
 	else
 	{
@@ -90,24 +90,26 @@ private:
 		F32 m_repeatTimes = 1.0f;
 	};
 
-	class Trf
-	{
-	public:
-		Vec3 m_translation;
-		Quat m_rotation;
-		F32 m_scale;
-	};
-
 	SceneNode* m_node;
 	SkeletonResourcePtr m_skeleton;
 	Array<DynamicArray<Mat4>, 2> m_boneTrfs;
-	DynamicArray<Trf> m_animationTrfs;
+
+	/// @name Animation transforms of the bones. In SoA form for the batched math
+	/// @{
+	DynamicArray<Vec3> m_animationTranslations;
+	DynamicArray<Quat> m_animationRotations;
+	DynamicArray<F32> m_animationScales;
+	DynamicArray<Mat3x4> m_animationMatrices;
+	/// @}
+
 	Aabb m_boneBoundingVolume = Aabb(Vec3(-1.0f), Vec3(1.0f));
 	Array<Track, MAX_ANIMATION_TRACKS> m_tracks;
 	Second m_absoluteTime = 0.0;
 	U8 m_crntBoneTrfs = 0;
 	U8 m_prevBoneTrfs = 1;
 
+	void destroyBoneArrays();
+
 	void visitBones(const Bone& bone, const Mat4& parentTrf, const BitSet<128, U8>& bonesAnimated, Vec4& minExtend,
 					Vec4& maxExtend);
 };
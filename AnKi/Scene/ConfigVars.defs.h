@@ -9,6 +9,9 @@ ANKI_CONFIG_VAR_F32(Lod0MaxDistance, 20.0f, 1.0f, MAX_F32, "Distance that will b
 ANKI_CONFIG_VAR_F32(Lod1MaxDistance, 40.0f, 2.0f, MAX_F32, "Distance that will be used to calculate the LOD 1")
 
 ANKI_CONFIG_VAR_U32(SceneOctreeMaxDepth, 5, 2, 10, "The max depth of the octree")
+ANKI_CONFIG_VAR_BOOL(SceneThreadCachingMemory, true, "Serve the small allocations of the scene from per-thread caches")
+ANKI_CONFIG_VAR_BOOL(ScenePerThreadFrameMemory, true,
+					 "Every ThreadHive thread allocates frame memory from its own chunks")
 ANKI_CONFIG_VAR_F32(SceneEarlyZDistance, 10.0f, 0.0f, MAX_F32,
 					"Objects with distance lower than that will be used in early Z")
 
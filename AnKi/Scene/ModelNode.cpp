@@ -15,6 +15,7 @@
 #include <AnKi/Resource/ResourceManager.h>
 #include <AnKi/Resource/SkeletonResource.h>
 #include <AnKi/Physics/PhysicsWorld.h>
+#include <AnKi/Core/GpuMemoryPools.h>
 
 namespace anki {
 
@@ -110,6 +111,23 @@ void ModelNode::feedbackUpdate()
 		updateSpatial = true;
 	}
 
+	// GPU scene update
+	if(movec.getTimestamp() == globTimestamp || modelc.getTimestamp() == globTimestamp)
+	{
+		m_gpuSceneUploadFrameCount = 2;
+	}
+
+	if(m_gpuSceneUploadFrameCount > 0)
+	{
+		--m_gpuSceneUploadFrameCount;
+
+		GpuSceneRenderable renderable;
+		renderable.m_worldTransform = Mat3x4(movec.getWorldTransform());
+		renderable.m_previousWorldTransform = Mat3x4(movec.getPreviousWorldTransform());
+		getSceneGraph().getGpuSceneMicroPatcher().newCopy(modelc.getGpuSceneRenderableOffset(), sizeof(renderable),
+														   &renderable);
+	}
+
 	// Spatial update
 	if(updateSpatial)
 	{
@@ -208,9 +226,11 @@ void ModelNode::draw(RenderQueueDrawContext& ctx, ConstWeakArray<void*> userData
 		// Transforms
 		Array<Mat3x4, MAX_INSTANCE_COUNT> trfs;
 		Array<Mat3x4, MAX_INSTANCE_COUNT> prevTrfs;
+		Array<U32, MAX_INSTANCE_COUNT> gpuSceneOffsets;
 		const MoveComponent& movec = getFirstComponentOfType<MoveComponent>();
 		trfs[0] = Mat3x4(movec.getWorldTransform());
 		prevTrfs[0] = Mat3x4(movec.getPreviousWorldTransform());
+		gpuSceneOffsets[0] = modelc.getGpuSceneRenderableOffset();
 		Bool moved = trfs[0] != prevTrfs[0];
 		for(U32 i = 1; i < instanceCount; ++i)
 		{
@@ -224,6 +244,7 @@ void ModelNode::draw(RenderQueueDrawContext& ctx, ConstWeakArray<void*> userData
 			const MoveComponent& otherNodeMovec = otherNode.getFirstComponentOfType<MoveComponent>();
 			trfs[i] = Mat3x4(otherNodeMovec.getWorldTransform());
 			prevTrfs[i] = Mat3x4(otherNodeMovec.getPreviousWorldTransform());
+			gpuSceneOffsets[i] = otherNode.getFirstComponentOfType<ModelComponent>().getGpuSceneRenderableOffset();
 
 			moved = moved || (trfs[i] != prevTrfs[i]);
 		}
@@ -263,7 +284,7 @@ void ModelNode::draw(RenderQueueDrawContext& ctx, ConstWeakArray<void*> userData
 		RenderComponent::allocateAndSetupUniforms(
 			modelc.getModelResource()->getModelPatches()[modelPatchIdx].getMaterial(), ctx,
 			ConstWeakArray<Mat3x4>(&trfs[0], instanceCount), ConstWeakArray<Mat3x4>(&prevTrfs[0], instanceCount),
-			*ctx.m_stagingGpuAllocator);
+			*ctx.m_stagingGpuAllocator, ConstWeakArray<U32>(&gpuSceneOffsets[0], instanceCount));
 
 		// Set attributes
 		for(U i = 0; i < modelInf.m_vertexAttributeCount; ++i)
@@ -285,8 +306,19 @@ void ModelNode::draw(RenderQueueDrawContext& ctx, ConstWeakArray<void*> userData
 		cmdb->bindIndexBuffer(modelInf.m_indexBuffer, modelInf.m_indexBufferOffset, IndexType::U16);
 
 		// Draw
-		cmdb->drawElements(PrimitiveTopology::TRIANGLES, modelInf.m_indexCount, instanceCount, modelInf.m_firstIndex, 0,
-						   0);
+		if(ctx.m_indirectDraw.m_buffer.isCreated())
+		{
+			// The GPU will cull the instances and write the commands
+			ctx.m_indirectDraw.m_draw->m_indexCount = modelInf.m_indexCount;
+			ctx.m_indirectDraw.m_draw->m_firstIndex = modelInf.m_firstIndex;
+			cmdb->drawElementsIndirect(PrimitiveTopology::TRIANGLES, instanceCount, ctx.m_indirectDraw.m_offset,
+									   ctx.m_indirectDraw.m_buffer);
+		}
+		else
+		{
+			cmdb->drawElements(PrimitiveTopology::TRIANGLES, modelInf.m_indexCount, instanceCount,
+							   modelInf.m_firstIndex, 0, 0);
+		}
 	}
 	else
 	{
@@ -37,6 +37,10 @@ private:
 
 	Bool m_deferredRenderComponentUpdate = false;
 
+	/// Number of frames the GpuSceneRenderable needs to be uploaded. The previous transform settles a frame after the
+	/// last move so upload it one more time.
+	U8 m_gpuSceneUploadFrameCount = 0;
+
 	void feedbackUpdate();
 
 	void draw(RenderQueueDrawContext& ctx, ConstWeakArray<void*> userData, U32 modelPatchIdx) const;
@@ -55,7 +55,8 @@ SceneGraph::~SceneGraph()
 
 Error SceneGraph::init(AllocAlignedCallback allocCb, void* allocCbData, ThreadHive* threadHive,
 					   ResourceManager* resources, Input* input, ScriptManager* scriptManager, UiManager* uiManager,
-					   ConfigSet* config, const Timestamp* globalTimestamp)
+					   ConfigSet* config, const Timestamp* globalTimestamp, GpuSceneMemoryPool* gpuSceneMem,
+					   GpuSceneMicroPatcher* gpuSceneMicroPatcher)
 {
 	m_globalTimestamp = globalTimestamp;
 	m_threadHive = threadHive;
@@ -66,9 +67,15 @@ Error SceneGraph::init(AllocAlignedCallback allocCb, void* allocCbData, ThreadHi
 	m_scriptManager = scriptManager;
 	m_uiManager = uiManager;
 	m_config = config;
+	m_gpuSceneMem = gpuSceneMem;
+	m_gpuSceneMicroPatcher = gpuSceneMicroPatcher;
 
-	m_alloc = SceneAllocator<U8>(allocCb, allocCbData);
-	m_frameAlloc = SceneFrameAllocator<U8>(allocCb, allocCbData, 1 * 1024 * 1024);
+	m_alloc = SceneAllocator<U8>(allocCb, allocCbData, "Scene", m_config->getSceneThreadCachingMemory());
+	// Give every ThreadHive thread its own frame memory chunks. Slot 0 is for the rest of the threads
+	const U32 frameMemoryThreadSlotCount =
+		(m_config->getScenePerThreadFrameMemory()) ? m_threadHive->getThreadCount() + 1 : 1;
+	m_frameAlloc = SceneFrameAllocator<U8>(allocCb, allocCbData, 1 * 1024 * 1024, 2.0, 0, true, ANKI_SAFE_ALIGNMENT,
+										   "SceneFrame", frameMemoryThreadSlotCount);
 
 	ANKI_CHECK(m_events.init(this));
 
@@ -179,7 +186,7 @@ void SceneGraph::deleteNodesMarkedForDeletion()
 Error SceneGraph::update(Second prevUpdateTime, Second crntTime)
 {
 	ANKI_ASSERT(m_mainCam);
-	ANKI_TRACE_SCOPED_EVENT(SCENE_UPDATE);
+	ANKI_TRACE_SCOPED_HW_EVENT(SCENE_UPDATE);
 
 	m_stats.m_updateTime = HighRezTimer::getCurrentTime();
 
@@ -24,6 +24,8 @@ class ConfigSet;
 class PerspectiveCameraNode;
 class Octree;
 class UiManager;
+class GpuSceneMemoryPool;
+class GpuSceneMicroPatcher;
 
 /// @addtogroup scene
 /// @{
@@ -50,7 +52,8 @@ public:
 
 	ANKI_USE_RESULT Error init(AllocAlignedCallback allocCb, void* allocCbData, ThreadHive* threadHive,
 							   ResourceManager* resources, Input* input, ScriptManager* scriptManager,
-							   UiManager* uiManager, ConfigSet* config, const Timestamp* globalTimestamp);
+							   UiManager* uiManager, ConfigSet* config, const Timestamp* globalTimestamp,
+							   GpuSceneMemoryPool* gpuSceneMem, GpuSceneMicroPatcher* gpuSceneMicroPatcher);
 
 	Timestamp getGlobalTimestamp() const
 	{
@@ -223,6 +226,18 @@ public:
 		return *m_config;
 	}
 
+	ANKI_INTERNAL GpuSceneMemoryPool& getGpuSceneMemory()
+	{
+		ANKI_ASSERT(m_gpuSceneMem);
+		return *m_gpuSceneMem;
+	}
+
+	ANKI_INTERNAL GpuSceneMicroPatcher& getGpuSceneMicroPatcher()
+	{
+		ANKI_ASSERT(m_gpuSceneMicroPatcher);
+		return *m_gpuSceneMicroPatcher;
+	}
+
 private:
 	class UpdateSceneNodesCtx;
 
@@ -238,6 +253,8 @@ private:
 	ScriptManager* m_scriptManager = nullptr;
 	UiManager* m_uiManager = nullptr;
 	ConfigSet* m_config = nullptr;
+	GpuSceneMemoryPool* m_gpuSceneMem = nullptr;
+	GpuSceneMicroPatcher* m_gpuSceneMicroPatcher = nullptr;
 
 	SceneAllocator<U8> m_alloc;
 	SceneFrameAllocator<U8> m_frameAlloc;
@@ -376,6 +376,8 @@ void VisibilityTestTask::test(ThreadHive& hive, U32 taskId)
 										   : max(0.0f, testPlane(nearPlane, spatialc->getAabbWorldSpace()));
 
 			el->m_lod = computeLod(primaryFrc, el->m_distanceFromCamera);
+			el->m_aabbMin = spatialc->getAabbWorldSpace().getMin().xyz();
+			el->m_aabbMax = spatialc->getAabbWorldSpace().getMax().xyz();
 
 			// Add to early Z
 			if(wantsEarlyZ && el->m_distanceFromCamera < m_frcCtx->m_visCtx->m_earlyZDist
@@ -837,7 +839,7 @@ void CombineResultsTask::combineQueueElements(SceneFrameAllocator<U8>& alloc,
 
 void SceneGraph::doVisibilityTests(SceneNode& fsn, SceneGraph& scene, RenderQueue& rqueue)
 {
-	ANKI_TRACE_SCOPED_EVENT(SCENE_VIS_TESTS);
+	ANKI_TRACE_SCOPED_HW_EVENT(SCENE_VIS_TESTS);
 
 	ThreadHive& hive = scene.getThreadHive();
 
@@ -32,13 +32,22 @@ Error ShaderProgramBinaryWrapper::deserializeFromFile(CString fname)
 {
 	cleanup();
 
-	File file;
-	ANKI_CHECK(file.open(fname, FileOpenFlag::READ | FileOpenFlag::BINARY));
+	// Map the file and patch the pointers in place. The large parts of the binary (the SPIR-V of the code blocks) will
+	// only be paged in when they are accessed. If mapping is not possible fall back to reading the whole file
+	if(!m_mappedFile.map(fname))
+	{
+		ANKI_CHECK(BinaryDeserializer::deserializeInPlace(m_binary, m_mappedFile.getData(), m_mappedFile.getSize()));
+	}
+	else
+	{
+		File file;
+		ANKI_CHECK(file.open(fname, FileOpenFlag::READ | FileOpenFlag::BINARY));
 
-	BinaryDeserializer deserializer;
-	ANKI_CHECK(deserializer.deserialize(m_binary, m_alloc, file));
+		BinaryDeserializer deserializer;
+		ANKI_CHECK(deserializer.deserialize(m_binary, m_alloc, file));
 
-	m_singleAllocation = true;
+		m_singleAllocation = true;
+	}
 
 	if(memcmp(SHADER_BINARY_MAGIC, &m_binary->m_magic[0], strlen(SHADER_BINARY_MAGIC)) != 0)
 	{
@@ -57,6 +66,13 @@ void ShaderProgramBinaryWrapper::cleanup()
 		return;
 	}
 
+	if(m_mappedFile.isMapped())
+	{
+		m_mappedFile.unmap();
+		m_binary = nullptr;
+		return;
+	}
+
 	BaseMemoryPool& mempool = m_alloc.getMemoryPool();
 
 	if(!m_singleAllocation)
@@ -204,12 +220,124 @@ static Error compileSpirv(ConstWeakArray<MutatorValue> mutation, const ShaderPro
 	return Error::NONE;
 }
 
+/// Holds the unique code blocks of a program while its variants are compiled. The SPIR-V of one shader stage can't be
+/// identical to the SPIR-V of another so the storage is sharded per stage and every shard has its own lock.
+class CodeBlockTable
+{
+public:
+	CodeBlockTable(GenericMemoryPoolAllocator<U8> tmpAlloc, GenericMemoryPoolAllocator<U8> binaryAlloc)
+		: m_tmpAlloc(tmpAlloc)
+		, m_binaryAlloc(binaryAlloc)
+	{
+	}
+
+	CodeBlockTable(const CodeBlockTable&) = delete; // Non-copyable
+
+	~CodeBlockTable()
+	{
+		for(Shard& shard : m_shards)
+		{
+			shard.m_codeBlocks.destroy(m_tmpAlloc);
+			shard.m_hashToCodeBlockIdx.destroy(m_tmpAlloc);
+		}
+	}
+
+	CodeBlockTable& operator=(const CodeBlockTable&) = delete; // Non-copyable
+
+	/// Find an identical code block or create a new one.
+	/// @return The index of the code block inside the stage's shard.
+	/// @note It's thread-safe.
+	U32 findOrCreate(ShaderType shaderType, ConstWeakArray<U8> spirv, U64 hash)
+	{
+		Shard& shard = m_shards[shaderType];
+		LockGuard<Mutex> lock(shard.m_mtx);
+
+		Bool hashCollision = false;
+		auto it = shard.m_hashToCodeBlockIdx.find(hash);
+		if(it != shard.m_hashToCodeBlockIdx.getEnd())
+		{
+			// Compare the whole binary, two different blobs can't share a code block
+			const ShaderProgramBinaryCodeBlock& block = shard.m_codeBlocks[*it];
+			if(block.m_binary.getSize() == spirv.getSize()
+			   && memcmp(block.m_binary.getBegin(), spirv.getBegin(), spirv.getSizeInBytes()) == 0)
+			{
+				return *it;
+			}
+
+			// Unlikely. Store the new code block without indexing it
+			hashCollision = true;
+		}
+
+		U8* code = m_binaryAlloc.allocate(spirv.getSizeInBytes());
+		memcpy(code, spirv.getBegin(), spirv.getSizeInBytes());
+
+		ShaderProgramBinaryCodeBlock block;
+		block.m_binary.setArray(code, spirv.getSize());
+		block.m_hash = hash;
+		shard.m_codeBlocks.emplaceBack(m_tmpAlloc, block);
+
+		const U32 idx = shard.m_codeBlocks.getSize() - 1;
+		if(!hashCollision)
+		{
+			shard.m_hashToCodeBlockIdx.emplace(m_tmpAlloc, hash, idx);
+		}
+
+		return idx;
+	}
+
+	/// Move all the code blocks to a single array and fix the code block indices of the variants. Call it after all
+	/// variants are compiled.
+	void flatten(WeakArray<ShaderProgramBinaryVariant> variants,
+				 DynamicArrayAuto<ShaderProgramBinaryCodeBlock>& codeBlocks)
+	{
+		Array<U32, U32(ShaderType::COUNT)> firstCodeBlock;
+		U32 count = 0;
+		for(ShaderType shaderType : EnumIterable<ShaderType>())
+		{
+			firstCodeBlock[shaderType] = count;
+			count += m_shards[shaderType].m_codeBlocks.getSize();
+		}
+
+		codeBlocks.create(count);
+		for(ShaderType shaderType : EnumIterable<ShaderType>())
+		{
+			const Shard& shard = m_shards[shaderType];
+			for(U32 i = 0; i < shard.m_codeBlocks.getSize(); ++i)
+			{
+				codeBlocks[firstCodeBlock[shaderType] + i] = shard.m_codeBlocks[i];
+			}
+		}
+
+		for(ShaderProgramBinaryVariant& variant : variants)
+		{
+			for(ShaderType shaderType : EnumIterable<ShaderType>())
+			{
+				if(variant.m_codeBlockIndices[shaderType] != MAX_U32)
+				{
+					variant.m_codeBlockIndices[shaderType] += firstCodeBlock[shaderType];
+				}
+			}
+		}
+	}
+
+private:
+	class Shard
+	{
+	public:
+		Mutex m_mtx;
+		DynamicArray<ShaderProgramBinaryCodeBlock> m_codeBlocks;
+		HashMap<U64, U32> m_hashToCodeBlockIdx;
+	};
+
+	GenericMemoryPoolAllocator<U8> m_tmpAlloc;
+	GenericMemoryPoolAllocator<U8> m_binaryAlloc;
+	Array<Shard, U32(ShaderType::COUNT)> m_shards;
+};
+
 static void compileVariantAsync(ConstWeakArray<MutatorValue> mutation, const ShaderProgramParser& parser,
-								ShaderProgramBinaryVariant& variant,
-								DynamicArrayAuto<ShaderProgramBinaryCodeBlock>& codeBlocks,
-								DynamicArrayAuto<U64>& codeBlockHashes, GenericMemoryPoolAllocator<U8>& tmpAlloc,
-								GenericMemoryPoolAllocator<U8>& binaryAlloc,
-								ShaderProgramAsyncTaskInterface& taskManager, Mutex& mtx, Atomic<I32>& error)
+								ShaderProgramBinaryVariant& variant, CodeBlockTable& codeBlocks,
+								GenericMemoryPoolAllocator<U8>& tmpAlloc, ShaderProgramAsyncTaskInterface& taskManager,
+								Atomic<I32>& error)
 {
 	variant = {};
 
@@ -217,13 +345,10 @@ static void compileVariantAsync(ConstWeakArray<MutatorValue> mutation, const Sha
 	{
 	public:
 		GenericMemoryPoolAllocator<U8> m_tmpAlloc;
-		GenericMemoryPoolAllocator<U8> m_binaryAlloc;
 		DynamicArrayAuto<MutatorValue> m_mutation = {m_tmpAlloc};
 		const ShaderProgramParser* m_parser;
 		ShaderProgramBinaryVariant* m_variant;
-		DynamicArrayAuto<ShaderProgramBinaryCodeBlock>* m_codeBlocks;
-		DynamicArrayAuto<U64>* m_codeBlockHashes;
-		Mutex* m_mtx;
+		CodeBlockTable* m_codeBlocks;
 		Atomic<I32>* m_err;
 
 		Ctx(GenericMemoryPoolAllocator<U8> tmpAlloc)
@@ -233,14 +358,11 @@ static void compileVariantAsync(ConstWeakArray<MutatorValue> mutation, const Sha
 	};
 
 	Ctx* ctx = tmpAlloc.newInstance<Ctx>(tmpAlloc);
-	ctx->m_binaryAlloc = binaryAlloc;
 	ctx->m_mutation.create(mutation.getSize());
 	memcpy(ctx->m_mutation.getBegin(), mutation.getBegin(), mutation.getSizeInBytes());
 	ctx->m_parser = &parser;
 	ctx->m_variant = &variant;
 	ctx->m_codeBlocks = &codeBlocks;
-	ctx->m_codeBlockHashes = &codeBlockHashes;
-	ctx->m_mtx = &mtx;
 	ctx->m_err = &error;
 
 	auto callback = [](void* userData) {
@@ -271,10 +393,7 @@ static void compileVariantAsync(ConstWeakArray<MutatorValue> mutation, const Sha
 
 		if(!err)
 		{
-			// No error, check if the spirvs are common with some other variant and store it
-
-			LockGuard<Mutex> lock(*ctx.m_mtx);
-
+			// No error, check if the spirvs are common with some other variant and store them
 			for(ShaderType shaderType : EnumIterable<ShaderType>())
 			{
 				DynamicArrayAuto<U8>& spirv = spirvs[shaderType];
@@ -285,35 +404,9 @@ static void compileVariantAsync(ConstWeakArray<MutatorValue> mutation, const Sha
 					continue;
 				}
 
-				// Check if the spirv is already generated
-				const U64 newHash = computeHash(&spirv[0], spirv.getSize());
-				Bool found = false;
-				for(U32 i = 0; i < ctx.m_codeBlockHashes->getSize(); ++i)
-				{
-					if((*ctx.m_codeBlockHashes)[i] == newHash)
-					{
-						// Found it
-						ctx.m_variant->m_codeBlockIndices[shaderType] = i;
-						found = true;
-						break;
-					}
-				}
-
-				// Create it if not found
-				if(!found)
-				{
-					U8* code = ctx.m_binaryAlloc.allocate(spirv.getSizeInBytes());
-					memcpy(code, &spirv[0], spirv.getSizeInBytes());
-
-					ShaderProgramBinaryCodeBlock block;
-					block.m_binary.setArray(code, U32(spirv.getSizeInBytes()));
-					block.m_hash = newHash;
-
-					ctx.m_codeBlocks->emplaceBack(block);
-					ctx.m_codeBlockHashes->emplaceBack(newHash);
-
-					ctx.m_variant->m_codeBlockIndices[shaderType] = ctx.m_codeBlocks->getSize() - 1;
-				}
+				const U64 hash = computeHash(&spirv[0], spirv.getSize());
+				ctx.m_variant->m_codeBlockIndices[shaderType] = ctx.m_codeBlocks->findOrCreate(
+					shaderType, ConstWeakArray<U8>(&spirv[0], spirv.getSize()), hash);
 			}
 		}
 		else
@@ -989,7 +1082,6 @@ Error compileShaderProgramInternal(CString fname, ShaderProgramFilesystemInterfa
 	}
 
 	// Create all variants
-	Mutex mtx;
 	Atomic<I32> errorAtomic(0);
 	class SyncronousShaderProgramAsyncTaskInterface : public ShaderProgramAsyncTaskInterface
 	{
@@ -1014,9 +1106,8 @@ Error compileShaderProgramInternal(CString fname, ShaderProgramFilesystemInterfa
 		DynamicArrayAuto<MutatorValue> rewrittenMutationValues(tempAllocator, parser.getMutators().getSize());
 		DynamicArrayAuto<U32> dials(tempAllocator, parser.getMutators().getSize(), 0);
 		DynamicArrayAuto<ShaderProgramBinaryVariant> variants(binaryAllocator);
-		DynamicArrayAuto<ShaderProgramBinaryCodeBlock> codeBlocks(binaryAllocator);
+		CodeBlockTable codeBlockTable(tempAllocator, binaryAllocator);
 		DynamicArrayAuto<ShaderProgramBinaryMutation> mutations(binaryAllocator, mutationCount);
-		DynamicArrayAuto<U64> codeBlockHashes(tempAllocator);
 		HashMapAuto<U64, U32> mutationHashToIdx(tempAllocator);
 
 		// Grow the storage of the variants array. Can't have it resize, threads will work on stale data
@@ -1057,8 +1148,8 @@ Error compileShaderProgramInternal(CString fname, ShaderProgramFilesystemInterfa
 				ShaderProgramBinaryVariant& variant = *variants.emplaceBack();
 				baseVariant = (baseVariant == nullptr) ? variants.getBegin() : baseVariant;
 
-				compileVariantAsync(originalMutationValues, parser, variant, codeBlocks, codeBlockHashes, tempAllocator,
-									binaryAllocator, taskManager, mtx, errorAtomic);
+				compileVariantAsync(originalMutationValues, parser, variant, codeBlockTable, tempAllocator, taskManager,
+									errorAtomic);
 
 				mutation.m_variantIndex = variants.getSize() - 1;
 
@@ -1080,8 +1171,8 @@ Error compileShaderProgramInternal(CString fname, ShaderProgramFilesystemInterfa
 					variant = variants.emplaceBack();
 					baseVariant = (baseVariant == nullptr) ? variants.getBegin() : baseVariant;
 
-					compileVariantAsync(originalMutationValues, parser, *variant, codeBlocks, codeBlockHashes,
-										tempAllocator, binaryAllocator, taskManager, mtx, errorAtomic);
+					compileVariantAsync(originalMutationValues, parser, *variant, codeBlockTable, tempAllocator,
+										taskManager, errorAtomic);
 
 					ShaderProgramBinaryMutation& otherMutation = mutations[mutationCount++];
 					otherMutation.m_values.setArray(
@@ -1116,6 +1207,9 @@ Error compileShaderProgramInternal(CString fname, ShaderProgramFilesystemInterfa
 		variants.moveAndReset(firstVariant, size, storage);
 		binary.m_variants.setArray(firstVariant, size);
 
+		DynamicArrayAuto<ShaderProgramBinaryCodeBlock> codeBlocks(binaryAllocator);
+		codeBlockTable.flatten(binary.m_variants, codeBlocks);
+
 		ShaderProgramBinaryCodeBlock* firstCodeBlock;
 		codeBlocks.moveAndReset(firstCodeBlock, size, storage);
 		binary.m_codeBlocks.setArray(firstCodeBlock, size);
@@ -1127,17 +1221,19 @@ Error compileShaderProgramInternal(CString fname, ShaderProgramFilesystemInterfa
 	else
 	{
 		DynamicArrayAuto<MutatorValue> mutation(tempAllocator);
-		DynamicArrayAuto<ShaderProgramBinaryCodeBlock> codeBlocks(binaryAllocator);
-		DynamicArrayAuto<U64> codeBlockHashes(tempAllocator);
+		CodeBlockTable codeBlockTable(tempAllocator, binaryAllocator);
 
 		binary.m_variants.setArray(binaryAllocator.newInstance<ShaderProgramBinaryVariant>(), 1);
 
-		compileVariantAsync(mutation, parser, binary.m_variants[0], codeBlocks, codeBlockHashes, tempAllocator,
-							binaryAllocator, taskManager, mtx, errorAtomic);
+		compileVariantAsync(mutation, parser, binary.m_variants[0], codeBlockTable, tempAllocator, taskManager,
+							errorAtomic);
 
 		ANKI_CHECK(taskManager.joinTasks());
 		ANKI_CHECK(Error(errorAtomic.getNonAtomically()));
 
+		DynamicArrayAuto<ShaderProgramBinaryCodeBlock> codeBlocks(binaryAllocator);
+		codeBlockTable.flatten(binary.m_variants, codeBlocks);
+
 		ANKI_ASSERT(codeBlocks.getSize() == U32(__builtin_popcount(U32(parser.getShaderTypes()))));
 
 		ShaderProgramBinaryCodeBlock* firstCodeBlock;
@@ -7,6 +7,7 @@
 
 #include <AnKi/ShaderCompiler/ShaderProgramDump.h>
 #include <AnKi/Util/String.h>
+#include <AnKi/Util/File.h>
 #include <AnKi/Gr/Common.h>
 
 namespace anki {
@@ -14,8 +15,8 @@ namespace anki {
 /// @addtogroup shader_compiler
 /// @{
 
-constexpr const char* SHADER_BINARY_MAGIC = "ANKISDR7"; ///< WARNING: If changed change SHADER_BINARY_VERSION
-constexpr U32 SHADER_BINARY_VERSION = 7;
+constexpr const char* SHADER_BINARY_MAGIC = "ANKISDR8"; ///< WARNING: If changed change SHADER_BINARY_VERSION
+constexpr U32 SHADER_BINARY_VERSION = 8;
 
 /// A wrapper over the POD ShaderProgramBinary class.
 /// @memberof ShaderProgramCompiler
@@ -45,6 +46,8 @@ public:
 
 	ANKI_USE_RESULT Error serializeToFile(CString fname) const;
 
+	/// Load a binary. The file is memory mapped and the binary is accessed in place so only the parts of it that are
+	/// used (eg the code blocks of the variants that get created) are actually read from disk.
 	ANKI_USE_RESULT Error deserializeFromFile(CString fname);
 
 	const ShaderProgramBinary& getBinary() const
@@ -56,6 +59,7 @@ public:
 private:
 	GenericMemoryPoolAllocator<U8> m_alloc;
 	ShaderProgramBinary* m_binary = nullptr;
+	MappedFile m_mappedFile; ///< If the binary was loaded from a file it points inside this mapping.
 	Bool m_singleAllocation = false;
 
 	void cleanup();
@@ -0,0 +1,120 @@
+// Copyright (C) 2009-2022, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Shaders/Include/GpuCullingTypes.h>
+
+ANKI_BEGIN_NAMESPACE
+
+// Project a world space box to the screen. The UVs are clamped to [0, 1].
+ANKI_SHADER_FUNC_INLINE GpuCullingScreenBounds gpuCullingComputeScreenBounds(Vec3 aabbMin, Vec3 aabbMax,
+																			 ANKI_SHADER_IN(Mat4) viewProjMat)
+{
+	GpuCullingScreenBounds bounds;
+	bounds.m_uvMin = Vec2(1.0f, 1.0f);
+	bounds.m_uvMax = Vec2(0.0f, 0.0f);
+	bounds.m_nearestDepth = 1.0f;
+	bounds.m_crossesNearPlane = 0u;
+
+	for(U32 i = 0u; i < 8u; ++i)
+	{
+		const Vec4 p = Vec4(((i & 1u) != 0u) ? aabbMax.x() : aabbMin.x(), ((i & 2u) != 0u) ? aabbMax.y() : aabbMin.y(),
+							((i & 4u) != 0u) ? aabbMax.z() : aabbMin.z(), 1.0f);
+		const Vec4 clip = viewProjMat * p;
+
+		if(clip.w() <= 0.0f)
+		{
+			// Behind the camera, can't say anything
+			bounds.m_crossesNearPlane = 1u;
+			return bounds;
+		}
+
+		const Vec3 ndc = clip.xyz() / clip.w();
+		const F32 u = clamp(ndc.x() * 0.5f + 0.5f, 0.0f, 1.0f);
+		const F32 v = clamp(ndc.y() * 0.5f + 0.5f, 0.0f, 1.0f);
+
+		bounds.m_uvMin.x() = min(bounds.m_uvMin.x(), u);
+		bounds.m_uvMin.y() = min(bounds.m_uvMin.y(), v);
+		bounds.m_uvMax.x() = max(bounds.m_uvMax.x(), u);
+		bounds.m_uvMax.y() = max(bounds.m_uvMax.y(), v);
+		bounds.m_nearestDepth = min(bounds.m_nearestDepth, ndc.z());
+	}
+
+	return bounds;
+}
+
+// Choose the HiZ mip where the bounds touch at most 2x2 texels. The 1st mip holds the average depth and not the max so
+// it's skipped. Returns MAX_U32 if there is no such mip and the HiZ can't be used.
+ANKI_SHADER_FUNC_INLINE U32 gpuCullingChooseHiZMip(GpuCullingScreenBounds bounds, UVec2 hizSize, U32 hizMipCount)
+{
+	const F32 width = (bounds.m_uvMax.x() - bounds.m_uvMin.x()) * F32(hizSize.x());
+	const F32 height = (bounds.m_uvMax.y() - bounds.m_uvMin.y()) * F32(hizSize.y());
+	U32 extent = U32(max(width, height)) + 1u;
+
+	U32 mip = 1u;
+	extent = (extent + 1u) >> 1u;
+	while(extent > 1u && mip < hizMipCount)
+	{
+		extent = (extent + 1u) >> 1u;
+		++mip;
+	}
+
+	return (mip < hizMipCount) ? mip : MAX_U32;
+}
+
+// Test the bounds against the max depth of the HiZ texels they touch.
+ANKI_SHADER_FUNC_INLINE Bool gpuCullingIsOccluded(GpuCullingScreenBounds bounds, F32 hizMaxDepth)
+{
+	return bounds.m_crossesNearPlane == 0u && bounds.m_nearestDepth > hizMaxDepth;
+}
+
+ANKI_SHADER_FUNC_INLINE Bool gpuCullingGetBit(UVec2 mask, U32 bit)
+{
+	return (bit < 32u) ? ((mask.x() >> bit) & 1u) != 0u : ((mask.y() >> (bit - 32u)) & 1u) != 0u;
+}
+
+// Build the commandIdx-th indirect command of a drawcall. The visible instances are grouped into runs of consecutive
+// instances and every run becomes a single command. The commands are compacted to the beginning of the drawcall's range
+// and the ones that follow get zero instances.
+ANKI_SHADER_FUNC_INLINE GpuCullingDrawIndexedIndirectArgs gpuCullingBuildIndirectArgs(UVec2 visibleMask,
+																					  GpuCullingDraw draw,
+																					  U32 commandIdx)
+{
+	GpuCullingDrawIndexedIndirectArgs args;
+	args.m_indexCount = draw.m_indexCount;
+	args.m_instanceCount = 0u;
+	args.m_firstIndex = draw.m_firstIndex;
+	args.m_vertexOffset = 0;
+	args.m_firstInstance = 0u;
+
+	U32 runCount = 0u;
+	Bool prevVisible = false;
+	for(U32 i = 0u; i < draw.m_instanceCount && runCount <= commandIdx + 1u; ++i)
+	{
+		const Bool visible = gpuCullingGetBit(visibleMask, i);
+
+		if(visible && !prevVisible)
+		{
+			if(runCount == commandIdx)
+			{
+				args.m_firstInstance = i;
+			}
+
+			++runCount;
+		}
+
+		if(visible && runCount == commandIdx + 1u)
+		{
+			++args.m_instanceCount;
+		}
+
+		prevVisible = visible;
+	}
+
+	return args;
+}
+
+ANKI_END_NAMESPACE
@@ -0,0 +1,62 @@
+// Copyright (C) 2009-2022, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Shaders/Include/Common.h>
+
+ANKI_BEGIN_NAMESPACE
+
+// Every thread culls the instances of one drawcall.
+const U32 GPU_CULLING_WORKGROUP_SIZE = 64u;
+
+// World space bounding box of a single instance.
+struct GpuCullingInstance
+{
+	Vec3 m_aabbMin;
+	U32 m_padding0;
+	Vec3 m_aabbMax;
+	U32 m_padding1;
+};
+
+// A merged drawcall. Its instances and its indirect commands start at the same index. If m_instanceCount or
+// m_indexCount is zero then there is no drawcall in that slot.
+struct GpuCullingDraw
+{
+	U32 m_instanceCount;
+	U32 m_indexCount;
+	U32 m_firstIndex;
+	U32 m_padding;
+};
+
+// Same as VkDrawIndexedIndirectCommand.
+struct GpuCullingDrawIndexedIndirectArgs
+{
+	U32 m_indexCount;
+	U32 m_instanceCount;
+	U32 m_firstIndex;
+	I32 m_vertexOffset;
+	U32 m_firstInstance;
+};
+
+struct GpuCullingUniforms
+{
+	Mat4 m_previousViewProjectionMatrix; // The matrix the HiZ was rendered with.
+
+	UVec2 m_hizSize; // Size of the 1st mip of the HiZ.
+	U32 m_hizMipCount;
+	U32 m_drawCount; // The number of drawcall slots in the draw slot list.
+};
+
+// Screen space bounds of a bounding box.
+struct GpuCullingScreenBounds
+{
+	Vec2 m_uvMin;
+	Vec2 m_uvMax;
+	F32 m_nearestDepth;
+	U32 m_crossesNearPlane;
+};
+
+ANKI_END_NAMESPACE
@@ -0,0 +1,34 @@
+// Copyright (C) 2009-2022, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Shaders/Include/Common.h>
+
+ANKI_BEGIN_NAMESPACE
+
+// The per-node data that live in the GPU scene buffer. The materials read them using the offset they get in the
+// per-instance uniforms.
+struct GpuSceneRenderable
+{
+	Mat3x4 m_worldTransform;
+	Mat3x4 m_previousWorldTransform;
+};
+
+// Describes a copy from the per-frame data to the GPU scene.
+struct GpuSceneMicroPatch
+{
+	U32 m_srcDwordOffset;
+	U32 m_dstDwordOffset;
+	U32 m_dwordCount;
+	U32 m_padding;
+};
+
+const U32 GPU_SCENE_MICRO_PATCHING_WORKGROUP_SIZE = 64u;
+
+// Upper limit of the workgroups of the micro patching. The rest of the patches are processed in a loop.
+const U32 GPU_SCENE_MICRO_PATCHING_MAX_WORKGROUP_COUNT = 1024u;
+
+ANKI_END_NAMESPACE
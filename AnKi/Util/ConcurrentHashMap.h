@@ -0,0 +1,158 @@
+// Copyright (C) 2009-2022, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Util/HashMap.h>
+#include <AnKi/Util/Atomic.h>
+
+namespace anki {
+
+/// @addtogroup util_containers
+/// @{
+
+/// A hash map for read-mostly caches that are shared between threads. Lookups are lock-free and they don't write to
+/// any shared memory so readers don't bounce cache lines between cores. Insertions need to be serialized by the user
+/// (eg by a Mutex) but they can run concurrently with any number of lookups. Elements can't be erased and the values
+/// have stable addresses for the lifetime of the map.
+///
+/// The elements live in nodes that are immutable after they get published. The table is an array of atomic node
+/// pointers with linear probing. When the table grows a new one is published and the old one is retired instead of
+/// freed since readers might still be traversing it. The retired tables are freed by destroy() and their total size is
+/// less than the size of the current table.
+template<typename TKey, typename TValue, typename THasher = DefaultHasher<TKey>>
+class ConcurrentHashMap
+{
+public:
+	// Typedefs
+	using Value = TValue;
+	using Key = TKey;
+	using Hasher = THasher;
+
+	// Consts
+	static constexpr U32 INITIAL_CAPACITY_LOG2 = 4;
+	static constexpr U32 INITIAL_CAPACITY = 1u << INITIAL_CAPACITY_LOG2;
+
+	ConcurrentHashMap()
+		: m_table(nullptr)
+		, m_size(0)
+	{
+	}
+
+	ConcurrentHashMap(const ConcurrentHashMap&) = delete; // Non-copyable
+
+	/// You need to manually destroy the map.
+	/// @see ConcurrentHashMap::destroy
+	~ConcurrentHashMap()
+	{
+		ANKI_ASSERT(m_table.getNonAtomically() == nullptr && "Forgot to destroy");
+	}
+
+	ConcurrentHashMap& operator=(const ConcurrentHashMap&) = delete; // Non-copyable
+
+	/// Destroy the map. It's not thread-safe.
+	template<typename TAllocator>
+	void destroy(TAllocator alloc);
+
+	/// Find a value using a key.
+	/// @note It's thread-safe and lock-free. An element that is inserted concurrently might not be found.
+	/// @return The value or nullptr if not found.
+	TValue* find(const TKey& key) const
+	{
+		return findAs(key);
+	}
+
+	/// Same as find() but the key is some other type that the THasher and the TKey::operator== accept.
+	template<typename TKeyLike>
+	TValue* findAs(const TKeyLike& key) const;
+
+	/// Construct an element inside the map. The key shouldn't be present.
+	/// @note Concurrent calls to emplace need to be serialized by the user. It can run concurrently with find().
+	/// @return The new value.
+	template<typename TAllocator, typename TKeyArg, typename... TArgs>
+	TValue* emplace(TAllocator alloc, TKeyArg&& key, TArgs&&... args);
+
+	/// Iterate all elements. Don't call it concurrently with emplace().
+	/// @param func A functor with signature void(const TKey&, TValue&).
+	template<typename TFunc>
+	void iterate(TFunc func);
+
+	/// @note It's thread-safe.
+	U32 getSize() const
+	{
+		return m_size.load();
+	}
+
+	/// @note It's thread-safe.
+	Bool isEmpty() const
+	{
+		return getSize() == 0;
+	}
+
+private:
+	class Node
+	{
+	public:
+		U64 m_hash;
+		TKey m_key;
+		TValue m_value;
+
+		template<typename TKeyArg, typename... TArgs>
+		Node(U64 hash, TKeyArg&& key, TArgs&&... args)
+			: m_hash(hash)
+			, m_key(std::forward<TKeyArg>(key))
+			, m_value(std::forward<TArgs>(args)...)
+		{
+		}
+	};
+
+	using NodeAtomic = Atomic<Node*>;
+
+	/// The header of the table. The slots follow it in the same allocation.
+	class Table
+	{
+	public:
+		U32 m_capacityLog2;
+		Table* m_retired; ///< The previous table. Kept alive for the readers that might still use it.
+
+		U32 getCapacity() const
+		{
+			return 1u << m_capacityLog2;
+		}
+
+		NodeAtomic* getSlots()
+		{
+			return reinterpret_cast<NodeAtomic*>(this + 1);
+		}
+
+		const NodeAtomic* getSlots() const
+		{
+			return reinterpret_cast<const NodeAtomic*>(this + 1);
+		}
+
+		/// Fibonacci hashing to spread hashes with bad low bits.
+		U32 getFirstSlot(U64 hash) const
+		{
+			return U32((hash * 0x9E3779B97F4A7C15ull) >> (64 - m_capacityLog2));
+		}
+	};
+
+	static_assert(sizeof(Table) % alignof(NodeAtomic) == 0, "The slots need to be aligned");
+
+	Atomic<Table*> m_table;
+	Atomic<U32> m_size;
+
+	/// Allocate a table and move the nodes of the old one. Called by the writer.
+	template<typename TAllocator>
+	Table* grow(TAllocator alloc, Table* oldTable);
+
+	/// Put a node to a free slot. Called by the writer.
+	static void insertNode(Table& table, Node* node);
+};
+/// @}
+
+} // end namespace anki
+
+#include <AnKi/Util/ConcurrentHashMap.inl.h>
@@ -0,0 +1,163 @@
+// Copyright (C) 2009-2022, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Util/ConcurrentHashMap.h>
+
+namespace anki {
+
+template<typename TKey, typename TValue, typename THasher>
+template<typename TAllocator>
+void ConcurrentHashMap<TKey, TValue, THasher>::destroy(TAllocator alloc)
+{
+	Table* table = m_table.getNonAtomically();
+	if(table)
+	{
+		NodeAtomic* slots = table->getSlots();
+		for(U32 i = 0; i < table->getCapacity(); ++i)
+		{
+			Node* node = slots[i].getNonAtomically();
+			if(node)
+			{
+				alloc.deleteInstance(node);
+			}
+		}
+	}
+
+	while(table)
+	{
+		Table* retired = table->m_retired;
+		alloc.getMemoryPool().free(table);
+		table = retired;
+	}
+
+	m_table.setNonAtomically(nullptr);
+	m_size.setNonAtomically(0);
+}
+
+template<typename TKey, typename TValue, typename THasher>
+template<typename TKeyLike>
+TValue* ConcurrentHashMap<TKey, TValue, THasher>::findAs(const TKeyLike& key) const
+{
+	const Table* table = m_table.load(AtomicMemoryOrder::ACQUIRE);
+	if(table == nullptr)
+	{
+		return nullptr;
+	}
+
+	const U64 hash = THasher()(key);
+	const U32 mask = table->getCapacity() - 1;
+	const NodeAtomic* slots = table->getSlots();
+
+	// The load factor is at most 0.5 so there is always a free slot to stop the probing
+	for(U32 idx = table->getFirstSlot(hash);; idx = (idx + 1) & mask)
+	{
+		Node* node = slots[idx].load(AtomicMemoryOrder::ACQUIRE);
+		if(node == nullptr)
+		{
+			return nullptr;
+		}
+
+		if(node->m_hash == hash && key == node->m_key)
+		{
+			return &node->m_value;
+		}
+	}
+}
+
+template<typename TKey, typename TValue, typename THasher>
+template<typename TAllocator, typename TKeyArg, typename... TArgs>
+TValue* ConcurrentHashMap<TKey, TValue, THasher>::emplace(TAllocator alloc, TKeyArg&& key, TArgs&&... args)
+{
+	ANKI_ASSERT(find(key) == nullptr && "Key already exists");
+
+	Table* table = m_table.load(AtomicMemoryOrder::RELAXED);
+	const U32 newSize = m_size.load(AtomicMemoryOrder::RELAXED) + 1;
+	if(table == nullptr || newSize * 2 > table->getCapacity())
+	{
+		table = grow(alloc, table);
+	}
+
+	const U64 hash = THasher()(key);
+	Node* node = alloc.template newInstance<Node>(hash, std::forward<TKeyArg>(key), std::forward<TArgs>(args)...);
+	insertNode(*table, node);
+	m_size.store(newSize, AtomicMemoryOrder::RELAXED);
+
+	return &node->m_value;
+}
+
+template<typename TKey, typename TValue, typename THasher>
+template<typename TFunc>
+void ConcurrentHashMap<TKey, TValue, THasher>::iterate(TFunc func)
+{
+	Table* table = m_table.load(AtomicMemoryOrder::ACQUIRE);
+	if(table == nullptr)
+	{
+		return;
+	}
+
+	NodeAtomic* slots = table->getSlots();
+	for(U32 i = 0; i < table->getCapacity(); ++i)
+	{
+		Node* node = slots[i].load(AtomicMemoryOrder::ACQUIRE);
+		if(node)
+		{
+			func(static_cast<const TKey&>(node->m_key), node->m_value);
+		}
+	}
+}
+
+template<typename TKey, typename TValue, typename THasher>
+template<typename TAllocator>
+typename ConcurrentHashMap<TKey, TValue, THasher>::Table*
+ConcurrentHashMap<TKey, TValue, THasher>::grow(TAllocator alloc, Table* oldTable)
+{
+	const U32 newCapacityLog2 = (oldTable) ? oldTable->m_capacityLog2 + 1 : U32(INITIAL_CAPACITY_LOG2);
+	const U32 newCapacity = 1u << newCapacityLog2;
+
+	Table* newTable = static_cast<Table*>(alloc.getMemoryPool().allocate(
+		sizeof(Table) + sizeof(NodeAtomic) * newCapacity, max(alignof(Table), alignof(NodeAtomic))));
+	newTable->m_capacityLog2 = newCapacityLog2;
+	newTable->m_retired = oldTable;
+
+	NodeAtomic* newSlots = newTable->getSlots();
+	for(U32 i = 0; i < newCapacity; ++i)
+	{
+		::new(&newSlots[i]) NodeAtomic(nullptr);
+	}
+
+	if(oldTable)
+	{
+		const NodeAtomic* oldSlots = oldTable->getSlots();
+		for(U32 i = 0; i < oldTable->getCapacity(); ++i)
+		{
+			Node* node = oldSlots[i].load(AtomicMemoryOrder::RELAXED);
+			if(node)
+			{
+				insertNode(*newTable, node);
+			}
+		}
+	}
+
+	// Publish it. The readers that already have the old table will continue using it
+	m_table.store(newTable, AtomicMemoryOrder::RELEASE);
+	return newTable;
+}
+
+template<typename TKey, typename TValue, typename THasher>
+void ConcurrentHashMap<TKey, TValue, THasher>::insertNode(Table& table, Node* node)
+{
+	const U32 mask = table.getCapacity() - 1;
+	NodeAtomic* slots = table.getSlots();
+
+	U32 idx = table.getFirstSlot(node->m_hash);
+	while(slots[idx].load(AtomicMemoryOrder::RELAXED) != nullptr)
+	{
+		idx = (idx + 1) & mask;
+	}
+
+	slots[idx].store(node, AtomicMemoryOrder::RELEASE);
+}
+
+} // end namespace anki
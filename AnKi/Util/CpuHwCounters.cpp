@@ -0,0 +1,146 @@
+// Copyright (C) 2009-2022, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Util/CpuHwCounters.h>
+#if ANKI_OS_LINUX || ANKI_OS_ANDROID
+#	include <linux/perf_event.h>
+#	include <sys/syscall.h>
+#	include <unistd.h>
+#	include <cstring>
+#endif
+
+namespace anki {
+
+static const Array<const char*, U32(CpuHwCounter::COUNT)> g_counterNames = {
+	{"cycles", "instructions", "cache_misses", "branch_misses", "context_switches"}};
+
+CString CpuHwCounters::getCounterName(CpuHwCounter counter)
+{
+	return g_counterNames[counter];
+}
+
+#if ANKI_OS_LINUX || ANKI_OS_ANDROID
+
+Error CpuHwCounters::init()
+{
+	ANKI_ASSERT(!isInitialized());
+
+	class Desc
+	{
+	public:
+		U32 m_type;
+		U64 m_config;
+	};
+
+	static const Array<Desc, U32(CpuHwCounter::COUNT)> descs = {
+		{{PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+		 {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+		 {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+		 {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+		 {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES}}};
+
+	// All counters go to a single group so a read() gets all of them. The 1st counter that opens is the leader
+	int leaderFd = -1;
+	U8 groupSize = 0;
+	for(CpuHwCounter counter = CpuHwCounter::FIRST; counter < CpuHwCounter::COUNT; ++counter)
+	{
+		perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = descs[counter].m_type;
+		attr.config = descs[counter].m_config;
+		attr.read_format = PERF_FORMAT_GROUP;
+		attr.exclude_kernel = 1; // Needed if perf_event_paranoid is 2
+		attr.exclude_hv = 1;
+
+		const int fd = int(syscall(__NR_perf_event_open, &attr, 0, -1, leaderFd, PERF_FLAG_FD_CLOEXEC));
+		if(fd < 0)
+		{
+			continue;
+		}
+
+		if(leaderFd < 0)
+		{
+			leaderFd = fd;
+		}
+
+		m_fds[counter] = fd;
+		m_groupIndices[counter] = groupSize++;
+		m_supportedCounters |= 1u << U32(counter);
+	}
+
+	return (isInitialized()) ? Error::NONE : Error::FUNCTION_FAILED;
+}
+
+void CpuHwCounters::destroy()
+{
+	// Close the leader last
+	for(I32 i = I32(CpuHwCounter::COUNT) - 1; i >= 0; --i)
+	{
+		if(m_fds[i] >= 0)
+		{
+			close(m_fds[i]);
+			m_fds[i] = -1;
+		}
+	}
+
+	m_supportedCounters = 0;
+}
+
+void CpuHwCounters::read(CpuHwCounterValues& values) const
+{
+	values = {};
+	if(!isInitialized())
+	{
+		return;
+	}
+
+	int leaderFd = -1;
+	for(int fd : m_fds)
+	{
+		if(fd >= 0)
+		{
+			leaderFd = fd;
+			break;
+		}
+	}
+
+	// The format of PERF_FORMAT_GROUP is the count followed by the values
+	Array<U64, U32(CpuHwCounter::COUNT) + 1> data;
+	const ssize_t bytes = ::read(leaderFd, &data[0], sizeof(data));
+	if(bytes < ssize_t(sizeof(U64)))
+	{
+		return;
+	}
+
+	const U64 count = data[0];
+	for(CpuHwCounter counter = CpuHwCounter::FIRST; counter < CpuHwCounter::COUNT; ++counter)
+	{
+		if(isCounterSupported(counter) && m_groupIndices[counter] < count)
+		{
+			values[counter] = data[m_groupIndices[counter] + 1];
+		}
+	}
+}
+
+#else
+
+Error CpuHwCounters::init()
+{
+	return Error::FUNCTION_FAILED;
+}
+
+void CpuHwCounters::destroy()
+{
+}
+
+void CpuHwCounters::read(CpuHwCounterValues& values) const
+{
+	values = {};
+}
+
+#endif
+
+} // end namespace anki
@@ -0,0 +1,81 @@
+// Copyright (C) 2009-2022, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Util/Array.h>
+#include <AnKi/Util/Enum.h>
+#include <AnKi/Util/String.h>
+
+namespace anki {
+
+/// @addtogroup util_other
+/// @{
+
+/// @memberof CpuHwCounters
+enum class CpuHwCounter : U8
+{
+	CYCLES,
+	INSTRUCTIONS,
+	CACHE_MISSES,
+	BRANCH_MISSES,
+	CONTEXT_SWITCHES,
+
+	COUNT,
+	FIRST = 0
+};
+ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(CpuHwCounter)
+
+/// @memberof CpuHwCounters
+using CpuHwCounterValues = Array<U64, U32(CpuHwCounter::COUNT)>;
+
+/// Counts CPU events of a single thread. On Linux it's built on top of perf_event_open. The counters that are not
+/// available (other OSes, VMs without a PMU, high perf_event_paranoid etc) read as zero.
+class CpuHwCounters
+{
+public:
+	CpuHwCounters() = default;
+
+	CpuHwCounters(const CpuHwCounters&) = delete; // Non-copyable
+
+	~CpuHwCounters()
+	{
+		destroy();
+	}
+
+	CpuHwCounters& operator=(const CpuHwCounters&) = delete; // Non-copyable
+
+	/// Start counting the events of the calling thread.
+	/// @return An error if none of the counters is available. It doesn't log anything, that's up to the caller.
+	ANKI_USE_RESULT Error init();
+
+	void destroy();
+
+	Bool isInitialized() const
+	{
+		return m_supportedCounters != 0;
+	}
+
+	Bool isCounterSupported(CpuHwCounter counter) const
+	{
+		return (m_supportedCounters & (1u << U32(counter))) != 0;
+	}
+
+	/// Read the values since init(). Values of unsupported counters are zero.
+	/// @note It can be called from any thread but it will read the counters of the thread that called init().
+	void read(CpuHwCounterValues& values) const;
+
+	static CString getCounterName(CpuHwCounter counter);
+
+private:
+	U32 m_supportedCounters = 0; ///< Mask of CpuHwCounter.
+#if ANKI_OS_LINUX || ANKI_OS_ANDROID
+	Array<int, U32(CpuHwCounter::COUNT)> m_fds = {-1, -1, -1, -1, -1};
+	Array<U8, U32(CpuHwCounter::COUNT)> m_groupIndices = {}; ///< Where the value is in the group read.
+#endif
+};
+/// @}
+
+} // end namespace anki
@@ -15,6 +15,11 @@
 #endif
 #if ANKI_POSIX
 #	include <sys/stat.h>
+#	include <sys/mman.h>
+#	include <fcntl.h>
+#	include <unistd.h>
+#elif ANKI_OS_WINDOWS
+#	include <AnKi/Util/Win32Minimal.h>
 #endif
 
 namespace anki {
@@ -472,4 +477,99 @@ Error File::readAllText(StringAuto& out)
 	return err;
 }
 
+Error MappedFile::map(CString filename)
+{
+	unmap();
+
+#if ANKI_POSIX
+	const int fd = ::open(filename.cstr(), O_RDONLY);
+	if(fd < 0)
+	{
+		ANKI_UTIL_LOGE("open() failed: %s", filename.cstr());
+		return Error::FILE_ACCESS;
+	}
+
+	struct stat stbuf;
+	if(fstat(fd, &stbuf) != 0 || !S_ISREG(stbuf.st_mode) || stbuf.st_size == 0)
+	{
+		ANKI_UTIL_LOGE("fstat() failed or the file is not a regular non-empty file: %s", filename.cstr());
+		::close(fd);
+		return Error::FUNCTION_FAILED;
+	}
+
+	const PtrSize size = PtrSize(stbuf.st_size);
+	void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+
+	// The mapping holds its own reference to the file
+	::close(fd);
+
+	if(data == MAP_FAILED)
+	{
+		ANKI_UTIL_LOGE("mmap() failed: %s", filename.cstr());
+		return Error::FUNCTION_FAILED;
+	}
+
+	m_data = data;
+	m_size = size;
+#elif ANKI_OS_WINDOWS
+	const HANDLE file = CreateFileA(filename.cstr(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+									FILE_ATTRIBUTE_NORMAL, nullptr);
+	if(file == INVALID_HANDLE_VALUE)
+	{
+		ANKI_UTIL_LOGE("CreateFileA() failed: %s", filename.cstr());
+		return Error::FILE_ACCESS;
+	}
+
+	LARGE_INTEGER fileSize;
+	if(!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+	{
+		ANKI_UTIL_LOGE("GetFileSizeEx() failed or the file is empty: %s", filename.cstr());
+		CloseHandle(file);
+		return Error::FUNCTION_FAILED;
+	}
+
+	const HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+	CloseHandle(file);
+	if(mapping == nullptr)
+	{
+		ANKI_UTIL_LOGE("CreateFileMappingA() failed: %s", filename.cstr());
+		return Error::FUNCTION_FAILED;
+	}
+
+	// The view holds its own reference to the mapping object
+	void* data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+	CloseHandle(mapping);
+	if(data == nullptr)
+	{
+		ANKI_UTIL_LOGE("MapViewOfFile() failed: %s", filename.cstr());
+		return Error::FUNCTION_FAILED;
+	}
+
+	m_data = data;
+	m_size = PtrSize(fileSize.QuadPart);
+#else
+	ANKI_UTIL_LOGE("Memory mapped files are not supported on this platform");
+	return Error::FUNCTION_FAILED;
+#endif
+
+	return Error::NONE;
+}
+
+void MappedFile::unmap()
+{
+	if(m_data == nullptr)
+	{
+		return;
+	}
+
+#if ANKI_POSIX
+	munmap(m_data, m_size);
+#elif ANKI_OS_WINDOWS
+	UnmapViewOfFile(m_data);
+#endif
+
+	m_data = nullptr;
+	m_size = 0;
+}
+
 } // end namespace anki
@@ -142,6 +142,57 @@ private:
 		m_size = 0;
 	}
 };
+
+/// A read-only view of a regular file that is mapped to memory. The mapping is private (copy-on-write) so the caller
+/// can patch the contents in place without touching the file. Only the pages that are accessed get paged in.
+class MappedFile
+{
+public:
+	MappedFile() = default;
+
+	MappedFile(const MappedFile&) = delete; // Non-copyable
+
+	MappedFile& operator=(const MappedFile&) = delete; // Non-copyable
+
+	/// Unmaps the file if it's mapped.
+	~MappedFile()
+	{
+		unmap();
+	}
+
+	/// Map a file. It can only map regular files, not files in archives or Android assets.
+	ANKI_USE_RESULT Error map(CString filename);
+
+	/// Unmap the file.
+	void unmap();
+
+	Bool isMapped() const
+	{
+		return m_data != nullptr;
+	}
+
+	void* getData()
+	{
+		ANKI_ASSERT(m_data);
+		return m_data;
+	}
+
+	const void* getData() const
+	{
+		ANKI_ASSERT(m_data);
+		return m_data;
+	}
+
+	PtrSize getSize() const
+	{
+		ANKI_ASSERT(m_data);
+		return m_size;
+	}
+
+private:
+	void* m_data = nullptr;
+	PtrSize m_size = 0;
+};
 /// @}
 
 } // end namespace anki
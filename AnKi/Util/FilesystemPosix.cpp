@@ -233,7 +233,11 @@ Error getFileModificationTime(CString filename, U32& year, U32& month, U32& day,
 	}
 
 	struct tm t;
+#if ANKI_OS_MACOS
+	localtime_r(&buff.st_mtimespec.tv_sec, &t);
+#else
 	localtime_r(&buff.st_mtim.tv_sec, &t);
+#endif
 	year = 1900 + t.tm_year;
 	month = t.tm_mon + 1;
 	day = t.tm_mday;
@@ -243,4 +247,22 @@ Error getFileModificationTime(CString filename, U32& year, U32& month, U32& day,
 	return Error::NONE;
 }
 
+Error getFileModificationTime(CString filename, U64& timestamp)
+{
+	struct stat buff;
+	if(stat(filename.cstr(), &buff))
+	{
+		ANKI_UTIL_LOGE("stat() failed: %s", filename.cstr());
+		return Error::FUNCTION_FAILED;
+	}
+
+#if ANKI_OS_MACOS
+	const struct timespec& mtime = buff.st_mtimespec;
+#else
+	const struct timespec& mtime = buff.st_mtim;
+#endif
+	timestamp = U64(mtime.tv_sec) * 1000000000ull + U64(mtime.tv_nsec);
+	return Error::NONE;
+}
+
 } // end namespace anki
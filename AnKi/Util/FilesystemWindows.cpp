@@ -197,4 +197,19 @@ Error walkDirectoryTreeInternal(const CString& dir, const Function<Error(const C
 	return walkDirectoryTreeRecursive(dir, callback, baseDirLen);
 }
 
+Error getFileModificationTime(CString filename, U64& timestamp)
+{
+	WIN32_FIND_DATAA data;
+	HANDLE handle = FindFirstFileA(filename.cstr(), &data);
+	if(handle == INVALID_HANDLE_VALUE)
+	{
+		ANKI_UTIL_LOGE("FindFirstFileA() failed: %s", filename.cstr());
+		return Error::FUNCTION_FAILED;
+	}
+
+	FindClose(handle);
+	timestamp = (U64(data.ftLastWriteTime.dwHighDateTime) << 32) | U64(data.ftLastWriteTime.dwLowDateTime);
+	return Error::NONE;
+}
+
 } // end namespace anki
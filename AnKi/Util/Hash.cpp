@@ -5,13 +5,399 @@
 
 #include <AnKi/Util/Hash.h>
 #include <AnKi/Util/Assert.h>
+#include <AnKi/Util/Array.h>
+#include <cstring>
+#if ANKI_SIMD_SSE
+#	include <emmintrin.h>
+#elif ANKI_SIMD_NEON
+#	include <arm_neon.h>
+#endif
 
 namespace anki {
 
+// The XXH3 implementation follows the XXH3 64bit spec (xxHash by Yann Collet). The output matches the reference
+// implementation bit for bit. All the reads are little endian, like all the platforms AnKi supports.
+
+constexpr U32 XXH_PRIME32_1 = 0x9E3779B1u;
+constexpr U32 XXH_PRIME32_2 = 0x85EBCA77u;
+constexpr U32 XXH_PRIME32_3 = 0xC2B2AE3Du;
+constexpr U64 XXH_PRIME64_1 = 0x9E3779B185EBCA87ull;
+constexpr U64 XXH_PRIME64_2 = 0xC2B2AE3D27D4EB4Full;
+constexpr U64 XXH_PRIME64_3 = 0x165667B19E3779F9ull;
+constexpr U64 XXH_PRIME64_4 = 0x85EBCA77C2B2AE63ull;
+constexpr U64 XXH_PRIME64_5 = 0x27D4EB2F165667C5ull;
+constexpr U64 XXH_PRIME_MX1 = 0x165667919E3779F9ull;
+constexpr U64 XXH_PRIME_MX2 = 0x9FB21C651E98DF25ull;
+
+constexpr U32 XXH_SECRET_SIZE = 192;
+constexpr U32 XXH_STRIPE_LEN = 64;
+constexpr U32 XXH_SECRET_CONSUME_RATE = 8;
+constexpr U32 XXH_ACC_COUNT = 8;
+constexpr U32 XXH_STRIPES_PER_BLOCK = (XXH_SECRET_SIZE - XXH_STRIPE_LEN) / XXH_SECRET_CONSUME_RATE;
+constexpr U32 XXH_BLOCK_LEN = XXH_STRIPE_LEN * XXH_STRIPES_PER_BLOCK;
+constexpr U32 XXH_SECRET_LASTACC_START = 7;
+constexpr U32 XXH_SECRET_MERGEACCS_START = 11;
+constexpr U32 XXH_MIDSIZE_MAX = 240;
+constexpr U32 XXH_MIDSIZE_STARTOFFSET = 3;
+constexpr U32 XXH_MIDSIZE_LASTOFFSET = 17;
+
+alignas(64) static const Array<U8, XXH_SECRET_SIZE> XXH_SECRET = {
+	{0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c, 0xde, 0xd4, 0x6d,
+	 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f, 0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0,
+	 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21, 0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0,
+	 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c, 0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b,
+	 0x1b, 0x53, 0x2e, 0xa3, 0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac,
+	 0xd8, 0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d, 0x8a, 0x51,
+	 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64, 0xea, 0xc5, 0xac, 0x83, 0x34,
+	 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb, 0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49,
+	 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e, 0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8,
+	 0xd1, 0x7a, 0xd0, 0x31, 0xce, 0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b,
+	 0x40, 0x7e}};
+
+static inline ANKI_FORCE_INLINE U32 readLe32(const U8* ptr)
+{
+	U32 out;
+	memcpy(&out, ptr, sizeof(out));
+	return out;
+}
+
+static inline ANKI_FORCE_INLINE U64 readLe64(const U8* ptr)
+{
+	U64 out;
+	memcpy(&out, ptr, sizeof(out));
+	return out;
+}
+
+static inline ANKI_FORCE_INLINE void writeLe64(U8* ptr, U64 val)
+{
+	memcpy(ptr, &val, sizeof(val));
+}
+
+static inline ANKI_FORCE_INLINE U64 rotl64(U64 x, U32 r)
+{
+	return (x << r) | (x >> (64 - r));
+}
+
+static inline ANKI_FORCE_INLINE U32 swap32(U32 x)
+{
+	return ((x << 24) & 0xff000000) | ((x << 8) & 0x00ff0000) | ((x >> 8) & 0x0000ff00) | ((x >> 24) & 0x000000ff);
+}
+
+static inline ANKI_FORCE_INLINE U64 swap64(U64 x)
+{
+	return (U64(swap32(U32(x))) << 32) | U64(swap32(U32(x >> 32)));
+}
+
+/// Multiply 2 64bit numbers and xor the 2 halves of the 128bit result.
+static inline ANKI_FORCE_INLINE U64 mul128Fold64(U64 a, U64 b)
+{
+#if defined(__SIZEOF_INT128__)
+	const __uint128_t product = __uint128_t(a) * __uint128_t(b);
+	return U64(product) ^ U64(product >> 64);
+#else
+	const U64 loLo = (a & 0xFFFFFFFF) * (b & 0xFFFFFFFF);
+	const U64 hiLo = (a >> 32) * (b & 0xFFFFFFFF);
+	const U64 loHi = (a & 0xFFFFFFFF) * (b >> 32);
+	const U64 hiHi = (a >> 32) * (b >> 32);
+	const U64 cross = (loLo >> 32) + (hiLo & 0xFFFFFFFF) + loHi;
+	const U64 upper = (hiLo >> 32) + (cross >> 32) + hiHi;
+	const U64 lower = (cross << 32) | (loLo & 0xFFFFFFFF);
+	return lower ^ upper;
+#endif
+}
+
+static inline ANKI_FORCE_INLINE U64 xxh64Avalanche(U64 h)
+{
+	h ^= h >> 33;
+	h *= XXH_PRIME64_2;
+	h ^= h >> 29;
+	h *= XXH_PRIME64_3;
+	h ^= h >> 32;
+	return h;
+}
+
+static inline ANKI_FORCE_INLINE U64 xxh3Avalanche(U64 h)
+{
+	h ^= h >> 37;
+	h *= XXH_PRIME_MX1;
+	h ^= h >> 32;
+	return h;
+}
+
+static inline ANKI_FORCE_INLINE U64 xxh3Rrmxmx(U64 h, U64 len)
+{
+	h ^= rotl64(h, 49) ^ rotl64(h, 24);
+	h *= XXH_PRIME_MX2;
+	h ^= (h >> 35) + len;
+	h *= XXH_PRIME_MX2;
+	h ^= h >> 28;
+	return h;
+}
+
+static inline ANKI_FORCE_INLINE U64 xxh3Mix16B(const U8* input, const U8* secret, U64 seed)
+{
+	const U64 inputLo = readLe64(input);
+	const U64 inputHi = readLe64(input + 8);
+	return mul128Fold64(inputLo ^ (readLe64(secret) + seed), inputHi ^ (readLe64(secret + 8) - seed));
+}
+
+static U64 xxh3Len0To16(const U8* input, PtrSize len, U64 seed)
+{
+	const U8* secret = &XXH_SECRET[0];
+
+	if(len > 8)
+	{
+		const U64 bitflip1 = (readLe64(secret + 24) ^ readLe64(secret + 32)) + seed;
+		const U64 bitflip2 = (readLe64(secret + 40) ^ readLe64(secret + 48)) - seed;
+		const U64 inputLo = readLe64(input) ^ bitflip1;
+		const U64 inputHi = readLe64(input + len - 8) ^ bitflip2;
+		const U64 acc = len + swap64(inputLo) + inputHi + mul128Fold64(inputLo, inputHi);
+		return xxh3Avalanche(acc);
+	}
+	else if(len >= 4)
+	{
+		seed ^= U64(swap32(U32(seed))) << 32;
+		const U32 input1 = readLe32(input);
+		const U32 input2 = readLe32(input + len - 4);
+		const U64 bitflip = (readLe64(secret + 8) ^ readLe64(secret + 16)) - seed;
+		const U64 input64 = input2 + (U64(input1) << 32);
+		return xxh3Rrmxmx(input64 ^ bitflip, len);
+	}
+	else if(len > 0)
+	{
+		const U32 c1 = input[0];
+		const U32 c2 = input[len >> 1];
+		const U32 c3 = input[len - 1];
+		const U32 combined = (c1 << 16) | (c2 << 24) | (c3 << 0) | (U32(len) << 8);
+		const U64 bitflip = (readLe32(secret) ^ readLe32(secret + 4)) + seed;
+		return xxh64Avalanche(U64(combined) ^ bitflip);
+	}
+	else
+	{
+		return xxh64Avalanche(seed ^ (readLe64(secret + 56) ^ readLe64(secret + 64)));
+	}
+}
+
+static U64 xxh3Len17To128(const U8* input, PtrSize len, U64 seed)
+{
+	const U8* secret = &XXH_SECRET[0];
+	U64 acc = len * XXH_PRIME64_1;
+
+	if(len > 32)
+	{
+		if(len > 64)
+		{
+			if(len > 96)
+			{
+				acc += xxh3Mix16B(input + 48, secret + 96, seed);
+				acc += xxh3Mix16B(input + len - 64, secret + 112, seed);
+			}
+			acc += xxh3Mix16B(input + 32, secret + 64, seed);
+			acc += xxh3Mix16B(input + len - 48, secret + 80, seed);
+		}
+		acc += xxh3Mix16B(input + 16, secret + 32, seed);
+		acc += xxh3Mix16B(input + len - 32, secret + 48, seed);
+	}
+	acc += xxh3Mix16B(input + 0, secret + 0, seed);
+	acc += xxh3Mix16B(input + len - 16, secret + 16, seed);
+
+	return xxh3Avalanche(acc);
+}
+
+static U64 xxh3Len129To240(const U8* input, PtrSize len, U64 seed)
+{
+	const U8* secret = &XXH_SECRET[0];
+	const U32 roundCount = U32(len / 16);
+
+	U64 acc = len * XXH_PRIME64_1;
+	for(U32 i = 0; i < 8; ++i)
+	{
+		acc += xxh3Mix16B(input + 16 * i, secret + 16 * i, seed);
+	}
+	acc = xxh3Avalanche(acc);
+
+	for(U32 i = 8; i < roundCount; ++i)
+	{
+		acc += xxh3Mix16B(input + 16 * i, secret + 16 * (i - 8) + XXH_MIDSIZE_STARTOFFSET, seed);
+	}
+
+	acc += xxh3Mix16B(input + len - 16, secret + 136 - XXH_MIDSIZE_LASTOFFSET, seed);
+	return xxh3Avalanche(acc);
+}
+
+/// Consume one stripe of 64 bytes.
+static inline ANKI_FORCE_INLINE void xxh3Accumulate512(U64* ANKI_RESTRICT acc, const U8* ANKI_RESTRICT input,
+													   const U8* ANKI_RESTRICT secret)
+{
+#if ANKI_SIMD_SSE
+	__m128i* accVecs = reinterpret_cast<__m128i*>(acc);
+	for(U32 i = 0; i < XXH_STRIPE_LEN / 16; ++i)
+	{
+		const __m128i dataVec = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input) + i);
+		const __m128i keyVec = _mm_loadu_si128(reinterpret_cast<const __m128i*>(secret) + i);
+		const __m128i dataKey = _mm_xor_si128(dataVec, keyVec);
+		const __m128i dataKeyLo = _mm_shuffle_epi32(dataKey, _MM_SHUFFLE(0, 3, 0, 1));
+		const __m128i product = _mm_mul_epu32(dataKey, dataKeyLo);
+		const __m128i dataSwap = _mm_shuffle_epi32(dataVec, _MM_SHUFFLE(1, 0, 3, 2));
+		const __m128i sum = _mm_add_epi64(accVecs[i], dataSwap);
+		accVecs[i] = _mm_add_epi64(product, sum);
+	}
+#elif ANKI_SIMD_NEON
+	for(U32 i = 0; i < XXH_STRIPE_LEN / 16; ++i)
+	{
+		const uint64x2_t dataVec = vreinterpretq_u64_u8(vld1q_u8(input + 16 * i));
+		const uint64x2_t keyVec = vreinterpretq_u64_u8(vld1q_u8(secret + 16 * i));
+		const uint64x2_t dataKey = veorq_u64(dataVec, keyVec);
+		const uint64x2_t dataSwap = vextq_u64(dataVec, dataVec, 1);
+		uint64x2_t accVec = vaddq_u64(vld1q_u64(acc + 2 * i), dataSwap);
+		accVec = vmlal_u32(accVec, vmovn_u64(dataKey), vshrn_n_u64(dataKey, 32));
+		vst1q_u64(acc + 2 * i, accVec);
+	}
+#else
+	for(U32 i = 0; i < XXH_ACC_COUNT; ++i)
+	{
+		const U64 dataVal = readLe64(input + 8 * i);
+		const U64 dataKey = dataVal ^ readLe64(secret + 8 * i);
+		acc[i ^ 1] += dataVal;
+		acc[i] += (dataKey & 0xFFFFFFFF) * (dataKey >> 32);
+	}
+#endif
+}
+
+static inline ANKI_FORCE_INLINE void xxh3ScrambleAcc(U64* ANKI_RESTRICT acc, const U8* ANKI_RESTRICT secret)
+{
+#if ANKI_SIMD_SSE
+	__m128i* accVecs = reinterpret_cast<__m128i*>(acc);
+	const __m128i prime32 = _mm_set1_epi32(I32(XXH_PRIME32_1));
+	for(U32 i = 0; i < XXH_STRIPE_LEN / 16; ++i)
+	{
+		const __m128i accVec = accVecs[i];
+		const __m128i dataVec = _mm_xor_si128(accVec, _mm_srli_epi64(accVec, 47));
+		const __m128i keyVec = _mm_loadu_si128(reinterpret_cast<const __m128i*>(secret) + i);
+		const __m128i dataKey = _mm_xor_si128(dataVec, keyVec);
+		const __m128i dataKeyHi = _mm_shuffle_epi32(dataKey, _MM_SHUFFLE(0, 3, 0, 1));
+		const __m128i productLo = _mm_mul_epu32(dataKey, prime32);
+		const __m128i productHi = _mm_mul_epu32(dataKeyHi, prime32);
+		accVecs[i] = _mm_add_epi64(productLo, _mm_slli_epi64(productHi, 32));
+	}
+#elif ANKI_SIMD_NEON
+	const uint32x2_t prime32 = vdup_n_u32(XXH_PRIME32_1);
+	for(U32 i = 0; i < XXH_STRIPE_LEN / 16; ++i)
+	{
+		const uint64x2_t accVec = vld1q_u64(acc + 2 * i);
+		const uint64x2_t dataVec = veorq_u64(accVec, vshrq_n_u64(accVec, 47));
+		const uint64x2_t keyVec = vreinterpretq_u64_u8(vld1q_u8(secret + 16 * i));
+		const uint64x2_t dataKey = veorq_u64(dataVec, keyVec);
+		const uint64x2_t productHi = vshlq_n_u64(vmull_u32(vshrn_n_u64(dataKey, 32), prime32), 32);
+		vst1q_u64(acc + 2 * i, vmlal_u32(productHi, vmovn_u64(dataKey), prime32));
+	}
+#else
+	for(U32 i = 0; i < XXH_ACC_COUNT; ++i)
+	{
+		U64 acc64 = acc[i];
+		acc64 ^= acc64 >> 47;
+		acc64 ^= readLe64(secret + 8 * i);
+		acc64 *= XXH_PRIME32_1;
+		acc[i] = acc64;
+	}
+#endif
+}
+
+static U64 xxh3HashLong(const U8* input, PtrSize len, U64 seed)
+{
+	// Derive the secret from the seed
+	alignas(64) Array<U8, XXH_SECRET_SIZE> customSecret;
+	const U8* secret = &XXH_SECRET[0];
+	if(seed != 0)
+	{
+		for(U32 i = 0; i < XXH_SECRET_SIZE / 16; ++i)
+		{
+			writeLe64(&customSecret[16 * i], readLe64(&XXH_SECRET[16 * i]) + seed);
+			writeLe64(&customSecret[16 * i + 8], readLe64(&XXH_SECRET[16 * i + 8]) - seed);
+		}
+		secret = &customSecret[0];
+	}
+
+	alignas(16) Array<U64, XXH_ACC_COUNT> acc = {{XXH_PRIME32_3, XXH_PRIME64_1, XXH_PRIME64_2, XXH_PRIME64_3,
+												  XXH_PRIME64_4, XXH_PRIME32_2, XXH_PRIME64_5, XXH_PRIME32_1}};
+
+	// Full blocks
+	const PtrSize blockCount = (len - 1) / XXH_BLOCK_LEN;
+	for(PtrSize b = 0; b < blockCount; ++b)
+	{
+		const U8* block = input + b * XXH_BLOCK_LEN;
+		for(U32 s = 0; s < XXH_STRIPES_PER_BLOCK; ++s)
+		{
+			xxh3Accumulate512(&acc[0], block + s * XXH_STRIPE_LEN, secret + s * XXH_SECRET_CONSUME_RATE);
+		}
+
+		xxh3ScrambleAcc(&acc[0], secret + XXH_SECRET_SIZE - XXH_STRIPE_LEN);
+	}
+
+	// Last partial block
+	const U8* block = input + blockCount * XXH_BLOCK_LEN;
+	const PtrSize stripeCount = ((len - 1) - (XXH_BLOCK_LEN * blockCount)) / XXH_STRIPE_LEN;
+	for(U32 s = 0; s < stripeCount; ++s)
+	{
+		xxh3Accumulate512(&acc[0], block + s * XXH_STRIPE_LEN, secret + s * XXH_SECRET_CONSUME_RATE);
+	}
+
+	// Last stripe
+	xxh3Accumulate512(&acc[0], input + len - XXH_STRIPE_LEN,
+					  secret + XXH_SECRET_SIZE - XXH_STRIPE_LEN - XXH_SECRET_LASTACC_START);
+
+	// Merge the accumulators
+	const U8* mergeSecret = secret + XXH_SECRET_MERGEACCS_START;
+	U64 result = len * XXH_PRIME64_1;
+	for(U32 i = 0; i < 4; ++i)
+	{
+		result += mul128Fold64(acc[2 * i] ^ readLe64(mergeSecret + 16 * i),
+							   acc[2 * i + 1] ^ readLe64(mergeSecret + 16 * i + 8));
+	}
+
+	return xxh3Avalanche(result);
+}
+
+static U64 xxh3(const void* buffer, PtrSize bufferSize, U64 seed)
+{
+	const U8* input = static_cast<const U8*>(buffer);
+
+	if(bufferSize <= 16)
+	{
+		return xxh3Len0To16(input, bufferSize, seed);
+	}
+	else if(bufferSize <= 128)
+	{
+		return xxh3Len17To128(input, bufferSize, seed);
+	}
+	else if(bufferSize <= XXH_MIDSIZE_MAX)
+	{
+		return xxh3Len129To240(input, bufferSize, seed);
+	}
+	else
+	{
+		return xxh3HashLong(input, bufferSize, seed);
+	}
+}
+
+U64 appendHash(const void* buffer, PtrSize bufferSize, U64 prevHash)
+{
+	const U64 h = xxh3(buffer, bufferSize, prevHash);
+	ANKI_ASSERT(h != 0);
+	return h;
+}
+
+U64 computeHash(const void* buffer, PtrSize bufferSize, U64 seed)
+{
+	const U64 h = xxh3(buffer, bufferSize, seed);
+	ANKI_ASSERT(h != 0);
+	return h;
+}
+
 constexpr U64 HASH_M = 0xc6a4a7935bd1e995;
 constexpr U64 HASH_R = 47;
 
-U64 appendHash(const void* buffer, PtrSize bufferSize, U64 h)
+U64 appendMurmurHash2(const void* buffer, PtrSize bufferSize, U64 h)
 {
 	const U64* data = static_cast<const U64*>(buffer);
 	const U64* const end = data + (bufferSize / sizeof(U64));
@@ -57,10 +443,10 @@ U64 appendHash(const void* buffer, PtrSize bufferSize, U64 h)
 	return h;
 }
 
-U64 computeHash(const void* buffer, PtrSize bufferSize, U64 seed)
+U64 computeMurmurHash2(const void* buffer, PtrSize bufferSize, U64 seed)
 {
 	const U64 h = seed ^ (bufferSize * HASH_M);
-	return appendHash(buffer, bufferSize, h);
+	return appendMurmurHash2(buffer, bufferSize, h);
 }
 
 } // end namespace anki
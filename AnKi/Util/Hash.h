@@ -12,19 +12,34 @@ namespace anki {
 /// @addtogroup util_other
 /// @{
 
-/// Computes a hash of a buffer. This function implements the MurmurHash2 algorithm by Austin Appleby.
+/// The version of the algorithm behind computeHash and appendHash. Bump it when the output changes and mix it to the
+/// version of files that store hashes so stale caches get discarded.
+/// - Version 1: MurmurHash2
+/// - Version 2: XXH3 64bit
+constexpr U32 HASH_ALGORITHM_VERSION = 2;
+
+/// Computes a hash of a buffer. This function implements the XXH3 64bit algorithm by Yann Collet. The output is the
+/// same across platforms and matches the reference implementation.
 /// @param[in] buffer The buffer to hash.
 /// @param bufferSize The size of the buffer.
 /// @param seed A unique seed.
 /// @return The hash.
 ANKI_USE_RESULT U64 computeHash(const void* buffer, PtrSize bufferSize, U64 seed = 123);
 
-/// Computes a hash of a buffer. This function implements the MurmurHash2 algorithm by Austin Appleby.
+/// Computes a hash of a buffer. This function implements the XXH3 64bit algorithm by Yann Collet using the previous
+/// hash as seed.
 /// @param[in] buffer The buffer to hash.
 /// @param bufferSize The size of the buffer.
 /// @param prevHash The hash to append to.
 /// @return The new hash.
 ANKI_USE_RESULT U64 appendHash(const void* buffer, PtrSize bufferSize, U64 prevHash);
+
+/// The MurmurHash2 algorithm by Austin Appleby. That was the algorithm of computeHash before HASH_ALGORITHM_VERSION 2.
+/// Use it to read hashes stored by older versions.
+ANKI_USE_RESULT U64 computeMurmurHash2(const void* buffer, PtrSize bufferSize, U64 seed = 123);
+
+/// @copydoc computeMurmurHash2
+ANKI_USE_RESULT U64 appendMurmurHash2(const void* buffer, PtrSize bufferSize, U64 prevHash);
 /// @}
 
 } // end namespace anki
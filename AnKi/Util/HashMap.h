@@ -14,12 +14,13 @@ namespace anki {
 /// @addtogroup util_containers
 /// @{
 
-/// Default hasher.
+/// Default hasher. It accepts any type with a computeHash() so maps can do lookups with a different key type.
 template<typename TKey>
 class DefaultHasher
 {
 public:
-	U64 operator()(const TKey& a) const
+	template<typename TKeyLike>
+	U64 operator()(const TKeyLike& a) const
 	{
 		return a.computeHash();
 	}
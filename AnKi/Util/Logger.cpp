@@ -15,6 +15,9 @@
 #endif
 #if ANKI_OS_WINDOWS
 #	include <AnKi/Util/Win32Minimal.h>
+#	include <io.h>
+#else
+#	include <unistd.h>
 #endif
 
 namespace anki {
@@ -22,6 +25,7 @@ namespace anki {
 static const Array<const char*, static_cast<U>(LoggerMessageType::COUNT)> MSG_TEXT = {"I", "V", "E", "W", "F"};
 
 Logger::Logger()
+	: m_asyncThread("AnKiLogger")
 {
 	addMessageHandler(this, &defaultSystemMessageHandler);
 
@@ -29,10 +33,19 @@ Logger::Logger()
 	{
 		m_verbosityEnabled = true;
 	}
+
+	m_asyncHead.setNonAtomically(&m_asyncStub);
+	m_asyncTail = &m_asyncStub;
+
+	if(getenv("ANKI_LOG_ASYNC") && getenv("ANKI_LOG_ASYNC") == CString("1"))
+	{
+		setAsync(true);
+	}
 }
 
 Logger::~Logger()
 {
+	setAsync(false);
 }
 
 void Logger::addMessageHandler(void* data, LoggerMessageHandlerCallback callback)
@@ -41,6 +54,11 @@ void Logger::addMessageHandler(void* data, LoggerMessageHandlerCallback callback
 	m_handlers[m_handlersCount++] = Handler(data, callback);
 }
 
+void Logger::addFileMessageHandler(File* file)
+{
+	addMessageHandler(file, &fileMessageHandler);
+}
+
 void Logger::removeMessageHandler(void* data, LoggerMessageHandlerCallback callback)
 {
 	LockGuard<Mutex> lock(m_mutex);
@@ -75,20 +93,272 @@ void Logger::write(const char* file, int line, const char* func, const char* sub
 
 	LoggerMessageInfo inf = {file, line, func, type, msg, subsystem, tid};
 
+	if(m_async)
+	{
+		pushAsyncMessage(inf);
+
+		if(type == LoggerMessageType::FATAL)
+		{
+			flush();
+			abort();
+		}
+
+		return;
+	}
+
 	m_mutex.lock();
+	dispatch(inf);
+	flushHandlers();
+	m_mutex.unlock();
 
+	if(type == LoggerMessageType::FATAL)
+	{
+		abort();
+	}
+}
+
+void Logger::dispatch(const LoggerMessageInfo& info)
+{
 	U count = m_handlersCount;
 	while(count-- != 0)
 	{
-		m_handlers[count].m_callback(m_handlers[count].m_data, inf);
+		m_handlers[count].m_callback(m_handlers[count].m_data, info);
 	}
+}
 
-	m_mutex.unlock();
+void Logger::flushHandlers()
+{
+	for(U i = 0; i < m_handlersCount; ++i)
+	{
+		if(m_handlers[i].m_callback == &fileMessageHandler)
+		{
+			const Error err = static_cast<File*>(m_handlers[i].m_data)->flush();
+			(void)err;
+		}
+	}
+}
 
-	if(type == LoggerMessageType::FATAL)
+void Logger::setAsync(Bool async)
+{
+	if(async == m_async)
 	{
+		return;
+	}
+
+	if(async)
+	{
+		m_asyncQuit = false;
+		m_async = true;
+		m_asyncThread.start(this, [](ThreadCallbackInfo& info) -> Error {
+			return static_cast<Logger*>(info.m_userData)->asyncThreadMain();
+		});
+	}
+	else
+	{
+		// Stop the thread. It will handle the remaining messages before it quits
+		{
+			LockGuard<Mutex> lock(m_asyncMtx);
+			m_asyncQuit = true;
+			m_asyncCvar.notifyOne();
+		}
+
+		const Error err = m_asyncThread.join();
+		(void)err;
+		m_async = false;
+
+		// Some thread might have pushed after the thread quit
+		flush();
+	}
+}
+
+void Logger::pushAsyncMessage(const LoggerMessageInfo& info)
+{
+	// Copy the message next to the node. Use malloc since the logger can't depend on allocators
+	const PtrSize msgLen = strlen(info.m_msg);
+	void* mem = malloc(sizeof(AsyncMessage) + msgLen + 1);
+	if(ANKI_UNLIKELY(mem == nullptr))
+	{
+		fprintf(stderr, "Logger::pushAsyncMessage() failed to allocate. Will not recover");
 		abort();
 	}
+
+	AsyncMessage* node = ::new(mem) AsyncMessage();
+	char* msg = reinterpret_cast<char*>(node + 1);
+	memcpy(msg, info.m_msg, msgLen + 1);
+	node->m_info = info;
+	node->m_info.m_msg = msg;
+
+	// Count it before pushing it so the consumer doesn't sleep while the push is in progress
+	const U32 prevPendingCount = m_asyncPendingCount.fetchAdd(1);
+
+	// Push to the head. After the exchange the node is in the queue but the consumer can't reach it until the previous
+	// head points to it
+	AsyncMessage* prevHead = m_asyncHead.exchange(node);
+	prevHead->m_next.store(node, AtomicMemoryOrder::RELEASE);
+
+	// Wake up the thread only if it might be sleeping
+	if(prevPendingCount == 0)
+	{
+		LockGuard<Mutex> lock(m_asyncMtx);
+		m_asyncCvar.notifyOne();
+	}
+}
+
+Logger::AsyncMessage* Logger::popAsyncMessage()
+{
+	AsyncMessage* tail = m_asyncTail;
+	AsyncMessage* next = tail->m_next.load(AtomicMemoryOrder::ACQUIRE);
+
+	// Skip the stub
+	if(tail == &m_asyncStub)
+	{
+		if(next == nullptr)
+		{
+			return nullptr;
+		}
+
+		m_asyncTail = next;
+		tail = next;
+		next = next->m_next.load(AtomicMemoryOrder::ACQUIRE);
+	}
+
+	if(next)
+	{
+		m_asyncTail = next;
+		return tail;
+	}
+
+	// The tail is the last node. If it's not the head as well a push is in progress, try later
+	if(tail != m_asyncHead.load())
+	{
+		return nullptr;
+	}
+
+	// Push the stub so the last node can be popped
+	m_asyncStub.m_next.store(nullptr, AtomicMemoryOrder::RELAXED);
+	AsyncMessage* prevHead = m_asyncHead.exchange(&m_asyncStub);
+	prevHead->m_next.store(&m_asyncStub, AtomicMemoryOrder::RELEASE);
+
+	next = tail->m_next.load(AtomicMemoryOrder::ACQUIRE);
+	if(next)
+	{
+		m_asyncTail = next;
+		return tail;
+	}
+
+	return nullptr;
+}
+
+U32 Logger::handleAsyncMessages()
+{
+	U32 count = 0;
+	while(AsyncMessage* node = popAsyncMessage())
+	{
+		dispatch(node->m_info);
+		node->~AsyncMessage();
+		free(node);
+		++count;
+	}
+
+	if(count)
+	{
+		flushHandlers();
+		m_asyncPendingCount.fetchSub(count);
+	}
+
+	return count;
+}
+
+void Logger::flush()
+{
+	while(m_asyncPendingCount.load() > 0)
+	{
+		U32 count;
+		{
+			LockGuard<Mutex> lock(m_mutex);
+			count = handleAsyncMessages();
+		}
+
+		if(count == 0)
+		{
+			// A push is in progress or the thread is handling the messages
+			std::this_thread::yield();
+		}
+	}
+}
+
+/// Write to stderr using only async-signal-safe functions.
+static void writeToStderrOnCrash(const char* str)
+{
+	const PtrSize len = strlen(str);
+#if ANKI_OS_WINDOWS
+	const int ret = _write(2, str, unsigned(len));
+#else
+	const ssize_t ret = ::write(STDERR_FILENO, str, len);
+#endif
+	(void)ret;
+}
+
+void Logger::flushOnCrash()
+{
+	// It runs in a signal handler so it can't lock, allocate, free or use the handlers. Walk the queue without popping
+	// and write the raw messages. The consumer might be in the middle of a pop so some messages might be lost
+	if(m_asyncPendingCount.load() == 0)
+	{
+		return;
+	}
+
+	writeToStderrOnCrash("Pending log messages:\n");
+
+	const AsyncMessage* node = m_asyncTail;
+	while(node)
+	{
+		if(node != &m_asyncStub)
+		{
+			writeToStderrOnCrash("[");
+			writeToStderrOnCrash(MSG_TEXT[U(node->m_info.m_type)]);
+			writeToStderrOnCrash("] ");
+			writeToStderrOnCrash(node->m_info.m_msg);
+			writeToStderrOnCrash("\n");
+		}
+
+		node = node->m_next.load(AtomicMemoryOrder::ACQUIRE);
+	}
+}
+
+Error Logger::asyncThreadMain()
+{
+	while(true)
+	{
+		// Wait for something
+		{
+			LockGuard<Mutex> lock(m_asyncMtx);
+			while(m_asyncPendingCount.load() == 0 && !m_asyncQuit)
+			{
+				m_asyncCvar.wait(m_asyncMtx);
+			}
+
+			if(m_asyncQuit && m_asyncPendingCount.load() == 0)
+			{
+				break;
+			}
+		}
+
+		// Handle the messages in one batch
+		U32 count;
+		{
+			LockGuard<Mutex> lock(m_mutex);
+			count = handleAsyncMessages();
+		}
+
+		if(count == 0)
+		{
+			// A push is in progress
+			std::this_thread::yield();
+		}
+	}
+
+	return Error::NONE;
 }
 
 void Logger::writeFormated(const char* file, int line, const char* func, const char* subsystem, LoggerMessageType type,
@@ -284,14 +554,10 @@ void Logger::fileMessageHandler(void* pfile, const LoggerMessageInfo& info)
 {
 	File* file = reinterpret_cast<File*>(pfile);
 
-	Error err = file->writeText("[%s] %s (%s:%d %s)\n", MSG_TEXT[U(info.m_type)], info.m_msg, info.m_file, info.m_line,
-								info.m_func);
-
-	if(!err)
-	{
-		err = file->flush();
-		(void)err;
-	}
+	// The logger flushes the file after the message or after the batch of messages
+	const Error err = file->writeText("[%s] %s (%s:%d %s)\n", MSG_TEXT[U(info.m_type)], info.m_msg, info.m_file,
+									  info.m_line, info.m_func);
+	(void)err;
 }
 
 } // end namespace anki
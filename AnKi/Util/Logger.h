@@ -8,6 +8,7 @@
 #include <AnKi/Config.h>
 #include <AnKi/Util/Singleton.h>
 #include <AnKi/Util/Thread.h>
+#include <AnKi/Util/Atomic.h>
 
 namespace anki {
 
@@ -49,6 +50,10 @@ using LoggerMessageHandlerCallback = void (*)(void*, const LoggerMessageInfo& in
 
 /// The logger singleton class. The logger cannot print errors or throw exceptions, it has to recover somehow. It's
 /// thread safe.
+///
+/// In asynchronous mode the threads that log only format the message and push it to a lock-free queue. A background
+/// thread pops the messages and passes them to the handlers in batches. That way a slow handler (eg writing to a file)
+/// doesn't stall the threads that log.
 /// To add a new signal:
 /// @code logger.addMessageHandler((void*)obj, &function) @endcode
 class Logger
@@ -77,6 +82,27 @@ public:
 	void writeFormated(const char* file, int line, const char* func, const char* subsystem, LoggerMessageType type,
 					   ThreadId tid, const char* fmt, ...);
 
+	/// Remove the default handler that prints to the terminal.
+	void removeSystemMessageHandler()
+	{
+		removeMessageHandler(this, &defaultSystemMessageHandler);
+	}
+
+	/// Enable or disable the asynchronous mode. Disabling it will flush the queued messages.
+	void setAsync(Bool async);
+
+	Bool getAsync() const
+	{
+		return m_async;
+	}
+
+	/// Wait until all the queued messages reach the handlers. It does nothing if not in asynchronous mode.
+	void flush();
+
+	/// Best effort flush when the application is crashing. It writes the queued messages to stderr and it's safe to call
+	/// from a signal handler.
+	void flushOnCrash();
+
 	/// Enable or disable logger verbosity.
 	void enableVerbosity(Bool enable)
 	{
@@ -103,13 +129,54 @@ private:
 		Handler& operator=(const Handler&) = default;
 	};
 
-	Mutex m_mutex; ///< For thread safety
+	/// A node of the message queue. The string of the message follows it in the same allocation.
+	class AsyncMessage
+	{
+	public:
+		Atomic<AsyncMessage*> m_next = {nullptr};
+		LoggerMessageInfo m_info;
+	};
+
+	Mutex m_mutex; ///< For thread safety. Protects the handlers and the consumer side of the queue.
 	Array<Handler, 4> m_handlers;
 	U32 m_handlersCount = 0;
 	Bool m_verbosityEnabled = false;
 
+	/// @name Asynchronous mode
+	/// @{
+	Bool m_async = false;
+	Bool m_asyncQuit = false;
+
+	/// Intrusive MPSC queue. Producers push to the head and the consumer pops from the tail.
+	Atomic<AsyncMessage*> m_asyncHead = {nullptr};
+	AsyncMessage* m_asyncTail = nullptr;
+	AsyncMessage m_asyncStub;
+
+	Atomic<U32> m_asyncPendingCount = {0}; ///< Pushed but not handled messages.
+	Mutex m_asyncMtx; ///< Only for the sleeping of the thread.
+	ConditionVariable m_asyncCvar;
+	Thread m_asyncThread;
+	/// @}
+
 	static void defaultSystemMessageHandler(void*, const LoggerMessageInfo& info);
 	static void fileMessageHandler(void* file, const LoggerMessageInfo& info);
+
+	/// Call all handlers. Needs m_mutex to be locked.
+	void dispatch(const LoggerMessageInfo& info);
+
+	/// Flush the handlers that support it. Needs m_mutex to be locked.
+	void flushHandlers();
+
+	void pushAsyncMessage(const LoggerMessageInfo& info);
+
+	/// Pop one message. Needs m_mutex to be locked.
+	AsyncMessage* popAsyncMessage();
+
+	/// Pop and handle all the available messages. Needs m_mutex to be locked.
+	/// @return The number of handled messages.
+	U32 handleAsyncMessages();
+
+	Error asyncThreadMain();
 };
 
 using LoggerSingleton = Singleton<Logger>;
@@ -161,26 +161,451 @@ BaseMemoryPool::~BaseMemoryPool()
 	ANKI_ASSERT(m_refcount.load() == 0 && "Refcount should be zero");
 }
 
-HeapMemoryPool::HeapMemoryPool(AllocAlignedCallback allocCb, void* allocCbUserDataconst, const char* name)
+/// Serves the small allocations of a HeapMemoryPool from size classes. Every thread works on its own cache of free
+/// objects and only touches the central free lists (in batches) when the cache runs dry or grows too big. The memory
+/// of the central lists comes from spans that are carved to objects of a single size class.
+///
+/// Threads are mapped to caches using a thread local index. A cache is still guarded by a spinlock because more than
+/// THREAD_CACHE_COUNT threads might share one and because it's simpler than dealing with thread exit and pool
+/// destruction. Normally the lock is uncontended.
+class HeapMemoryPool::ThreadCachingAllocator
+{
+public:
+	ThreadCachingAllocator(HeapMemoryPool* pool)
+		: m_pool(pool)
+	{
+		for(U32 c = 0; c < SIZE_CLASS_COUNT; ++c)
+		{
+			m_batchSizes[c] = min<U32>(max<U32>(U32(8_KB / getSizeClassSize(c)), 4), 64);
+		}
+	}
+
+	~ThreadCachingAllocator()
+	{
+		Span* span = m_spans;
+		while(span)
+		{
+			Span* next = span->m_next;
+			m_pool->m_allocCb(m_pool->m_allocCbUserData, span, 0, 0);
+			span = next;
+		}
+	}
+
+	void* allocate(PtrSize size, PtrSize alignment);
+
+	void free(void* ptr);
+
+	void getStats(HeapMemoryPoolStats& stats) const;
+
+	I32 getAllocationCount() const;
+
+private:
+	/// 16 classes of 16 bytes up to 256 and then 4 classes per power of two up to 2K. The sizes include the header.
+	static constexpr U32 SIZE_CLASS_COUNT = 16 + 3 * 4;
+	static constexpr PtrSize MAX_SMALL_SIZE = 2_KB;
+	static constexpr U32 LARGE_SIZE_CLASS = MAX_U32;
+	static constexpr PtrSize SPAN_SIZE = 64_KB;
+	static constexpr U32 THREAD_CACHE_COUNT = 32;
+
+	/// Every allocation has a header in front of it. It keeps the alignment of the returned memory.
+	class alignas(ANKI_SAFE_ALIGNMENT) Header
+	{
+	public:
+		U32 m_sizeClass; ///< LARGE_SIZE_CLASS for the allocations that bypass the caches.
+		U32 m_largeOffset; ///< For large allocations it's the offset from the real allocation to the header.
+#if ANKI_MEM_EXTRA_CHECKS
+		PoolSignature m_signature;
+#endif
+	};
+
+	static_assert(sizeof(Header) == ANKI_SAFE_ALIGNMENT, "See file");
+
+	/// A free object. It's stored in the memory of the object.
+	class FreeObject
+	{
+	public:
+		FreeObject* m_next;
+	};
+
+	/// A chunk of memory that is split to objects of the same size class.
+	class alignas(ANKI_SAFE_ALIGNMENT) Span
+	{
+	public:
+		Span* m_next;
+	};
+
+	class alignas(ANKI_CACHE_LINE_SIZE) ThreadCache
+	{
+	public:
+		SpinLock m_lock;
+		Array<FreeObject*, SIZE_CLASS_COUNT> m_freeLists = {};
+		Array<U32, SIZE_CLASS_COUNT> m_freeCounts = {};
+		U64 m_hits = 0;
+		U64 m_misses = 0;
+		I64 m_usedSize = 0; ///< It's signed because memory can be freed in a different cache than it was allocated.
+		I32 m_allocationCount = 0; ///< Signed for the same reason as m_usedSize.
+	};
+
+	class alignas(ANKI_CACHE_LINE_SIZE) CentralFreeList
+	{
+	public:
+		SpinLock m_lock;
+		FreeObject* m_head = nullptr;
+	};
+
+	HeapMemoryPool* m_pool;
+	Array<ThreadCache, THREAD_CACHE_COUNT> m_caches;
+	Array<CentralFreeList, SIZE_CLASS_COUNT> m_centralFreeLists;
+	Array<U32, SIZE_CLASS_COUNT> m_batchSizes;
+
+	Span* m_spans = nullptr;
+	SpinLock m_spansLock;
+	Atomic<PtrSize> m_reservedSize = {0};
+
+	static thread_local U32 m_threadCacheIndex;
+	static Atomic<U32> m_threadCount;
+
+	static U32 computeSizeClass(PtrSize size)
+	{
+		ANKI_ASSERT(size > 0 && size <= MAX_SMALL_SIZE);
+		if(size <= 256)
+		{
+			return U32((size + 15) / 16) - 1;
+		}
+
+		const U32 log2 = U32(sizeof(U64) * 8 - 1) - U32(__builtin_clzll(size - 1));
+		return 16 + (log2 - 8) * 4 + U32((size - 1) >> (log2 - 2)) - 4;
+	}
+
+	static PtrSize getSizeClassSize(U32 sizeClass)
+	{
+		ANKI_ASSERT(sizeClass < SIZE_CLASS_COUNT);
+		if(sizeClass < 16)
+		{
+			return (sizeClass + 1) * 16;
+		}
+
+		const U32 log2 = (sizeClass - 16) / 4 + 8;
+		return (PtrSize(1) << log2) + ((sizeClass - 16) % 4 + 1) * (PtrSize(1) << (log2 - 2));
+	}
+
+	ThreadCache& getThreadCache()
+	{
+		if(ANKI_UNLIKELY(m_threadCacheIndex == MAX_U32))
+		{
+			m_threadCacheIndex = m_threadCount.fetchAdd(1);
+		}
+
+		return m_caches[m_threadCacheIndex % THREAD_CACHE_COUNT];
+	}
+
+	/// Move a batch from the central list to the cache. The cache is locked.
+	Bool refill(ThreadCache& cache, U32 sizeClass);
+
+	/// Give a batch of the cache back to the central list. The cache is locked.
+	void release(ThreadCache& cache, U32 sizeClass);
+};
+
+thread_local U32 HeapMemoryPool::ThreadCachingAllocator::m_threadCacheIndex = MAX_U32;
+Atomic<U32> HeapMemoryPool::ThreadCachingAllocator::m_threadCount = {0};
+
+void* HeapMemoryPool::ThreadCachingAllocator::allocate(PtrSize size, PtrSize alignment)
+{
+	const PtrSize fullSize = size + sizeof(Header);
+	Header* header;
+
+	if(ANKI_LIKELY(fullSize <= MAX_SMALL_SIZE && alignment <= ANKI_SAFE_ALIGNMENT))
+	{
+		const U32 sizeClass = computeSizeClass(fullSize);
+		ThreadCache& cache = getThreadCache();
+
+		LockGuard<SpinLock> lock(cache.m_lock);
+
+		if(ANKI_LIKELY(cache.m_freeLists[sizeClass]))
+		{
+			++cache.m_hits;
+		}
+		else
+		{
+			++cache.m_misses;
+			if(ANKI_UNLIKELY(!refill(cache, sizeClass)))
+			{
+				return nullptr;
+			}
+		}
+
+		FreeObject* obj = cache.m_freeLists[sizeClass];
+		cache.m_freeLists[sizeClass] = obj->m_next;
+		--cache.m_freeCounts[sizeClass];
+		cache.m_usedSize += I64(getSizeClassSize(sizeClass));
+		++cache.m_allocationCount;
+
+		header = reinterpret_cast<Header*>(obj);
+		header->m_sizeClass = sizeClass;
+		header->m_largeOffset = 0;
+	}
+	else
+	{
+		// Big or over-aligned, go to the allocation callback. Leave enough space in front for the header
+		alignment = max<PtrSize>(alignment, ANKI_SAFE_ALIGNMENT);
+		const PtrSize offset = getAlignedRoundUp(alignment, sizeof(Header));
+		U8* mem = static_cast<U8*>(m_pool->m_allocCb(m_pool->m_allocCbUserData, nullptr, size + offset, alignment));
+		if(ANKI_UNLIKELY(!mem))
+		{
+			return nullptr;
+		}
+
+		header = reinterpret_cast<Header*>(mem + offset - sizeof(Header));
+		header->m_sizeClass = LARGE_SIZE_CLASS;
+		header->m_largeOffset = U32(offset - sizeof(Header));
+		m_pool->m_allocationCount.fetchAdd(1);
+	}
+
+#if ANKI_MEM_EXTRA_CHECKS
+	header->m_signature = m_pool->m_signature;
+#endif
+
+	return header + 1;
+}
+
+void HeapMemoryPool::ThreadCachingAllocator::free(void* ptr)
+{
+	ANKI_ASSERT(ptr);
+	Header* header = static_cast<Header*>(ptr) - 1;
+
+#if ANKI_MEM_EXTRA_CHECKS
+	if(header->m_signature != m_pool->m_signature)
+	{
+		ANKI_UTIL_LOGE("Signature missmatch on free");
+	}
+#endif
+
+	const U32 sizeClass = header->m_sizeClass;
+	if(sizeClass == LARGE_SIZE_CLASS)
+	{
+		m_pool->m_allocationCount.fetchSub(1);
+		m_pool->m_allocCb(m_pool->m_allocCbUserData, reinterpret_cast<U8*>(header) - header->m_largeOffset, 0, 0);
+		return;
+	}
+
+	ANKI_ASSERT(sizeClass < SIZE_CLASS_COUNT);
+	invalidateMemory(header, getSizeClassSize(sizeClass));
+
+	ThreadCache& cache = getThreadCache();
+	LockGuard<SpinLock> lock(cache.m_lock);
+
+	FreeObject* obj = reinterpret_cast<FreeObject*>(header);
+	obj->m_next = cache.m_freeLists[sizeClass];
+	cache.m_freeLists[sizeClass] = obj;
+	++cache.m_freeCounts[sizeClass];
+	cache.m_usedSize -= I64(getSizeClassSize(sizeClass));
+	--cache.m_allocationCount;
+
+	if(ANKI_UNLIKELY(cache.m_freeCounts[sizeClass] > m_batchSizes[sizeClass] * 2))
+	{
+		release(cache, sizeClass);
+	}
+}
+
+Bool HeapMemoryPool::ThreadCachingAllocator::refill(ThreadCache& cache, U32 sizeClass)
+{
+	ANKI_ASSERT(cache.m_freeLists[sizeClass] == nullptr);
+	const U32 batchSize = m_batchSizes[sizeClass];
+	CentralFreeList& central = m_centralFreeLists[sizeClass];
+
+	{
+		LockGuard<SpinLock> lock(central.m_lock);
+
+		if(central.m_head)
+		{
+			// Detach a batch from the central list
+			FreeObject* first = central.m_head;
+			FreeObject* last = first;
+			U32 count = 1;
+			while(count < batchSize && last->m_next)
+			{
+				last = last->m_next;
+				++count;
+			}
+
+			central.m_head = last->m_next;
+			last->m_next = nullptr;
+			cache.m_freeLists[sizeClass] = first;
+			cache.m_freeCounts[sizeClass] = count;
+			return true;
+		}
+	}
+
+	// The central list is empty, create a new span. Do that without holding the central lock
+	Span* span = static_cast<Span*>(m_pool->m_allocCb(m_pool->m_allocCbUserData, nullptr, SPAN_SIZE, alignof(Span)));
+	if(ANKI_UNLIKELY(!span))
+	{
+		return false;
+	}
+
+	m_reservedSize.fetchAdd(SPAN_SIZE);
+	{
+		LockGuard<SpinLock> lock(m_spansLock);
+		span->m_next = m_spans;
+		m_spans = span;
+	}
+
+	// Split the span. Keep a batch for the cache and give the rest to the central list
+	const PtrSize objSize = getSizeClassSize(sizeClass);
+	U8* begin = reinterpret_cast<U8*>(span + 1);
+	const U32 objCount = U32((SPAN_SIZE - sizeof(Span)) / objSize);
+	ANKI_ASSERT(objCount > batchSize);
+
+	auto linkObjects = [&](U32 first, U32 end) {
+		for(U32 i = first; i < end; ++i)
+		{
+			FreeObject* obj = reinterpret_cast<FreeObject*>(begin + i * objSize);
+			obj->m_next = (i + 1 < end) ? reinterpret_cast<FreeObject*>(begin + (i + 1) * objSize) : nullptr;
+		}
+		return reinterpret_cast<FreeObject*>(begin + first * objSize);
+	};
+
+	FreeObject* head = linkObjects(0, batchSize);
+	FreeObject* centralHead = linkObjects(batchSize, objCount);
+	FreeObject* centralTail = reinterpret_cast<FreeObject*>(begin + (objCount - 1) * objSize);
+
+	{
+		LockGuard<SpinLock> lock(central.m_lock);
+		centralTail->m_next = central.m_head;
+		central.m_head = centralHead;
+	}
+
+	cache.m_freeLists[sizeClass] = head;
+	cache.m_freeCounts[sizeClass] = batchSize;
+	return true;
+}
+
+void HeapMemoryPool::ThreadCachingAllocator::release(ThreadCache& cache, U32 sizeClass)
+{
+	const U32 batchSize = m_batchSizes[sizeClass];
+	ANKI_ASSERT(cache.m_freeCounts[sizeClass] > batchSize);
+
+	FreeObject* first = cache.m_freeLists[sizeClass];
+	FreeObject* last = first;
+	for(U32 i = 1; i < batchSize; ++i)
+	{
+		last = last->m_next;
+	}
+
+	cache.m_freeLists[sizeClass] = last->m_next;
+	cache.m_freeCounts[sizeClass] -= batchSize;
+
+	CentralFreeList& central = m_centralFreeLists[sizeClass];
+	LockGuard<SpinLock> lock(central.m_lock);
+	last->m_next = central.m_head;
+	central.m_head = first;
+}
+
+void HeapMemoryPool::ThreadCachingAllocator::getStats(HeapMemoryPoolStats& stats) const
+{
+	I64 usedSize = 0;
+	for(const ThreadCache& cache : m_caches)
+	{
+		LockGuard<SpinLock> lock(const_cast<ThreadCache&>(cache).m_lock);
+		usedSize += cache.m_usedSize;
+		stats.m_threadCacheHits += cache.m_hits;
+		stats.m_threadCacheMisses += cache.m_misses;
+	}
+
+	ANKI_ASSERT(usedSize >= 0);
+	stats.m_smallObjectUsedSize = PtrSize(usedSize);
+	stats.m_smallObjectReservedSize = m_reservedSize.load();
+}
+
+I32 HeapMemoryPool::ThreadCachingAllocator::getAllocationCount() const
+{
+	I32 count = 0;
+	for(const ThreadCache& cache : m_caches)
+	{
+		LockGuard<SpinLock> lock(const_cast<ThreadCache&>(cache).m_lock);
+		count += cache.m_allocationCount;
+	}
+
+	return count;
+}
+
+HeapMemoryPool::HeapMemoryPool(AllocAlignedCallback allocCb, void* allocCbUserDataconst, const char* name,
+							   Bool threadCaching)
 	: BaseMemoryPool(Type::HEAP, allocCb, allocCbUserDataconst, name)
 {
 #if ANKI_MEM_EXTRA_CHECKS
 	m_signature = computePoolSignature(this);
 #endif
+
+	if(threadCaching)
+	{
+		void* mem = m_allocCb(m_allocCbUserData, nullptr, sizeof(ThreadCachingAllocator),
+							  alignof(ThreadCachingAllocator));
+		if(ANKI_UNLIKELY(!mem))
+		{
+			ANKI_CREATION_OOM_ACTION();
+		}
+
+		m_threadCaching = ::new(mem) ThreadCachingAllocator(this);
+	}
 }
 
 HeapMemoryPool::~HeapMemoryPool()
 {
-	const U32 count = m_allocationCount.load();
+	const U32 count = getAllocationCount();
 	if(count != 0)
 	{
 		ANKI_UTIL_LOGW("Memory pool destroyed before all memory being released (%u deallocations missed): %s", count,
 					   getName());
 	}
+
+	if(m_threadCaching)
+	{
+		m_threadCaching->~ThreadCachingAllocator();
+		m_allocCb(m_allocCbUserData, m_threadCaching, 0, 0);
+		m_threadCaching = nullptr;
+	}
+}
+
+I32 HeapMemoryPool::getThreadCachedAllocationCount() const
+{
+	return (m_threadCaching) ? m_threadCaching->getAllocationCount() : 0;
+}
+
+void HeapMemoryPool::getStats(HeapMemoryPoolStats& stats) const
+{
+	stats = {};
+	if(m_threadCaching)
+	{
+		m_threadCaching->getStats(stats);
+
+		if(stats.m_smallObjectReservedSize)
+		{
+			stats.m_smallObjectFragmentation =
+				1.0f - F32(F64(stats.m_smallObjectUsedSize) / F64(stats.m_smallObjectReservedSize));
+		}
+
+		const U64 total = stats.m_threadCacheHits + stats.m_threadCacheMisses;
+		if(total)
+		{
+			stats.m_threadCacheHitRate = F32(F64(stats.m_threadCacheHits) / F64(total));
+		}
+	}
 }
 
 void* HeapMemoryPool::allocate(PtrSize size, PtrSize alignment)
 {
+	if(m_threadCaching)
+	{
+		void* mem = m_threadCaching->allocate(size, alignment);
+		if(ANKI_UNLIKELY(!mem))
+		{
+			ANKI_OOM_ACTION();
+		}
+
+		return mem;
+	}
+
 #if ANKI_MEM_EXTRA_CHECKS
 	ANKI_ASSERT(alignment <= MAX_ALIGNMENT && "Wrong assumption");
 	size += ALLOCATION_HEADER_SIZE;
@@ -216,6 +641,12 @@ void HeapMemoryPool::free(void* ptr)
 		return;
 	}
 
+	if(m_threadCaching)
+	{
+		m_threadCaching->free(ptr);
+		return;
+	}
+
 #if ANKI_MEM_EXTRA_CHECKS
 	U8* memU8 = static_cast<U8*>(ptr) - ALLOCATION_HEADER_SIZE;
 	AllocationHeader& header = *reinterpret_cast<AllocationHeader*>(memU8);
@@ -267,35 +698,61 @@ void StackMemoryPool::StackAllocatorBuilderInterface::recycleChunk(Chunk& chunk)
 
 StackMemoryPool::StackMemoryPool(AllocAlignedCallback allocCb, void* allocCbUserData, PtrSize initialChunkSize,
 								 F64 nextChunkScale, PtrSize nextChunkBias, Bool ignoreDeallocationErrors,
-								 U32 alignmentBytes, const char* name)
+								 U32 alignmentBytes, const char* name, U32 threadSlotCount)
 	: BaseMemoryPool(Type::STACK, allocCb, allocCbUserData, name)
 {
 	ANKI_ASSERT(initialChunkSize > 0);
 	ANKI_ASSERT(nextChunkScale >= 1.0);
 	ANKI_ASSERT(alignmentBytes > 0 && alignmentBytes <= MAX_ALIGNMENT);
+	ANKI_ASSERT(threadSlotCount > 0);
+
+	m_threadSlots = static_cast<ThreadSlot*>(
+		m_allocCb(m_allocCbUserData, nullptr, sizeof(ThreadSlot) * threadSlotCount, alignof(ThreadSlot)));
+	if(ANKI_UNLIKELY(!m_threadSlots))
+	{
+		ANKI_CREATION_OOM_ACTION();
+	}
 
-	m_builder.getInterface().m_parent = this;
-	m_builder.getInterface().m_alignmentBytes = alignmentBytes;
-	m_builder.getInterface().m_ignoreDeallocationErrors = ignoreDeallocationErrors;
-	m_builder.getInterface().m_initialChunkSize = initialChunkSize;
-	m_builder.getInterface().m_nextChunkScale = nextChunkScale;
-	m_builder.getInterface().m_nextChunkBias = nextChunkBias;
+	m_threadSlotCount = threadSlotCount;
+	for(U32 i = 0; i < threadSlotCount; ++i)
+	{
+		ThreadSlot& slot = *::new(&m_threadSlots[i]) ThreadSlot();
+		slot.m_builder.getInterface().m_parent = this;
+		slot.m_builder.getInterface().m_alignmentBytes = alignmentBytes;
+		slot.m_builder.getInterface().m_ignoreDeallocationErrors = ignoreDeallocationErrors;
+		slot.m_builder.getInterface().m_initialChunkSize = initialChunkSize;
+		slot.m_builder.getInterface().m_nextChunkScale = nextChunkScale;
+		slot.m_builder.getInterface().m_nextChunkBias = nextChunkBias;
+	}
 }
 
 StackMemoryPool::~StackMemoryPool()
 {
+	if(!m_threadSlots[0].m_builder.getInterface().ignoreDeallocationErrors() && getThreadSlotAllocationCount() != 0)
+	{
+		ANKI_UTIL_LOGW("Forgot to deallocate");
+	}
+
+	for(U32 i = 0; i < m_threadSlotCount; ++i)
+	{
+		m_threadSlots[i].~ThreadSlot();
+	}
+
+	m_allocCb(m_allocCbUserData, m_threadSlots, 0, 0);
 }
 
 void* StackMemoryPool::allocate(PtrSize size, PtrSize alignment)
 {
+	ThreadSlot& slot = getCurrentThreadSlot();
+
 	Chunk* chunk;
 	PtrSize offset;
-	if(m_builder.allocate(size, alignment, chunk, offset))
+	if(slot.m_builder.allocate(size, alignment, chunk, offset))
 	{
 		return nullptr;
 	}
 
-	m_allocationCount.fetchAdd(1);
+	slot.m_allocationCount.fetchAdd(1);
 	const PtrSize address = ptrToNumber(&chunk->m_memoryStart[0]) + offset;
 	return numberToPtr<void*>(address);
 }
@@ -307,16 +764,46 @@ void StackMemoryPool::free(void* ptr)
 		return;
 	}
 
-	const U32 count = m_allocationCount.fetchSub(1);
-	ANKI_ASSERT(count > 0);
-	(void)count;
-	m_builder.free();
+	// It's not necessarily the slot that allocated the memory but that's fine, only the sum of the counts matters
+	ThreadSlot& slot = getCurrentThreadSlot();
+	slot.m_allocationCount.fetchSub(1);
+	slot.m_builder.free();
 }
 
 void StackMemoryPool::reset()
 {
-	m_builder.reset();
-	m_allocationCount.store(0);
+	if(!m_threadSlots[0].m_builder.getInterface().ignoreDeallocationErrors() && getThreadSlotAllocationCount() != 0)
+	{
+		ANKI_UTIL_LOGW("Forgot to deallocate");
+	}
+
+	for(U32 i = 0; i < m_threadSlotCount; ++i)
+	{
+		m_threadSlots[i].m_builder.reset();
+		m_threadSlots[i].m_allocationCount.store(0);
+	}
+}
+
+PtrSize StackMemoryPool::getMemoryCapacity() const
+{
+	PtrSize capacity = 0;
+	for(U32 i = 0; i < m_threadSlotCount; ++i)
+	{
+		capacity += m_threadSlots[i].m_builder.getMemoryCapacity();
+	}
+
+	return capacity;
+}
+
+I32 StackMemoryPool::getThreadSlotAllocationCount() const
+{
+	I32 count = 0;
+	for(U32 i = 0; i < m_threadSlotCount; ++i)
+	{
+		count += m_threadSlots[i].m_allocationCount.load();
+	}
+
+	return count;
 }
 
 ChainMemoryPool::ChainMemoryPool(AllocAlignedCallback allocCb, void* allocCbUserData, PtrSize initialChunkSize,
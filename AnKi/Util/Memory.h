@@ -90,10 +90,7 @@ public:
 	}
 
 	/// Return number of allocations
-	U32 getAllocationCount() const
-	{
-		return m_allocationCount.load();
-	}
+	U32 getAllocationCount() const;
 
 	/// Get the name of the pool.
 	const char* getName() const
@@ -134,8 +131,21 @@ private:
 	Type m_type = Type::NONE;
 };
 
+/// @memberof HeapMemoryPool
+class HeapMemoryPoolStats
+{
+public:
+	PtrSize m_smallObjectUsedSize = 0; ///< The memory of the small objects that are in use, rounded to size classes.
+	PtrSize m_smallObjectReservedSize = 0; ///< The memory the small object spans reserved from the system.
+	F32 m_smallObjectFragmentation = 0.0f; ///< 1 - used / reserved.
+	U64 m_threadCacheHits = 0; ///< Small allocations served without touching the central free lists.
+	U64 m_threadCacheMisses = 0;
+	F32 m_threadCacheHitRate = 0.0f;
+};
+
 /// A dummy interface to match the StackMemoryPool and ChainMemoryPool interfaces in order to be used by the same
-/// allocator template.
+/// allocator template. Optionally it can serve the small allocations from size classes that are cached per thread
+/// instead of going to the allocation callback every time.
 class HeapMemoryPool final : public BaseMemoryPool
 {
 public:
@@ -143,7 +153,10 @@ public:
 	/// @param allocCb The allocation function callback.
 	/// @param allocCbUserData The user data to pass to the allocation function.
 	/// @param name An optional name.
-	HeapMemoryPool(AllocAlignedCallback allocCb, void* allocCbUserDataconst, const char* name = nullptr);
+	/// @param threadCaching If true the small allocations will be served by thread caches of size classes. The memory
+	///        of the small objects is never given back to the allocation callback until the pool is destroyed.
+	HeapMemoryPool(AllocAlignedCallback allocCb, void* allocCbUserDataconst, const char* name = nullptr,
+				   Bool threadCaching = false);
 
 	/// Destroy
 	~HeapMemoryPool();
@@ -160,14 +173,31 @@ public:
 	/// @param[in, out] ptr Memory block to deallocate.
 	void free(void* ptr);
 
+	/// Get the stats of the thread caching. It's thread safe.
+	void getStats(HeapMemoryPoolStats& stats) const;
+
+	Bool isThreadCaching() const
+	{
+		return m_threadCaching != nullptr;
+	}
+
+	/// The thread caches count their small allocations on their own to avoid contention on m_allocationCount.
+	/// @note It's used by BaseMemoryPool::getAllocationCount.
+	I32 getThreadCachedAllocationCount() const;
+
 private:
+	class ThreadCachingAllocator;
+
+	ThreadCachingAllocator* m_threadCaching = nullptr;
+
 #if ANKI_MEM_EXTRA_CHECKS
 	PoolSignature m_signature = 0;
 #endif
 };
 
 /// Thread safe memory pool. It's a preallocated memory pool that is used for memory allocations on top of that
-/// preallocated memory. It is mainly used by fast stack allocators
+/// preallocated memory. It is mainly used by fast stack allocators. Optionally it can keep a separate list of chunks
+/// per thread (see Thread::getCurrentThreadIndex) to avoid contention when many threads allocate at the same time.
 class StackMemoryPool final : public BaseMemoryPool
 {
 public:
@@ -181,9 +211,12 @@ public:
 	///        true to suppress such errors.
 	/// @param alignmentBytes The maximum supported alignment for returned memory.
 	/// @param name An optional name.
+	/// @param threadSlotCount If it's more than one the pool will have that many independent chunk lists. The current
+	///        thread allocates from the slot Thread::getCurrentThreadIndex() % threadSlotCount. The chunk sizes are
+	///        per slot.
 	StackMemoryPool(AllocAlignedCallback allocCb, void* allocCbUserData, PtrSize initialChunkSize,
 					F64 nextChunkScale = 2.0, PtrSize nextChunkBias = 0, Bool ignoreDeallocationErrors = true,
-					U32 alignmentBytes = ANKI_SAFE_ALIGNMENT, const char* name = nullptr);
+					U32 alignmentBytes = ANKI_SAFE_ALIGNMENT, const char* name = nullptr, U32 threadSlotCount = 1);
 
 	/// Destroy
 	~StackMemoryPool();
@@ -206,11 +239,17 @@ public:
 
 	/// Get the physical memory allocated by the pool.
 	/// @note It's not thread safe with other methods.
-	PtrSize getMemoryCapacity() const
+	PtrSize getMemoryCapacity() const;
+
+	U32 getThreadSlotCount() const
 	{
-		return m_builder.getMemoryCapacity();
+		return m_threadSlotCount;
 	}
 
+	/// The thread slots count their allocations on their own.
+	/// @note It's used by BaseMemoryPool::getAllocationCount.
+	I32 getThreadSlotAllocationCount() const;
+
 private:
 	/// This is the absolute max alignment.
 	static constexpr U32 MAX_ALIGNMENT = ANKI_SAFE_ALIGNMENT;
@@ -286,12 +325,29 @@ private:
 
 		Atomic<U32>* getAllocationCount()
 		{
-			return &m_parent->m_allocationCount;
+			// The pool does the counting
+			return nullptr;
 		}
 	};
 
-	/// The allocator helper.
-	StackAllocatorBuilder<Chunk, StackAllocatorBuilderInterface, Mutex> m_builder;
+	/// The chunks of one or more threads.
+	class alignas(ANKI_CACHE_LINE_SIZE) ThreadSlot
+	{
+	public:
+		/// The allocator helper.
+		StackAllocatorBuilder<Chunk, StackAllocatorBuilderInterface, Mutex> m_builder;
+
+		/// It's signed because memory might be freed from a different slot than the one that allocated it.
+		Atomic<I32> m_allocationCount = {0};
+	};
+
+	ThreadSlot* m_threadSlots = nullptr;
+	U32 m_threadSlotCount = 0;
+
+	ThreadSlot& getCurrentThreadSlot()
+	{
+		return m_threadSlots[(m_threadSlotCount == 1) ? 0 : (Thread::getCurrentThreadIndex() % m_threadSlotCount)];
+	}
 };
 
 /// Chain memory pool. Almost similar to StackMemoryPool but more flexible and at the same time a bit slower.
@@ -393,6 +449,22 @@ private:
 	void destroyChunk(Chunk* ch);
 };
 
+inline U32 BaseMemoryPool::getAllocationCount() const
+{
+	I32 count = I32(m_allocationCount.load());
+	if(m_type == Type::HEAP)
+	{
+		count += static_cast<const HeapMemoryPool*>(this)->getThreadCachedAllocationCount();
+	}
+	else if(m_type == Type::STACK)
+	{
+		count += static_cast<const StackMemoryPool*>(this)->getThreadSlotAllocationCount();
+	}
+
+	ANKI_ASSERT(count >= 0);
+	return U32(count);
+}
+
 inline void* BaseMemoryPool::allocate(PtrSize size, PtrSize alignmentBytes)
 {
 	void* out = nullptr;
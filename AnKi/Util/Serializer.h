@@ -206,6 +206,15 @@ public:
 	template<typename T>
 	static ANKI_USE_RESULT Error deserialize(T*& x, GenericMemoryPoolAllocator<U8> allocator, File& file);
 
+	/// Deserialize a class that lives in memory, typically a memory mapped file. It doesn't allocate or copy anything,
+	/// it patches the pointers of the serialized data in place. The returned structure points inside @a data so it's
+	/// valid for as long as @a data is.
+	/// @param[out] x The struct to read.
+	/// @param[in,out] data The contents of a whole serialized file. It should be aligned to ANKI_SAFE_ALIGNMENT.
+	/// @param dataSize The size of the above.
+	template<typename T>
+	static ANKI_USE_RESULT Error deserializeInPlace(T*& x, void* data, PtrSize dataSize);
+
 	/// Read a single value. Can't call this directly.
 	template<typename T>
 	void doValue(CString varName, PtrSize memberOffset, T& x)
@@ -231,4 +231,72 @@ Error BinaryDeserializer::deserialize(T*& x, GenericMemoryPoolAllocator<U8> allo
 	return Error::NONE;
 }
 
+template<typename T>
+Error BinaryDeserializer::deserializeInPlace(T*& x, void* data, PtrSize dataSize)
+{
+	ANKI_ASSERT(data && isAligned(ANKI_SAFE_ALIGNMENT, data));
+	x = nullptr;
+
+	if(dataSize < sizeof(detail::BinarySerializerHeader))
+	{
+		ANKI_UTIL_LOGE("Data too small");
+		return Error::USER_DATA;
+	}
+
+	const detail::BinarySerializerHeader& header = *static_cast<const detail::BinarySerializerHeader*>(data);
+	U8* const baseAddress = static_cast<U8*>(data) + sizeof(header);
+
+	// Sanity checks
+	{
+		if(memcmp(&header.m_magic[0], detail::BINARY_SERIALIZER_MAGIC, 8) != 0)
+		{
+			ANKI_UTIL_LOGE("Wrong magic work in header");
+			return Error::USER_DATA;
+		}
+
+		if(header.m_dataSize < sizeof(T))
+		{
+			ANKI_UTIL_LOGE("Wrong data size");
+			return Error::USER_DATA;
+		}
+
+		const PtrSize expectedSizeAfterHeader = header.m_dataSize + header.m_pointerCount * sizeof(void*);
+		const PtrSize actualSizeAfterHeader = dataSize - sizeof(header);
+		if(expectedSizeAfterHeader > actualSizeAfterHeader
+		   || (header.m_pointerCount
+			   && header.m_pointerArrayFilePosition + header.m_pointerCount * sizeof(void*) > dataSize))
+		{
+			ANKI_UTIL_LOGE("Data size doesn't match expectations");
+			return Error::USER_DATA;
+		}
+	}
+
+	// Fix pointers. Only the pages that contain pointers will be written (and copied if it's a private mapping)
+	const U8* pointerOffsets = static_cast<const U8*>(data) + header.m_pointerArrayFilePosition;
+	for(PtrSize i = 0; i < header.m_pointerCount; ++i)
+	{
+		// The array of offsets is not necessarily aligned
+		PtrSize offsetFromBeginOfData;
+		memcpy(&offsetFromBeginOfData, pointerOffsets + i * sizeof(PtrSize), sizeof(PtrSize));
+		if(offsetFromBeginOfData + sizeof(void*) > header.m_dataSize)
+		{
+			ANKI_UTIL_LOGE("Corrupt pointer");
+			return Error::USER_DATA;
+		}
+
+		PtrSize& ptrValue = *reinterpret_cast<PtrSize*>(baseAddress + offsetFromBeginOfData);
+		if(ptrValue >= header.m_dataSize)
+		{
+			ANKI_UTIL_LOGE("Corrupt pointer");
+			return Error::USER_DATA;
+		}
+
+		ptrValue += ptrToNumber(baseAddress);
+	}
+
+	// Done
+	x = reinterpret_cast<T*>(baseAddress);
+	return Error::NONE;
+}
+
 } // end namespace anki
@@ -617,11 +617,10 @@ public:
 		return toCString().toNumber(out);
 	}
 
-	/// Compute the hash.
+	/// Compute the hash. It's the same as the hash of the CString.
 	U64 computeHash() const
 	{
-		checkInit();
-		return anki::computeHash(&m_data[0], m_data.getSize());
+		return toCString().computeHash();
 	}
 
 	/// Replace all occurrences of "from" with "to".
@@ -0,0 +1,540 @@
+// Copyright (C) 2009-2022, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Util/HashMap.h>
+#if ANKI_SIMD_SSE
+#	include <emmintrin.h>
+#elif ANKI_SIMD_NEON
+#	include <arm_neon.h>
+#endif
+
+namespace anki {
+
+/// @addtogroup util_containers
+/// @{
+
+/// @memberof SwissHashMap
+/// The control bytes of a group of slots. The control byte of a full slot holds 7 bits of the hash of its key. With
+/// SIMD a group is 16 slots, without it's 8 slots that are processed as a U64.
+class SwissHashMapGroup
+{
+public:
+#if ANKI_SIMD_NONE
+	static constexpr U32 WIDTH = 8;
+#else
+	static constexpr U32 WIDTH = 16;
+#endif
+
+	static constexpr I8 EMPTY = -128; // 0b10000000
+	static constexpr I8 DELETED = -2; // 0b11111110
+
+	/// A mask of slots. Every slot is represented by SLOT_BITS bits.
+	class Mask
+	{
+	public:
+#if ANKI_SIMD_SSE
+		static constexpr U32 SLOT_BITS = 1;
+#elif ANKI_SIMD_NEON
+		static constexpr U32 SLOT_BITS = 4;
+#else
+		static constexpr U32 SLOT_BITS = 8;
+#endif
+
+		U64 m_bits;
+
+		explicit operator Bool() const
+		{
+			return m_bits != 0;
+		}
+
+		/// Get the index of the first slot in the mask.
+		U32 getLowestSlot() const
+		{
+			ANKI_ASSERT(m_bits);
+			return U32(__builtin_ctzll(m_bits)) / SLOT_BITS;
+		}
+
+		/// Remove the first slot from the mask.
+		void removeLowestSlot()
+		{
+#if ANKI_SIMD_NEON
+			m_bits &= ~(U64(0xF) << (getLowestSlot() * SLOT_BITS));
+#else
+			m_bits &= m_bits - 1;
+#endif
+		}
+	};
+
+	explicit SwissHashMapGroup(const I8* ctrl)
+	{
+#if ANKI_SIMD_SSE
+		m_ctrl = _mm_load_si128(reinterpret_cast<const __m128i*>(ctrl));
+#elif ANKI_SIMD_NEON
+		m_ctrl = vld1q_s8(ctrl);
+#else
+		memcpy(&m_ctrl, ctrl, sizeof(m_ctrl));
+#endif
+	}
+
+	/// Find the slots that have the same 7 bits of hash. Might have false positives.
+	Mask match(I8 h2) const
+	{
+#if ANKI_SIMD_SSE
+		return {U64(U32(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), m_ctrl))))};
+#elif ANKI_SIMD_NEON
+		return toMask(vceqq_s8(vdupq_n_s8(h2), m_ctrl));
+#else
+		// Find the zero bytes of the xor. Can have false positives if the byte after a match is h2^0x01
+		const U64 x = m_ctrl ^ (LSBS * U8(h2));
+		return {(x - LSBS) & ~x & MSBS};
+#endif
+	}
+
+	/// Find the empty slots.
+	Mask matchEmpty() const
+	{
+#if ANKI_SIMD_NONE
+		// EMPTY is the only one that has the sign bit set and the 2nd bit unset
+		return {m_ctrl & (~m_ctrl << 6) & MSBS};
+#else
+		return match(EMPTY);
+#endif
+	}
+
+	/// Find the slots that are empty or deleted. Both have the sign bit set.
+	Mask matchEmptyOrDeleted() const
+	{
+#if ANKI_SIMD_SSE
+		return {U64(U32(_mm_movemask_epi8(m_ctrl)))};
+#elif ANKI_SIMD_NEON
+		return toMask(vcltzq_s8(m_ctrl));
+#else
+		return {m_ctrl & MSBS};
+#endif
+	}
+
+private:
+#if ANKI_SIMD_SSE
+	__m128i m_ctrl;
+#elif ANKI_SIMD_NEON
+	int8x16_t m_ctrl;
+
+	/// Narrow the 16 bytes of the comparison to 16 nibbles.
+	static Mask toMask(uint8x16_t cmp)
+	{
+		const uint8x8_t narrow = vshrn_n_u16(vreinterpretq_u16_u8(cmp), 4);
+		return {vget_lane_u64(vreinterpret_u64_u8(narrow), 0)};
+	}
+#else
+	static constexpr U64 LSBS = 0x0101010101010101ull;
+	static constexpr U64 MSBS = 0x8080808080808080ull;
+
+	U64 m_ctrl;
+#endif
+};
+
+/// SwissHashMap iterator.
+template<typename TSlotPointer, typename TValuePointer, typename TValueReference, typename TKeyReference>
+class SwissHashMapIterator
+{
+	template<typename, typename, typename>
+	friend class SwissHashMap;
+
+	template<typename, typename, typename, typename>
+	friend class SwissHashMapIterator;
+
+public:
+	SwissHashMapIterator() = default;
+
+	/// Allow conversion from iterator to const iterator.
+	template<typename YSlotPointer, typename YValuePointer, typename YValueReference, typename YKeyReference>
+	SwissHashMapIterator(
+		const SwissHashMapIterator<YSlotPointer, YValuePointer, YValueReference, YKeyReference>& b)
+		: m_slots(b.m_slots)
+		, m_ctrl(b.m_ctrl)
+		, m_idx(b.m_idx)
+		, m_capacity(b.m_capacity)
+	{
+	}
+
+	TValueReference operator*() const
+	{
+		check();
+		return m_slots[m_idx].m_value;
+	}
+
+	TValuePointer operator->() const
+	{
+		check();
+		return &m_slots[m_idx].m_value;
+	}
+
+	/// Get the key of the element.
+	TKeyReference getKey() const
+	{
+		check();
+		return m_slots[m_idx].m_key;
+	}
+
+	SwissHashMapIterator& operator++()
+	{
+		check();
+		++m_idx;
+		skipToNextFull();
+		return *this;
+	}
+
+	SwissHashMapIterator operator++(int)
+	{
+		SwissHashMapIterator out = *this;
+		++(*this);
+		return out;
+	}
+
+	template<typename YSlotPointer, typename YValuePointer, typename YValueReference, typename YKeyReference>
+	Bool operator==(const SwissHashMapIterator<YSlotPointer, YValuePointer, YValueReference, YKeyReference>& b) const
+	{
+		ANKI_ASSERT(m_ctrl == b.m_ctrl && "Comparing iterators of different maps");
+		return m_idx == b.m_idx;
+	}
+
+	template<typename YSlotPointer, typename YValuePointer, typename YValueReference, typename YKeyReference>
+	Bool operator!=(const SwissHashMapIterator<YSlotPointer, YValuePointer, YValueReference, YKeyReference>& b) const
+	{
+		return !(*this == b);
+	}
+
+private:
+	TSlotPointer m_slots = nullptr;
+	const I8* m_ctrl = nullptr;
+	U32 m_idx = 0;
+	U32 m_capacity = 0;
+
+	SwissHashMapIterator(TSlotPointer slots, const I8* ctrl, U32 idx, U32 capacity)
+		: m_slots(slots)
+		, m_ctrl(ctrl)
+		, m_idx(idx)
+		, m_capacity(capacity)
+	{
+	}
+
+	void skipToNextFull()
+	{
+		while(m_idx < m_capacity && m_ctrl[m_idx] < 0)
+		{
+			++m_idx;
+		}
+	}
+
+	void check() const
+	{
+		ANKI_ASSERT(m_idx < m_capacity && m_ctrl[m_idx] >= 0);
+	}
+};
+
+/// An open addressing hash map in the spirit of Google's Swiss tables. Next to the slots there is an array of 1 byte
+/// control values, one per slot, that hold 7 bits of the hash of the key or mark the slot as empty or deleted. A lookup
+/// probes groups of 16 control bytes at once using SIMD and touches the slots only when the 7 bits match. Unlike
+/// HashMap it stores the keys so collisions of the 64bit hashes are handled and lookups can use a different key type
+/// (eg CString against StringAuto keys) as long as the hasher and the operator== accept it.
+template<typename TKey, typename TValue, typename THasher = DefaultHasher<TKey>>
+class SwissHashMap
+{
+	class Slot;
+
+public:
+	// Typedefs
+	using Value = TValue;
+	using Key = TKey;
+	using Hasher = THasher;
+	using Iterator = SwissHashMapIterator<Slot*, TValue*, TValue&, const TKey&>;
+	using ConstIterator = SwissHashMapIterator<const Slot*, const TValue*, const TValue&, const TKey&>;
+
+	// Consts
+	/// The maximum load factor is 7/8 of the capacity.
+	static constexpr U32 MAX_LOAD_FACTOR_NUMERATOR = 7;
+	static constexpr U32 MAX_LOAD_FACTOR_DENOMINATOR = 8;
+
+	SwissHashMap() = default;
+
+	/// Move.
+	SwissHashMap(SwissHashMap&& b)
+	{
+		*this = std::move(b);
+	}
+
+	/// You need to manually destroy the map.
+	/// @see SwissHashMap::destroy
+	~SwissHashMap()
+	{
+		ANKI_ASSERT(m_ctrl == nullptr && "Forgot to destroy");
+	}
+
+	/// Move.
+	SwissHashMap& operator=(SwissHashMap&& b)
+	{
+		ANKI_ASSERT(m_ctrl == nullptr && "Forgot to destroy");
+		m_ctrl = b.m_ctrl;
+		m_slots = b.m_slots;
+		m_capacity = b.m_capacity;
+		m_size = b.m_size;
+		m_growthLeft = b.m_growthLeft;
+		b.resetMembers();
+		return *this;
+	}
+
+	/// Get begin.
+	Iterator getBegin()
+	{
+		Iterator it(m_slots, m_ctrl, 0, m_capacity);
+		it.skipToNextFull();
+		return it;
+	}
+
+	/// Get begin.
+	ConstIterator getBegin() const
+	{
+		ConstIterator it(m_slots, m_ctrl, 0, m_capacity);
+		it.skipToNextFull();
+		return it;
+	}
+
+	/// Get end.
+	Iterator getEnd()
+	{
+		return Iterator(m_slots, m_ctrl, m_capacity, m_capacity);
+	}
+
+	/// Get end.
+	ConstIterator getEnd() const
+	{
+		return ConstIterator(m_slots, m_ctrl, m_capacity, m_capacity);
+	}
+
+	/// Get begin.
+	Iterator begin()
+	{
+		return getBegin();
+	}
+
+	/// Get begin.
+	ConstIterator begin() const
+	{
+		return getBegin();
+	}
+
+	/// Get end.
+	Iterator end()
+	{
+		return getEnd();
+	}
+
+	/// Get end.
+	ConstIterator end() const
+	{
+		return getEnd();
+	}
+
+	/// Return true if map is empty.
+	Bool isEmpty() const
+	{
+		return m_size == 0;
+	}
+
+	PtrSize getSize() const
+	{
+		return m_size;
+	}
+
+	PtrSize getCapacity() const
+	{
+		return m_capacity;
+	}
+
+	/// Destroy the map.
+	template<typename TAllocator>
+	void destroy(TAllocator alloc);
+
+	/// Allocate enough space for a number of elements.
+	template<typename TAllocator>
+	void reserve(TAllocator alloc, PtrSize elementCount);
+
+	/// Construct an element inside the map. The key shouldn't be present.
+	/// @param key A key or something that TKey can be constructed from.
+	template<typename TAllocator, typename TKeyArg, typename... TArgs>
+	Iterator emplace(TAllocator alloc, TKeyArg&& key, TArgs&&... args);
+
+	/// Erase element.
+	template<typename TAllocator>
+	void erase(TAllocator alloc, Iterator it);
+
+	/// Find a value using a key.
+	/// @param key The key or some other type that the THasher and the TKey::operator== accept.
+	template<typename TKeyLike>
+	Iterator find(const TKeyLike& key)
+	{
+		return Iterator(m_slots, m_ctrl, findInternal(key), m_capacity);
+	}
+
+	/// Find a value using a key.
+	/// @param key The key or some other type that the THasher and the TKey::operator== accept.
+	template<typename TKeyLike>
+	ConstIterator find(const TKeyLike& key) const
+	{
+		return ConstIterator(m_slots, m_ctrl, findInternal(key), m_capacity);
+	}
+
+private:
+	class Slot
+	{
+	public:
+		TKey m_key;
+		TValue m_value;
+
+		template<typename TKeyArg, typename... TArgs>
+		Slot(TKeyArg&& key, TArgs&&... args)
+			: m_key(std::forward<TKeyArg>(key))
+			, m_value(std::forward<TArgs>(args)...)
+		{
+		}
+	};
+
+	/// The 1st part is the control bytes and the 2nd the slots. Both in one allocation.
+	I8* m_ctrl = nullptr;
+	Slot* m_slots = nullptr;
+	U32 m_capacity = 0; ///< Always a multiple of SwissHashMapGroup::WIDTH and the group count is a power of two.
+	U32 m_size = 0;
+	U32 m_growthLeft = 0; ///< How many elements can be inserted before a rehash. The deleted slots count as used.
+
+	/// The hasher might not have good entropy in all bits (eg DefaultHasher<U64>) so mix it.
+	template<typename TKeyLike>
+	static U64 computeHash(const TKeyLike& key)
+	{
+		const U64 h = THasher()(key) * 0x9E3779B97F4A7C15ull;
+		return h ^ (h >> 32);
+	}
+
+	/// Get the 7 bits that are stored in the control bytes.
+	static I8 getH2(U64 hash)
+	{
+		return I8(hash & 0x7F);
+	}
+
+	/// Get the 1st group to probe.
+	static U32 getH1(U64 hash)
+	{
+		return U32(hash >> 7);
+	}
+
+	U32 getGroupMask() const
+	{
+		return m_capacity / SwissHashMapGroup::WIDTH - 1;
+	}
+
+	static U32 computeMaxSize(U32 capacity)
+	{
+		return capacity / MAX_LOAD_FACTOR_DENOMINATOR * MAX_LOAD_FACTOR_NUMERATOR;
+	}
+
+	void resetMembers()
+	{
+		m_ctrl = nullptr;
+		m_slots = nullptr;
+		m_capacity = 0;
+		m_size = 0;
+		m_growthLeft = 0;
+	}
+
+	template<typename TKeyLike>
+	U32 findInternal(const TKeyLike& key) const;
+
+	/// Find an empty or deleted slot for a new element.
+	U32 findSlotForInsertion(U64 hash) const;
+
+	void setCtrl(U32 idx, I8 ctrl)
+	{
+		ANKI_ASSERT(idx < m_capacity);
+		m_ctrl[idx] = ctrl;
+	}
+
+	/// Re-create the storage and move the elements.
+	template<typename TAllocator>
+	void rehash(TAllocator alloc, U32 newCapacity);
+};
+
+/// Swiss hash map template with automatic cleanup.
+template<typename TKey, typename TValue, typename THasher = DefaultHasher<TKey>>
+class SwissHashMapAuto : public SwissHashMap<TKey, TValue, THasher>
+{
+public:
+	using Base = SwissHashMap<TKey, TValue, THasher>;
+
+	SwissHashMapAuto(const GenericMemoryPoolAllocator<U8>& alloc)
+		: m_alloc(alloc)
+	{
+	}
+
+	/// Move.
+	SwissHashMapAuto(SwissHashMapAuto&& b)
+		: Base()
+		, m_alloc(b.m_alloc)
+	{
+		Base::operator=(std::move(b));
+	}
+
+	SwissHashMapAuto(const SwissHashMapAuto&) = delete; // Non-copyable
+
+	/// Destructor.
+	~SwissHashMapAuto()
+	{
+		destroy();
+	}
+
+	/// Move.
+	SwissHashMapAuto& operator=(SwissHashMapAuto&& b)
+	{
+		destroy();
+		m_alloc = b.m_alloc;
+		Base::operator=(std::move(b));
+		return *this;
+	}
+
+	SwissHashMapAuto& operator=(const SwissHashMapAuto&) = delete; // Non-copyable
+
+	/// Allocate enough space for a number of elements.
+	void reserve(PtrSize elementCount)
+	{
+		Base::reserve(m_alloc, elementCount);
+	}
+
+	/// Construct an element inside the map.
+	template<typename TKeyArg, typename... TArgs>
+	typename Base::Iterator emplace(TKeyArg&& key, TArgs&&... args)
+	{
+		return Base::emplace(m_alloc, std::forward<TKeyArg>(key), std::forward<TArgs>(args)...);
+	}
+
+	/// Erase element.
+	void erase(typename Base::Iterator it)
+	{
+		Base::erase(m_alloc, it);
+	}
+
+	/// Clean up the map.
+	void destroy()
+	{
+		Base::destroy(m_alloc);
+	}
+
+private:
+	GenericMemoryPoolAllocator<U8> m_alloc;
+};
+/// @}
+
+} // end namespace anki
+
+#include <AnKi/Util/SwissHashMap.inl.h>
@@ -0,0 +1,224 @@
+// Copyright (C) 2009-2022, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Util/SwissHashMap.h>
+
+namespace anki {
+
+template<typename TKey, typename TValue, typename THasher>
+template<typename TAllocator>
+void SwissHashMap<TKey, TValue, THasher>::destroy(TAllocator alloc)
+{
+	if(m_ctrl)
+	{
+		for(U32 i = 0; i < m_capacity; ++i)
+		{
+			if(m_ctrl[i] >= 0)
+			{
+				m_slots[i].~Slot();
+			}
+		}
+
+		alloc.getMemoryPool().free(m_ctrl);
+	}
+
+	resetMembers();
+}
+
+template<typename TKey, typename TValue, typename THasher>
+template<typename TAllocator>
+void SwissHashMap<TKey, TValue, THasher>::reserve(TAllocator alloc, PtrSize elementCount)
+{
+	U32 newCapacity = max(m_capacity, SwissHashMapGroup::WIDTH);
+	while(computeMaxSize(newCapacity) < elementCount)
+	{
+		newCapacity *= 2;
+	}
+
+	if(newCapacity != m_capacity)
+	{
+		rehash(alloc, newCapacity);
+	}
+}
+
+template<typename TKey, typename TValue, typename THasher>
+template<typename TAllocator, typename TKeyArg, typename... TArgs>
+typename SwissHashMap<TKey, TValue, THasher>::Iterator
+SwissHashMap<TKey, TValue, THasher>::emplace(TAllocator alloc, TKeyArg&& key, TArgs&&... args)
+{
+	ANKI_ASSERT(findInternal(key) == m_capacity && "Key already exists");
+
+	if(m_growthLeft == 0)
+	{
+		// Out of space. If most of the used slots are deleted rehash without growing
+		U32 newCapacity;
+		if(m_capacity == 0)
+		{
+			newCapacity = SwissHashMapGroup::WIDTH;
+		}
+		else if(m_size > computeMaxSize(m_capacity) / 2)
+		{
+			newCapacity = m_capacity * 2;
+		}
+		else
+		{
+			newCapacity = m_capacity;
+		}
+
+		rehash(alloc, newCapacity);
+	}
+
+	const U64 hash = computeHash(key);
+	const U32 idx = findSlotForInsertion(hash);
+
+	if(m_ctrl[idx] == SwissHashMapGroup::EMPTY)
+	{
+		ANKI_ASSERT(m_growthLeft > 0);
+		--m_growthLeft;
+	}
+
+	setCtrl(idx, getH2(hash));
+	::new(&m_slots[idx]) Slot(std::forward<TKeyArg>(key), std::forward<TArgs>(args)...);
+	++m_size;
+
+	return Iterator(m_slots, m_ctrl, idx, m_capacity);
+}
+
+template<typename TKey, typename TValue, typename THasher>
+template<typename TAllocator>
+void SwissHashMap<TKey, TValue, THasher>::erase(TAllocator alloc, Iterator it)
+{
+	ANKI_ASSERT(it.m_ctrl == m_ctrl && "Iterator of another map");
+	it.check();
+	const U32 idx = it.m_idx;
+
+	m_slots[idx].~Slot();
+	--m_size;
+
+	// If the group has an empty slot the probing of all the keys stops at this group anyway so the slot can become
+	// empty. If not the slot becomes a tombstone so the probing continues to the next groups
+	const SwissHashMapGroup group(m_ctrl + (idx / SwissHashMapGroup::WIDTH) * SwissHashMapGroup::WIDTH);
+	if(group.matchEmpty())
+	{
+		setCtrl(idx, SwissHashMapGroup::EMPTY);
+		++m_growthLeft;
+	}
+	else
+	{
+		setCtrl(idx, SwissHashMapGroup::DELETED);
+	}
+
+	if(m_size == 0)
+	{
+		// Clean the tombstones
+		memset(m_ctrl, SwissHashMapGroup::EMPTY, m_capacity);
+		m_growthLeft = computeMaxSize(m_capacity);
+	}
+}
+
+template<typename TKey, typename TValue, typename THasher>
+template<typename TKeyLike>
+U32 SwissHashMap<TKey, TValue, THasher>::findInternal(const TKeyLike& key) const
+{
+	if(m_size == 0)
+	{
+		return m_capacity;
+	}
+
+	const U64 hash = computeHash(key);
+	const I8 h2 = getH2(hash);
+	const U32 groupMask = getGroupMask();
+	U32 groupIdx = getH1(hash) & groupMask;
+
+	// Triangular probing visits all groups since the group count is a power of two
+	for(U32 step = 1;; ++step)
+	{
+		const U32 firstSlot = groupIdx * SwissHashMapGroup::WIDTH;
+		const SwissHashMapGroup group(m_ctrl + firstSlot);
+
+		for(SwissHashMapGroup::Mask mask = group.match(h2); mask; mask.removeLowestSlot())
+		{
+			const U32 idx = firstSlot + mask.getLowestSlot();
+			if(key == m_slots[idx].m_key)
+			{
+				return idx;
+			}
+		}
+
+		if(group.matchEmpty() || step > groupMask)
+		{
+			return m_capacity;
+		}
+
+		groupIdx = (groupIdx + step) & groupMask;
+	}
+}
+
+template<typename TKey, typename TValue, typename THasher>
+U32 SwissHashMap<TKey, TValue, THasher>::findSlotForInsertion(U64 hash) const
+{
+	const U32 groupMask = getGroupMask();
+	U32 groupIdx = getH1(hash) & groupMask;
+
+	for(U32 step = 1;; ++step)
+	{
+		const U32 firstSlot = groupIdx * SwissHashMapGroup::WIDTH;
+		const SwissHashMapGroup::Mask mask = SwissHashMapGroup(m_ctrl + firstSlot).matchEmptyOrDeleted();
+		if(mask)
+		{
+			return firstSlot + mask.getLowestSlot();
+		}
+
+		ANKI_ASSERT(step <= groupMask && "The load factor should have left free slots");
+		groupIdx = (groupIdx + step) & groupMask;
+	}
+}
+
+template<typename TKey, typename TValue, typename THasher>
+template<typename TAllocator>
+void SwissHashMap<TKey, TValue, THasher>::rehash(TAllocator alloc, U32 newCapacity)
+{
+	ANKI_ASSERT(newCapacity >= SwissHashMapGroup::WIDTH && isPowerOfTwo(newCapacity / SwissHashMapGroup::WIDTH));
+	ANKI_ASSERT(computeMaxSize(newCapacity) >= m_size);
+
+	I8* oldCtrl = m_ctrl;
+	Slot* oldSlots = m_slots;
+	const U32 oldCapacity = m_capacity;
+
+	// Allocate the new storage
+	const PtrSize slotsOffset = getAlignedRoundUp(alignof(Slot), PtrSize(newCapacity));
+	const PtrSize alignment = max<PtrSize>(alignof(Slot), SwissHashMapGroup::WIDTH);
+	U8* mem = static_cast<U8*>(
+		alloc.getMemoryPool().allocate(slotsOffset + PtrSize(newCapacity) * sizeof(Slot), alignment));
+
+	m_ctrl = reinterpret_cast<I8*>(mem);
+	m_slots = reinterpret_cast<Slot*>(mem + slotsOffset);
+	m_capacity = newCapacity;
+	m_growthLeft = computeMaxSize(newCapacity) - m_size;
+	memset(m_ctrl, SwissHashMapGroup::EMPTY, newCapacity);
+
+	// Move the elements
+	for(U32 i = 0; i < oldCapacity; ++i)
+	{
+		if(oldCtrl[i] < 0)
+		{
+			continue;
+		}
+
+		Slot& oldSlot = oldSlots[i];
+		const U64 hash = computeHash(oldSlot.m_key);
+		const U32 idx = findSlotForInsertion(hash);
+		setCtrl(idx, getH2(hash));
+		::new(&m_slots[idx]) Slot(std::move(oldSlot));
+		oldSlot.~Slot();
+	}
+
+	if(oldCtrl)
+	{
+		alloc.getMemoryPool().free(oldCtrl);
+	}
+}
+
+} // end namespace anki
@@ -108,7 +108,22 @@ public:
 	/// Name the current thread.
 	static void setNameOfCurrentThread(const CString& name);
 
+	/// Get a small index that identifies the current thread. The ThreadHive workers have indices starting from 1 and
+	/// every other thread has zero. It's used to pick per-thread resources without locking.
+	static U32 getCurrentThreadIndex()
+	{
+		return m_currentThreadIndex;
+	}
+
+	/// @copydoc getCurrentThreadIndex
+	static void setCurrentThreadIndex(U32 index)
+	{
+		m_currentThreadIndex = index;
+	}
+
 private:
+	static thread_local U32 m_currentThreadIndex;
+
 	/// The system native type.
 #if ANKI_POSIX
 	pthread_t m_handle = {};
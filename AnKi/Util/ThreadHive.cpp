@@ -4,6 +4,7 @@
 // http://www.anki3d.org/LICENSE
 
 #include <AnKi/Util/ThreadHive.h>
+#include <AnKi/Util/Tracer.h>
 #include <cstring>
 #include <cstdio>
 
@@ -40,6 +41,7 @@ private:
 	{
 		Thread& self = *static_cast<Thread*>(info.m_userData);
 
+		anki::Thread::setCurrentThreadIndex(self.m_id + 1);
 		self.m_hive->threadRun(self.m_id);
 		return Error::NONE;
 	}
@@ -159,7 +161,10 @@ void ThreadHive::threadRun(U32 threadId)
 		ANKI_ASSERT(task && task->m_cb);
 		ANKI_HIVE_DEBUG_PRINT("tid: %lu will exec %p (udata: %p)\n", threadId, static_cast<void*>(task),
 							  static_cast<void*>(task->m_arg));
-		task->m_cb(task->m_arg, threadId, *this, task->m_signalSemaphore);
+		{
+			ANKI_TRACE_SCOPED_HW_EVENT(THREAD_HIVE_TASK);
+			task->m_cb(task->m_arg, threadId, *this, task->m_signalSemaphore);
+		}
 
 #if ANKI_EXTRA_CHECKS
 		task->m_cb = nullptr;
@@ -9,6 +9,8 @@
 
 namespace anki {
 
+thread_local U32 Thread::m_currentThreadIndex = 0;
+
 void Thread::start(void* userData, ThreadCallback callback, const ThreadCoreAffinityMask& coreAffintyMask)
 {
 	ANKI_ASSERT(!m_started);
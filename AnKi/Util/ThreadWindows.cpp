@@ -32,6 +32,8 @@ DWORD ANKI_WINAPI Thread::threadCallback(LPVOID ud)
 	return thread->m_returnCode._getCode();
 }
 
+thread_local U32 Thread::m_currentThreadIndex = 0;
+
 void Thread::start(void* userData, ThreadCallback callback, const ThreadCoreAffinityMask& coreAffintyMask)
 {
 	ANKI_ASSERT(!m_started);
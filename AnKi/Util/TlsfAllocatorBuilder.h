@@ -0,0 +1,136 @@
+// Copyright (C) 2009-2022, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Util/DynamicArray.h>
+#include <AnKi/Util/HashMap.h>
+
+namespace anki {
+
+/// @addtogroup util_memory
+/// @{
+
+/// @memberof TlsfAllocatorBuilder
+class TlsfAllocatorBuilderStats
+{
+public:
+	PtrSize m_userAllocatedSize;
+	PtrSize m_realAllocatedSize;
+	PtrSize m_largestFreeBlockSize;
+	U32 m_freeBlockCount;
+	F32 m_externalFragmentation;
+	F32 m_internalFragmentation;
+};
+
+/// This is a generic implementation of a two-level segregated fit allocator (TLSF). It doesn't own memory, it manages
+/// offsets in an address space. Allocations and deallocations are O(1) and unlike the BuddyAllocatorBuilder the sizes
+/// are not rounded to powers of two so the internal fragmentation is minimal.
+/// @tparam TLock This an optional lock. Can be a Mutex or SpinLock or some dummy class.
+template<typename TLock>
+class TlsfAllocatorBuilder
+{
+public:
+	TlsfAllocatorBuilder()
+	{
+	}
+
+	/// @copydoc init
+	TlsfAllocatorBuilder(GenericMemoryPoolAllocator<U8> alloc, PtrSize size)
+	{
+		init(alloc, size);
+	}
+
+	TlsfAllocatorBuilder(const TlsfAllocatorBuilder&) = delete; // Non-copyable
+
+	~TlsfAllocatorBuilder()
+	{
+		destroy();
+	}
+
+	TlsfAllocatorBuilder& operator=(const TlsfAllocatorBuilder&) = delete; // Non-copyable
+
+	/// Init the allocator.
+	/// @param alloc The allocator used for internal structures of the TlsfAllocatorBuilder.
+	/// @param size The size of the address space. Doesn't have to be a power of two.
+	void init(GenericMemoryPoolAllocator<U8> alloc, PtrSize size);
+
+	/// Destroy the allocator.
+	void destroy();
+
+	/// Allocate memory.
+	/// @param size The size of the allocation.
+	/// @param alignment The returned address should have this alignment.
+	/// @param[out] address The returned address if the allocation didn't fail. It will stay untouched if it failed.
+	/// @return True if the allocation succeeded.
+	ANKI_USE_RESULT Bool allocate(PtrSize size, PtrSize alignment, PtrSize& address);
+
+	/// Free memory.
+	/// @param address The address to free.
+	/// @param size The size of the allocation.
+	/// @param alignment The alignment of the original allocation.
+	void free(PtrSize address, PtrSize size, PtrSize alignment);
+
+	/// Get some info.
+	void getStats(TlsfAllocatorBuilderStats& stats) const;
+
+private:
+	/// The 2nd level divides every power of two range to that many lists.
+	static constexpr U32 SECOND_LEVEL_LOG2 = 4;
+	static constexpr U32 SECOND_LEVEL_COUNT = 1u << SECOND_LEVEL_LOG2;
+	static constexpr U32 FIRST_LEVEL_COUNT = 64 - SECOND_LEVEL_LOG2 + 1;
+
+	/// Don't split blocks if the remainder is smaller than that. It will be part of the allocation.
+	static constexpr PtrSize MIN_BLOCK_SIZE = 16;
+
+	class Block
+	{
+	public:
+		PtrSize m_address;
+		PtrSize m_size;
+		U32 m_prevPhysical; ///< The block that is before this one in the address space.
+		U32 m_nextPhysical; ///< The block that is after this one in the address space.
+		U32 m_prevFree;
+		U32 m_nextFree; ///< Also used to link the unused slots of m_blocks.
+		Bool m_free;
+	};
+
+	GenericMemoryPoolAllocator<U8> m_alloc;
+	DynamicArray<Block> m_blocks;
+	U32 m_unusedBlockSlotsHead = MAX_U32;
+	HashMap<U64, U32> m_usedBlocks; ///< Address to m_blocks index.
+
+	U64 m_firstLevelBitmap = 0;
+	Array<U32, FIRST_LEVEL_COUNT> m_secondLevelBitmaps;
+	Array2d<U32, FIRST_LEVEL_COUNT, SECOND_LEVEL_COUNT> m_freeListHeads;
+
+	PtrSize m_size = 0;
+	PtrSize m_userAllocatedSize = 0; ///< The total ammount of memory requested by the user.
+	PtrSize m_realAllocatedSize = 0; ///< The total ammount of memory actually allocated.
+	mutable TLock m_mutex;
+
+	static void mapping(PtrSize size, U32& firstLevel, U32& secondLevel);
+
+	Bool findFreeBlock(PtrSize size, U32& firstLevel, U32& secondLevel) const;
+
+	U32 newBlock(PtrSize address, PtrSize size);
+
+	void deleteBlock(U32 idx);
+
+	void insertFreeBlock(U32 idx);
+
+	void removeFreeBlock(U32 idx);
+
+	/// Split a block to two. The 1st part keeps its index and the 2nd part is returned.
+	U32 splitBlock(U32 idx, PtrSize firstPartSize);
+
+	/// Merge a block with the one after it. The 2nd is deleted.
+	void mergeBlocks(U32 idx, U32 nextIdx);
+};
+/// @}
+
+} // end namespace anki
+
+#include <AnKi/Util/TlsfAllocatorBuilder.inl.h>
@@ -0,0 +1,397 @@
+// Copyright (C) 2009-2022, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Util/TlsfAllocatorBuilder.h>
+
+namespace anki {
+
+template<typename TLock>
+void TlsfAllocatorBuilder<TLock>::init(GenericMemoryPoolAllocator<U8> alloc, PtrSize size)
+{
+	ANKI_ASSERT(size > 0);
+	ANKI_ASSERT(m_blocks.getSize() == 0 && m_userAllocatedSize == 0 && m_realAllocatedSize == 0);
+
+	m_alloc = alloc;
+	m_size = size;
+
+	m_firstLevelBitmap = 0;
+	for(U32 fl = 0; fl < FIRST_LEVEL_COUNT; ++fl)
+	{
+		m_secondLevelBitmaps[fl] = 0;
+		for(U32 sl = 0; sl < SECOND_LEVEL_COUNT; ++sl)
+		{
+			m_freeListHeads[fl][sl] = MAX_U32;
+		}
+	}
+
+	// Everything is a single free block
+	const U32 idx = newBlock(0, m_size);
+	insertFreeBlock(idx);
+}
+
+template<typename TLock>
+void TlsfAllocatorBuilder<TLock>::destroy()
+{
+	ANKI_ASSERT(m_userAllocatedSize == 0 && "Forgot to free all memory");
+	m_blocks.destroy(m_alloc);
+	m_usedBlocks.destroy(m_alloc);
+	m_unusedBlockSlotsHead = MAX_U32;
+	m_size = 0;
+	m_userAllocatedSize = 0;
+	m_realAllocatedSize = 0;
+}
+
+template<typename TLock>
+void TlsfAllocatorBuilder<TLock>::mapping(PtrSize size, U32& firstLevel, U32& secondLevel)
+{
+	ANKI_ASSERT(size > 0);
+
+	if(size < SECOND_LEVEL_COUNT)
+	{
+		// Small sizes go linearly to the 1st list
+		firstLevel = 0;
+		secondLevel = U32(size);
+	}
+	else
+	{
+		const U32 log2 = 63u - U32(__builtin_clzll(size));
+		firstLevel = log2 - SECOND_LEVEL_LOG2 + 1;
+		secondLevel = U32(size >> (log2 - SECOND_LEVEL_LOG2)) - SECOND_LEVEL_COUNT;
+	}
+
+	ANKI_ASSERT(firstLevel < FIRST_LEVEL_COUNT && secondLevel < SECOND_LEVEL_COUNT);
+}
+
+template<typename TLock>
+Bool TlsfAllocatorBuilder<TLock>::findFreeBlock(PtrSize size, U32& firstLevel, U32& secondLevel) const
+{
+	// Round the size up to the next list so any block of that list will be big enough
+	if(size >= SECOND_LEVEL_COUNT)
+	{
+		const U32 log2 = 63u - U32(__builtin_clzll(size));
+		size += (PtrSize(1) << (log2 - SECOND_LEVEL_LOG2)) - 1;
+	}
+
+	U32 fl, sl;
+	mapping(size, fl, sl);
+
+	// Search in the same 1st level list
+	U32 slBitmap = m_secondLevelBitmaps[fl] & (MAX_U32 << sl);
+	if(slBitmap == 0)
+	{
+		// Search in the next 1st level lists
+		const U64 flBitmap = (fl + 1 < 64) ? (m_firstLevelBitmap & (MAX_U64 << (fl + 1))) : 0;
+		if(flBitmap == 0)
+		{
+			return false;
+		}
+
+		fl = U32(__builtin_ctzll(flBitmap));
+		slBitmap = m_secondLevelBitmaps[fl];
+		ANKI_ASSERT(slBitmap);
+	}
+
+	firstLevel = fl;
+	secondLevel = U32(__builtin_ctzll(U64(slBitmap)));
+	ANKI_ASSERT(m_freeListHeads[firstLevel][secondLevel] != MAX_U32);
+	return true;
+}
+
+template<typename TLock>
+U32 TlsfAllocatorBuilder<TLock>::newBlock(PtrSize address, PtrSize size)
+{
+	U32 idx;
+	if(m_unusedBlockSlotsHead != MAX_U32)
+	{
+		idx = m_unusedBlockSlotsHead;
+		m_unusedBlockSlotsHead = m_blocks[idx].m_nextFree;
+	}
+	else
+	{
+		idx = m_blocks.getSize();
+		m_blocks.emplaceBack(m_alloc);
+	}
+
+	Block& block = m_blocks[idx];
+	block.m_address = address;
+	block.m_size = size;
+	block.m_prevPhysical = MAX_U32;
+	block.m_nextPhysical = MAX_U32;
+	block.m_prevFree = MAX_U32;
+	block.m_nextFree = MAX_U32;
+	block.m_free = false;
+	return idx;
+}
+
+template<typename TLock>
+void TlsfAllocatorBuilder<TLock>::deleteBlock(U32 idx)
+{
+	m_blocks[idx].m_nextFree = m_unusedBlockSlotsHead;
+	m_unusedBlockSlotsHead = idx;
+}
+
+template<typename TLock>
+void TlsfAllocatorBuilder<TLock>::insertFreeBlock(U32 idx)
+{
+	Block& block = m_blocks[idx];
+	ANKI_ASSERT(!block.m_free);
+
+	U32 fl, sl;
+	mapping(block.m_size, fl, sl);
+
+	block.m_free = true;
+	block.m_prevFree = MAX_U32;
+	block.m_nextFree = m_freeListHeads[fl][sl];
+	if(block.m_nextFree != MAX_U32)
+	{
+		m_blocks[block.m_nextFree].m_prevFree = idx;
+	}
+
+	m_freeListHeads[fl][sl] = idx;
+	m_firstLevelBitmap |= U64(1) << fl;
+	m_secondLevelBitmaps[fl] |= 1u << sl;
+}
+
+template<typename TLock>
+void TlsfAllocatorBuilder<TLock>::removeFreeBlock(U32 idx)
+{
+	Block& block = m_blocks[idx];
+	ANKI_ASSERT(block.m_free);
+
+	if(block.m_prevFree != MAX_U32)
+	{
+		m_blocks[block.m_prevFree].m_nextFree = block.m_nextFree;
+	}
+
+	if(block.m_nextFree != MAX_U32)
+	{
+		m_blocks[block.m_nextFree].m_prevFree = block.m_prevFree;
+	}
+
+	U32 fl, sl;
+	mapping(block.m_size, fl, sl);
+	if(m_freeListHeads[fl][sl] == idx)
+	{
+		m_freeListHeads[fl][sl] = block.m_nextFree;
+		if(block.m_nextFree == MAX_U32)
+		{
+			// List is empty now
+			m_secondLevelBitmaps[fl] &= ~(1u << sl);
+			if(m_secondLevelBitmaps[fl] == 0)
+			{
+				m_firstLevelBitmap &= ~(U64(1) << fl);
+			}
+		}
+	}
+
+	block.m_free = false;
+	block.m_prevFree = MAX_U32;
+	block.m_nextFree = MAX_U32;
+}
+
+template<typename TLock>
+U32 TlsfAllocatorBuilder<TLock>::splitBlock(U32 idx, PtrSize firstPartSize)
+{
+	ANKI_ASSERT(firstPartSize > 0 && firstPartSize < m_blocks[idx].m_size);
+
+	const U32 newIdx = newBlock(m_blocks[idx].m_address + firstPartSize, m_blocks[idx].m_size - firstPartSize);
+
+	// Don't hold references to m_blocks before newBlock() because it may grow the array
+	Block& block = m_blocks[idx];
+	Block& newb = m_blocks[newIdx];
+
+	block.m_size = firstPartSize;
+
+	newb.m_prevPhysical = idx;
+	newb.m_nextPhysical = block.m_nextPhysical;
+	if(block.m_nextPhysical != MAX_U32)
+	{
+		m_blocks[block.m_nextPhysical].m_prevPhysical = newIdx;
+	}
+	block.m_nextPhysical = newIdx;
+
+	return newIdx;
+}
+
+template<typename TLock>
+void TlsfAllocatorBuilder<TLock>::mergeBlocks(U32 idx, U32 nextIdx)
+{
+	Block& block = m_blocks[idx];
+	Block& next = m_blocks[nextIdx];
+	ANKI_ASSERT(block.m_nextPhysical == nextIdx && next.m_prevPhysical == idx);
+	ANKI_ASSERT(block.m_address + block.m_size == next.m_address);
+
+	block.m_size += next.m_size;
+	block.m_nextPhysical = next.m_nextPhysical;
+	if(next.m_nextPhysical != MAX_U32)
+	{
+		m_blocks[next.m_nextPhysical].m_prevPhysical = idx;
+	}
+
+	deleteBlock(nextIdx);
+}
+
+template<typename TLock>
+Bool TlsfAllocatorBuilder<TLock>::allocate(PtrSize size, PtrSize alignment, PtrSize& outAddress)
+{
+	ANKI_ASSERT(size > 0 && size <= m_size);
+	ANKI_ASSERT(alignment > 0);
+
+	// Ask for more space to accommodate the alignment
+	const PtrSize searchSize = (alignment > 1) ? size + alignment - 1 : size;
+
+	LockGuard<TLock> lock(m_mutex);
+
+	U32 idx = MAX_U32;
+	U32 fl, sl;
+	if(findFreeBlock(searchSize, fl, sl))
+	{
+		idx = m_freeListHeads[fl][sl];
+	}
+	else
+	{
+		// The good fit failed. The list that holds blocks of that size might still have a block that is big enough
+		mapping(searchSize, fl, sl);
+		U32 it = m_freeListHeads[fl][sl];
+		while(it != MAX_U32)
+		{
+			if(m_blocks[it].m_size >= searchSize)
+			{
+				idx = it;
+				break;
+			}
+
+			it = m_blocks[it].m_nextFree;
+		}
+
+		if(idx == MAX_U32)
+		{
+			// Out of memory
+			return false;
+		}
+	}
+
+	removeFreeBlock(idx);
+	ANKI_ASSERT(m_blocks[idx].m_size >= searchSize);
+
+	// Give back the front padding
+	PtrSize address = m_blocks[idx].m_address;
+	alignRoundUp(alignment, address);
+	const PtrSize padding = address - m_blocks[idx].m_address;
+	if(padding > 0)
+	{
+		const U32 alignedIdx = splitBlock(idx, padding);
+		insertFreeBlock(idx);
+		idx = alignedIdx;
+	}
+
+	// Give back the remainder
+	if(m_blocks[idx].m_size - size >= MIN_BLOCK_SIZE)
+	{
+		const U32 remainderIdx = splitBlock(idx, size);
+		insertFreeBlock(remainderIdx);
+	}
+
+	ANKI_ASSERT(m_blocks[idx].m_address == address && m_blocks[idx].m_size >= size);
+	ANKI_ASSERT(address + size <= m_size);
+	m_usedBlocks.emplace(m_alloc, address, idx);
+
+	m_userAllocatedSize += size;
+	m_realAllocatedSize += m_blocks[idx].m_size;
+	outAddress = address;
+	return true;
+}
+
+template<typename TLock>
+void TlsfAllocatorBuilder<TLock>::free(PtrSize address, PtrSize size, PtrSize alignment)
+{
+	(void)alignment;
+	LockGuard<TLock> lock(m_mutex);
+
+	auto it = m_usedBlocks.find(address);
+	ANKI_ASSERT(it != m_usedBlocks.getEnd() && "Freeing something that wasn't allocated");
+	U32 idx = *it;
+	m_usedBlocks.erase(m_alloc, it);
+
+	ANKI_ASSERT(!m_blocks[idx].m_free && m_blocks[idx].m_address == address && m_blocks[idx].m_size >= size);
+
+	ANKI_ASSERT(m_userAllocatedSize >= size);
+	m_userAllocatedSize -= size;
+	ANKI_ASSERT(m_realAllocatedSize >= m_blocks[idx].m_size);
+	m_realAllocatedSize -= m_blocks[idx].m_size;
+
+	// Merge with the neighbours
+	const U32 prevIdx = m_blocks[idx].m_prevPhysical;
+	if(prevIdx != MAX_U32 && m_blocks[prevIdx].m_free)
+	{
+		removeFreeBlock(prevIdx);
+		mergeBlocks(prevIdx, idx);
+		idx = prevIdx;
+	}
+
+	const U32 nextIdx = m_blocks[idx].m_nextPhysical;
+	if(nextIdx != MAX_U32 && m_blocks[nextIdx].m_free)
+	{
+		removeFreeBlock(nextIdx);
+		mergeBlocks(idx, nextIdx);
+	}
+
+	insertFreeBlock(idx);
+
+	// Some checks
+	if(m_userAllocatedSize == 0)
+	{
+		ANKI_ASSERT(m_realAllocatedSize == 0);
+		ANKI_ASSERT(m_blocks[idx].m_address == 0 && m_blocks[idx].m_size == m_size);
+	}
+}
+
+template<typename TLock>
+void TlsfAllocatorBuilder<TLock>::getStats(TlsfAllocatorBuilderStats& stats) const
+{
+	LockGuard<TLock> lock(m_mutex);
+
+	stats.m_userAllocatedSize = m_userAllocatedSize;
+	stats.m_realAllocatedSize = m_realAllocatedSize;
+
+	// The biggest block lives in the last non-empty list
+	stats.m_largestFreeBlockSize = 0;
+	if(m_firstLevelBitmap)
+	{
+		const U32 fl = 63u - U32(__builtin_clzll(m_firstLevelBitmap));
+		const U32 sl = 63u - U32(__builtin_clzll(U64(m_secondLevelBitmaps[fl])));
+		U32 idx = m_freeListHeads[fl][sl];
+		while(idx != MAX_U32)
+		{
+			stats.m_largestFreeBlockSize = max(stats.m_largestFreeBlockSize, m_blocks[idx].m_size);
+			idx = m_blocks[idx].m_nextFree;
+		}
+	}
+
+	stats.m_freeBlockCount = 0;
+	for(U32 fl = 0; fl < FIRST_LEVEL_COUNT; ++fl)
+	{
+		for(U32 sl = 0; sl < SECOND_LEVEL_COUNT; ++sl)
+		{
+			U32 idx = m_freeListHeads[fl][sl];
+			while(idx != MAX_U32)
+			{
+				++stats.m_freeBlockCount;
+				idx = m_blocks[idx].m_nextFree;
+			}
+		}
+	}
+
+	// Compute external fragmetation (wikipedia has the definition)
+	const PtrSize realFreeMemory = m_size - m_realAllocatedSize;
+	stats.m_externalFragmentation =
+		(realFreeMemory) ? F32(1.0 - F64(stats.m_largestFreeBlockSize) / F64(realFreeMemory)) : 0.0f;
+
+	// Internal fragmentation
+	stats.m_internalFragmentation =
+		(m_realAllocatedSize) ? F32(1.0 - F64(m_userAllocatedSize) / F64(m_realAllocatedSize)) : 0.0f;
+}
+
+} // end namespace anki
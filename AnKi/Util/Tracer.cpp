@@ -5,18 +5,30 @@
 
 #include <AnKi/Util/Tracer.h>
 #include <AnKi/Util/HighRezTimer.h>
-#include <AnKi/Util/HashMap.h>
-#include <AnKi/Util/List.h>
 
 namespace anki {
 
-class Tracer::Chunk : public IntrusiveListEnabled<Chunk>
+/// A chunk has a single writer, the thread that owns it. The writer fills the slots and then publishes them by
+/// incrementing the counts. The flush only reads the published slots so it never waits for the writer. When the chunk
+/// is full the writer links a new one and never touches the old one again. Then the flush can free the old one.
+class Tracer::Chunk
 {
 public:
 	Array<TracerEvent, EVENTS_PER_CHUNK> m_events;
-	U32 m_eventCount = 0;
 	Array<TracerCounter, COUNTERS_PER_CHUNK> m_counters;
-	U32 m_counterCount = 0;
+
+	/// @name Written by the owning thread
+	/// @{
+	Atomic<U32> m_eventCount = {0};
+	Atomic<U32> m_counterCount = {0};
+	Atomic<Chunk*> m_next = {nullptr};
+	/// @}
+
+	/// @name Owned by the flush
+	/// @{
+	U32 m_flushedEventCount = 0;
+	U32 m_flushedCounterCount = 0;
+	/// @}
 };
 
 /// Thread local storage.
@@ -25,31 +37,67 @@ class alignas(ANKI_CACHE_LINE_SIZE) Tracer::ThreadLocal
 public:
 	ThreadId m_tid = 0;
 
-	Chunk* m_currentChunk = nullptr;
-	IntrusiveList<Chunk> m_allChunks;
-	SpinLock m_currentChunkLock;
+	Chunk* m_currentChunk = nullptr; ///< The chunk that is written. Only the owning thread touches it.
+	Chunk* m_firstChunk = nullptr; ///< The oldest chunk. Only the flush touches it.
+	Atomic<U32> m_chunkCount = {0};
+
+	CpuHwCounters m_hwCounters;
+	Bool m_hwCountersInitialized = false; ///< True if there was an attempt to initialize m_hwCounters.
 };
 
 thread_local Tracer::ThreadLocal* Tracer::m_threadLocal = nullptr;
+thread_local U64 Tracer::m_threadLocalTracerUuid = 0;
+
+static Atomic<U64> g_tracerUuid = {1};
+static Atomic<U32> g_hwCountersWarningPrinted = {0};
+
+Tracer::Tracer(GenericMemoryPoolAllocator<U8> alloc)
+	: m_alloc(alloc)
+	, m_uuid(g_tracerUuid.fetchAdd(1))
+{
+}
 
 Tracer::~Tracer()
 {
 	LockGuard<Mutex> lock(m_allThreadLocalMtx);
 	for(ThreadLocal* tlocal : m_allThreadLocal)
 	{
+		Chunk* chunk = tlocal->m_firstChunk;
+		while(chunk)
+		{
+			Chunk* next = chunk->m_next.load();
+			m_alloc.deleteInstance(chunk);
+			chunk = next;
+		}
+
 		m_alloc.deleteInstance(tlocal);
 	}
 	m_allThreadLocal.destroy(m_alloc);
+
+	m_hwEventCounterNames.iterate([&](PtrSize, HwEventCounterNames& names) {
+		for(String& name : names.m_names)
+		{
+			name.destroy(m_alloc);
+		}
+	});
+	m_hwEventCounterNames.destroy(m_alloc);
 }
 
 Tracer::ThreadLocal& Tracer::getThreadLocal()
 {
 	ThreadLocal* out = m_threadLocal;
-	if(ANKI_UNLIKELY(out == nullptr))
+	if(ANKI_UNLIKELY(out == nullptr || m_threadLocalTracerUuid != m_uuid))
 	{
 		out = m_alloc.newInstance<ThreadLocal>();
 		out->m_tid = Thread::getCurrentThreadId();
+
+		// Start with a chunk so the flush and the writer never race on the head of the list
+		out->m_currentChunk = m_alloc.newInstance<Chunk>();
+		out->m_firstChunk = out->m_currentChunk;
+		out->m_chunkCount.setNonAtomically(1);
+
 		m_threadLocal = out;
+		m_threadLocalTracerUuid = m_uuid;
 
 		// Store it
 		LockGuard<Mutex> lock(m_allThreadLocalMtx);
@@ -59,25 +107,22 @@ Tracer::ThreadLocal& Tracer::getThreadLocal()
 	return *out;
 }
 
-Tracer::Chunk& Tracer::getOrCreateChunk(ThreadLocal& tlocal)
+Tracer::Chunk& Tracer::newChunk(ThreadLocal& tlocal)
 {
-	Chunk* out;
+	Chunk* chunk = m_alloc.newInstance<Chunk>();
+	tlocal.m_chunkCount.fetchAdd(1);
 
-	if(tlocal.m_currentChunk && tlocal.m_currentChunk->m_eventCount < EVENTS_PER_CHUNK
-	   && tlocal.m_currentChunk->m_counterCount < COUNTERS_PER_CHUNK)
-	{
-		// There is a chunk and it has enough space
-		out = tlocal.m_currentChunk;
-	}
-	else
-	{
-		// Create a new
-		out = m_alloc.newInstance<Chunk>();
-		tlocal.m_currentChunk = out;
-		tlocal.m_allChunks.pushBack(out);
-	}
+	// This is the last time the writer touches the old chunk
+	tlocal.m_currentChunk->m_next.store(chunk, AtomicMemoryOrder::RELEASE);
+	tlocal.m_currentChunk = chunk;
+	return *chunk;
+}
 
-	return *out;
+Tracer::Chunk& Tracer::getChunkForEvent(ThreadLocal& tlocal)
+{
+	Chunk& chunk = *tlocal.m_currentChunk;
+	return (ANKI_LIKELY(chunk.m_eventCount.load(AtomicMemoryOrder::RELAXED) < EVENTS_PER_CHUNK)) ? chunk
+																								: newChunk(tlocal);
 }
 
 TracerEventHandle Tracer::beginEvent()
@@ -103,28 +148,89 @@ void Tracer::endEvent(const char* eventName, TracerEventHandle event)
 		return;
 	}
 
-	// Get the time before the lock and everything
 	const Second duration = HighRezTimer::getCurrentTime() - event.m_start;
 	if(duration == 0.0)
 	{
 		return;
 	}
 
+	addCustomEvent(eventName, event.m_start, duration);
+}
+
+TracerHwEventHandle Tracer::beginHwEvent()
+{
+	TracerHwEventHandle out;
+	out.m_hwCountersValid = false;
+
+	if(m_enabled && m_hwCountersEnabled)
+	{
+		ThreadLocal& tlocal = getThreadLocal();
+		if(ANKI_UNLIKELY(!tlocal.m_hwCountersInitialized))
+		{
+			tlocal.m_hwCountersInitialized = true;
+			if(tlocal.m_hwCounters.init() && g_hwCountersWarningPrinted.exchange(1) == 0)
+			{
+				ANKI_UTIL_LOGW("CPU HW counters are not available. Check the perf_event_paranoid");
+			}
+		}
+
+		if(tlocal.m_hwCounters.isInitialized())
+		{
+			tlocal.m_hwCounters.read(out.m_hwCounters);
+			out.m_hwCountersValid = true;
+		}
+	}
+
+	// Start the timer after the read
+	out.m_event = beginEvent();
+	return out;
+}
+
+void Tracer::endHwEvent(const char* eventName, const TracerHwEventHandle& event)
+{
+	endEvent(eventName, event.m_event);
+
+	if(!event.m_hwCountersValid || !m_enabled)
+	{
+		return;
+	}
+
 	ThreadLocal& tlocal = getThreadLocal();
+	CpuHwCounterValues values;
+	tlocal.m_hwCounters.read(values);
 
-	// Write the event
-	LockGuard<SpinLock> lock(tlocal.m_currentChunkLock);
-	Chunk& chunk = getOrCreateChunk(tlocal);
+	const HwEventCounterNames& names = getHwEventCounterNames(eventName);
+	for(CpuHwCounter counter = CpuHwCounter::FIRST; counter < CpuHwCounter::COUNT; ++counter)
+	{
+		if(tlocal.m_hwCounters.isCounterSupported(counter))
+		{
+			incrementCounter(names.m_names[counter].cstr(), values[counter] - event.m_hwCounters[counter]);
+		}
+	}
+}
 
-	TracerEvent& writeEvent = chunk.m_events[chunk.m_eventCount++];
-	writeEvent.m_name = eventName;
-	writeEvent.m_start = event.m_start;
-	writeEvent.m_duration = duration;
+const Tracer::HwEventCounterNames& Tracer::getHwEventCounterNames(const char* eventName)
+{
+	const PtrSize key = ptrToNumber(eventName);
+	const HwEventCounterNames* names = m_hwEventCounterNames.find(key);
+	if(ANKI_LIKELY(names))
+	{
+		return *names;
+	}
+
+	LockGuard<Mutex> lock(m_hwEventCounterNamesMtx);
+	HwEventCounterNames* newNames = m_hwEventCounterNames.find(key);
+	if(newNames == nullptr)
+	{
+		newNames = m_hwEventCounterNames.emplace(m_alloc, key);
+		for(CpuHwCounter counter = CpuHwCounter::FIRST; counter < CpuHwCounter::COUNT; ++counter)
+		{
+			newNames->m_names[counter].sprintf(m_alloc, "%s.%s", eventName,
+											   CpuHwCounters::getCounterName(counter).cstr());
+		}
+	}
 
-	// Write counter as well. In ns
-	TracerCounter& writeCounter = chunk.m_counters[chunk.m_counterCount++];
-	writeCounter.m_name = eventName;
-	writeCounter.m_value = U64(writeEvent.m_duration * 1000000000.0);
+	return *newNames;
 }
 
 void Tracer::addCustomEvent(const char* eventName, Second start, Second duration)
@@ -136,20 +242,15 @@ void Tracer::addCustomEvent(const char* eventName, Second start, Second duration
 	}
 
 	ThreadLocal& tlocal = getThreadLocal();
+	Chunk& chunk = getChunkForEvent(tlocal);
 
-	// Write the event
-	LockGuard<SpinLock> lock(tlocal.m_currentChunkLock);
-	Chunk& chunk = getOrCreateChunk(tlocal);
-
-	TracerEvent& writeEvent = chunk.m_events[chunk.m_eventCount++];
+	// Write the event and then publish it
+	const U32 idx = chunk.m_eventCount.load(AtomicMemoryOrder::RELAXED);
+	TracerEvent& writeEvent = chunk.m_events[idx];
 	writeEvent.m_name = eventName;
 	writeEvent.m_start = start;
 	writeEvent.m_duration = duration;
-
-	// Write counter as well. In ns
-	TracerCounter& writeCounter = chunk.m_counters[chunk.m_counterCount++];
-	writeCounter.m_name = eventName;
-	writeCounter.m_value = U64(duration * 1000000000.0);
+	chunk.m_eventCount.store(idx + 1, AtomicMemoryOrder::RELEASE);
 }
 
 void Tracer::incrementCounter(const char* counterName, U64 value)
@@ -160,13 +261,18 @@ void Tracer::incrementCounter(const char* counterName, U64 value)
 	}
 
 	ThreadLocal& tlocal = getThreadLocal();
+	Chunk* chunk = tlocal.m_currentChunk;
+	if(ANKI_UNLIKELY(chunk->m_counterCount.load(AtomicMemoryOrder::RELAXED) >= COUNTERS_PER_CHUNK))
+	{
+		chunk = &newChunk(tlocal);
+	}
 
-	LockGuard<SpinLock> lock(tlocal.m_currentChunkLock);
-	Chunk& chunk = getOrCreateChunk(tlocal);
-
-	TracerCounter& writeTo = chunk.m_counters[chunk.m_counterCount++];
+	// Write the counter and then publish it
+	const U32 idx = chunk->m_counterCount.load(AtomicMemoryOrder::RELAXED);
+	TracerCounter& writeTo = chunk->m_counters[idx];
 	writeTo.m_name = counterName;
 	writeTo.m_value = value;
+	chunk->m_counterCount.store(idx + 1, AtomicMemoryOrder::RELEASE);
 }
 
 void Tracer::flush(TracerFlushCallback callback, void* callbackUserData)
@@ -176,19 +282,66 @@ void Tracer::flush(TracerFlushCallback callback, void* callbackUserData)
 	LockGuard<Mutex> lock(m_allThreadLocalMtx);
 	for(ThreadLocal* tlocal : m_allThreadLocal)
 	{
-		LockGuard<SpinLock> lock2(tlocal->m_currentChunkLock);
-
-		while(!tlocal->m_allChunks.isEmpty())
+		Chunk* chunk = tlocal->m_firstChunk;
+		while(true)
 		{
-			Chunk* chunk = tlocal->m_allChunks.popFront();
+			// Load the next first. If it's set the writer is done with this chunk and the counts are final
+			Chunk* next = chunk->m_next.load(AtomicMemoryOrder::ACQUIRE);
+			const U32 eventCount = chunk->m_eventCount.load(AtomicMemoryOrder::ACQUIRE);
+			const U32 counterCount = chunk->m_counterCount.load(AtomicMemoryOrder::ACQUIRE);
+
+			if(eventCount > chunk->m_flushedEventCount || counterCount > chunk->m_flushedCounterCount)
+			{
+				callback(callbackUserData, tlocal->m_tid,
+						 WeakArray<TracerEvent>(chunk->m_events.getBegin() + chunk->m_flushedEventCount,
+												eventCount - chunk->m_flushedEventCount),
+						 WeakArray<TracerCounter>(chunk->m_counters.getBegin() + chunk->m_flushedCounterCount,
+												  counterCount - chunk->m_flushedCounterCount));
+
+				chunk->m_flushedEventCount = eventCount;
+				chunk->m_flushedCounterCount = counterCount;
+			}
+
+			if(next == nullptr)
+			{
+				// The writer is still using it, keep it
+				break;
+			}
+
+			m_alloc.deleteInstance(chunk);
+			tlocal->m_chunkCount.fetchSub(1);
+			chunk = next;
+		}
+
+		tlocal->m_firstChunk = chunk;
+	}
+}
+
+void Tracer::discardOldChunks()
+{
+	if(m_maxChunksPerThread == 0)
+	{
+		return;
+	}
 
-			callback(callbackUserData, tlocal->m_tid, WeakArray<TracerEvent>(&chunk->m_events[0], chunk->m_eventCount),
-					 WeakArray<TracerCounter>(&chunk->m_counters[0], chunk->m_counterCount));
+	LockGuard<Mutex> lock(m_allThreadLocalMtx);
+	for(ThreadLocal* tlocal : m_allThreadLocal)
+	{
+		Chunk* chunk = tlocal->m_firstChunk;
+		while(tlocal->m_chunkCount.load(AtomicMemoryOrder::RELAXED) > m_maxChunksPerThread)
+		{
+			Chunk* next = chunk->m_next.load(AtomicMemoryOrder::ACQUIRE);
+			if(next == nullptr)
+			{
+				break;
+			}
 
 			m_alloc.deleteInstance(chunk);
+			tlocal->m_chunkCount.fetchSub(1);
+			chunk = next;
 		}
 
-		tlocal->m_currentChunk = nullptr;
+		tlocal->m_firstChunk = chunk;
 	}
 }
 
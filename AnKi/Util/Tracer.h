@@ -10,6 +10,8 @@
 #include <AnKi/Util/DynamicArray.h>
 #include <AnKi/Util/Singleton.h>
 #include <AnKi/Util/String.h>
+#include <AnKi/Util/CpuHwCounters.h>
+#include <AnKi/Util/ConcurrentHashMap.h>
 
 namespace anki {
 
@@ -25,6 +27,17 @@ private:
 	Second m_start;
 };
 
+/// @memberof Tracer
+class TracerHwEventHandle
+{
+	friend class Tracer;
+
+private:
+	TracerEventHandle m_event;
+	CpuHwCounterValues m_hwCounters;
+	Bool m_hwCountersValid;
+};
+
 /// @memberof Tracer
 class TracerEvent
 {
@@ -61,10 +74,7 @@ using TracerFlushCallback = void (*)(void* userData, ThreadId tid, ConstWeakArra
 class Tracer
 {
 public:
-	Tracer(GenericMemoryPoolAllocator<U8> alloc)
-		: m_alloc(alloc)
-	{
-	}
+	Tracer(GenericMemoryPoolAllocator<U8> alloc);
 
 	Tracer(const Tracer&) = delete; // Non-copyable
 
@@ -80,6 +90,15 @@ public:
 	/// @note It's thread-safe.
 	void endEvent(const char* eventName, TracerEventHandle event);
 
+	/// Begin a new event that will sample the CPU HW counters as well.
+	/// @note It's thread-safe.
+	ANKI_USE_RESULT TracerHwEventHandle beginHwEvent();
+
+	/// End the event that got started with beginHwEvent(). It will add one counter per CPU HW counter with the delta
+	/// since the beginning of the event. The counters are named as "<eventName>.<hwCounterName>".
+	/// @note It's thread-safe.
+	void endHwEvent(const char* eventName, const TracerHwEventHandle& event);
+
 	/// Add a custom event.
 	/// @note It's thread-safe.
 	void addCustomEvent(const char* eventName, Second start, Second duration);
@@ -102,6 +121,37 @@ public:
 		m_enabled = enabled;
 	}
 
+	Bool getHwCountersEnabled() const
+	{
+		return m_hwCountersEnabled;
+	}
+
+	/// Enable the sampling of the CPU HW counters for the events that begin with beginHwEvent(). If the counters are
+	/// not available the HW events will behave like plain events.
+	void setHwCountersEnabled(Bool enabled)
+	{
+		m_hwCountersEnabled = enabled;
+	}
+
+	/// Limit the memory per thread. If the limit is reached discardOldChunks() will drop the oldest events and
+	/// counters. That turns the tracer into a flight recorder that always holds the most recent events.
+	/// @param count The max number of chunks per thread. 0 means no limit.
+	/// @note Set it before the tracer is used.
+	void setMaxChunksPerThread(U32 count)
+	{
+		m_maxChunksPerThread = count;
+	}
+
+	U32 getMaxChunksPerThread() const
+	{
+		return m_maxChunksPerThread;
+	}
+
+	/// Free the oldest chunks of the threads that exceed the setMaxChunksPerThread() limit. Call it periodically when
+	/// not flushing.
+	/// @note It's thread-safe.
+	void discardOldChunks();
+
 private:
 	static constexpr U32 EVENTS_PER_CHUNK = 256;
 	static constexpr U32 COUNTERS_PER_CHUNK = 512;
@@ -109,25 +159,67 @@ private:
 	class ThreadLocal;
 	class Chunk;
 
+	/// The counter names of a HW event.
+	class HwEventCounterNames
+	{
+	public:
+		Array<String, U32(CpuHwCounter::COUNT)> m_names;
+	};
+
 	GenericMemoryPoolAllocator<U8> m_alloc;
 
 	static thread_local ThreadLocal* m_threadLocal;
+	static thread_local U64 m_threadLocalTracerUuid; ///< The tracer that m_threadLocal belongs to.
+	U64 m_uuid; ///< Tracers may be re-created so m_threadLocal needs to know if it's stale.
 	DynamicArray<ThreadLocal*> m_allThreadLocal; ///< The Tracer should know about all the ThreadLocal.
 	Mutex m_allThreadLocalMtx;
 
 	Bool m_enabled = false;
+	Bool m_hwCountersEnabled = false;
+	U32 m_maxChunksPerThread = 0;
+
+	/// The event name pointer to the counter names. Counters need names that outlive them.
+	ConcurrentHashMap<PtrSize, HwEventCounterNames> m_hwEventCounterNames;
+	Mutex m_hwEventCounterNamesMtx;
 
 	/// Get the thread local ThreadLocal structure.
 	/// @note Thread-safe.
 	ThreadLocal& getThreadLocal();
 
-	/// Get or create a new chunk.
-	Chunk& getOrCreateChunk(ThreadLocal& tlocal);
+	/// Append a new chunk to the thread's list. Called by the thread that owns the ThreadLocal.
+	Chunk& newChunk(ThreadLocal& tlocal);
+
+	/// Get a chunk that has space for one more event.
+	Chunk& getChunkForEvent(ThreadLocal& tlocal);
+
+	const HwEventCounterNames& getHwEventCounterNames(const char* eventName);
 };
 
 /// The global tracer.
 using TracerSingleton = SingletonInit<Tracer>;
 
+/// Scoped tracer event that samples the CPU HW counters.
+class TracerScopedHwEvent
+{
+public:
+	TracerScopedHwEvent(const char* name)
+		: m_name(name)
+		, m_tracer(&TracerSingleton::get())
+	{
+		m_handle = m_tracer->beginHwEvent();
+	}
+
+	~TracerScopedHwEvent()
+	{
+		m_tracer->endHwEvent(m_name, m_handle);
+	}
+
+private:
+	const char* m_name;
+	TracerHwEventHandle m_handle;
+	Tracer* m_tracer;
+};
+
 /// Scoped tracer event.
 class TracerScopedEvent
 {
@@ -152,11 +244,13 @@ private:
 
 #if ANKI_ENABLE_TRACE
 #	define ANKI_TRACE_SCOPED_EVENT(name_) TracerScopedEvent _tse##name_(#    name_)
+#	define ANKI_TRACE_SCOPED_HW_EVENT(name_) TracerScopedHwEvent _tse##name_(#    name_)
 #	define ANKI_TRACE_CUSTOM_EVENT(name_, start_, duration_) \
 		TracerSingleton::get().addCustomEvent(#name_, start_, duration_)
 #	define ANKI_TRACE_INC_COUNTER(name_, val_) TracerSingleton::get().incrementCounter(#    name_, val_)
 #else
 #	define ANKI_TRACE_SCOPED_EVENT(name_) ((void)0)
+#	define ANKI_TRACE_SCOPED_HW_EVENT(name_) ((void)0)
 #	define ANKI_TRACE_CUSTOM_EVENT(name_, start_, duration_) ((void)0)
 #	define ANKI_TRACE_INC_COUNTER(name_, val_) ((void)0)
 #endif
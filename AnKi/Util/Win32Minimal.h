@@ -42,6 +42,7 @@ typedef DWORD* LPDWORD;
 typedef void* HANDLE;
 typedef void* PVOID;
 typedef void* LPVOID;
+typedef const void* LPCVOID;
 typedef const CHAR *LPCSTR, *PCSTR;
 typedef const CHAR* PCZZSTR;
 typedef CHAR* LPSTR;
@@ -101,6 +102,17 @@ ANKI_WINBASEAPI HANDLE ANKI_WINAPI FindFirstFileA(LPCSTR lpFileName, LPWIN32_FIN
 ANKI_WINBASEAPI BOOL ANKI_WINAPI FindClose(HANDLE hFindFile);
 ANKI_WINBASEAPI BOOL ANKI_WINAPI FindNextFileA(HANDLE hFindFile, LPWIN32_FIND_DATAA lpFindFileData);
 ANKI_WINBASEAPI DWORD ANKI_WINAPI GetTempPathA(DWORD nBufferLength, LPSTR lpBuffer);
+ANKI_WINBASEAPI HANDLE ANKI_WINAPI CreateFileA(LPCSTR lpFileName, DWORD dwDesiredAccess, DWORD dwShareMode,
+											   LPSECURITY_ATTRIBUTES lpSecurityAttributes, DWORD dwCreationDisposition,
+											   DWORD dwFlagsAndAttributes, HANDLE hTemplateFile);
+ANKI_WINBASEAPI BOOL ANKI_WINAPI GetFileSizeEx(HANDLE hFile, LARGE_INTEGER* lpFileSize);
+ANKI_WINBASEAPI HANDLE ANKI_WINAPI CreateFileMappingA(HANDLE hFile, LPSECURITY_ATTRIBUTES lpFileMappingAttributes,
+													  DWORD flProtect, DWORD dwMaximumSizeHigh, DWORD dwMaximumSizeLow,
+													  LPCSTR lpName);
+ANKI_WINBASEAPI LPVOID ANKI_WINAPI MapViewOfFile(HANDLE hFileMappingObject, DWORD dwDesiredAccess,
+												 DWORD dwFileOffsetHigh, DWORD dwFileOffsetLow,
+												 SIZE_T dwNumberOfBytesToMap);
+ANKI_WINBASEAPI BOOL ANKI_WINAPI UnmapViewOfFile(LPCVOID lpBaseAddress);
 
 // Other
 ANKI_WINBASEAPI DWORD ANKI_WINAPI GetLastError(VOID);
@@ -136,6 +148,12 @@ constexpr WORD CSIDL_PROFILE = 0x0028;
 constexpr DWORD STD_OUTPUT_HANDLE = (DWORD)-11;
 constexpr HRESULT S_OK = 0;
 constexpr DWORD INFINITE = 0xFFFFFFFF;
+constexpr DWORD GENERIC_READ = 0x80000000L;
+constexpr DWORD FILE_SHARE_READ = 0x00000001;
+constexpr DWORD OPEN_EXISTING = 3;
+constexpr DWORD FILE_ATTRIBUTE_NORMAL = 0x00000080;
+constexpr DWORD PAGE_WRITECOPY = 0x08;
+constexpr DWORD FILE_MAP_COPY = 0x00000001;
 
 constexpr WORD FOREGROUND_BLUE = 0x0001;
 constexpr WORD FOREGROUND_GREEN = 0x0002;
@@ -414,6 +432,27 @@ inline DWORD GetTempPathA(DWORD nBufferLength, LPSTR lpBuffer)
 	return ::GetTempPathA(nBufferLength, lpBuffer);
 }
 
+inline HANDLE CreateFileA(LPCSTR lpFileName, DWORD dwDesiredAccess, DWORD dwShareMode,
+						  LPSECURITY_ATTRIBUTES lpSecurityAttributes, DWORD dwCreationDisposition,
+						  DWORD dwFlagsAndAttributes, HANDLE hTemplateFile)
+{
+	return ::CreateFileA(lpFileName, dwDesiredAccess, dwShareMode,
+						 reinterpret_cast<::LPSECURITY_ATTRIBUTES>(lpSecurityAttributes), dwCreationDisposition,
+						 dwFlagsAndAttributes, hTemplateFile);
+}
+
+inline BOOL GetFileSizeEx(HANDLE hFile, LARGE_INTEGER* lpFileSize)
+{
+	return ::GetFileSizeEx(hFile, reinterpret_cast<::LARGE_INTEGER*>(lpFileSize));
+}
+
+inline HANDLE CreateFileMappingA(HANDLE hFile, LPSECURITY_ATTRIBUTES lpFileMappingAttributes, DWORD flProtect,
+								 DWORD dwMaximumSizeHigh, DWORD dwMaximumSizeLow, LPCSTR lpName)
+{
+	return ::CreateFileMappingA(hFile, reinterpret_cast<::LPSECURITY_ATTRIBUTES>(lpFileMappingAttributes), flProtect,
+								dwMaximumSizeHigh, dwMaximumSizeLow, lpName);
+}
+
 // Other
 inline BOOL QueryPerformanceFrequency(LARGE_INTEGER* lpFrequency)
 {
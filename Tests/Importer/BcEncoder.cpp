@@ -0,0 +1,326 @@
+// Copyright (C) 2009-2022, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <AnKi/Importer/BcEncoder.h>
+#include <AnKi/Util/F16.h>
+#include <AnKi/Util/HighRezTimer.h>
+
+using namespace anki;
+
+static U32 readBits(const U8* block, U32& pos, U32 bitCount)
+{
+	U32 out = 0;
+	for(U32 i = 0; i < bitCount; ++i, ++pos)
+	{
+		out |= U32((block[pos / 8] >> (pos % 8)) & 1u) << i;
+	}
+	return out;
+}
+
+static void decodeBc1Block(const U8* block, Array<U8Vec4, 16>& out)
+{
+	U16 c0, c1;
+	U32 bits;
+	memcpy(&c0, block, 2);
+	memcpy(&c1, block + 2, 2);
+	memcpy(&bits, block + 4, 4);
+
+	auto expand = [](U16 c) {
+		const U32 r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+		return Vec3(F32((r << 3) | (r >> 2)), F32((g << 2) | (g >> 4)), F32((b << 3) | (b >> 2)));
+	};
+
+	Array<Vec3, 4> palette;
+	palette[0] = expand(c0);
+	palette[1] = expand(c1);
+	if(c0 > c1)
+	{
+		palette[2] = (palette[0] * 2.0f + palette[1]) / 3.0f;
+		palette[3] = (palette[0] + palette[1] * 2.0f) / 3.0f;
+	}
+	else
+	{
+		palette[2] = (palette[0] + palette[1]) / 2.0f;
+		palette[3] = Vec3(0.0f);
+	}
+
+	for(U32 i = 0; i < 16; ++i)
+	{
+		const Vec3 c = palette[(bits >> (i * 2)) & 3];
+		out[i] = U8Vec4(U8(c.x() + 0.5f), U8(c.y() + 0.5f), U8(c.z() + 0.5f), 255);
+	}
+}
+
+static void decodeBc4Block(const U8* block, Array<U8, 16>& out)
+{
+	const F32 a0 = block[0];
+	const F32 a1 = block[1];
+	Array<F32, 8> palette;
+	palette[0] = a0;
+	palette[1] = a1;
+	if(a0 > a1)
+	{
+		for(U32 i = 2; i < 8; ++i)
+		{
+			palette[i] = (F32(8 - i) * a0 + F32(i - 1) * a1) / 7.0f;
+		}
+	}
+	else
+	{
+		for(U32 i = 2; i < 6; ++i)
+		{
+			palette[i] = (F32(6 - i) * a0 + F32(i - 1) * a1) / 5.0f;
+		}
+		palette[6] = 0.0f;
+		palette[7] = 255.0f;
+	}
+
+	U32 pos = 16;
+	for(U32 i = 0; i < 16; ++i)
+	{
+		out[i] = U8(palette[readBits(block, pos, 3)] + 0.5f);
+	}
+}
+
+/// Decodes only mode 11.
+static Bool decodeBc6hBlock(const U8* block, Array<Vec3, 16>& out)
+{
+	U32 pos = 0;
+	if(readBits(block, pos, 5) != 3)
+	{
+		return false;
+	}
+
+	UVec3 e0, e1;
+	for(U32 c = 0; c < 3; ++c)
+	{
+		e0[c] = readBits(block, pos, 10);
+	}
+	for(U32 c = 0; c < 3; ++c)
+	{
+		e1[c] = readBits(block, pos, 10);
+	}
+
+	auto unquantize = [](U32 q) -> U32 {
+		return (q == 0) ? 0 : ((q == 1023) ? 0xFFFF : (((q << 16) + 0x8000) >> 10));
+	};
+	const Array<U32, 16> weights = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+	for(U32 i = 0; i < 16; ++i)
+	{
+		const U32 idx = readBits(block, pos, (i == 0) ? 3 : 4);
+		for(U32 c = 0; c < 3; ++c)
+		{
+			const U32 interp = (unquantize(e0[c]) * (64 - weights[idx]) + unquantize(e1[c]) * weights[idx] + 32) >> 6;
+			out[i][c] = F16(U16((interp * 31) >> 6)).toF32();
+		}
+	}
+
+	return pos == 128;
+}
+
+static void generateImage(U32 width, U32 height, U32 channelCount, DynamicArrayAuto<U8, PtrSize>& pixels)
+{
+	pixels.create(PtrSize(width) * height * channelCount);
+	for(U32 y = 0; y < height; ++y)
+	{
+		for(U32 x = 0; x < width; ++x)
+		{
+			for(U32 c = 0; c < channelCount; ++c)
+			{
+				// Smooth gradients with some noise and some hard edges
+				const U32 gradient = (c == 0) ? x * 255 / width : ((c == 1) ? y * 255 / height : (x + y) * 127 / width);
+				const U32 edge = (((x / 16) + (y / 16)) % 2) ? 40 : 0;
+				const U32 noise = getRandomRange(0u, 8u);
+				pixels[(PtrSize(y) * width + x) * channelCount + c] = U8(min(255u, gradient + edge + noise));
+			}
+		}
+	}
+}
+
+ANKI_TEST(Importer, BcEncoder)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	constexpr U32 WIDTH = 64;
+	constexpr U32 HEIGHT = 32;
+
+	// BC1 and BC3
+	for(U32 channelCount = 3; channelCount <= 4; ++channelCount)
+	{
+		DynamicArrayAuto<U8, PtrSize> pixels(alloc);
+		generateImage(WIDTH, HEIGHT, channelCount, pixels);
+
+		const BcFormat format = (channelCount == 3) ? BcFormat::BC1 : BcFormat::BC3;
+		Array<F64, 3> errors;
+		for(BcEncoderQuality quality : {BcEncoderQuality::FAST, BcEncoderQuality::NORMAL, BcEncoderQuality::HIGH})
+		{
+			const BcEncoder encoder(format, quality, WIDTH, HEIGHT, channelCount);
+			DynamicArrayAuto<U8, PtrSize> compressed(alloc);
+			compressed.create(encoder.getCompressedSize());
+			encoder.encode(ConstWeakArray<U8, PtrSize>(pixels), WeakArray<U8, PtrSize>(compressed));
+
+			// Encoding in batches of rows gives the same result
+			DynamicArrayAuto<U8, PtrSize> compressed2(alloc);
+			compressed2.create(encoder.getCompressedSize());
+			for(U32 row = 0; row < encoder.getBlockRowCount(); row += 3)
+			{
+				encoder.encode(ConstWeakArray<U8, PtrSize>(pixels), row, min(3u, encoder.getBlockRowCount() - row),
+							   WeakArray<U8, PtrSize>(compressed2));
+			}
+			ANKI_TEST_EXPECT_EQ(memcmp(&compressed[0], &compressed2[0], compressed.getSize()), 0);
+
+			// Decode and compute the error
+			F64 squaredError = 0.0;
+			const U32 blockSize = getBcBlockSize(format);
+			for(U32 by = 0; by < HEIGHT / 4; ++by)
+			{
+				for(U32 bx = 0; bx < WIDTH / 4; ++bx)
+				{
+					const U8* block = &compressed[(by * (WIDTH / 4) + bx) * blockSize];
+					Array<U8Vec4, 16> decoded;
+					Array<U8, 16> alpha;
+					if(format == BcFormat::BC3)
+					{
+						decodeBc4Block(block, alpha);
+						decodeBc1Block(block + 8, decoded);
+					}
+					else
+					{
+						decodeBc1Block(block, decoded);
+					}
+
+					for(U32 i = 0; i < 16; ++i)
+					{
+						const U32 x = bx * 4 + i % 4;
+						const U32 y = by * 4 + i / 4;
+						for(U32 c = 0; c < channelCount; ++c)
+						{
+							const F64 original = pixels[(y * WIDTH + x) * channelCount + c];
+							const F64 value = (c < 3) ? decoded[i][c] : alpha[i];
+							squaredError += (original - value) * (original - value);
+						}
+					}
+				}
+			}
+
+			const F64 rmse = sqrt(squaredError / (WIDTH * HEIGHT * channelCount));
+			errors[U32(quality)] = rmse;
+			ANKI_TEST_LOGI("%s quality %u: RMSE %f", (format == BcFormat::BC1) ? "BC1" : "BC3", U32(quality), rmse);
+			ANKI_TEST_EXPECT_LT(rmse, 8.0);
+		}
+
+		ANKI_TEST_EXPECT_LEQ(errors[2], errors[0]);
+	}
+
+	// BC5
+	{
+		DynamicArrayAuto<U8, PtrSize> pixels(alloc);
+		generateImage(WIDTH, HEIGHT, 2, pixels);
+
+		const BcEncoder encoder(BcFormat::BC5, BcEncoderQuality::HIGH, WIDTH, HEIGHT, 2);
+		DynamicArrayAuto<U8, PtrSize> compressed(alloc);
+		compressed.create(encoder.getCompressedSize());
+		encoder.encode(ConstWeakArray<U8, PtrSize>(pixels), WeakArray<U8, PtrSize>(compressed));
+
+		F64 maxError = 0.0;
+		for(U32 by = 0; by < HEIGHT / 4; ++by)
+		{
+			for(U32 bx = 0; bx < WIDTH / 4; ++bx)
+			{
+				for(U32 c = 0; c < 2; ++c)
+				{
+					Array<U8, 16> decoded;
+					decodeBc4Block(&compressed[(by * (WIDTH / 4) + bx) * 16 + c * 8], decoded);
+					for(U32 i = 0; i < 16; ++i)
+					{
+						const U32 x = bx * 4 + i % 4;
+						const U32 y = by * 4 + i / 4;
+						const F64 original = pixels[(y * WIDTH + x) * 2 + c];
+						maxError = max(maxError, absolute(original - F64(decoded[i])));
+					}
+				}
+			}
+		}
+
+		ANKI_TEST_LOGI("BC5 max error %f", maxError);
+		ANKI_TEST_EXPECT_LT(maxError, 12.0);
+	}
+
+	// BC6H
+	{
+		DynamicArrayAuto<F32> pixels(alloc);
+		pixels.create(WIDTH * HEIGHT * 3);
+		for(U32 i = 0; i < WIDTH * HEIGHT; ++i)
+		{
+			const U32 x = i % WIDTH;
+			const U32 y = i / WIDTH;
+			pixels[i * 3 + 0] = 0.5f + F32(x) / F32(WIDTH) * 10.0f;
+			pixels[i * 3 + 1] = 1.0f + F32(y) / F32(HEIGHT);
+			pixels[i * 3 + 2] = (x == y) ? 4.0f : 1.0f;
+		}
+
+		const ConstWeakArray<U8, PtrSize> pixelBytes(reinterpret_cast<const U8*>(&pixels[0]), pixels.getSizeInBytes());
+		for(BcEncoderQuality quality : {BcEncoderQuality::FAST, BcEncoderQuality::HIGH})
+		{
+			const BcEncoder encoder(BcFormat::BC6H, quality, WIDTH, HEIGHT, 3);
+			DynamicArrayAuto<U8, PtrSize> compressed(alloc);
+			compressed.create(encoder.getCompressedSize());
+			encoder.encode(pixelBytes, WeakArray<U8, PtrSize>(compressed));
+
+			F64 relativeError = 0.0;
+			for(U32 by = 0; by < HEIGHT / 4; ++by)
+			{
+				for(U32 bx = 0; bx < WIDTH / 4; ++bx)
+				{
+					Array<Vec3, 16> decoded;
+					ANKI_TEST_EXPECT_EQ(decodeBc6hBlock(&compressed[(by * (WIDTH / 4) + bx) * 16], decoded), true);
+
+					for(U32 i = 0; i < 16; ++i)
+					{
+						const U32 x = bx * 4 + i % 4;
+						const U32 y = by * 4 + i / 4;
+						for(U32 c = 0; c < 3; ++c)
+						{
+							const F64 original = pixels[(y * WIDTH + x) * 3 + c];
+							relativeError += absolute(original - F64(decoded[i][c])) / original;
+						}
+					}
+				}
+			}
+
+			relativeError /= WIDTH * HEIGHT * 3;
+			ANKI_TEST_LOGI("BC6H quality %u: mean relative error %f", U32(quality), relativeError);
+			ANKI_TEST_EXPECT_LT(relativeError, 0.03);
+		}
+	}
+}
+
+ANKI_TEST(Importer, BcEncoderBenchmark)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	constexpr U32 SIZE = 512;
+
+	DynamicArrayAuto<U8, PtrSize> pixels(alloc);
+	generateImage(SIZE, SIZE, 4, pixels);
+
+	for(BcEncoderQuality quality : {BcEncoderQuality::FAST, BcEncoderQuality::NORMAL, BcEncoderQuality::HIGH})
+	{
+		for(BcFormat format : {BcFormat::BC1, BcFormat::BC3})
+		{
+			const BcEncoder encoder(format, quality, SIZE, SIZE, 4);
+			DynamicArrayAuto<U8, PtrSize> compressed(alloc);
+			compressed.create(encoder.getCompressedSize());
+
+			HighRezTimer timer;
+			timer.start();
+			encoder.encode(ConstWeakArray<U8, PtrSize>(pixels), WeakArray<U8, PtrSize>(compressed));
+			timer.stop();
+
+			ANKI_TEST_LOGI("%s quality %u: %f MPixels/sec", (format == BcFormat::BC1) ? "BC1" : "BC3", U32(quality),
+						   F64(SIZE * SIZE) / timer.getElapsedTime() / 1000000.0);
+		}
+	}
+}
@@ -0,0 +1,285 @@
+// Copyright (C) 2009-2022, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <AnKi/Importer/MipmapGenerator.h>
+#include <AnKi/Util/ThreadHive.h>
+#include <AnKi/Util/HighRezTimer.h>
+#include <AnKi/Util/System.h>
+
+using namespace anki;
+
+/// Allocate the memory of a whole mip chain in one buffer and point the mips to it.
+static void allocateMips(U32 width, U32 height, U32 mipCount, PtrSize pixelSize,
+						 DynamicArrayAuto<U8, PtrSize>& storage, DynamicArrayAuto<WeakArray<U8, PtrSize>>& mips)
+{
+	PtrSize size = 0;
+	for(U32 mip = 0; mip < mipCount; ++mip)
+	{
+		size += PtrSize(width >> mip) * (height >> mip) * pixelSize;
+	}
+	storage.create(size, 0);
+
+	mips.create(mipCount);
+	PtrSize offset = 0;
+	for(U32 mip = 0; mip < mipCount; ++mip)
+	{
+		const PtrSize mipSize = PtrSize(width >> mip) * (height >> mip) * pixelSize;
+		mips[mip] = WeakArray<U8, PtrSize>(&storage[offset], mipSize);
+		offset += mipSize;
+	}
+}
+
+static void generateImage(U32 width, U32 height, U32 channelCount, WeakArray<U8, PtrSize> pixels)
+{
+	for(U32 y = 0; y < height; ++y)
+	{
+		for(U32 x = 0; x < width; ++x)
+		{
+			for(U32 c = 0; c < channelCount; ++c)
+			{
+				const U32 v = x * 7 + y * 13 + c * 61 + ((x ^ y) & 31);
+				pixels[(PtrSize(y) * width + x) * channelCount + c] = U8(v & 0xFF);
+			}
+		}
+	}
+}
+
+/// The scalar box filter that the importer used to have.
+static void referenceBoxMip(ConstWeakArray<U8, PtrSize> in, U32 inWidth, U32 inHeight, U32 channelCount,
+							WeakArray<U8, PtrSize> out)
+{
+	const U32 outWidth = inWidth >> 1;
+	const U32 outHeight = inHeight >> 1;
+	for(U32 h = 0; h < outHeight; ++h)
+	{
+		for(U32 w = 0; w < outWidth; ++w)
+		{
+			for(U32 c = 0; c < channelCount; ++c)
+			{
+				F32 average = 0.0f;
+				for(U32 y = 0; y < 2; ++y)
+				{
+					for(U32 x = 0; x < 2; ++x)
+					{
+						average += F32(in[(PtrSize(h * 2 + y) * inWidth + (w * 2 + x)) * channelCount + c]) * 0.25f;
+					}
+				}
+
+				out[(PtrSize(h) * outWidth + w) * channelCount + c] = U8(average);
+			}
+		}
+	}
+}
+
+ANKI_TEST(Importer, MipmapGenerator)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	constexpr U32 WIDTH = 256;
+	constexpr U32 HEIGHT = 64;
+	constexpr U32 MIP_COUNT = 6;
+
+	// A constant image stays constant with all filters
+	for(MipmapFilter filter : {MipmapFilter::BOX, MipmapFilter::KAISER, MipmapFilter::LANCZOS})
+	{
+		DynamicArrayAuto<U8, PtrSize> storage(alloc);
+		DynamicArrayAuto<WeakArray<U8, PtrSize>> mips(alloc);
+		allocateMips(WIDTH, HEIGHT, MIP_COUNT, 4, storage, mips);
+		for(PtrSize i = 0; i < mips[0].getSize(); ++i)
+		{
+			mips[0][i] = U8(50 + (i % 4) * 40);
+		}
+
+		MipmapGenerator generator(alloc, filter, 4, false);
+		generator.addSurface(ConstWeakArray<WeakArray<U8, PtrSize>>(mips), WIDTH, HEIGHT);
+		generator.generate(nullptr);
+
+		for(U32 mip = 1; mip < MIP_COUNT; ++mip)
+		{
+			for(PtrSize i = 0; i < mips[mip].getSize(); ++i)
+			{
+				ANKI_TEST_EXPECT_EQ(mips[mip][i], U8(50 + (i % 4) * 40));
+			}
+		}
+	}
+
+	// Box matches the old scalar implementation and the threaded results match the serial ones
+	for(U32 channelCount = 3; channelCount <= 4; ++channelCount)
+	{
+		for(MipmapFilter filter : {MipmapFilter::BOX, MipmapFilter::KAISER, MipmapFilter::LANCZOS})
+		{
+			DynamicArrayAuto<U8, PtrSize> storage(alloc);
+			DynamicArrayAuto<WeakArray<U8, PtrSize>> mips(alloc);
+			allocateMips(WIDTH, HEIGHT, MIP_COUNT, channelCount, storage, mips);
+			generateImage(WIDTH, HEIGHT, channelCount, mips[0]);
+
+			DynamicArrayAuto<U8, PtrSize> storage2(alloc);
+			DynamicArrayAuto<WeakArray<U8, PtrSize>> mips2(alloc);
+			allocateMips(WIDTH, HEIGHT, MIP_COUNT, channelCount, storage2, mips2);
+			generateImage(WIDTH, HEIGHT, channelCount, mips2[0]);
+
+			{
+				MipmapGenerator generator(alloc, filter, channelCount, false);
+				generator.addSurface(ConstWeakArray<WeakArray<U8, PtrSize>>(mips), WIDTH, HEIGHT);
+				generator.generate(nullptr);
+			}
+
+			{
+				ThreadHive hive(4, alloc);
+				MipmapGenerator generator(alloc, filter, channelCount, false);
+				generator.addSurface(ConstWeakArray<WeakArray<U8, PtrSize>>(mips2), WIDTH, HEIGHT);
+				generator.generate(&hive);
+			}
+
+			ANKI_TEST_EXPECT_EQ(memcmp(&storage[0], &storage2[0], storage.getSize()), 0);
+
+			if(filter == MipmapFilter::BOX)
+			{
+				DynamicArrayAuto<U8, PtrSize> reference(alloc);
+				reference.create(mips[1].getSize());
+				for(U32 mip = 1; mip < MIP_COUNT; ++mip)
+				{
+					// Feed the reference with our previous mip to compare one level at a time
+					referenceBoxMip(mips[mip - 1], WIDTH >> (mip - 1), HEIGHT >> (mip - 1), channelCount,
+									WeakArray<U8, PtrSize>(&reference[0], mips[mip].getSize()));
+					for(PtrSize i = 0; i < mips[mip].getSize(); ++i)
+					{
+						ANKI_TEST_EXPECT_LEQ(absolute(I32(mips[mip][i]) - I32(reference[i])), 1);
+					}
+				}
+			}
+		}
+	}
+
+	// sRGB. A black and white checkerboard should average to 50% linear intensity
+	{
+		DynamicArrayAuto<U8, PtrSize> storage(alloc);
+		DynamicArrayAuto<WeakArray<U8, PtrSize>> mips(alloc);
+		allocateMips(WIDTH, HEIGHT, 2, 4, storage, mips);
+		for(U32 y = 0; y < HEIGHT; ++y)
+		{
+			for(U32 x = 0; x < WIDTH; ++x)
+			{
+				const U8 v = ((x ^ y) & 1) ? 255 : 0;
+				for(U32 c = 0; c < 4; ++c)
+				{
+					mips[0][(y * WIDTH + x) * 4 + c] = v;
+				}
+			}
+		}
+
+		MipmapGenerator generator(alloc, MipmapFilter::BOX, 4, false, MipmapGeneratorFlag::SRGB);
+		generator.addSurface(ConstWeakArray<WeakArray<U8, PtrSize>>(mips), WIDTH, HEIGHT);
+		generator.generate(nullptr);
+
+		for(PtrSize i = 0; i < mips[1].getSize(); i += 4)
+		{
+			ANKI_TEST_EXPECT_EQ(mips[1][i], 188);
+			ANKI_TEST_EXPECT_EQ(mips[1][i + 3], 128); // Alpha is linear
+		}
+	}
+
+	// Normal maps stay normalized
+	{
+		DynamicArrayAuto<U8, PtrSize> storage(alloc);
+		DynamicArrayAuto<WeakArray<U8, PtrSize>> mips(alloc);
+		allocateMips(WIDTH, HEIGHT, MIP_COUNT, 3, storage, mips);
+		for(U32 y = 0; y < HEIGHT; ++y)
+		{
+			for(U32 x = 0; x < WIDTH; ++x)
+			{
+				const F32 angle = F32(x * 5 + y * 3) * 0.1f;
+				const Vec3 n = Vec3(cos(angle) * 0.6f, sin(angle) * 0.6f, 0.8f);
+				for(U32 c = 0; c < 3; ++c)
+				{
+					mips[0][(y * WIDTH + x) * 3 + c] = U8((n[c] * 0.5f + 0.5f) * 255.0f + 0.5f);
+				}
+			}
+		}
+
+		MipmapGenerator generator(alloc, MipmapFilter::KAISER, 3, false, MipmapGeneratorFlag::NORMAL_MAP);
+		generator.addSurface(ConstWeakArray<WeakArray<U8, PtrSize>>(mips), WIDTH, HEIGHT);
+		generator.generate(nullptr);
+
+		for(U32 mip = 1; mip < MIP_COUNT; ++mip)
+		{
+			for(PtrSize i = 0; i < mips[mip].getSize(); i += 3)
+			{
+				const Vec3 n = Vec3(F32(mips[mip][i]), F32(mips[mip][i + 1]), F32(mips[mip][i + 2])) / 255.0f * 2.0f
+							   - 1.0f;
+				ANKI_TEST_EXPECT_NEAR(n.getLength(), 1.0f, 0.02f);
+			}
+		}
+	}
+
+	// HDR
+	{
+		DynamicArrayAuto<U8, PtrSize> storage(alloc);
+		DynamicArrayAuto<WeakArray<U8, PtrSize>> mips(alloc);
+		allocateMips(WIDTH, HEIGHT, MIP_COUNT, sizeof(F32) * 3, storage, mips);
+		F32* pixels = reinterpret_cast<F32*>(&mips[0][0]);
+		for(U32 i = 0; i < WIDTH * HEIGHT * 3; ++i)
+		{
+			pixels[i] = (i & 1) ? 10.0f : 2.0f;
+		}
+
+		MipmapGenerator generator(alloc, MipmapFilter::LANCZOS, 3, true);
+		generator.addSurface(ConstWeakArray<WeakArray<U8, PtrSize>>(mips), WIDTH, HEIGHT);
+		generator.generate(nullptr);
+
+		const F32* mip1 = reinterpret_cast<const F32*>(&mips[1][0]);
+		for(U32 i = 0; i < (WIDTH / 2) * (HEIGHT / 2) * 3; ++i)
+		{
+			ANKI_TEST_EXPECT_GEQ(mip1[i], 0.0f);
+		}
+	}
+}
+
+ANKI_TEST(Importer, MipmapGeneratorBenchmark)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+#if ANKI_OPTIMIZE
+	constexpr U32 SIZE = 8192;
+#else
+	constexpr U32 SIZE = 1024;
+#endif
+	constexpr U32 MIP_COUNT = 8;
+
+	DynamicArrayAuto<U8, PtrSize> storage(alloc);
+	DynamicArrayAuto<WeakArray<U8, PtrSize>> mips(alloc);
+	allocateMips(SIZE, SIZE, MIP_COUNT, 4, storage, mips);
+	generateImage(SIZE, SIZE, 4, mips[0]);
+
+	// The old scalar implementation
+	{
+		HighRezTimer timer;
+		timer.start();
+		for(U32 mip = 1; mip < MIP_COUNT; ++mip)
+		{
+			referenceBoxMip(mips[mip - 1], SIZE >> (mip - 1), SIZE >> (mip - 1), 4, mips[mip]);
+		}
+		timer.stop();
+
+		ANKI_TEST_LOGI("Scalar box: %f MPixels/sec", F64(SIZE) * SIZE / timer.getElapsedTime() / 1000000.0);
+	}
+
+	ThreadHive hive(getCpuCoresCount(), alloc, true);
+	for(MipmapFilter filter : {MipmapFilter::BOX, MipmapFilter::KAISER, MipmapFilter::LANCZOS})
+	{
+		for(ThreadHive* h : {static_cast<ThreadHive*>(nullptr), &hive})
+		{
+			MipmapGenerator generator(alloc, filter, 4, false);
+			generator.addSurface(ConstWeakArray<WeakArray<U8, PtrSize>>(mips), SIZE, SIZE);
+
+			HighRezTimer timer;
+			timer.start();
+			generator.generate(h);
+			timer.stop();
+
+			ANKI_TEST_LOGI("Filter %u, %u threads: %f MPixels/sec", U32(filter), (h) ? h->getThreadCount() : 1,
+						   F64(SIZE) * SIZE / timer.getElapsedTime() / 1000000.0);
+		}
+	}
+}
@@ -0,0 +1,313 @@
+// Copyright (C) 2009-2022, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <AnKi/Math.h>
+#include <AnKi/Util/DynamicArray.h>
+#include <AnKi/Util/HighRezTimer.h>
+
+using namespace anki;
+
+template<typename T>
+static Bool nearEqual(const T& a, const T& b, U32 floatCount)
+{
+	const F32* af = reinterpret_cast<const F32*>(&a);
+	const F32* bf = reinterpret_cast<const F32*>(&b);
+	for(U32 i = 0; i < floatCount; ++i)
+	{
+		if(absolute(af[i] - bf[i]) > 1.0e-4f)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+template<typename TMat>
+static TMat getRandomMat()
+{
+	TMat m;
+	for(U32 i = 0; i < TMat::SIZE; ++i)
+	{
+		m[i] = getRandomRange(-1.0f, 1.0f);
+	}
+	return m;
+}
+
+static Quat getRandomQuat()
+{
+	Quat q(getRandomRange(-1.0f, 1.0f), getRandomRange(-1.0f, 1.0f), getRandomRange(-1.0f, 1.0f),
+		   getRandomRange(0.1f, 1.0f));
+	q.normalize();
+	return q;
+}
+
+ANKI_TEST(Math, Batch)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	// Odd count to test the remainders of the SIMD paths
+	constexpr U32 COUNT = 37;
+
+	// multiplyMat4s
+	{
+		DynamicArrayAuto<Mat4> a(alloc), b(alloc), out(alloc);
+		a.create(COUNT);
+		b.create(COUNT);
+		out.create(COUNT);
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			a[i] = getRandomMat<Mat4>();
+			b[i] = getRandomMat<Mat4>();
+		}
+
+		multiplyMat4s(&a[0], &b[0], &out[0], COUNT);
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(nearEqual(out[i], a[i] * b[i], 16), true);
+		}
+
+		multiplyMat4s(a[0], &b[0], &out[0], COUNT);
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(nearEqual(out[i], a[0] * b[i], 16), true);
+		}
+
+		// In place
+		out = b;
+		multiplyMat4s(&a[0], &out[0], &out[0], COUNT);
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(nearEqual(out[i], a[i] * b[i], 16), true);
+		}
+	}
+
+	// combineTransformations
+	{
+		DynamicArrayAuto<Mat3x4> a(alloc), b(alloc), out(alloc);
+		a.create(COUNT);
+		b.create(COUNT);
+		out.create(COUNT);
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			a[i] = getRandomMat<Mat3x4>();
+			b[i] = getRandomMat<Mat3x4>();
+		}
+
+		combineTransformations(&a[0], &b[0], &out[0], COUNT);
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(nearEqual(out[i], a[i].combineTransformations(b[i]), 12), true);
+		}
+
+		out = b;
+		combineTransformations(a[0], &out[0], &out[0], COUNT);
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(nearEqual(out[i], a[0].combineTransformations(b[i]), 12), true);
+		}
+	}
+
+	// transformPoints
+	{
+		const Mat3x4 m3 = getRandomMat<Mat3x4>();
+		const Mat4 m4 = getRandomMat<Mat4>();
+		DynamicArrayAuto<Vec3> points3(alloc), out3(alloc);
+		DynamicArrayAuto<Vec4> points4(alloc), out4(alloc);
+		points3.create(COUNT);
+		out3.create(COUNT);
+		points4.create(COUNT);
+		out4.create(COUNT);
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			points3[i] =
+				Vec3(getRandomRange(-10.0f, 10.0f), getRandomRange(-10.0f, 10.0f), getRandomRange(-10.0f, 10.0f));
+			points4[i] = Vec4(points3[i], getRandomRange(-1.0f, 1.0f));
+		}
+
+		transformPoints(m3, &points3[0], &out3[0], COUNT);
+		transformPoints(m4, &points4[0], &out4[0], COUNT);
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(nearEqual(out3[i], m3 * Vec4(points3[i], 1.0f), 3), true);
+			ANKI_TEST_EXPECT_EQ(nearEqual(out4[i], m4 * points4[i], 4), true);
+		}
+
+		// In place
+		out3 = points3;
+		transformPoints(m3, &out3[0], &out3[0], COUNT);
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(nearEqual(out3[i], m3 * Vec4(points3[i], 1.0f), 3), true);
+		}
+	}
+
+	// makeMat3x4s
+	{
+		DynamicArrayAuto<Vec3> translations(alloc);
+		DynamicArrayAuto<Quat> rotations(alloc);
+		DynamicArrayAuto<F32> scales(alloc);
+		DynamicArrayAuto<Mat3x4> out(alloc);
+		translations.create(COUNT);
+		rotations.create(COUNT);
+		scales.create(COUNT);
+		out.create(COUNT);
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			translations[i] = Vec3(getRandomRange(-10.0f, 10.0f), getRandomRange(-10.0f, 10.0f), 1.0f);
+			rotations[i] = getRandomQuat();
+			scales[i] = (i % 2) ? getRandomRange(0.1f, 2.0f) : 1.0f;
+		}
+
+		makeMat3x4s(&translations[0], &rotations[0], &scales[0], &out[0], COUNT);
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(nearEqual(out[i], Mat3x4(translations[i], rotations[i], scales[i]), 12), true);
+		}
+	}
+}
+
+ANKI_TEST(Math, BatchBenchmark)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	constexpr U32 COUNT = 1024;
+	constexpr U32 ITERATIONS = 2000;
+
+	DynamicArrayAuto<Mat4> mats4(alloc), mats4b(alloc), outMats4(alloc);
+	DynamicArrayAuto<Mat3x4> mats3x4(alloc), outMats3x4(alloc);
+	DynamicArrayAuto<Vec3> points(alloc), outPoints(alloc), translations(alloc);
+	DynamicArrayAuto<Quat> rotations(alloc);
+	DynamicArrayAuto<F32> scales(alloc);
+	mats4.create(COUNT);
+	mats4b.create(COUNT);
+	outMats4.create(COUNT);
+	mats3x4.create(COUNT);
+	outMats3x4.create(COUNT);
+	points.create(COUNT);
+	outPoints.create(COUNT);
+	translations.create(COUNT);
+	rotations.create(COUNT);
+	scales.create(COUNT);
+	for(U32 i = 0; i < COUNT; ++i)
+	{
+		mats4[i] = getRandomMat<Mat4>();
+		mats4b[i] = getRandomMat<Mat4>();
+		mats3x4[i] = getRandomMat<Mat3x4>();
+		points[i] = Vec3(getRandomRange(-10.0f, 10.0f));
+		translations[i] = points[i];
+		rotations[i] = getRandomQuat();
+		scales[i] = getRandomRange(0.1f, 2.0f);
+	}
+
+	const Mat4 parent4 = getRandomMat<Mat4>();
+	const Mat3x4 parent3x4 = getRandomMat<Mat3x4>();
+
+	// Prevent the compiler from optimizing away the loops. Change the input a bit every iteration so the work can't be
+	// hoisted out of the iterations
+	F32 sink = 0.0f;
+	auto touch = [&](U32 it) {
+		const U32 i = it % COUNT;
+		mats4[i](0, 0) += 1.0e-6f;
+		mats4b[i](1, 1) += 1.0e-6f;
+		mats3x4[i](0, 1) += 1.0e-6f;
+		points[i].x() += 1.0e-6f;
+		translations[i].y() += 1.0e-6f;
+	};
+
+	auto bench = [&](CString name, auto loopFunc, auto batchFunc, const F32& checkVal) {
+		HighRezTimer timer;
+		timer.start();
+		for(U32 it = 0; it < ITERATIONS; ++it)
+		{
+			loopFunc();
+			touch(it);
+		}
+		timer.stop();
+		const Second loopTime = timer.getElapsedTime();
+		sink += checkVal;
+
+		timer.start();
+		for(U32 it = 0; it < ITERATIONS; ++it)
+		{
+			batchFunc();
+			touch(it);
+		}
+		timer.stop();
+		const Second batchTime = timer.getElapsedTime();
+		sink += checkVal;
+
+		const F64 elementCount = F64(COUNT) * ITERATIONS;
+		ANKI_TEST_LOGI("%s: loop %f ns/element, batch %f ns/element | %f%%", name.cstr(),
+					   loopTime / elementCount * 1000000000.0, batchTime / elementCount * 1000000000.0,
+					   batchTime / loopTime * 100.0);
+	};
+
+	bench(
+		"multiplyMat4s",
+		[&]() {
+			for(U32 i = 0; i < COUNT; ++i)
+			{
+				outMats4[i] = mats4[i] * mats4b[i];
+			}
+		},
+		[&]() {
+			multiplyMat4s(&mats4[0], &mats4b[0], &outMats4[0], COUNT);
+		},
+		outMats4[7](1, 2));
+
+	bench(
+		"multiplyMat4s (common parent)",
+		[&]() {
+			for(U32 i = 0; i < COUNT; ++i)
+			{
+				outMats4[i] = parent4 * mats4[i];
+			}
+		},
+		[&]() {
+			multiplyMat4s(parent4, &mats4[0], &outMats4[0], COUNT);
+		},
+		outMats4[9](2, 3));
+
+	bench(
+		"combineTransformations (common parent)",
+		[&]() {
+			for(U32 i = 0; i < COUNT; ++i)
+			{
+				outMats3x4[i] = parent3x4.combineTransformations(mats3x4[i]);
+			}
+		},
+		[&]() {
+			combineTransformations(parent3x4, &mats3x4[0], &outMats3x4[0], COUNT);
+		},
+		outMats3x4[3](0, 3));
+
+	bench(
+		"transformPoints",
+		[&]() {
+			for(U32 i = 0; i < COUNT; ++i)
+			{
+				outPoints[i] = parent3x4 * Vec4(points[i], 1.0f);
+			}
+		},
+		[&]() {
+			transformPoints(parent3x4, &points[0], &outPoints[0], COUNT);
+		},
+		outPoints[5].y());
+
+	bench(
+		"makeMat3x4s",
+		[&]() {
+			for(U32 i = 0; i < COUNT; ++i)
+			{
+				outMats3x4[i] = Mat3x4(translations[i], rotations[i], scales[i]);
+			}
+		},
+		[&]() {
+			makeMat3x4s(&translations[0], &rotations[0], &scales[0], &outMats3x4[0], COUNT);
+		},
+		outMats3x4[11](1, 1));
+
+	ANKI_TEST_LOGI("Ignore this: %f", sink);
+}
@@ -0,0 +1,294 @@
+// Copyright (C) 2009-2022, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <AnKi/Physics/PhysicsWorld.h>
+#include <AnKi/Physics/PhysicsBody.h>
+#include <AnKi/Physics/PhysicsCollisionShape.h>
+#include <AnKi/Util/ThreadHive.h>
+#include <AnKi/Util/HighRezTimer.h>
+#include <AnKi/Util/System.h>
+
+using namespace anki;
+
+/// Something like the tower of boxes of the PhysicsPlayground sample. A static floor and columns of boxes on top.
+static void createBoxes(PhysicsWorld& world, U32 columnsX, U32 columnsZ, U32 height,
+						DynamicArrayAuto<PhysicsBodyPtr>& bodies)
+{
+	PhysicsCollisionShapePtr floorShape = world.newInstance<PhysicsBox>(Vec3(100.0f, 1.0f, 100.0f));
+	PhysicsBodyInitInfo init;
+	init.m_shape = floorShape;
+	init.m_mass = 0.0f;
+	init.m_transform.setOrigin(Vec4(0.0f, -1.0f, 0.0f, 0.0f));
+	bodies.emplaceBack(world.newInstance<PhysicsBody>(init));
+
+	PhysicsCollisionShapePtr boxShape = world.newInstance<PhysicsBox>(Vec3(0.5f));
+	init.m_shape = boxShape;
+	init.m_mass = 1.0f;
+	for(U32 y = 0; y < height; ++y)
+	{
+		for(U32 z = 0; z < columnsZ; ++z)
+		{
+			for(U32 x = 0; x < columnsX; ++x)
+			{
+				const Vec3 pos(F32(x) * 1.5f - F32(columnsX) * 0.75f, F32(y) * 1.05f + 0.55f,
+							   F32(z) * 1.5f - F32(columnsZ) * 0.75f);
+				init.m_transform.setOrigin(pos.xyz0());
+				bodies.emplaceBack(world.newInstance<PhysicsBody>(init));
+			}
+		}
+	}
+}
+
+ANKI_TEST(Physics, PhysicsWorldMultithreaded)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	ThreadHive hive(4, alloc, false);
+
+	Array<F32, 2> restingHeights;
+	for(U32 multithreaded = 0; multithreaded < 2; ++multithreaded)
+	{
+		PhysicsWorld world;
+		ANKI_TEST_EXPECT_NO_ERR(world.init(allocAligned, nullptr, (multithreaded) ? &hive : nullptr));
+
+		{
+			DynamicArrayAuto<PhysicsBodyPtr> bodies(alloc);
+			createBoxes(world, 8, 8, 4, bodies);
+
+			// Drop a sphere from above
+			PhysicsBodyInitInfo init;
+			init.m_shape = world.newInstance<PhysicsSphere>(0.5f);
+			init.m_mass = 1.0f;
+			init.m_transform.setOrigin(Vec4(50.0f, 10.0f, 50.0f, 0.0f));
+			PhysicsBodyPtr sphere = world.newInstance<PhysicsBody>(init);
+
+			for(U32 i = 0; i < 240; ++i)
+			{
+				ANKI_TEST_EXPECT_NO_ERR(world.update(1.0 / 60.0));
+			}
+
+			restingHeights[multithreaded] = sphere->getTransform().getOrigin().y();
+
+			// The boxes should stay on the floor
+			for(U32 i = 1; i < bodies.getSize(); ++i)
+			{
+				ANKI_TEST_EXPECT_GT(bodies[i]->getTransform().getOrigin().y(), 0.0f);
+			}
+		}
+	}
+
+	ANKI_TEST_EXPECT_NEAR(restingHeights[0], 0.5f, 0.05f);
+	ANKI_TEST_EXPECT_NEAR(restingHeights[1], 0.5f, 0.05f);
+}
+
+ANKI_TEST(Physics, PhysicsWorldBenchmark)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+#if ANKI_OPTIMIZE
+	constexpr U32 COLUMNS = 25;
+	constexpr U32 HEIGHT = 16; // 10K boxes
+#else
+	constexpr U32 COLUMNS = 10;
+	constexpr U32 HEIGHT = 10;
+#endif
+	constexpr U32 WARMUP_STEPS = 30;
+	constexpr U32 STEPS = 120;
+
+	const U32 maxThreadCount = min(getCpuCoresCount(), ThreadHive::MAX_THREADS);
+	for(U32 threadCount = 0; threadCount <= maxThreadCount; threadCount = (threadCount) ? threadCount * 2 : 1)
+	{
+		ThreadHive* hive = (threadCount) ? alloc.newInstance<ThreadHive>(threadCount, alloc, true) : nullptr;
+
+		{
+			PhysicsWorld world;
+			ANKI_TEST_EXPECT_NO_ERR(world.init(allocAligned, nullptr, hive));
+
+			DynamicArrayAuto<PhysicsBodyPtr> bodies(alloc);
+			createBoxes(world, COLUMNS, COLUMNS, HEIGHT, bodies);
+
+			for(U32 i = 0; i < WARMUP_STEPS; ++i)
+			{
+				ANKI_TEST_EXPECT_NO_ERR(world.update(1.0 / 60.0));
+			}
+
+			HighRezTimer timer;
+			timer.start();
+			for(U32 i = 0; i < STEPS; ++i)
+			{
+				ANKI_TEST_EXPECT_NO_ERR(world.update(1.0 / 60.0));
+			}
+			timer.stop();
+
+			ANKI_TEST_LOGI("%u bodies, %s: %f ms per step", COLUMNS * COLUMNS * HEIGHT,
+						   (hive) ? StringAuto(alloc).sprintf("%u job threads", threadCount).cstr() : "single threaded",
+						   timer.getElapsedTime() * 1000.0 / F64(STEPS));
+
+			bodies.destroy();
+		}
+
+		alloc.deleteInstance(hive);
+	}
+}
+
+ANKI_TEST(Physics, PhysicsWorldQueries)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	ThreadHive hive(4, alloc, false);
+
+	PhysicsWorld world;
+	ANKI_TEST_EXPECT_NO_ERR(world.init(allocAligned, nullptr));
+
+	{
+		// A floor with its top at y=0 and a static box on top of it
+		PhysicsBodyInitInfo init;
+		init.m_shape = world.newInstance<PhysicsBox>(Vec3(100.0f, 1.0f, 100.0f));
+		init.m_transform.setOrigin(Vec4(0.0f, -1.0f, 0.0f, 0.0f));
+		PhysicsBodyPtr floor = world.newInstance<PhysicsBody>(init);
+
+		init.m_shape = world.newInstance<PhysicsBox>(Vec3(0.5f));
+		init.m_transform.setOrigin(Vec4(0.0f, 0.5f, 0.0f, 0.0f));
+		PhysicsBodyPtr box = world.newInstance<PhysicsBody>(init);
+
+		ANKI_TEST_EXPECT_NO_ERR(world.update(1.0 / 60.0));
+
+		Array<PhysicsWorldQuery, 8> queries;
+		queries[0].m_from = Vec3(0.0f, 10.0f, 0.0f);
+		queries[0].m_to = Vec3(0.0f, -10.0f, 0.0f);
+
+		queries[1] = queries[0];
+		queries[1].m_from.x() = queries[1].m_to.x() = 5.0f;
+
+		queries[2] = queries[0];
+		queries[2].m_materialMask = PhysicsMaterialBit::DYNAMIC_GEOMETRY;
+
+		queries[3] = queries[0];
+		queries[3].m_type = PhysicsWorldQueryType::SPHERE_SWEEP;
+		queries[3].m_radius = 0.5f;
+
+		queries[4] = queries[0];
+		queries[4].m_type = PhysicsWorldQueryType::CAPSULE_SWEEP;
+		queries[4].m_radius = 0.25f;
+		queries[4].m_halfHeight = 0.5f;
+
+		queries[5].m_type = PhysicsWorldQueryType::SPHERE_OVERLAP;
+		queries[5].m_from = Vec3(0.0f, 0.5f, 0.0f);
+		queries[5].m_radius = 0.3f;
+
+		queries[6] = queries[5];
+		queries[6].m_from = Vec3(3.0f, 2.0f, 3.0f);
+
+		queries[7] = queries[5];
+		queries[7].m_from = Vec3(3.0f, 0.2f, 3.0f);
+
+		Array<PhysicsWorldQueryResult, 8> results;
+		world.query(queries, results);
+
+		ANKI_TEST_EXPECT_EQ(results[0].m_object, box.get());
+		ANKI_TEST_EXPECT_NEAR(results[0].m_position.y(), 1.0f, 0.001f);
+		ANKI_TEST_EXPECT_NEAR(results[0].m_normal.y(), 1.0f, 0.001f);
+		ANKI_TEST_EXPECT_NEAR(results[0].m_fraction, 0.45f, 0.001f);
+
+		ANKI_TEST_EXPECT_EQ(results[1].m_object, floor.get());
+		ANKI_TEST_EXPECT_NEAR(results[1].m_position.y(), 0.0f, 0.001f);
+
+		ANKI_TEST_EXPECT_EQ(results[2].m_object, nullptr);
+
+		ANKI_TEST_EXPECT_EQ(results[3].m_object, box.get());
+		ANKI_TEST_EXPECT_NEAR(results[3].m_fraction, (10.0f - 1.5f) / 20.0f, 0.005f);
+
+		ANKI_TEST_EXPECT_EQ(results[4].m_object, box.get());
+		ANKI_TEST_EXPECT_NEAR(results[4].m_fraction, (10.0f - 1.75f) / 20.0f, 0.005f);
+
+		ANKI_TEST_EXPECT_EQ(results[5].m_object, box.get());
+		ANKI_TEST_EXPECT_EQ(results[6].m_object, nullptr);
+		ANKI_TEST_EXPECT_EQ(results[7].m_object, floor.get());
+		ANKI_TEST_EXPECT_NEAR(results[7].m_normal.y(), 1.0f, 0.001f);
+
+		// The same in many threads
+		DynamicArrayAuto<PhysicsWorldQuery> manyQueries(alloc);
+		DynamicArrayAuto<PhysicsWorldQueryResult> manyResults(alloc);
+		manyResults.create(queries.getSize() * 256);
+		for(U32 i = 0; i < 256; ++i)
+		{
+			for(const PhysicsWorldQuery& q : queries)
+			{
+				manyQueries.emplaceBack(q);
+			}
+		}
+
+		world.query(manyQueries, WeakArray<PhysicsWorldQueryResult>(manyResults), &hive);
+
+		for(U32 i = 0; i < manyResults.getSize(); ++i)
+		{
+			const PhysicsWorldQueryResult& a = manyResults[i];
+			const PhysicsWorldQueryResult& b = results[i % queries.getSize()];
+			ANKI_TEST_EXPECT_EQ(a.m_object, b.m_object);
+			ANKI_TEST_EXPECT_EQ(a.m_fraction, b.m_fraction);
+		}
+	}
+}
+
+ANKI_TEST(Physics, PhysicsWorldQueryBenchmark)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+#if ANKI_OPTIMIZE
+	constexpr U32 COLUMNS = 25;
+	constexpr U32 HEIGHT = 16;
+	constexpr U32 RAY_COUNT = 256 * 1024;
+#else
+	constexpr U32 COLUMNS = 10;
+	constexpr U32 HEIGHT = 10;
+	constexpr U32 RAY_COUNT = 16 * 1024;
+#endif
+
+	PhysicsWorld world;
+	ANKI_TEST_EXPECT_NO_ERR(world.init(allocAligned, nullptr));
+
+	DynamicArrayAuto<PhysicsBodyPtr> bodies(alloc);
+	createBoxes(world, COLUMNS, COLUMNS, HEIGHT, bodies);
+	for(U32 i = 0; i < 30; ++i)
+	{
+		ANKI_TEST_EXPECT_NO_ERR(world.update(1.0 / 60.0));
+	}
+
+	// Random rays from above the tower to the floor
+	DynamicArrayAuto<PhysicsWorldQuery> queries(alloc);
+	DynamicArrayAuto<PhysicsWorldQueryResult> results(alloc);
+	queries.create(RAY_COUNT);
+	results.create(RAY_COUNT);
+	const F32 extent = F32(COLUMNS) * 0.75f;
+	for(PhysicsWorldQuery& q : queries)
+	{
+		const Vec2 a = Vec2(getRandomRange(-extent, extent), getRandomRange(-extent, extent));
+		const Vec2 b = Vec2(getRandomRange(-extent, extent), getRandomRange(-extent, extent));
+		q.m_from = Vec3(a.x(), F32(HEIGHT) * 2.0f, a.y());
+		q.m_to = Vec3(b.x(), -0.5f, b.y());
+	}
+
+	const U32 maxThreadCount = min(getCpuCoresCount(), ThreadHive::MAX_THREADS);
+	for(U32 threadCount = 0; threadCount <= maxThreadCount; threadCount = (threadCount) ? threadCount * 2 : 1)
+	{
+		ThreadHive* hive = (threadCount) ? alloc.newInstance<ThreadHive>(threadCount, alloc, true) : nullptr;
+
+		HighRezTimer timer;
+		timer.start();
+		world.query(queries, WeakArray<PhysicsWorldQueryResult>(results), hive);
+		timer.stop();
+
+		U32 hitCount = 0;
+		for(const PhysicsWorldQueryResult& r : results)
+		{
+			hitCount += (r.m_object) ? 1 : 0;
+		}
+
+		ANKI_TEST_LOGI("%s: %f MRays/sec (%u hits)",
+					   (hive) ? StringAuto(alloc).sprintf("%u job threads", threadCount).cstr() : "Single threaded",
+					   F64(RAY_COUNT) / timer.getElapsedTime() / 1000000.0, hitCount);
+
+		alloc.deleteInstance(hive);
+	}
+
+	bodies.destroy();
+}
@@ -0,0 +1,97 @@
+// Copyright (C) 2009-2022, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <AnKi/Renderer/GpuCulling.h>
+
+namespace anki {
+
+ANKI_TEST(Renderer, GpuCulling)
+{
+	// Camera at the origin looking at -Z
+	GpuCullingUniforms unis;
+	unis.m_previousViewProjectionMatrix =
+		Mat4::calculatePerspectiveProjectionMatrix(toRad(90.0f), toRad(90.0f), 0.1f, 100.0f);
+	unis.m_hizSize = UVec2(4, 4);
+	unis.m_hizMipCount = 1;
+
+	// A wall at Z=-10 that covers the whole screen
+	const Vec4 wallClip = unis.m_previousViewProjectionMatrix * Vec4(0.0f, 0.0f, -10.0f, 1.0f);
+	Array<F32, 16> hiz;
+	for(F32& d : hiz)
+	{
+		d = wallClip.z() / wallClip.w();
+	}
+
+	// One drawcall with 5 instances, the 3rd is behind the wall. And an empty slot at the end
+	constexpr U32 SLOT_COUNT = 6;
+	const Array<F32, 5> instanceZs = {-2.0f, -3.0f, -50.0f, -4.0f, -5.0f};
+	Array<GpuCullingInstance, SLOT_COUNT> instances = {};
+	for(U32 i = 0; i < instanceZs.getSize(); ++i)
+	{
+		instances[i].m_aabbMin = Vec3(-0.5f, -0.5f, instanceZs[i] - 0.5f);
+		instances[i].m_aabbMax = Vec3(0.5f, 0.5f, instanceZs[i] + 0.5f);
+	}
+
+	Array<GpuCullingDraw, SLOT_COUNT> draws = {};
+	draws[0].m_instanceCount = instanceZs.getSize();
+	draws[0].m_indexCount = 36;
+	draws[0].m_firstIndex = 12;
+
+	Array<GpuCullingDrawIndexedIndirectArgs, SLOT_COUNT> args;
+	memset(&args[0], 0xFF, sizeof(args));
+	const Array<U32, 1> drawSlots = {0};
+	unis.m_drawCount = drawSlots.getSize();
+
+	// With occlusion
+	GpuCulling::cullOnCpu(unis, ConstWeakArray<F32>(hiz), ConstWeakArray<GpuCullingInstance>(instances),
+						  ConstWeakArray<GpuCullingDraw>(draws), ConstWeakArray<U32>(drawSlots),
+						  WeakArray<GpuCullingDrawIndexedIndirectArgs>(args));
+
+	ANKI_TEST_EXPECT_EQ(args[0].m_firstInstance, 0);
+	ANKI_TEST_EXPECT_EQ(args[0].m_instanceCount, 2);
+	ANKI_TEST_EXPECT_EQ(args[0].m_indexCount, 36);
+	ANKI_TEST_EXPECT_EQ(args[0].m_firstIndex, 12);
+	ANKI_TEST_EXPECT_EQ(args[1].m_firstInstance, 3);
+	ANKI_TEST_EXPECT_EQ(args[1].m_instanceCount, 2);
+	ANKI_TEST_EXPECT_EQ(args[2].m_instanceCount, 0);
+	ANKI_TEST_EXPECT_EQ(args[3].m_instanceCount, 0);
+	ANKI_TEST_EXPECT_EQ(args[4].m_instanceCount, 0);
+	ANKI_TEST_EXPECT_EQ(args[5].m_instanceCount, MAX_U32); // Untouched
+
+	// Without HiZ everything is visible
+	GpuCulling::cullOnCpu(unis, ConstWeakArray<F32>(), ConstWeakArray<GpuCullingInstance>(instances),
+						  ConstWeakArray<GpuCullingDraw>(draws), ConstWeakArray<U32>(drawSlots),
+						  WeakArray<GpuCullingDrawIndexedIndirectArgs>(args));
+
+	ANKI_TEST_EXPECT_EQ(args[0].m_firstInstance, 0);
+	ANKI_TEST_EXPECT_EQ(args[0].m_instanceCount, 5);
+	for(U32 i = 1; i < instanceZs.getSize(); ++i)
+	{
+		ANKI_TEST_EXPECT_EQ(args[i].m_instanceCount, 0);
+	}
+
+	// Alternating visibility
+	for(U32 i = 0; i < instanceZs.getSize(); ++i)
+	{
+		const F32 z = (i % 2) ? -50.0f : -2.0f;
+		instances[i].m_aabbMin.z() = z - 0.5f;
+		instances[i].m_aabbMax.z() = z + 0.5f;
+	}
+
+	GpuCulling::cullOnCpu(unis, ConstWeakArray<F32>(hiz), ConstWeakArray<GpuCullingInstance>(instances),
+						  ConstWeakArray<GpuCullingDraw>(draws), ConstWeakArray<U32>(drawSlots),
+						  WeakArray<GpuCullingDrawIndexedIndirectArgs>(args));
+
+	for(U32 i = 0; i < 3; ++i)
+	{
+		ANKI_TEST_EXPECT_EQ(args[i].m_firstInstance, i * 2);
+		ANKI_TEST_EXPECT_EQ(args[i].m_instanceCount, 1);
+	}
+	ANKI_TEST_EXPECT_EQ(args[3].m_instanceCount, 0);
+	ANKI_TEST_EXPECT_EQ(args[4].m_instanceCount, 0);
+}
+
+} // end namespace anki
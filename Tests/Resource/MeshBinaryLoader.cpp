@@ -0,0 +1,211 @@
+// Copyright (C) 2009-2022, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <AnKi/Resource/MeshBinaryLoader.h>
+#include <AnKi/Util/File.h>
+
+namespace anki {
+
+namespace {
+
+class TestMesh
+{
+public:
+	MeshBinaryHeader m_header;
+	MeshBinarySubMesh m_subMesh;
+	Array<U16, 3> m_indices = {{0, 1, 2}};
+	Array<Vec3, 3> m_positions = {{Vec3(0.0f, 0.0f, 0.0f), Vec3(1.0f, 0.0f, 0.0f), Vec3(0.0f, 1.0f, 0.0f)}};
+	Array<U8, 16 * 3> m_vertexBuffer1 = {};
+
+	MeshBinaryMeshletsHeader m_meshletsHeader;
+	MeshBinarySubMeshMeshlets m_subMeshMeshlets;
+	MeshBinaryMeshlet m_meshlet;
+	Array<U16, 3> m_meshletVertexIndices = {{2, 0, 1}};
+	Array<U8Vec4, 1> m_meshletPrimitives = {{U8Vec4(0, 1, 2, 0)}};
+
+	TestMesh()
+	{
+		zeroMemory(m_header);
+		memcpy(&m_header.m_magic[0], MESH_MAGIC, 8);
+		m_header.m_flags = MeshBinaryFlag::MESHLETS;
+		m_header.m_vertexBuffers[0].m_vertexStride = sizeof(Vec3);
+		m_header.m_vertexBuffers[1].m_vertexStride = 16;
+		m_header.m_vertexBufferCount = 2;
+		m_header.m_vertexAttributes[VertexAttributeId::POSITION] = {0, Format::R32G32B32_SFLOAT, 0, 1.0f};
+		m_header.m_vertexAttributes[VertexAttributeId::NORMAL] = {1, Format::A2B10G10R10_SNORM_PACK32, 0, 1.0f};
+		m_header.m_vertexAttributes[VertexAttributeId::TANGENT] = {1, Format::A2B10G10R10_SNORM_PACK32, 4, 1.0f};
+		m_header.m_vertexAttributes[VertexAttributeId::UV0] = {1, Format::R32G32_SFLOAT, 8, 1.0f};
+		m_header.m_indexType = IndexType::U16;
+		m_header.m_totalIndexCount = 3;
+		m_header.m_totalVertexCount = 3;
+		m_header.m_subMeshCount = 1;
+		m_header.m_aabbMin = Vec3(0.0f, 0.0f, -0.1f);
+		m_header.m_aabbMax = Vec3(1.0f, 1.0f, 0.1f);
+
+		zeroMemory(m_subMesh);
+		m_subMesh.m_indexCount = 3;
+		m_subMesh.m_aabbMin = m_header.m_aabbMin;
+		m_subMesh.m_aabbMax = m_header.m_aabbMax;
+
+		zeroMemory(m_meshletsHeader);
+		m_meshletsHeader.m_meshletCount = 1;
+		m_meshletsHeader.m_meshletVertexCount = 3;
+		m_meshletsHeader.m_meshletPrimitiveCount = 1;
+
+		m_subMeshMeshlets.m_firstMeshlet = 0;
+		m_subMeshMeshlets.m_meshletCount = 1;
+
+		zeroMemory(m_meshlet);
+		m_meshlet.m_vertexCount = 3;
+		m_meshlet.m_primitiveCount = 1;
+		m_meshlet.m_sphereCenter = Vec3(0.5f, 0.5f, 0.0f);
+		m_meshlet.m_sphereRadius = 0.75f;
+		m_meshlet.m_coneApex = Vec3(0.0f);
+		m_meshlet.m_coneCutoff = 0.5f;
+		m_meshlet.m_coneAxis = Vec3(0.0f, 0.0f, 1.0f);
+	}
+
+	/// Write the mesh. If truncate is true it skips the last section.
+	ANKI_USE_RESULT Error write(CString filename, Bool truncate = false) const
+	{
+		File file;
+		ANKI_CHECK(file.open(filename, FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+
+		ANKI_CHECK(file.write(&m_header, sizeof(m_header)));
+		ANKI_CHECK(file.write(&m_subMesh, sizeof(m_subMesh)));
+		ANKI_CHECK(writeAligned(file, &m_indices[0], sizeof(m_indices)));
+		ANKI_CHECK(writeAligned(file, &m_positions[0], sizeof(m_positions)));
+		ANKI_CHECK(writeAligned(file, &m_vertexBuffer1[0], sizeof(m_vertexBuffer1)));
+
+		Array<U8, sizeof(m_meshletsHeader) + sizeof(m_subMeshMeshlets)> meshletsHeader;
+		memcpy(&meshletsHeader[0], &m_meshletsHeader, sizeof(m_meshletsHeader));
+		memcpy(&meshletsHeader[sizeof(m_meshletsHeader)], &m_subMeshMeshlets, sizeof(m_subMeshMeshlets));
+		ANKI_CHECK(writeAligned(file, &meshletsHeader[0], sizeof(meshletsHeader)));
+
+		ANKI_CHECK(writeAligned(file, &m_meshlet, sizeof(m_meshlet)));
+		ANKI_CHECK(writeAligned(file, &m_meshletVertexIndices[0], sizeof(m_meshletVertexIndices)));
+		if(!truncate)
+		{
+			ANKI_CHECK(writeAligned(file, &m_meshletPrimitives[0], sizeof(m_meshletPrimitives)));
+		}
+
+		return Error::NONE;
+	}
+
+private:
+	static ANKI_USE_RESULT Error writeAligned(File& file, const void* data, PtrSize size)
+	{
+		ANKI_CHECK(file.write(data, size));
+
+		const Array<U8, MESH_BINARY_BUFFER_ALIGNMENT> zeros = {};
+		const PtrSize padding = getAlignedRoundUp(MESH_BINARY_BUFFER_ALIGNMENT, size) - size;
+		if(padding)
+		{
+			ANKI_CHECK(file.write(&zeros[0], padding));
+		}
+
+		return Error::NONE;
+	}
+};
+
+} // end namespace
+
+ANKI_TEST(Resource, MeshBinaryLoader)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	ResourceFilesystem fs(alloc);
+	fs.addCachePath("/tmp/");
+
+	// Round trip
+	{
+		const TestMesh mesh;
+		ANKI_TEST_EXPECT_NO_ERR(mesh.write("/tmp/MeshBinaryLoaderTest.ankimesh"));
+
+		MeshBinaryLoader loader(&fs, alloc);
+		ANKI_TEST_EXPECT_NO_ERR(loader.load("MeshBinaryLoaderTest.ankimesh"));
+		ANKI_TEST_EXPECT_EQ(loader.hasMeshlets(), true);
+
+		const MeshBinaryMeshletsHeader& header = loader.getMeshletsHeader();
+		ANKI_TEST_EXPECT_EQ(header.m_meshletCount, 1);
+		ANKI_TEST_EXPECT_EQ(header.m_meshletVertexCount, 3);
+		ANKI_TEST_EXPECT_EQ(header.m_meshletPrimitiveCount, 1);
+
+		ANKI_TEST_EXPECT_EQ(loader.getSubMeshMeshlets().getSize(), 1);
+		ANKI_TEST_EXPECT_EQ(loader.getSubMeshMeshlets()[0].m_firstMeshlet, 0);
+		ANKI_TEST_EXPECT_EQ(loader.getSubMeshMeshlets()[0].m_meshletCount, 1);
+
+		ANKI_TEST_EXPECT_EQ(loader.getMeshlets().getSize(), 1);
+		const MeshBinaryMeshlet& meshlet = loader.getMeshlets()[0];
+		ANKI_TEST_EXPECT_EQ(meshlet.m_firstVertex, 0);
+		ANKI_TEST_EXPECT_EQ(meshlet.m_vertexCount, 3);
+		ANKI_TEST_EXPECT_EQ(meshlet.m_firstPrimitive, 0);
+		ANKI_TEST_EXPECT_EQ(meshlet.m_primitiveCount, 1);
+		ANKI_TEST_EXPECT_EQ(meshlet.m_sphereCenter, mesh.m_meshlet.m_sphereCenter);
+		ANKI_TEST_EXPECT_EQ(meshlet.m_sphereRadius, mesh.m_meshlet.m_sphereRadius);
+		ANKI_TEST_EXPECT_EQ(meshlet.m_coneAxis, mesh.m_meshlet.m_coneAxis);
+		ANKI_TEST_EXPECT_EQ(meshlet.m_coneCutoff, mesh.m_meshlet.m_coneCutoff);
+
+		// The buffers around the meshlet section
+		Array<U16, 3> indices;
+		ANKI_TEST_EXPECT_NO_ERR(loader.storeIndexBuffer(&indices[0], sizeof(indices)));
+		ANKI_TEST_EXPECT_EQ(memcmp(&indices[0], &mesh.m_indices[0], sizeof(indices)), 0);
+
+		Array<Vec3, 3> positions;
+		ANKI_TEST_EXPECT_NO_ERR(loader.storeVertexBuffer(0, &positions[0], sizeof(positions)));
+		ANKI_TEST_EXPECT_EQ(memcmp(&positions[0], &mesh.m_positions[0], sizeof(positions)), 0);
+
+		Array<U16, 3> meshletVertexIndices;
+		ANKI_TEST_EXPECT_NO_ERR(
+			loader.storeMeshletVertexIndices(&meshletVertexIndices[0], sizeof(meshletVertexIndices)));
+		ANKI_TEST_EXPECT_EQ(
+			memcmp(&meshletVertexIndices[0], &mesh.m_meshletVertexIndices[0], sizeof(meshletVertexIndices)), 0);
+
+		Array<U8Vec4, 1> meshletPrimitives;
+		ANKI_TEST_EXPECT_NO_ERR(loader.storeMeshletPrimitives(&meshletPrimitives[0], sizeof(meshletPrimitives)));
+		ANKI_TEST_EXPECT_EQ(meshletPrimitives[0], mesh.m_meshletPrimitives[0]);
+	}
+
+	// Meshlet out of the vertex index range
+	{
+		TestMesh mesh;
+		mesh.m_meshlet.m_firstVertex = 1;
+		ANKI_TEST_EXPECT_NO_ERR(mesh.write("/tmp/MeshBinaryLoaderTest.ankimesh"));
+
+		MeshBinaryLoader loader(&fs, alloc);
+		ANKI_TEST_EXPECT_ERR(loader.load("MeshBinaryLoaderTest.ankimesh"), Error::USER_DATA);
+	}
+
+	// Meshlet out of the primitive range
+	{
+		TestMesh mesh;
+		mesh.m_meshlet.m_primitiveCount = 2;
+		ANKI_TEST_EXPECT_NO_ERR(mesh.write("/tmp/MeshBinaryLoaderTest.ankimesh"));
+
+		MeshBinaryLoader loader(&fs, alloc);
+		ANKI_TEST_EXPECT_ERR(loader.load("MeshBinaryLoaderTest.ankimesh"), Error::USER_DATA);
+	}
+
+	// Sub mesh meshlet ranges don't add up
+	{
+		TestMesh mesh;
+		mesh.m_subMeshMeshlets.m_meshletCount = 2;
+		ANKI_TEST_EXPECT_NO_ERR(mesh.write("/tmp/MeshBinaryLoaderTest.ankimesh"));
+
+		MeshBinaryLoader loader(&fs, alloc);
+		ANKI_TEST_EXPECT_ERR(loader.load("MeshBinaryLoaderTest.ankimesh"), Error::USER_DATA);
+	}
+
+	// Truncated file
+	{
+		const TestMesh mesh;
+		ANKI_TEST_EXPECT_NO_ERR(mesh.write("/tmp/MeshBinaryLoaderTest.ankimesh", true));
+
+		MeshBinaryLoader loader(&fs, alloc);
+		ANKI_TEST_EXPECT_ERR(loader.load("MeshBinaryLoaderTest.ankimesh"), Error::USER_DATA);
+	}
+}
+
+} // end namespace anki
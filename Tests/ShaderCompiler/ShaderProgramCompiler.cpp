@@ -6,6 +6,8 @@
 #include <Tests/Framework/Framework.h>
 #include <AnKi/ShaderCompiler/ShaderProgramCompiler.h>
 #include <AnKi/Util/ThreadHive.h>
+#include <AnKi/Util/HighRezTimer.h>
+#include <AnKi/Util/System.h>
 
 ANKI_TEST(ShaderCompiler, ShaderProgramCompilerSimple)
 {
@@ -342,3 +344,167 @@ void main()
 	ANKI_LOGI("Binary disassembly:\n%s\n", dis.cstr());
 #endif
 }
+
+ANKI_TEST(ShaderCompiler, ShaderProgramCompilerDedup)
+{
+	// Only A affects the vertex shader and only B, C and D affect the fragment shader. The rest of the mutators produce
+	// identical SPIR-V that should be shared
+	const CString sourceCode = R"(
+#pragma anki mutator A 0 1
+#pragma anki mutator B 0 1
+#pragma anki mutator C 0 1
+#pragma anki mutator D 0 1
+#pragma anki mutator E 0 1
+#pragma anki mutator F 0 1
+#pragma anki mutator G 0 1
+
+#pragma anki start vert
+out gl_PerVertex
+{
+	Vec4 gl_Position;
+};
+
+void main()
+{
+	gl_Position = Vec4(F32(gl_VertexID + A));
+}
+#pragma anki end
+
+#pragma anki start frag
+layout(location = 0) out Vec3 out_color;
+
+void main()
+{
+	out_color = Vec3(F32(B + C * 2 + D * 4));
+}
+#pragma anki end
+	)";
+
+	// Write the file
+	{
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open("test.glslp", FileOpenFlag::WRITE));
+		ANKI_TEST_EXPECT_NO_ERR(file.writeText(sourceCode));
+	}
+
+	class Fsystem : public ShaderProgramFilesystemInterface
+	{
+	public:
+		Error readAllText(CString filename, StringAuto& txt) final
+		{
+			File file;
+			ANKI_CHECK(file.open(filename, FileOpenFlag::READ));
+			ANKI_CHECK(file.readAllText(txt));
+			return Error::NONE;
+		}
+	} fsystem;
+
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	class TaskManager : public ShaderProgramAsyncTaskInterface
+	{
+	public:
+		ThreadHive* m_hive = nullptr;
+		HeapAllocator<U8> m_alloc;
+
+		void enqueueTask(void (*callback)(void* userData), void* userData)
+		{
+			struct Ctx
+			{
+				void (*m_callback)(void* userData);
+				void* m_userData;
+				HeapAllocator<U8> m_alloc;
+			};
+			Ctx* ctx = m_alloc.newInstance<Ctx>();
+			ctx->m_callback = callback;
+			ctx->m_userData = userData;
+			ctx->m_alloc = m_alloc;
+
+			m_hive->submitTask(
+				[](void* userData, U32 threadId, ThreadHive& hive, ThreadHiveSemaphore* signalSemaphore) {
+					Ctx* ctx = static_cast<Ctx*>(userData);
+					ctx->m_callback(ctx->m_userData);
+					auto alloc = ctx->m_alloc;
+					alloc.deleteInstance(ctx);
+				},
+				ctx);
+		}
+
+		Error joinTasks()
+		{
+			m_hive->waitAllTasks();
+			return Error::NONE;
+		}
+	};
+
+	// Compile with a different number of threads to see how it scales
+	const U32 maxThreadCount = max(getCpuCoresCount(), 4u);
+	Second singleThreadTime = 0.0;
+	for(U32 threadCount = 1; threadCount <= maxThreadCount; threadCount *= 2)
+	{
+		ThreadHive hive(threadCount, alloc);
+		TaskManager taskManager;
+		taskManager.m_hive = &hive;
+		taskManager.m_alloc = alloc;
+
+		ShaderProgramBinaryWrapper binaryw(alloc);
+
+		HighRezTimer timer;
+		timer.start();
+		ANKI_TEST_EXPECT_NO_ERR(compileShaderProgram("test.glslp", fsystem, nullptr, &taskManager, alloc,
+													 ShaderCompilerOptions(), binaryw));
+		timer.stop();
+
+		singleThreadTime = (threadCount == 1) ? timer.getElapsedTime() : singleThreadTime;
+		ANKI_TEST_LOGI("%u threads: %f ms (speedup %f)", threadCount, timer.getElapsedTime() * 1000.0,
+					   singleThreadTime / timer.getElapsedTime());
+
+		const ShaderProgramBinary& binary = binaryw.getBinary();
+		ANKI_TEST_EXPECT_EQ(binary.m_variants.getSize(), 128);
+		ANKI_TEST_EXPECT_EQ(binary.m_codeBlocks.getSize(), 2 + 8);
+
+		// Check that every variant points to the correct code
+		for(const ShaderProgramBinaryMutation& mutation : binary.m_mutations)
+		{
+			const ShaderProgramBinaryVariant& variant = binary.m_variants[mutation.m_variantIndex];
+			for(const ShaderProgramBinaryMutation& other : binary.m_mutations)
+			{
+				const ShaderProgramBinaryVariant& otherVariant = binary.m_variants[other.m_variantIndex];
+
+				const Bool sameVert = mutation.m_values[0] == other.m_values[0];
+				ANKI_TEST_EXPECT_EQ(variant.m_codeBlockIndices[ShaderType::VERTEX]
+										== otherVariant.m_codeBlockIndices[ShaderType::VERTEX],
+									sameVert);
+
+				const Bool sameFrag = mutation.m_values[1] == other.m_values[1]
+									  && mutation.m_values[2] == other.m_values[2]
+									  && mutation.m_values[3] == other.m_values[3];
+				ANKI_TEST_EXPECT_EQ(variant.m_codeBlockIndices[ShaderType::FRAGMENT]
+										== otherVariant.m_codeBlockIndices[ShaderType::FRAGMENT],
+									sameFrag);
+			}
+		}
+
+		// Round trip through a file. The loaded binary is memory mapped and accessed in place
+		if(threadCount == 1)
+		{
+			ANKI_TEST_EXPECT_NO_ERR(binaryw.serializeToFile("test.ankiprogbin"));
+
+			ShaderProgramBinaryWrapper loadedw(alloc);
+			ANKI_TEST_EXPECT_NO_ERR(loadedw.deserializeFromFile("test.ankiprogbin"));
+			const ShaderProgramBinary& loaded = loadedw.getBinary();
+
+			ANKI_TEST_EXPECT_EQ(loaded.m_variants.getSize(), binary.m_variants.getSize());
+			ANKI_TEST_EXPECT_EQ(loaded.m_mutations.getSize(), binary.m_mutations.getSize());
+			ANKI_TEST_EXPECT_EQ(loaded.m_codeBlocks.getSize(), binary.m_codeBlocks.getSize());
+			for(U32 i = 0; i < loaded.m_codeBlocks.getSize(); ++i)
+			{
+				const ShaderProgramBinaryCodeBlock& a = loaded.m_codeBlocks[i];
+				const ShaderProgramBinaryCodeBlock& b = binary.m_codeBlocks[i];
+				ANKI_TEST_EXPECT_EQ(a.m_hash, b.m_hash);
+				ANKI_TEST_EXPECT_EQ(a.m_binary.getSize(), b.m_binary.getSize());
+				ANKI_TEST_EXPECT_EQ(memcmp(a.m_binary.getBegin(), b.m_binary.getBegin(), a.m_binary.getSize()), 0);
+			}
+		}
+	}
+}
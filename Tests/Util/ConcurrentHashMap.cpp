@@ -0,0 +1,220 @@
+// Copyright (C) 2009-2022, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <AnKi/Util/ConcurrentHashMap.h>
+#include <AnKi/Util/ThreadPool.h>
+#include <AnKi/Util/HighRezTimer.h>
+#include <AnKi/Util/String.h>
+
+namespace anki {
+
+ANKI_TEST(Util, ConcurrentHashMap)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	// Simple
+	{
+		ConcurrentHashMap<U64, U32> map;
+		ANKI_TEST_EXPECT_EQ(map.find(U64(123)), nullptr);
+
+		for(U32 i = 0; i < 1000; ++i)
+		{
+			U32* val = map.emplace(alloc, U64(i) * 7919, i);
+			ANKI_TEST_EXPECT_EQ(*val, i);
+		}
+
+		ANKI_TEST_EXPECT_EQ(map.getSize(), 1000);
+
+		for(U32 i = 0; i < 1000; ++i)
+		{
+			const U32* val = map.find(U64(i) * 7919);
+			ANKI_TEST_EXPECT_NEQ(val, nullptr);
+			ANKI_TEST_EXPECT_EQ(*val, i);
+			ANKI_TEST_EXPECT_EQ(map.find(U64(i) * 7919 + 1), nullptr);
+		}
+
+		U32 count = 0;
+		map.iterate([&](U64 key, U32& val) {
+			ANKI_TEST_EXPECT_EQ(key, U64(val) * 7919);
+			++count;
+		});
+		ANKI_TEST_EXPECT_EQ(count, 1000);
+
+		map.destroy(alloc);
+	}
+
+	// Lookup with a different key type
+	{
+		ConcurrentHashMap<StringAuto, U32> map;
+		StringAuto key(alloc);
+		key.create("Sponza");
+		map.emplace(alloc, std::move(key), 10u);
+
+		ANKI_TEST_EXPECT_EQ(*map.findAs(CString("Sponza")), 10);
+		ANKI_TEST_EXPECT_EQ(map.findAs(CString("Sky")), nullptr);
+
+		map.destroy(alloc);
+	}
+
+	constexpr U32 THREAD_COUNT = 8;
+	ThreadPool threadPool(THREAD_COUNT);
+
+	// Readers that run concurrently with a writer
+	{
+		constexpr U32 KEY_COUNT = 64 * 1024;
+		ConcurrentHashMap<U64, U64> map;
+		Mutex mtx;
+
+		class Task : public ThreadPoolTask
+		{
+		public:
+			ConcurrentHashMap<U64, U64>* m_map = nullptr;
+			Mutex* m_mtx = nullptr;
+			HeapAllocator<U8> m_alloc;
+			Atomic<U32> m_failures = {0};
+
+			Error operator()(U32 taskId, PtrSize threadsCount)
+			{
+				U32 seed = taskId * 7919 + 1;
+				for(U32 i = 0; i < KEY_COUNT; ++i)
+				{
+					seed = seed * 1103515245 + 12345;
+					const U64 key = (seed >> 8) % KEY_COUNT + 1;
+
+					// Get or create like the factories do
+					U64* val = m_map->find(key);
+					if(val == nullptr)
+					{
+						LockGuard<Mutex> lock(*m_mtx);
+						val = m_map->find(key);
+						if(val == nullptr)
+						{
+							val = m_map->emplace(m_alloc, key, key * 3);
+						}
+					}
+
+					if(*val != key * 3)
+					{
+						m_failures.fetchAdd(1);
+					}
+				}
+
+				return Error::NONE;
+			}
+		};
+
+		Task task;
+		task.m_map = &map;
+		task.m_mtx = &mtx;
+		task.m_alloc = alloc;
+		for(U32 i = 0; i < THREAD_COUNT; ++i)
+		{
+			threadPool.assignNewTask(i, &task);
+		}
+		ANKI_TEST_EXPECT_NO_ERR(threadPool.waitForAllThreadsToFinish());
+
+		ANKI_TEST_EXPECT_EQ(task.m_failures.load(), 0);
+		U32 count = 0;
+		map.iterate([&](U64 key, U64& val) {
+			ANKI_TEST_EXPECT_EQ(val, key * 3);
+			++count;
+		});
+		ANKI_TEST_EXPECT_EQ(count, map.getSize());
+
+		map.destroy(alloc);
+	}
+
+	// Reader scaling bench against a HashMap with a RWMutex
+	{
+		constexpr U32 KEY_COUNT = 1024;
+		constexpr U32 LOOKUP_COUNT = 1024 * 1024;
+
+		class Hasher
+		{
+		public:
+			U64 operator()(U64 x) const
+			{
+				return x;
+			}
+		};
+
+		HashMap<U64, U64, Hasher> lockedMap;
+		RWMutex lockedMapMtx;
+		ConcurrentHashMap<U64, U64> map;
+		for(U64 i = 0; i < KEY_COUNT; ++i)
+		{
+			const U64 key = computeHash(&i, sizeof(i));
+			lockedMap.emplace(alloc, key, i);
+			map.emplace(alloc, key, i);
+		}
+
+		class Task : public ThreadPoolTask
+		{
+		public:
+			HashMap<U64, U64, Hasher>* m_lockedMap = nullptr;
+			RWMutex* m_lockedMapMtx = nullptr;
+			ConcurrentHashMap<U64, U64>* m_map = nullptr;
+			Bool m_locked = false;
+			Array<U64, THREAD_COUNT> m_sums = {};
+
+			Error operator()(U32 taskId, PtrSize threadsCount)
+			{
+				U64 sum = 0;
+				for(U64 i = 0; i < LOOKUP_COUNT; ++i)
+				{
+					const U64 idx = (i * 7 + taskId) % KEY_COUNT;
+					const U64 key = computeHash(&idx, sizeof(idx));
+					if(m_locked)
+					{
+						RLockGuard<RWMutex> lock(*m_lockedMapMtx);
+						sum += *m_lockedMap->find(key);
+					}
+					else
+					{
+						sum += *m_map->find(key);
+					}
+				}
+
+				m_sums[taskId] = sum;
+				return Error::NONE;
+			}
+		};
+
+		for(U32 threadCount = 1; threadCount <= THREAD_COUNT; threadCount *= 2)
+		{
+			Array<Second, 2> times;
+			for(U32 locked = 0; locked < 2; ++locked)
+			{
+				Task task;
+				task.m_lockedMap = &lockedMap;
+				task.m_lockedMapMtx = &lockedMapMtx;
+				task.m_map = &map;
+				task.m_locked = locked;
+
+				HighRezTimer timer;
+				timer.start();
+				for(U32 i = 0; i < THREAD_COUNT; ++i)
+				{
+					threadPool.assignNewTask(i, (i < threadCount) ? &task : nullptr);
+				}
+				ANKI_TEST_EXPECT_NO_ERR(threadPool.waitForAllThreadsToFinish());
+				timer.stop();
+				times[locked] = timer.getElapsedTime();
+			}
+
+			const F64 lookups = F64(LOOKUP_COUNT) * threadCount;
+			ANKI_TEST_LOGI("Lookup bench with %u threads: RWMutex+HashMap %f Mlookups/s "
+						   "ConcurrentHashMap %f Mlookups/s | %f%%",
+						   threadCount, lookups / times[1] / 1000000.0, lookups / times[0] / 1000000.0,
+						   times[1] / times[0] * 100.0);
+		}
+
+		lockedMap.destroy(alloc);
+		map.destroy(alloc);
+	}
+}
+
+} // end namespace anki
@@ -0,0 +1,101 @@
+// Copyright (C) 2009-2022, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <AnKi/Util/CpuHwCounters.h>
+#include <AnKi/Util/Tracer.h>
+
+namespace anki {
+
+ANKI_TEST(Util, CpuHwCounters)
+{
+	CpuHwCounters counters;
+	if(counters.init())
+	{
+		// Not an error, the counters are optional
+		ANKI_TEST_LOGW("CPU HW counters are not available. Skipping the test");
+		CpuHwCounterValues values;
+		counters.read(values);
+		for(U64 v : values)
+		{
+			ANKI_TEST_EXPECT_EQ(v, 0);
+		}
+		return;
+	}
+
+	for(CpuHwCounter c = CpuHwCounter::FIRST; c < CpuHwCounter::COUNT; ++c)
+	{
+		ANKI_TEST_LOGI("%s: %s", CpuHwCounters::getCounterName(c).cstr(),
+					   (counters.isCounterSupported(c)) ? "supported" : "not supported");
+	}
+
+	CpuHwCounterValues begin;
+	counters.read(begin);
+
+	volatile U64 sum = 0;
+	for(U32 i = 0; i < 1000000; ++i)
+	{
+		sum = sum + i;
+	}
+
+	CpuHwCounterValues end;
+	counters.read(end);
+
+	for(CpuHwCounter c = CpuHwCounter::FIRST; c < CpuHwCounter::COUNT; ++c)
+	{
+		ANKI_TEST_EXPECT_GEQ(end[c], begin[c]);
+	}
+
+	if(counters.isCounterSupported(CpuHwCounter::INSTRUCTIONS))
+	{
+		ANKI_TEST_EXPECT_GT(end[CpuHwCounter::INSTRUCTIONS] - begin[CpuHwCounter::INSTRUCTIONS], 1000000);
+	}
+
+	// The tracer should add one counter per supported HW counter
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	Tracer tracer(alloc);
+	tracer.setEnabled(true);
+	tracer.setHwCountersEnabled(true);
+
+	{
+		const TracerHwEventHandle handle = tracer.beginHwEvent();
+		for(U32 i = 0; i < 1000; ++i)
+		{
+			sum = sum + i;
+		}
+		tracer.endHwEvent("EVENT", handle);
+	}
+
+	class Ctx
+	{
+	public:
+		U32 m_eventCount = 0;
+		U32 m_counterCount = 0;
+		Bool m_foundContextSwitches = false;
+	} ctx;
+
+	tracer.flush(
+		[](void* ud, ThreadId tid, ConstWeakArray<TracerEvent> events, ConstWeakArray<TracerCounter> counters) {
+			Ctx& ctx = *static_cast<Ctx*>(ud);
+			ctx.m_eventCount += events.getSize();
+			ctx.m_counterCount += counters.getSize();
+			for(const TracerCounter& counter : counters)
+			{
+				ctx.m_foundContextSwitches = ctx.m_foundContextSwitches || counter.m_name == "EVENT.context_switches";
+			}
+		},
+		&ctx);
+
+	ANKI_TEST_EXPECT_EQ(ctx.m_eventCount, 1);
+	U32 supportedCount = 0;
+	for(CpuHwCounter c = CpuHwCounter::FIRST; c < CpuHwCounter::COUNT; ++c)
+	{
+		supportedCount += counters.isCounterSupported(c);
+	}
+	ANKI_TEST_EXPECT_EQ(ctx.m_counterCount, supportedCount);
+	ANKI_TEST_EXPECT_EQ(ctx.m_foundContextSwitches, counters.isCounterSupported(CpuHwCounter::CONTEXT_SWITCHES));
+}
+
+} // end namespace anki
@@ -6,6 +6,7 @@
 #include <Tests/Framework/Framework.h>
 #include <AnKi/Util/Filesystem.h>
 #include <AnKi/Util/File.h>
+#include <AnKi/Util/HighRezTimer.h>
 
 ANKI_TEST(Util, FileExists)
 {
@@ -130,3 +131,28 @@ ANKI_TEST(Util, WalkDir)
 
 	ANKI_TEST_EXPECT_EQ(count, 1);
 }
+
+ANKI_TEST(Util, FileModificationTime)
+{
+	File file;
+	ANKI_TEST_EXPECT_NO_ERR(file.open("./tmp_mtime", FileOpenFlag::WRITE));
+	ANKI_TEST_EXPECT_NO_ERR(file.writeText("1"));
+	file.close();
+
+	U64 timestampA, timestampB;
+	ANKI_TEST_EXPECT_NO_ERR(getFileModificationTime("./tmp_mtime", timestampA));
+	ANKI_TEST_EXPECT_NO_ERR(getFileModificationTime("./tmp_mtime", timestampB));
+	ANKI_TEST_EXPECT_EQ(timestampA, timestampB);
+
+	// Give some time to filesystems with coarse timestamps
+	HighRezTimer::sleep(1.1);
+
+	ANKI_TEST_EXPECT_NO_ERR(file.open("./tmp_mtime", FileOpenFlag::WRITE));
+	ANKI_TEST_EXPECT_NO_ERR(file.writeText("2"));
+	file.close();
+
+	ANKI_TEST_EXPECT_NO_ERR(getFileModificationTime("./tmp_mtime", timestampB));
+	ANKI_TEST_EXPECT_GT(timestampB, timestampA);
+
+	ANKI_TEST_EXPECT_EQ(getFileModificationTime("./tmp_doesnt_exist", timestampB), Error::FUNCTION_FAILED);
+}
@@ -0,0 +1,92 @@
+// Copyright (C) 2009-2022, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <AnKi/Util/Hash.h>
+#include <AnKi/Util/HighRezTimer.h>
+#include <vector>
+
+namespace anki {
+
+ANKI_TEST(Util, Hash)
+{
+	std::vector<U8> data(1_MB);
+	for(U32 i = 0; i < data.size(); ++i)
+	{
+		data[i] = U8(i * 31 + 7);
+	}
+
+	// Compare with the reference XXH3 64bit. The sizes cover all the code paths
+	{
+		class Reference
+		{
+		public:
+			PtrSize m_size;
+			U64 m_hashSeed0;
+			U64 m_hashSeed123;
+		};
+
+		const Array<Reference, 16> references = {{{0, 0x2D06800538D394C2ull, 0x3616479B9A94FDA7ull},
+												  {1, 0x4C5CCA45D0F4811Full, 0xD130572FEAE800DBull},
+												  {3, 0x15F7093B173D005Cull, 0x46C5618A1D38B6CEull},
+												  {4, 0xDCA012F95811B6B9ull, 0x594D68E12F0D7784ull},
+												  {8, 0xDEC6A9A43575982Eull, 0x20E399196D1BBC0Cull},
+												  {9, 0xCBE393399F17FFBDull, 0x32383207241543F6ull},
+												  {16, 0x7E484C18D74895D0ull, 0x6DD306CEA5C41BD3ull},
+												  {17, 0x208BDE5EE2BED407ull, 0xEB4DE381B9C53A00ull},
+												  {128, 0xF92B70EAA21A6288ull, 0x7A9F9A4B705D0979ull},
+												  {129, 0xF8F76713F2BB60FAull, 0xF7210E58BC85C6D8ull},
+												  {240, 0xCCC7375172C41F03ull, 0x56503AEE3043CC79ull},
+												  {241, 0x0B3B630948CE4A00ull, 0x2500FD3D8A6A4898ull},
+												  {1024, 0x23BC880EBF0D29C6ull, 0x2E85FD9A3F183B2Aull},
+												  {1025, 0xC09FDFBC398C7D82ull, 0x4CAF5FA4AE9F4188ull},
+												  {4096, 0xA3C19F8174CDE0BBull, 0x5ED3FD55734F638Full},
+												  {100000, 0xCCF90DF7E7E37036ull, 0x2868B3860BF4D062ull}}};
+
+		for(const Reference& ref : references)
+		{
+			ANKI_TEST_EXPECT_EQ(computeHash(&data[0], ref.m_size, 0), ref.m_hashSeed0);
+			ANKI_TEST_EXPECT_EQ(computeHash(&data[0], ref.m_size), ref.m_hashSeed123);
+			ANKI_TEST_EXPECT_EQ(appendHash(&data[0], ref.m_size, 123), ref.m_hashSeed123);
+		}
+	}
+
+	// Unaligned input
+	{
+		std::vector<U8> copy(data.begin(), data.begin() + 4096 + 1);
+		memmove(&copy[1], &copy[0], 4096);
+		ANKI_TEST_EXPECT_EQ(computeHash(&copy[1], 4096, 0), 0xA3C19F8174CDE0BBull);
+	}
+
+	// Bench against the old algorithm
+	{
+		constexpr PtrSize TOTAL_SIZE = 256_MB;
+		const Array<PtrSize, 6> sizes = {16, 64, 256, 4_KB, 64_KB, 1_MB};
+
+		for(PtrSize size : sizes)
+		{
+			const PtrSize iterationCount = TOTAL_SIZE / size;
+			U64 sum = 0;
+			Array<Second, 2> times;
+			for(U32 algorithm = 0; algorithm < 2; ++algorithm)
+			{
+				HighRezTimer timer;
+				timer.start();
+				for(PtrSize i = 0; i < iterationCount; ++i)
+				{
+					sum += (algorithm == 0) ? computeMurmurHash2(&data[0], size, i) : computeHash(&data[0], size, i);
+				}
+				timer.stop();
+				times[algorithm] = timer.getElapsedTime();
+			}
+
+			ANKI_TEST_LOGI("Hash bench %zuB: MurmurHash2 %f GB/s XXH3 %f GB/s | %f%% (%lu)", size,
+						   F64(TOTAL_SIZE) / F64(1_GB) / times[0], F64(TOTAL_SIZE) / F64(1_GB) / times[1],
+						   times[0] / times[1] * 100.0, sum);
+		}
+	}
+}
+
+} // end namespace anki
@@ -6,6 +6,8 @@
 #include <Tests/Framework/Framework.h>
 #include <Tests/Util/Foo.h>
 #include <AnKi/Util/HashMap.h>
+#include <AnKi/Util/SwissHashMap.h>
+#include <AnKi/Util/String.h>
 #include <AnKi/Util/DynamicArray.h>
 #include <AnKi/Util/HighRezTimer.h>
 #include <unordered_map>
@@ -254,3 +256,210 @@ ANKI_TEST(Util, HashMap)
 		akMap.destroy(alloc);
 	}
 }
+
+ANKI_TEST(Util, SwissHashMap)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	// Simple
+	{
+		SwissHashMap<int, int, Hasher> map;
+		ANKI_TEST_EXPECT_EQ(map.find(20), map.getEnd());
+		map.emplace(alloc, 20, 1);
+		map.emplace(alloc, 21, 2);
+		ANKI_TEST_EXPECT_EQ(map.getSize(), 2);
+		ANKI_TEST_EXPECT_EQ(*map.find(20), 1);
+		ANKI_TEST_EXPECT_EQ(*map.find(21), 2);
+		ANKI_TEST_EXPECT_EQ(map.find(21).getKey(), 21);
+		ANKI_TEST_EXPECT_EQ(map.find(22), map.getEnd());
+		map.destroy(alloc);
+	}
+
+	// Keys with the same hash
+	{
+		class BadHasher
+		{
+		public:
+			U64 operator()(int x) const
+			{
+				return x & 1;
+			}
+		};
+
+		SwissHashMap<int, int, BadHasher> map;
+		for(int i = 0; i < 100; ++i)
+		{
+			map.emplace(alloc, i, i * 10);
+		}
+
+		for(int i = 0; i < 100; ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(*map.find(i), i * 10);
+		}
+
+		map.destroy(alloc);
+	}
+
+	// Lookup with a different key type
+	{
+		SwissHashMapAuto<StringAuto, int> map(alloc);
+		const Array<CString, 4> names = {"Sponza", "Cornell", "Sky", "Car"};
+		for(U32 i = 0; i < names.getSize(); ++i)
+		{
+			StringAuto key(alloc);
+			key.create(names[i]);
+			map.emplace(std::move(key), i);
+		}
+
+		for(U32 i = 0; i < names.getSize(); ++i)
+		{
+			auto it = map.find(names[i]);
+			ANKI_TEST_EXPECT_NEQ(it, map.getEnd());
+			ANKI_TEST_EXPECT_EQ(*it, I32(i));
+			ANKI_TEST_EXPECT_EQ(it.getKey(), names[i]);
+		}
+
+		ANKI_TEST_EXPECT_EQ(map.find(CString("Terrain")), map.getEnd());
+		map.erase(map.find(CString("Sky")));
+		ANKI_TEST_EXPECT_EQ(map.find(CString("Sky")), map.getEnd());
+		ANKI_TEST_EXPECT_EQ(map.getSize(), 3);
+	}
+
+	// Fuzzy test against the STL
+	{
+		SwissHashMap<int, int, Hasher> akMap;
+		std::unordered_map<int, int> stdMap;
+
+		for(U32 i = 0; i < 100000; ++i)
+		{
+			const int key = rand() % 2000;
+			auto it = akMap.find(key);
+			auto stdIt = stdMap.find(key);
+			ANKI_TEST_EXPECT_EQ(it == akMap.getEnd(), stdIt == stdMap.end());
+
+			if(stdIt == stdMap.end())
+			{
+				akMap.emplace(alloc, key, int(i));
+				stdMap[key] = int(i);
+			}
+			else
+			{
+				ANKI_TEST_EXPECT_EQ(*it, stdIt->second);
+				if(rand() % 2)
+				{
+					akMap.erase(alloc, it);
+					stdMap.erase(stdIt);
+				}
+			}
+
+			ANKI_TEST_EXPECT_EQ(akMap.getSize(), stdMap.size());
+		}
+
+		// Iterate
+		PtrSize count = 0;
+		for(auto it = akMap.getBegin(); it != akMap.getEnd(); ++it)
+		{
+			ANKI_TEST_EXPECT_EQ(stdMap[it.getKey()], *it);
+			++count;
+		}
+		ANKI_TEST_EXPECT_EQ(count, stdMap.size());
+
+		akMap.destroy(alloc);
+	}
+
+	// Bench it against the HashMap
+	{
+		constexpr U32 COUNT = 1024 * 1024;
+		std::vector<int> vals(COUNT);
+		{
+			std::unordered_map<int, int> tmpMap;
+			for(U32 i = 0; i < COUNT; ++i)
+			{
+				int v;
+				do
+				{
+					v = rand();
+				} while(tmpMap.find(v) != tmpMap.end());
+				tmpMap[v] = 1;
+
+				vals[i] = v;
+			}
+		}
+
+		HashMap<int, int, Hasher> akMap;
+		SwissHashMap<int, int, Hasher> swissMap;
+		HighRezTimer timer;
+		Array<Second, 2> times;
+
+		// Insertion
+		timer.start();
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			akMap.emplace(alloc, vals[i], vals[i]);
+		}
+		timer.stop();
+		times[0] = timer.getElapsedTime();
+
+		timer.start();
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			swissMap.emplace(alloc, vals[i], vals[i]);
+		}
+		timer.stop();
+		times[1] = timer.getElapsedTime();
+
+		ANKI_TEST_LOGI("Inserting bench: HashMap %f SwissHashMap %f | %f%%", times[0], times[1],
+					   times[0] / times[1] * 100.0);
+
+		// Find existing and missing keys
+		I64 count = 0;
+		std::random_shuffle(vals.begin(), vals.end());
+
+		timer.start();
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			count += *akMap.find(vals[i]);
+			count += akMap.find(vals[i] + 1) != akMap.getEnd();
+		}
+		timer.stop();
+		times[0] = timer.getElapsedTime();
+
+		timer.start();
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			count += *swissMap.find(vals[i]);
+			count += swissMap.find(vals[i] + 1) != swissMap.getEnd();
+		}
+		timer.stop();
+		times[1] = timer.getElapsedTime();
+
+		ANKI_TEST_LOGI("Find bench: HashMap %f SwissHashMap %f | %f%% (%ld)", times[0], times[1],
+					   times[0] / times[1] * 100.0, count);
+
+		// Erase
+		std::random_shuffle(vals.begin(), vals.end());
+
+		timer.start();
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			akMap.erase(alloc, akMap.find(vals[i]));
+		}
+		timer.stop();
+		times[0] = timer.getElapsedTime();
+
+		timer.start();
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			swissMap.erase(alloc, swissMap.find(vals[i]));
+		}
+		timer.stop();
+		times[1] = timer.getElapsedTime();
+
+		ANKI_TEST_LOGI("Deleting bench: HashMap %f SwissHashMap %f | %f%%", times[0], times[1],
+					   times[0] / times[1] * 100.0);
+
+		ANKI_TEST_EXPECT_EQ(swissMap.getSize(), 0);
+		akMap.destroy(alloc);
+		swissMap.destroy(alloc);
+	}
+}
@@ -0,0 +1,114 @@
+// Copyright (C) 2009-2022, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <AnKi/Util/Logger.h>
+#include <AnKi/Util/ThreadPool.h>
+#include <AnKi/Util/HighRezTimer.h>
+#include <AnKi/Util/File.h>
+
+namespace anki {
+
+namespace {
+
+constexpr U32 THREAD_COUNT = 8;
+constexpr U32 MESSAGES_PER_THREAD = 20 * 1024;
+
+class MessageCounter
+{
+public:
+	Array<U32, THREAD_COUNT> m_nextMessage = {};
+	U32 m_count = 0;
+	U32 m_outOfOrder = 0;
+};
+
+} // end namespace
+
+static void countMessage(void* ud, const LoggerMessageInfo& info)
+{
+	MessageCounter& counter = *static_cast<MessageCounter*>(ud);
+
+	U32 thread, msg;
+	if(sscanf(info.m_msg, "Thread %u message %u", &thread, &msg) != 2 || thread >= THREAD_COUNT)
+	{
+		++counter.m_outOfOrder;
+		return;
+	}
+
+	// The messages of a single thread should arrive in order
+	if(counter.m_nextMessage[thread] != msg)
+	{
+		++counter.m_outOfOrder;
+	}
+
+	counter.m_nextMessage[thread] = msg + 1;
+	++counter.m_count;
+}
+
+ANKI_TEST(Util, Logger)
+{
+	ThreadPool threadPool(THREAD_COUNT);
+
+	class Task : public ThreadPoolTask
+	{
+	public:
+		Logger* m_logger = nullptr;
+
+		Error operator()(U32 taskId, PtrSize threadsCount)
+		{
+			for(U32 i = 0; i < MESSAGES_PER_THREAD; ++i)
+			{
+				m_logger->writeFormated(ANKI_FILE, __LINE__, ANKI_FUNC, "Test", LoggerMessageType::NORMAL, 0,
+										"Thread %u message %u", taskId, i);
+			}
+
+			return Error::NONE;
+		}
+	};
+
+	Array<Second, 2> times;
+	for(U32 async = 0; async < 2; ++async)
+	{
+		// The file outlives the logger
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open("LoggerTest.txt", FileOpenFlag::WRITE));
+
+		Logger logger;
+		logger.removeSystemMessageHandler();
+
+		MessageCounter counter;
+		logger.addMessageHandler(&counter, countMessage);
+		logger.addFileMessageHandler(&file);
+
+		logger.setAsync(async);
+		ANKI_TEST_EXPECT_EQ(logger.getAsync(), Bool(async));
+
+		Task task;
+		task.m_logger = &logger;
+
+		HighRezTimer timer;
+		timer.start();
+		for(U32 i = 0; i < THREAD_COUNT; ++i)
+		{
+			threadPool.assignNewTask(i, &task);
+		}
+		ANKI_TEST_EXPECT_NO_ERR(threadPool.waitForAllThreadsToFinish());
+		timer.stop();
+		times[async] = timer.getElapsedTime();
+
+		logger.flush();
+		ANKI_TEST_EXPECT_EQ(counter.m_count, THREAD_COUNT * MESSAGES_PER_THREAD);
+		ANKI_TEST_EXPECT_EQ(counter.m_outOfOrder, 0);
+
+		logger.setAsync(false);
+	}
+
+	const F64 messageCount = F64(THREAD_COUNT * MESSAGES_PER_THREAD);
+	ANKI_TEST_LOGI("Logger bench: sync %f ns/message async %f ns/message (producer side) | %f%%",
+				   times[0] / messageCount * 1000000000.0, times[1] / messageCount * 1000000000.0,
+				   times[1] / times[0] * 100.0);
+}
+
+} // end namespace anki
@@ -7,6 +7,8 @@
 #include <Tests/Util/Foo.h>
 #include <AnKi/Util/Memory.h>
 #include <AnKi/Util/ThreadPool.h>
+#include <AnKi/Util/ThreadHive.h>
+#include <AnKi/Util/HighRezTimer.h>
 #include <type_traits>
 #include <cstring>
 
@@ -33,6 +35,135 @@ ANKI_TEST(Util, HeapMemoryPool)
 	}
 }
 
+ANKI_TEST(Util, ThreadCachingHeapMemoryPool)
+{
+	// Simple
+	{
+		HeapMemoryPool pool(allocAligned, nullptr, "Test", true);
+		ANKI_TEST_EXPECT_EQ(pool.isThreadCaching(), true);
+
+		// Small, big and over-aligned
+		Array<PtrSize, 6> sizes = {1, 16, 250, 2000, 5000, 100};
+		Array<PtrSize, 6> alignments = {1, 16, 8, 16, 16, 64};
+		Array<U8*, 6> ptrs;
+		for(U32 i = 0; i < sizes.getSize(); ++i)
+		{
+			ptrs[i] = static_cast<U8*>(pool.allocate(sizes[i], alignments[i]));
+			ANKI_TEST_EXPECT_NEQ(ptrs[i], nullptr);
+			ANKI_TEST_EXPECT_EQ(isAligned(alignments[i], ptrs[i]), true);
+			memset(ptrs[i], i, sizes[i]);
+		}
+
+		for(U32 i = 0; i < sizes.getSize(); ++i)
+		{
+			for(U32 j = 0; j < sizes[i]; ++j)
+			{
+				ANKI_TEST_EXPECT_EQ(ptrs[i][j], i);
+			}
+			pool.free(ptrs[i]);
+		}
+
+		ANKI_TEST_EXPECT_EQ(pool.getAllocationCount(), 0);
+
+		// The 2nd time should hit the cache
+		void* ptr = pool.allocate(16, 16);
+		pool.free(ptr);
+
+		HeapMemoryPoolStats stats;
+		pool.getStats(stats);
+		ANKI_TEST_EXPECT_EQ(stats.m_smallObjectUsedSize, 0);
+		ANKI_TEST_EXPECT_GT(stats.m_smallObjectReservedSize, 0);
+		ANKI_TEST_EXPECT_GT(stats.m_threadCacheHits, 0);
+	}
+
+	// Allocate in one thread, free in another and bench it against the plain pool
+	{
+		constexpr U32 THREAD_COUNT = 8;
+		constexpr U32 ALLOCATION_COUNT = 128 * 1024;
+		constexpr U32 LIVE_ALLOCATION_COUNT = 256;
+		ThreadPool threadPool(THREAD_COUNT);
+
+		class AllocateTask : public ThreadPoolTask
+		{
+		public:
+			HeapMemoryPool* m_pool = nullptr;
+			Array<void*, LIVE_ALLOCATION_COUNT>* m_liveAllocations = nullptr;
+			Bool m_failed = false;
+
+			Error operator()(U32 taskId, PtrSize threadsCount)
+			{
+				Array<void*, LIVE_ALLOCATION_COUNT>& live = *m_liveAllocations;
+				U32 seed = taskId * 7919 + 1;
+				for(U32 i = 0; i < ALLOCATION_COUNT; ++i)
+				{
+					seed = seed * 1103515245 + 12345;
+					const U32 slot = (seed >> 8) % LIVE_ALLOCATION_COUNT;
+					const PtrSize size = (seed >> 16) % 512 + 1;
+
+					if(live[slot])
+					{
+						m_failed = m_failed || *static_cast<U8*>(live[slot]) != U8(slot);
+						m_pool->free(live[slot]);
+					}
+
+					live[slot] = m_pool->allocate(size, 8);
+					*static_cast<U8*>(live[slot]) = U8(slot);
+				}
+
+				return Error::NONE;
+			}
+		};
+
+		Array<Second, 2> times;
+		for(U32 threadCaching = 0; threadCaching < 2; ++threadCaching)
+		{
+			HeapMemoryPool pool(allocAligned, nullptr, "Bench", threadCaching);
+			Array<Array<void*, LIVE_ALLOCATION_COUNT>, THREAD_COUNT> liveAllocations = {};
+			Array<AllocateTask, THREAD_COUNT> tasks;
+
+			HighRezTimer timer;
+			timer.start();
+			for(U32 round = 0; round < 2; ++round)
+			{
+				// The 2nd round frees the allocations the previous thread did
+				for(U32 i = 0; i < THREAD_COUNT; ++i)
+				{
+					tasks[i].m_pool = &pool;
+					tasks[i].m_liveAllocations = &liveAllocations[(i + round) % THREAD_COUNT];
+					threadPool.assignNewTask(i, &tasks[i]);
+				}
+
+				ANKI_TEST_EXPECT_NO_ERR(threadPool.waitForAllThreadsToFinish());
+			}
+			timer.stop();
+			times[threadCaching] = timer.getElapsedTime();
+
+			for(U32 i = 0; i < THREAD_COUNT; ++i)
+			{
+				ANKI_TEST_EXPECT_EQ(tasks[i].m_failed, false);
+				for(void* ptr : liveAllocations[i])
+				{
+					pool.free(ptr);
+				}
+			}
+
+			ANKI_TEST_EXPECT_EQ(pool.getAllocationCount(), 0);
+
+			if(threadCaching)
+			{
+				HeapMemoryPoolStats stats;
+				pool.getStats(stats);
+				ANKI_TEST_EXPECT_EQ(stats.m_smallObjectUsedSize, 0);
+				ANKI_TEST_LOGI("Thread caching stats: reserved %zu, hit rate %f", stats.m_smallObjectReservedSize,
+							   stats.m_threadCacheHitRate);
+			}
+		}
+
+		ANKI_TEST_LOGI("Allocation bench: Heap %f ThreadCaching %f | %f%%", times[0], times[1],
+					   times[0] / times[1] * 100.0);
+	}
+}
+
 ANKI_TEST(Util, StackMemoryPool)
 {
 	// Create/destroy test
@@ -158,6 +289,78 @@ ANKI_TEST(Util, StackMemoryPool)
 	}
 }
 
+ANKI_TEST(Util, StackMemoryPoolThreadSlots)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	// Many threads allocate small objects like the visibility tests do. Compare one chunk list against one per thread
+	for(U32 threadCount : {16u, 32u, 64u})
+	{
+		ThreadHive hive(threadCount, alloc);
+		constexpr U32 TASK_COUNT = 256;
+		constexpr U32 ALLOCATIONS_PER_TASK = 2048;
+
+		class Task
+		{
+		public:
+			StackMemoryPool* m_pool;
+			U32 m_id;
+			Bool m_failed = false;
+			Array<U32*, ALLOCATIONS_PER_TASK> m_allocations;
+		};
+
+		Array<Second, 2> times;
+		for(U32 perThread = 0; perThread < 2; ++perThread)
+		{
+			StackMemoryPool pool(allocAligned, nullptr, 64_KB, 2.0, 0, true, ANKI_SAFE_ALIGNMENT, "Bench",
+								 (perThread) ? threadCount + 1 : 1);
+
+			Array<Task, TASK_COUNT> tasks;
+			for(U32 i = 0; i < TASK_COUNT; ++i)
+			{
+				tasks[i].m_pool = &pool;
+				tasks[i].m_id = i;
+			}
+
+			HighRezTimer timer;
+			timer.start();
+			for(Task& task : tasks)
+			{
+				hive.submitTask(
+					[](void* ud, U32 threadId, ThreadHive& hive, ThreadHiveSemaphore* sem) {
+						Task& task = *static_cast<Task*>(ud);
+						for(U32 i = 0; i < ALLOCATIONS_PER_TASK; ++i)
+						{
+							U32* ptr = static_cast<U32*>(task.m_pool->allocate(sizeof(U32) * ((i % 8) + 1), 4));
+							*ptr = task.m_id;
+							task.m_allocations[i] = ptr;
+						}
+					},
+					&task);
+			}
+			hive.waitAllTasks();
+			timer.stop();
+			times[perThread] = timer.getElapsedTime();
+
+			// Check that no allocations overlapped
+			for(const Task& task : tasks)
+			{
+				for(U32* ptr : task.m_allocations)
+				{
+					ANKI_TEST_EXPECT_EQ(*ptr, task.m_id);
+					pool.free(ptr);
+				}
+			}
+
+			ANKI_TEST_EXPECT_EQ(pool.getAllocationCount(), 0);
+			pool.reset();
+		}
+
+		ANKI_TEST_LOGI("Stack allocation bench with %u threads: Shared %f PerThread %f | %f%%", threadCount, times[0],
+					   times[1], times[0] / times[1] * 100.0);
+	}
+}
+
 ANKI_TEST(Util, ChainMemoryPool)
 {
 	// Basic test
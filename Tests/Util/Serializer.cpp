@@ -67,3 +67,66 @@ ANKI_TEST(Util, BinarySerializer)
 		alloc.deleteInstance(pa);
 	}
 }
+
+ANKI_TEST(Util, BinarySerializerInPlace)
+{
+	Array<ClassB, 2> b = {};
+	b[0].m_array[0] = 2;
+	b[0].m_array[1] = 3;
+	b[0].m_array[2] = 4;
+	Array<U32, 3> bDarr = {{0xFF12EE34, 0xAA12BB34, 0xCC12DD34}};
+	b[0].m_darray = bDarr;
+	b[1].m_array[0] = 255;
+	b[1].m_array[1] = 127;
+	b[1].m_array[2] = 55;
+
+	ClassA a = {};
+	a.m_array[0] = 123;
+	a.m_u32 = 321;
+	a.m_u64 = 0x123456789ABCDEFF;
+	a.m_darray = b;
+
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	// Serialize
+	{
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open("serialized_in_place.bin", FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+		BinarySerializer serializer;
+		ANKI_TEST_EXPECT_NO_ERR(serializer.serialize(a, alloc, file));
+	}
+
+	// Map and deserialize
+	{
+		MappedFile mappedFile;
+		ANKI_TEST_EXPECT_NO_ERR(mappedFile.map("serialized_in_place.bin"));
+
+		ClassA* pa;
+		ANKI_TEST_EXPECT_NO_ERR(
+			BinaryDeserializer::deserializeInPlace(pa, mappedFile.getData(), mappedFile.getSize()));
+
+		const U8* begin = static_cast<const U8*>(mappedFile.getData());
+		ANKI_TEST_EXPECT_EQ(ptrToNumber(pa) > ptrToNumber(begin), true);
+		ANKI_TEST_EXPECT_EQ(ptrToNumber(pa) < ptrToNumber(begin + mappedFile.getSize()), true);
+
+		ANKI_TEST_EXPECT_EQ(pa->m_array[0], a.m_array[0]);
+		ANKI_TEST_EXPECT_EQ(pa->m_u32, a.m_u32);
+		ANKI_TEST_EXPECT_EQ(pa->m_u64, a.m_u64);
+		ANKI_TEST_EXPECT_EQ(pa->m_darray.getSize(), 2);
+		ANKI_TEST_EXPECT_EQ(pa->m_darray[1].m_array[1], 127);
+		ANKI_TEST_EXPECT_EQ(pa->m_darray[0].m_darray.getSize(), 3);
+		ANKI_TEST_EXPECT_EQ(pa->m_darray[0].m_darray[2], 0xCC12DD34);
+		ANKI_TEST_EXPECT_EQ(pa->m_darray[1].m_darray.getSize(), 0);
+	}
+
+	// The private mapping didn't modify the file
+	{
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open("serialized_in_place.bin", FileOpenFlag::READ | FileOpenFlag::BINARY));
+		BinaryDeserializer deserializer;
+		ClassA* pa;
+		ANKI_TEST_EXPECT_NO_ERR(deserializer.deserialize(pa, alloc, file));
+		ANKI_TEST_EXPECT_EQ(pa->m_darray[0].m_darray[1], 0xAA12BB34);
+		alloc.deleteInstance(pa);
+	}
+}
@@ -0,0 +1,187 @@
+// Copyright (C) 2009-2022, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <AnKi/Util/TlsfAllocatorBuilder.h>
+#include <AnKi/Util/BuddyAllocatorBuilder.h>
+#include <tuple>
+
+namespace anki {
+
+/// Check if all memory has the same value.
+static int memvcmp(const void* memory, U8 val, PtrSize size)
+{
+	const U8* mm = static_cast<const U8*>(memory);
+	return (*mm == val) && memcmp(mm, mm + 1, size - 1) == 0;
+}
+
+ANKI_TEST(Util, TlsfAllocatorBuilder)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	// Simple
+	{
+		TlsfAllocatorBuilder<Mutex> tlsf(alloc, 1000);
+
+		Array<PtrSize, 3> addr;
+		Bool success = tlsf.allocate(100, 1, addr[0]);
+		ANKI_TEST_EXPECT_EQ(success, true);
+		ANKI_TEST_EXPECT_EQ(addr[0], 0);
+
+		success = tlsf.allocate(200, 64, addr[1]);
+		ANKI_TEST_EXPECT_EQ(success, true);
+		ANKI_TEST_EXPECT_EQ(addr[1] % 64, 0);
+		ANKI_TEST_EXPECT_GEQ(addr[1], 100);
+
+		// Not a power of two and there is not enough space for the size plus the alignment
+		success = tlsf.allocate(900, 1, addr[2]);
+		ANKI_TEST_EXPECT_EQ(success, false);
+
+		tlsf.free(addr[0], 100, 1);
+		tlsf.free(addr[1], 200, 64);
+
+		// Everything is merged back to a single block
+		success = tlsf.allocate(1000, 1, addr[2]);
+		ANKI_TEST_EXPECT_EQ(success, true);
+		ANKI_TEST_EXPECT_EQ(addr[2], 0);
+
+		TlsfAllocatorBuilderStats stats;
+		tlsf.getStats(stats);
+		ANKI_TEST_EXPECT_EQ(stats.m_userAllocatedSize, 1000);
+		ANKI_TEST_EXPECT_EQ(stats.m_realAllocatedSize, 1000);
+		ANKI_TEST_EXPECT_EQ(stats.m_freeBlockCount, 0);
+
+		tlsf.free(addr[2], 1000, 1);
+	}
+
+	// Fragmentation metrics
+	{
+		TlsfAllocatorBuilder<SpinLock> tlsf(alloc, 1024);
+
+		Array<PtrSize, 4> addr;
+		for(PtrSize& a : addr)
+		{
+			ANKI_TEST_EXPECT_EQ(tlsf.allocate(256, 1, a), true);
+		}
+
+		// Free every other block. Half the memory is free but the largest block is a quarter
+		tlsf.free(addr[0], 256, 1);
+		tlsf.free(addr[2], 256, 1);
+
+		TlsfAllocatorBuilderStats stats;
+		tlsf.getStats(stats);
+		ANKI_TEST_EXPECT_EQ(stats.m_freeBlockCount, 2);
+		ANKI_TEST_EXPECT_EQ(stats.m_largestFreeBlockSize, 256);
+		ANKI_TEST_EXPECT_NEAR(stats.m_externalFragmentation, 0.5f, EPSILON);
+		ANKI_TEST_EXPECT_NEAR(stats.m_internalFragmentation, 0.0f, EPSILON);
+
+		PtrSize tmp;
+		ANKI_TEST_EXPECT_EQ(tlsf.allocate(512, 1, tmp), false);
+
+		tlsf.free(addr[1], 256, 1);
+		tlsf.free(addr[3], 256, 1);
+	}
+
+	// Fuzzy with alignment. Compare with the buddy allocator while at it
+	{
+		constexpr U32 MEMORY_RANGE_LOG2 = 26;
+		constexpr PtrSize MEMORY_RANGE = PtrSize(1) << MEMORY_RANGE_LOG2;
+
+		TlsfAllocatorBuilder<Mutex> tlsf(alloc, MEMORY_RANGE);
+		BuddyAllocatorBuilder<32, Mutex> buddy(alloc, MEMORY_RANGE_LOG2);
+		std::vector<std::tuple<PtrSize, U32, U32, U8>> allocations;
+		std::vector<std::tuple<U32, U32, U32>> buddyAllocations;
+
+		U8* backingMemory = static_cast<U8*>(malloc(MEMORY_RANGE));
+
+		for(U32 it = 0; it < 20000; ++it)
+		{
+			if((getRandom() % 3) != 0)
+			{
+				// Do an allocation
+				PtrSize addr;
+				const U32 size = max<U32>(U32(getRandom() % 1_MB), 1);
+				const U32 alignment = max<U32>(U32(getRandom() % 24), 1);
+				const Bool success = tlsf.allocate(size, alignment, addr);
+				if(success)
+				{
+					ANKI_TEST_EXPECT_EQ(addr % alignment, 0);
+					ANKI_TEST_EXPECT_LEQ(addr + size, MEMORY_RANGE);
+
+					const U8 bufferValue = U8(getRandom() % MAX_U8);
+					memset(backingMemory + addr, bufferValue, size);
+					allocations.push_back({addr, size, alignment, bufferValue});
+				}
+
+				// Use the alignment the vertex memory uses
+				U32 buddyAddr;
+				if(buddy.allocate(size, 4, buddyAddr))
+				{
+					buddyAllocations.push_back({buddyAddr, size, 4});
+				}
+			}
+			else
+			{
+				// Do some deallocation
+				if(allocations.size())
+				{
+					const PtrSize randPos = getRandom() % allocations.size();
+
+					const PtrSize address = std::get<0>(allocations[randPos]);
+					const U32 size = std::get<1>(allocations[randPos]);
+					const U32 alignment = std::get<2>(allocations[randPos]);
+					const U8 bufferValue = std::get<3>(allocations[randPos]);
+
+					ANKI_TEST_EXPECT_EQ(memvcmp(backingMemory + address, bufferValue, size), 1);
+
+					tlsf.free(address, size, alignment);
+					allocations.erase(allocations.begin() + randPos);
+				}
+
+				if(buddyAllocations.size())
+				{
+					const PtrSize randPos = getRandom() % buddyAllocations.size();
+					buddy.free(std::get<0>(buddyAllocations[randPos]), std::get<1>(buddyAllocations[randPos]),
+							   std::get<2>(buddyAllocations[randPos]));
+					buddyAllocations.erase(buddyAllocations.begin() + randPos);
+				}
+			}
+		}
+		free(backingMemory);
+
+		// Get the fragmentation
+		TlsfAllocatorBuilderStats stats;
+		tlsf.getStats(stats);
+		ANKI_TEST_LOGI("TLSF: allocations %zu, userAllocatedSize %zu, realAllocatedSize %zu, externalFragmentation %f, "
+					   "internalFragmentation %f, freeBlocks %u",
+					   allocations.size(), stats.m_userAllocatedSize, stats.m_realAllocatedSize,
+					   stats.m_externalFragmentation, stats.m_internalFragmentation, stats.m_freeBlockCount);
+
+		BuddyAllocatorBuilderStats buddyStats;
+		buddy.getStats(buddyStats);
+		ANKI_TEST_LOGI("Buddy: allocations %zu, userAllocatedSize %zu, realAllocatedSize %zu, externalFragmentation "
+					   "%f, internalFragmentation %f",
+					   buddyAllocations.size(), buddyStats.m_userAllocatedSize, buddyStats.m_realAllocatedSize,
+					   buddyStats.m_externalFragmentation, buddyStats.m_internalFragmentation);
+
+		// Remove the remaining
+		for(const auto& a : allocations)
+		{
+			tlsf.free(std::get<0>(a), std::get<1>(a), std::get<2>(a));
+		}
+
+		for(const auto& a : buddyAllocations)
+		{
+			buddy.free(std::get<0>(a), std::get<1>(a), std::get<2>(a));
+		}
+
+		tlsf.getStats(stats);
+		ANKI_TEST_EXPECT_EQ(stats.m_userAllocatedSize, 0);
+		ANKI_TEST_EXPECT_EQ(stats.m_freeBlockCount, 1);
+		ANKI_TEST_EXPECT_EQ(stats.m_largestFreeBlockSize, MEMORY_RANGE);
+	}
+}
+
+} // end namespace anki
@@ -6,14 +6,18 @@
 #include <Tests/Framework/Framework.h>
 #include <AnKi/Util/Tracer.h>
 #include <AnKi/Core/CoreTracer.h>
+#include <AnKi/Core/TraceFile.h>
+#include <AnKi/Core/ConfigSet.h>
 #include <AnKi/Util/HighRezTimer.h>
+#include <AnKi/Util/ThreadPool.h>
 
 #if ANKI_ENABLE_TRACE
 ANKI_TEST(Util, Tracer)
 {
 	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	ConfigSet config(allocAligned, nullptr);
 	CoreTracer tracer;
-	ANKI_TEST_EXPECT_NO_ERR(tracer.init(alloc, "./"));
+	ANKI_TEST_EXPECT_NO_ERR(tracer.init(alloc, "./", config));
 	TracerSingleton::get().setEnabled(true);
 
 	// 1st frame
@@ -54,3 +58,230 @@ ANKI_TEST(Util, Tracer)
 	tracer.flushFrame(4);
 }
 #endif
+
+ANKI_TEST(Util, TraceFile)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	// Write a few events of 2 threads
+	Array<TracerEvent, 4> events;
+	events[0].m_name = "Render";
+	events[0].m_start = 10.0;
+	events[0].m_duration = 0.016;
+	events[1].m_name = "Physics";
+	events[1].m_start = 10.002;
+	events[1].m_duration = 0.004;
+	events[2].m_name = "Render";
+	events[2].m_start = 9.5; // Not sorted
+	events[2].m_duration = 0.001;
+	events[3].m_name = "Physics";
+	events[3].m_start = 11.0;
+	events[3].m_duration = 0.000001;
+
+	{
+		TraceFileWriter writer;
+		ANKI_TEST_EXPECT_NO_ERR(writer.open(alloc, "./test.ankitrace"));
+		ANKI_TEST_EXPECT_NO_ERR(writer.writeEvents(100, 1, ConstWeakArray<TracerEvent>(&events[0], 3)));
+		ANKI_TEST_EXPECT_NO_ERR(writer.writeEvents(200, 2, ConstWeakArray<TracerEvent>(&events[3], 1)));
+
+		// Delta timestamps and interned names should be way smaller than the raw events
+		ANKI_TEST_EXPECT_LEQ(writer.getWrittenSize(), sizeof(events));
+	}
+
+	// Read them back
+	{
+		TraceFileReader reader(alloc);
+		ANKI_TEST_EXPECT_NO_ERR(reader.open("./test.ankitrace"));
+
+		for(U32 i = 0; i < events.getSize(); ++i)
+		{
+			TraceFileEvent event;
+			Bool endOfFile;
+			ANKI_TEST_EXPECT_NO_ERR(reader.readNextEvent(event, endOfFile));
+			ANKI_TEST_EXPECT_EQ(endOfFile, false);
+
+			ANKI_TEST_EXPECT_EQ(event.m_name, events[i].m_name);
+			ANKI_TEST_EXPECT_EQ(event.m_tid, (i < 3) ? 100 : 200);
+			ANKI_TEST_EXPECT_EQ(event.m_frame, (i < 3) ? 1 : 2);
+			ANKI_TEST_EXPECT_EQ(event.m_startNs, U64(events[i].m_start * 1000000000.0));
+			ANKI_TEST_EXPECT_EQ(event.m_durationNs, U64(events[i].m_duration * 1000000000.0));
+		}
+
+		TraceFileEvent event;
+		Bool endOfFile;
+		ANKI_TEST_EXPECT_NO_ERR(reader.readNextEvent(event, endOfFile));
+		ANKI_TEST_EXPECT_EQ(endOfFile, true);
+	}
+}
+
+ANKI_TEST(Util, TracerFlightRecorder)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	Tracer tracer(alloc);
+	tracer.setEnabled(true);
+	tracer.setMaxChunksPerThread(2);
+
+	// Write way more events than the limit
+	constexpr U32 EVENT_COUNT = 10000;
+	for(U32 i = 0; i < EVENT_COUNT; ++i)
+	{
+		tracer.addCustomEvent("EVENT", Second(i + 1), 1.0);
+	}
+
+	// Only the most recent should remain
+	tracer.discardOldChunks();
+
+	class Ctx
+	{
+	public:
+		Second m_oldest = MAX_SECOND;
+		Second m_newest = 0.0;
+		U32 m_count = 0;
+	} ctx;
+
+	tracer.flush(
+		[](void* ud, ThreadId tid, ConstWeakArray<TracerEvent> events, ConstWeakArray<TracerCounter> counters) {
+			Ctx& ctx = *static_cast<Ctx*>(ud);
+			for(const TracerEvent& event : events)
+			{
+				ctx.m_oldest = min(ctx.m_oldest, event.m_start);
+				ctx.m_newest = max(ctx.m_newest, event.m_start);
+				++ctx.m_count;
+			}
+		},
+		&ctx);
+
+	ANKI_TEST_EXPECT_GT(ctx.m_count, 0);
+	ANKI_TEST_EXPECT_LT(ctx.m_count, EVENT_COUNT);
+	ANKI_TEST_EXPECT_EQ(ctx.m_newest, Second(EVENT_COUNT));
+	ANKI_TEST_EXPECT_EQ(ctx.m_oldest, Second(EVENT_COUNT - ctx.m_count + 1));
+}
+
+ANKI_TEST(Util, TracerConcurrentFlush)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	Tracer tracer(alloc);
+	tracer.setEnabled(true);
+
+	constexpr U32 THREAD_COUNT = 4;
+	constexpr U32 EVENT_COUNT = 100000;
+	ThreadPool threadPool(THREAD_COUNT);
+
+	class Task : public ThreadPoolTask
+	{
+	public:
+		Tracer* m_tracer = nullptr;
+		Atomic<U32> m_done = {0};
+
+		Error operator()(U32 taskId, PtrSize threadsCount)
+		{
+			for(U32 i = 0; i < EVENT_COUNT; ++i)
+			{
+				m_tracer->addCustomEvent("EVENT", Second(i + 1), 1.0);
+				if((i % 3) == 0)
+				{
+					m_tracer->incrementCounter("COUNTER", 1);
+				}
+			}
+
+			m_done.fetchAdd(1);
+			return Error::NONE;
+		}
+	};
+
+	Task task;
+	task.m_tracer = &tracer;
+	for(U32 i = 0; i < THREAD_COUNT; ++i)
+	{
+		threadPool.assignNewTask(i, &task);
+	}
+
+	// Flush while the threads are writing. Every event should be seen once and in order
+	class Ctx
+	{
+	public:
+		HashMap<ThreadId, Second> m_lastStart;
+		HeapAllocator<U8> m_alloc;
+		U64 m_eventCount = 0;
+		U64 m_counterSum = 0;
+		U32 m_failures = 0;
+	} ctx;
+	ctx.m_alloc = alloc;
+
+	auto flush = [&]() {
+		tracer.flush(
+			[](void* ud, ThreadId tid, ConstWeakArray<TracerEvent> events, ConstWeakArray<TracerCounter> counters) {
+				Ctx& ctx = *static_cast<Ctx*>(ud);
+				auto it = ctx.m_lastStart.find(tid);
+				if(it == ctx.m_lastStart.getEnd())
+				{
+					it = ctx.m_lastStart.emplace(ctx.m_alloc, tid, 0.0);
+				}
+
+				for(const TracerEvent& event : events)
+				{
+					ctx.m_failures += (event.m_start != *it + 1.0);
+					*it = event.m_start;
+				}
+
+				for(const TracerCounter& counter : counters)
+				{
+					ctx.m_counterSum += counter.m_value;
+				}
+
+				ctx.m_eventCount += events.getSize();
+			},
+			&ctx);
+	};
+
+	while(task.m_done.load() < THREAD_COUNT)
+	{
+		flush();
+	}
+	ANKI_TEST_EXPECT_NO_ERR(threadPool.waitForAllThreadsToFinish());
+	flush();
+
+	ANKI_TEST_EXPECT_EQ(ctx.m_failures, 0);
+	ANKI_TEST_EXPECT_EQ(ctx.m_eventCount, U64(EVENT_COUNT) * THREAD_COUNT);
+	ANKI_TEST_EXPECT_EQ(ctx.m_counterSum, U64((EVENT_COUNT + 2) / 3) * THREAD_COUNT);
+	ctx.m_lastStart.destroy(alloc);
+}
+
+ANKI_TEST(Util, TracerOverhead)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	TracerSingleton::init(alloc);
+
+	constexpr U32 EVENT_COUNT = 1000000;
+	constexpr U32 FLUSH_EVERY = 64 * 1024;
+
+	auto bench = [&](Bool enabled) -> Second {
+		Tracer& tracer = TracerSingleton::get();
+		tracer.setEnabled(enabled);
+
+		Second total = 0.0;
+		for(U32 i = 0; i < EVENT_COUNT; i += FLUSH_EVERY)
+		{
+			HighRezTimer timer;
+			timer.start();
+			for(U32 j = 0; j < FLUSH_EVERY; ++j)
+			{
+				TracerScopedEvent event("EVENT");
+			}
+			timer.stop();
+			total += timer.getElapsedTime();
+
+			tracer.flush([](void*, ThreadId, ConstWeakArray<TracerEvent>, ConstWeakArray<TracerCounter>) {}, nullptr);
+		}
+
+		return total;
+	};
+
+	const Second disabled = bench(false);
+	const Second enabled = bench(true);
+	const U32 count = (EVENT_COUNT + FLUSH_EVERY - 1) / FLUSH_EVERY * FLUSH_EVERY;
+	ANKI_TEST_LOGI("Scoped event cost: disabled %f ns, enabled %f ns", disabled / count * 1000000000.0,
+				   enabled / count * 1000000000.0);
+
+	TracerSingleton::destroy();
+}
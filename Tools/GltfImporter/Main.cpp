@@ -12,6 +12,8 @@ Options:
 -rpath <string>        : Replace all absolute paths of assets with that path
 -texrpath <string>     : Same as rpath but for textures
 -optimize-meshes <0|1> : Optimize meshes. Default is 1
+-meshlets <0|1>        : Generate meshlets. Default is 1
+-incremental <0|1>     : Skip the outputs that are up to date. Default is 1
 -j <thread_count>      : Number of threads. Defaults to system's max
 -lod-count <1|2|3>     : The number of geometry LODs to generate. Default: 1
 -lod-factor <float>    : The decimate factor for each LOD. Default 0.25
@@ -27,6 +29,8 @@ public:
 	StringAuto m_rpath = {m_alloc};
 	StringAuto m_texRpath = {m_alloc};
 	Bool m_optimizeMeshes = true;
+	Bool m_generateMeshlets = true;
+	Bool m_incremental = true;
 	U32 m_threadCount = MAX_U32;
 	U32 m_lodCount = 1;
 	F32 m_lodFactor = 0.25f;
@@ -106,6 +110,36 @@ static Error parseCommandLineArgs(int argc, char** argv, CmdLineArgs& info)
 				return Error::USER_DATA;
 			}
 		}
+		else if(strcmp(argv[i], "-meshlets") == 0)
+		{
+			++i;
+
+			if(i < argc)
+			{
+				I meshlets = 1;
+				ANKI_CHECK(CString(argv[i]).toNumber(meshlets));
+				info.m_generateMeshlets = meshlets != 0;
+			}
+			else
+			{
+				return Error::USER_DATA;
+			}
+		}
+		else if(strcmp(argv[i], "-incremental") == 0)
+		{
+			++i;
+
+			if(i < argc)
+			{
+				I incremental = 1;
+				ANKI_CHECK(CString(argv[i]).toNumber(incremental));
+				info.m_incremental = incremental != 0;
+			}
+			else
+			{
+				return Error::USER_DATA;
+			}
+		}
 		else if(strcmp(argv[i], "-j") == 0)
 		{
 			++i;
@@ -206,6 +240,8 @@ int main(int argc, char** argv)
 	initInfo.m_rpath = cmdArgs.m_rpath;
 	initInfo.m_texrpath = cmdArgs.m_texRpath;
 	initInfo.m_optimizeMeshes = cmdArgs.m_optimizeMeshes;
+	initInfo.m_generateMeshlets = cmdArgs.m_generateMeshlets;
+	initInfo.m_incremental = cmdArgs.m_incremental;
 	initInfo.m_lodFactor = cmdArgs.m_lodFactor;
 	initInfo.m_lodCount = cmdArgs.m_lodCount;
 	initInfo.m_lightIntensityScale = cmdArgs.m_lightIntensityScale;
@@ -21,6 +21,12 @@ Options:
 -to-linear             : Convert sRGB to linear
 -to-srgb               : Convert linear to sRGB
 -flip-image <0|1>      : Flip the image. Default is 1
+-s3tc-quality <q>      : Quality of the built-in S3TC encoder. One of: fast, normal, high. Default is normal
+-compressonator <0|1>  : Use compressonatorcli for S3TC instead of the built-in encoder. Default is 0
+-threads <number>      : Max number of threads of mip generation and compression. By default use all cores
+-mip-filter <filter>   : The mipmap filter. One of: box, kaiser, lanczos. Default is box
+-srgb-mips             : The image is sRGB. Generate the mipmaps in linear space
+-normal-map            : The image is a normal map. Renormalize the mipmaps
 )";
 
 static Error parseCommandLineArgs(int argc, char** argv, ImageImporterConfig& config,
@@ -198,6 +204,95 @@ static Error parseCommandLineArgs(int argc, char** argv, ImageImporterConfig& co
 				return Error::USER_DATA;
 			}
 		}
+		else if(CString(argv[i]) == "-s3tc-quality")
+		{
+			++i;
+			if(i >= argc)
+			{
+				return Error::USER_DATA;
+			}
+
+			if(CString(argv[i]) == "fast")
+			{
+				config.m_s3tcQuality = BcEncoderQuality::FAST;
+			}
+			else if(CString(argv[i]) == "normal")
+			{
+				config.m_s3tcQuality = BcEncoderQuality::NORMAL;
+			}
+			else if(CString(argv[i]) == "high")
+			{
+				config.m_s3tcQuality = BcEncoderQuality::HIGH;
+			}
+			else
+			{
+				return Error::USER_DATA;
+			}
+		}
+		else if(CString(argv[i]) == "-compressonator")
+		{
+			++i;
+			if(i >= argc)
+			{
+				return Error::USER_DATA;
+			}
+
+			if(CString(argv[i]) == "1")
+			{
+				config.m_useCompressonator = true;
+			}
+			else if(CString(argv[i]) == "0")
+			{
+				config.m_useCompressonator = false;
+			}
+			else
+			{
+				return Error::USER_DATA;
+			}
+		}
+		else if(CString(argv[i]) == "-threads")
+		{
+			++i;
+			if(i >= argc)
+			{
+				return Error::USER_DATA;
+			}
+
+			ANKI_CHECK(CString(argv[i]).toNumber(config.m_threadCount));
+		}
+		else if(CString(argv[i]) == "-mip-filter")
+		{
+			++i;
+			if(i >= argc)
+			{
+				return Error::USER_DATA;
+			}
+
+			if(CString(argv[i]) == "box")
+			{
+				config.m_mipmapFilter = MipmapFilter::BOX;
+			}
+			else if(CString(argv[i]) == "kaiser")
+			{
+				config.m_mipmapFilter = MipmapFilter::KAISER;
+			}
+			else if(CString(argv[i]) == "lanczos")
+			{
+				config.m_mipmapFilter = MipmapFilter::LANCZOS;
+			}
+			else
+			{
+				return Error::USER_DATA;
+			}
+		}
+		else if(CString(argv[i]) == "-srgb-mips")
+		{
+			config.m_sRgbMipmaps = true;
+		}
+		else if(CString(argv[i]) == "-normal-map")
+		{
+			config.m_normalMap = true;
+		}
 		else
 		{
 			filenames.emplaceBack(filenames.getAllocator(), argv[i]);
@@ -0,0 +1,83 @@
+// Copyright (C) 2009-2022, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Core/TraceFile.h>
+#include <algorithm>
+
+using namespace anki;
+
+static const char* USAGE = R"(Convert an AnKi binary trace to the Chrome trace JSON format. Perfetto can open it as well
+Usage: %s in_file out_file
+)";
+
+static Error convert(CString inFname, CString outFname)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	// Read all events
+	TraceFileReader reader(alloc);
+	ANKI_CHECK(reader.open(inFname));
+
+	DynamicArrayAuto<TraceFileEvent> events(alloc);
+	while(true)
+	{
+		TraceFileEvent event;
+		Bool endOfFile;
+		ANKI_CHECK(reader.readNextEvent(event, endOfFile));
+		if(endOfFile)
+		{
+			break;
+		}
+
+		events.emplaceBack(event);
+	}
+
+	// Sort them to fix overlaping in chrome
+	std::sort(events.getBegin(), events.getEnd(), [](const TraceFileEvent& a, const TraceFileEvent& b) {
+		return (a.m_startNs != b.m_startNs) ? a.m_startNs < b.m_startNs : a.m_durationNs > b.m_durationNs;
+	});
+
+	// Write them
+	File file;
+	ANKI_CHECK(file.open(outFname, FileOpenFlag::WRITE));
+	ANKI_CHECK(file.writeText("{\"traceEvents\": [\n"));
+
+	for(U32 i = 0; i < events.getSize(); ++i)
+	{
+		const TraceFileEvent& event = events[i];
+
+		// Do a hack and put the GPU time on its own track
+		const ThreadId tid = (event.m_name == "GPU_TIME") ? 1 : event.m_tid;
+
+		ANKI_CHECK(file.writeText("{\"name\": \"%s\", \"cat\": \"PERF\", \"ph\": \"X\", \"pid\": 1, \"tid\": %llu, "
+								  "\"ts\": %.3f, \"dur\": %.3f, \"args\": {\"frame\": %llu}}%s\n",
+								  event.m_name.cstr(), tid, F64(event.m_startNs) / 1000.0,
+								  F64(event.m_durationNs) / 1000.0, event.m_frame,
+								  (i + 1 < events.getSize()) ? "," : ""));
+	}
+
+	ANKI_CHECK(file.writeText("]}\n"));
+
+	ANKI_LOGI("Converted %u events", events.getSize());
+	return Error::NONE;
+}
+
+int main(int argc, char** argv)
+{
+	if(argc != 3)
+	{
+		ANKI_LOGE(USAGE, argv[0]);
+		return 1;
+	}
+
+	const Error err = convert(argv[1], argv[2]);
+	if(err)
+	{
+		ANKI_LOGE("Can't convert due to an error. Bye");
+		return 1;
+	}
+
+	return 0;
+}